@@ -21,6 +21,7 @@
 #include "render/camera.h"
 #include "render/integrator.h"
 #include "render/scene.h"
+#include "render/scene_binary.h"
 #include "render/session.h"
 
 #include "util/util_args.h"
@@ -127,11 +128,22 @@ static void scene_init()
 {
   options.scene = new Scene(options.scene_params, options.session->device);
 
-  /* Read XML */
-  xml_read_file(options.scene, options.filepath.c_str());
+  /* Read binary scene or XML */
+  const bool is_binary = scene_binary_is_file(options.filepath);
+
+  if (is_binary) {
+    if (!scene_binary_read(options.scene, options.filepath)) {
+      exit(EXIT_FAILURE);
+    }
+  }
+  else {
+    xml_read_file(options.scene, options.filepath.c_str());
+  }
 
   /* Camera width/height override? */
-  if (!(options.width == 0 || options.height == 0)) {
+  const bool resolution_override = !(options.width == 0 || options.height == 0);
+
+  if (resolution_override) {
     options.scene->camera->width = options.width;
     options.scene->camera->height = options.height;
   }
@@ -140,8 +152,10 @@ static void scene_init()
     options.height = options.scene->camera->height;
   }
 
-  /* Calculate Viewplane */
-  options.scene->camera->compute_auto_viewplane();
+  /* Calculate Viewplane, binary scenes store the one computed by the host application. */
+  if (!is_binary || resolution_override) {
+    options.scene->camera->compute_auto_viewplane();
+  }
 }
 
 static void session_init()
@@ -392,7 +406,7 @@ static void options_parse(int argc, const char **argv)
   bool help = false, debug = false, version = false;
   int verbosity = 1;
 
-  ap.options("Usage: cycles [options] file.xml",
+  ap.options("Usage: cycles [options] file.xml|file.cycles",
              "%*",
              files_parse,
              "",
@@ -501,7 +515,14 @@ static void options_parse(int argc, const char **argv)
 
   bool device_available = false;
   if (!devices.empty()) {
-    options.session_params.device = devices.front();
+    if (device_type == DEVICE_NETWORK) {
+      /* Render on all configured servers. */
+      options.session_params.device = Device::get_multi_device(
+          devices, options.session_params.threads, options.session_params.background);
+    }
+    else {
+      options.session_params.device = devices.front();
+    }
     device_available = true;
   }
 
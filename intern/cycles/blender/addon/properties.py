@@ -59,6 +59,12 @@ enum_bvh_layouts = (
     ('BVH8', "BVH8", "", 4),
 )
 
+enum_numa_modes = (
+    ('NONE', "None", "Let the operating system place scene data and render threads", 0),
+    ('INTERLEAVE', "Interleave", "Spread scene data evenly over the memory of all nodes", 1),
+    ('REPLICATE', "Replicate", "Copy scene data to the memory of every node, images are interleaved", 2),
+)
+
 enum_bvh_types = (
     ('DYNAMIC_BVH', "Dynamic BVH", "Objects can be individually updated, at the cost of slower render time"),
     ('STATIC_BVH', "Static BVH", "Any object modification requires a complete BVH rebuild, but renders faster"),
@@ -349,6 +355,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=0.0, max=1.0,
         default=0.01,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Pick lights by their estimated contribution to the shading point, instead of by area and light count. "
+        "Converges faster in scenes with many lights (only supported by CPU rendering)",
+        default=False,
+    )
 
     use_adaptive_sampling: BoolProperty(
         name="Use Adaptive Sampling",
@@ -644,12 +656,55 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Use special type BVH optimized for hair (uses more ram but renders faster)",
         default=True,
     )
+    use_checkpoint: BoolProperty(
+        name="Checkpoint",
+        description="Periodically save rendered tiles during final renders, so an interrupted render "
+        "resumes where it stopped when started again with the same scene and settings",
+        default=False,
+    )
+    checkpoint_directory: StringProperty(
+        name="Directory",
+        description="Directory to store checkpoint files in, they are removed once a render completes",
+        subtype='DIR_PATH',
+        default="//checkpoints/",
+    )
+    checkpoint_interval: FloatProperty(
+        name="Interval",
+        description="Time in seconds between saving checkpoints",
+        default=300.0,
+        min=1.0, soft_max=3600.0,
+    )
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Read tiles of tiled image files (.tx, tiled OpenEXR) on demand while rendering "
+        "on the CPU, instead of loading full images into memory",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        default=4096,
+        min=64, soft_max=65536,
+    )
+    use_compressed_geometry: BoolProperty(
+        name="Compressed Geometry",
+        description="Store mesh normals, texture coordinates and attributes with reduced precision "
+        "to save memory, at the cost of small shading differences",
+        default=False,
+    )
     debug_bvh_time_steps: IntProperty(
         name="BVH Time Steps",
         description="Split BVH primitives by this number of time steps to speed up render time in cost of memory",
         default=0,
         min=0, max=16,
     )
+    debug_export_scene_filepath: StringProperty(
+        name="Export Scene",
+        description="Write the synchronized scene to this file on final renders, "
+        "to render it with the standalone Cycles application",
+        subtype='FILE_PATH',
+        default="",
+    )
     tile_order: EnumProperty(
         name="Tile Order",
         description="Tile order for rendering",
@@ -789,6 +844,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default='BVH8',
     )
     debug_use_cpu_split_kernel: BoolProperty(name="Split Kernel", default=False)
+    debug_numa_mode: EnumProperty(
+        name="NUMA Mode",
+        description="Placement of scene data on systems with multiple NUMA nodes",
+        items=enum_numa_modes,
+        default='NONE',
+    )
 
     debug_use_cuda_adaptive_compile: BoolProperty(name="Adaptive Compile", default=False)
     debug_use_cuda_split_kernel: BoolProperty(name="Split Kernel", default=False)
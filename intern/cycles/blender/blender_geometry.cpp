@@ -24,6 +24,7 @@
 #include "blender/blender_util.h"
 
 #include "util/util_foreach.h"
+#include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -31,7 +32,10 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
                                      BL::Object &b_ob,
                                      BL::Object &b_ob_instance,
                                      bool object_updated,
-                                     bool use_particle_hair)
+                                     bool use_particle_hair,
+                                     uint motion_steps,
+                                     bool use_motion_blur,
+                                     TaskPool *task_pool)
 {
   /* Test if we can instance or if the object is modified. */
   BL::ID b_ob_data = b_ob.data();
@@ -87,6 +91,12 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
     geometry_map.add(key, geom);
   }
   else {
+    /* Ensure we only sync instanced geometry once. This is tested before anything else, since
+     * the geometry may be written by a sync task at this point. */
+    if (geometry_synced.find(geom) != geometry_synced.end()) {
+      return geom;
+    }
+
     /* Test if we need to update existing geometry. */
     sync = geometry_map.update(geom, b_key_id);
   }
@@ -118,31 +128,48 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
     }
   }
 
-  /* Ensure we only sync instanced geometry once. */
-  if (geometry_synced.find(geom) != geometry_synced.end()) {
-    return geom;
-  }
-
-  progress.set_sync_status("Synchronizing object", b_ob.name());
-
+  /* Bookkeeping is done here on the calling thread, only the conversion of the geometry data
+   * itself may run in the task pool. */
   geometry_synced.insert(geom);
 
   geom->name = ustring(b_ob_data.name().c_str());
 
+  /* Motion settings are read by the sync task, so they must be set before it is pushed. */
+  if (scene->need_motion() != Scene::MOTION_NONE) {
+    geom->motion_steps = motion_steps;
+    geom->use_motion_blur = use_motion_blur;
+  }
+
+  auto sync_func = [=]() mutable {
+    if (progress.get_cancel()) {
+      return;
+    }
+
+    progress.set_sync_status("Synchronizing object", b_ob.name());
+
 #ifdef WITH_NEW_OBJECT_TYPES
-  if (b_ob.type() == BL::Object::type_HAIR || use_particle_hair) {
+    if (b_ob.type() == BL::Object::type_HAIR || use_particle_hair) {
 #else
-  if (use_particle_hair) {
+    if (use_particle_hair) {
 #endif
-    sync_hair(b_depsgraph, b_ob, geom, used_shaders);
-  }
-  else if (b_ob.type() == BL::Object::type_VOLUME || object_fluid_gas_domain_find(b_ob)) {
-    Mesh *mesh = static_cast<Mesh *>(geom);
-    sync_volume(b_ob, mesh, used_shaders);
+      sync_hair(b_depsgraph, b_ob, geom, used_shaders);
+    }
+    else if (b_ob.type() == BL::Object::type_VOLUME || object_fluid_gas_domain_find(b_ob)) {
+      Mesh *mesh = static_cast<Mesh *>(geom);
+      sync_volume(b_ob, mesh, used_shaders);
+    }
+    else {
+      Mesh *mesh = static_cast<Mesh *>(geom);
+      sync_mesh(b_depsgraph, b_ob, mesh, used_shaders);
+    }
+  };
+
+  /* Defer the actual geometry sync to the task pool for multithreading. */
+  if (task_pool) {
+    task_pool->push(function_bind(sync_func));
   }
   else {
-    Mesh *mesh = static_cast<Mesh *>(geom);
-    sync_mesh(b_depsgraph, b_ob, mesh, used_shaders);
+    sync_func();
   }
 
   return geom;
@@ -152,7 +179,8 @@ void BlenderSync::sync_geometry_motion(BL::Depsgraph &b_depsgraph,
                                        BL::Object &b_ob,
                                        Object *object,
                                        float motion_time,
-                                       bool use_particle_hair)
+                                       bool use_particle_hair,
+                                       TaskPool *task_pool)
 {
   /* Ensure we only sync instanced geometry once. */
   Geometry *geom = object->geometry;
@@ -173,19 +201,33 @@ void BlenderSync::sync_geometry_motion(BL::Depsgraph &b_depsgraph,
     return;
   }
 
+  auto sync_func = [=]() mutable {
+    if (progress.get_cancel()) {
+      return;
+    }
+
 #ifdef WITH_NEW_OBJECT_TYPES
-  if (b_ob.type() == BL::Object::type_HAIR || use_particle_hair) {
+    if (b_ob.type() == BL::Object::type_HAIR || use_particle_hair) {
 #else
-  if (use_particle_hair) {
+    if (use_particle_hair) {
 #endif
-    sync_hair_motion(b_depsgraph, b_ob, geom, motion_step);
-  }
-  else if (b_ob.type() == BL::Object::type_VOLUME || object_fluid_gas_domain_find(b_ob)) {
-    /* No volume motion blur support yet. */
+      sync_hair_motion(b_depsgraph, b_ob, geom, motion_step);
+    }
+    else if (b_ob.type() == BL::Object::type_VOLUME || object_fluid_gas_domain_find(b_ob)) {
+      /* No volume motion blur support yet. */
+    }
+    else {
+      Mesh *mesh = static_cast<Mesh *>(geom);
+      sync_mesh_motion(b_depsgraph, b_ob, mesh, motion_step);
+    }
+  };
+
+  /* Defer the actual geometry sync to the task pool for multithreading. */
+  if (task_pool) {
+    task_pool->push(function_bind(sync_func));
   }
   else {
-    Mesh *mesh = static_cast<Mesh *>(geom);
-    sync_mesh_motion(b_depsgraph, b_ob, mesh, motion_step);
+    sync_func();
   }
 }
 
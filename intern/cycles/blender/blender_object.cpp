@@ -32,6 +32,8 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_logging.h"
+#include "util/util_task.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -107,7 +109,8 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
                                  bool use_particle_hair,
                                  bool show_lights,
                                  BlenderObjectCulling &culling,
-                                 bool *use_portal)
+                                 bool *use_portal,
+                                 TaskPool *geom_task_pool)
 {
   const bool is_instance = b_instance.is_instance();
   BL::Object b_ob = b_instance.object();
@@ -202,7 +205,8 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
 
       /* mesh deformation */
       if (object->geometry)
-        sync_geometry_motion(b_depsgraph, b_ob, object, motion_time, use_particle_hair);
+        sync_geometry_motion(
+            b_depsgraph, b_ob_instance, object, motion_time, use_particle_hair, geom_task_pool);
     }
 
     return object;
@@ -214,9 +218,31 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
   if (object_map.add_or_update(&object, b_ob, b_parent, key))
     object_updated = true;
 
-  /* mesh sync */
-  object->geometry = sync_geometry(
-      b_depsgraph, b_ob, b_ob_instance, object_updated, use_particle_hair);
+  /* motion blur settings of the geometry, computed up front since a deferred geometry sync
+   * task reads them */
+  Scene::MotionType need_motion = scene->need_motion();
+  uint motion_steps = 0;
+  bool use_motion_blur = false;
+
+  if (need_motion == Scene::MOTION_BLUR) {
+    motion_steps = object_motion_steps(b_parent, b_ob, Object::MAX_MOTION_STEPS);
+    use_motion_blur = motion_steps && object_use_deform_motion(b_parent, b_ob);
+  }
+  else if (need_motion != Scene::MOTION_NONE) {
+    motion_steps = 3;
+  }
+
+  /* mesh sync
+   * b_ob is owned by the instance iterator and changes with the next instance, while
+   * b_ob_instance is the evaluated object and stays valid for deferred geometry sync. */
+  object->geometry = sync_geometry(b_depsgraph,
+                                   b_ob_instance,
+                                   b_ob_instance,
+                                   object_updated,
+                                   use_particle_hair,
+                                   motion_steps,
+                                   use_motion_blur,
+                                   geom_task_pool);
 
   /* special case not tracked by object update flags */
 
@@ -255,11 +281,17 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
     object_updated = true;
   }
 
+  /* Geometry synced in this pass is always updated. It is tested first, since with a task pool
+   * the geometry may still be written by a sync task. */
+  const bool geometry_synced_now = object->geometry && geometry_synced.find(object->geometry) !=
+                                                           geometry_synced.end();
+  const bool geometry_updated = geometry_synced_now ||
+                                (object->geometry && object->geometry->need_update);
+
   /* object sync
    * transform comparison should not be needed, but duplis don't work perfect
    * in the depsgraph and may not signal changes, so this is a workaround */
-  if (object_updated || (object->geometry && object->geometry->need_update) ||
-      tfm != object->tfm) {
+  if (object_updated || geometry_updated || tfm != object->tfm) {
     object->name = b_ob.name().c_str();
     object->pass_id = b_ob.pass_index();
     object->color = get_float3(b_ob.color());
@@ -267,24 +299,13 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
     object->motion.clear();
 
     /* motion blur */
-    Scene::MotionType need_motion = scene->need_motion();
     if (need_motion != Scene::MOTION_NONE && object->geometry) {
-      Geometry *geom = object->geometry;
-      geom->use_motion_blur = false;
-      geom->motion_steps = 0;
-
-      uint motion_steps;
-
-      if (need_motion == Scene::MOTION_BLUR) {
-        motion_steps = object_motion_steps(b_parent, b_ob, Object::MAX_MOTION_STEPS);
-        geom->motion_steps = motion_steps;
-        if (motion_steps && object_use_deform_motion(b_parent, b_ob)) {
-          geom->use_motion_blur = true;
-        }
-      }
-      else {
-        motion_steps = 3;
+      /* Geometry synced in this pass got its motion settings before the sync task was pushed,
+       * and may still be in use by that task. */
+      if (!geometry_synced_now) {
+        Geometry *geom = object->geometry;
         geom->motion_steps = motion_steps;
+        geom->use_motion_blur = use_motion_blur;
       }
 
       object->motion.clear();
@@ -312,7 +333,7 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
       object->random_id = hash_uint2(hash_string(object->name.c_str()), 0);
     }
 
-    object->tag_update(scene);
+    object->tag_update(scene, !geometry_synced_now);
   }
 
   if (is_instance) {
@@ -352,6 +373,9 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
   bool use_portal = false;
   const bool show_lights = BlenderViewportParameters(b_v3d).use_scene_lights;
 
+  /* Geometry is converted in parallel, objects and their bookkeeping are synced here. */
+  TaskPool geom_task_pool;
+
   BL::ViewLayer b_view_layer = b_depsgraph.view_layer_eval();
 
   BL::Depsgraph::object_instances_iterator b_instance_iter;
@@ -370,6 +394,11 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
     /* Load per-object culling data. */
     culling.init_object(scene, b_ob);
 
+    /* Mesh and particle hair of the same object both evaluate the object's mesh, so do not run
+     * those at the same time. */
+    const bool sync_particle_hair = b_instance.show_particles() &&
+                                    object_has_particle_hair(b_ob);
+
     /* Object itself. */
     if (b_instance.show_self()) {
       sync_object(b_depsgraph,
@@ -379,11 +408,12 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
                   false,
                   show_lights,
                   culling,
-                  &use_portal);
+                  &use_portal,
+                  sync_particle_hair ? NULL : &geom_task_pool);
     }
 
     /* Particle hair as separate object. */
-    if (b_instance.show_particles() && object_has_particle_hair(b_ob)) {
+    if (sync_particle_hair) {
       sync_object(b_depsgraph,
                   b_view_layer,
                   b_instance,
@@ -391,12 +421,25 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
                   true,
                   show_lights,
                   culling,
-                  &use_portal);
+                  &use_portal,
+                  &geom_task_pool);
     }
 
     cancel = progress.get_cancel();
   }
 
+  /* Wait for geometry sync to finish. */
+  {
+    scoped_timer timer;
+    TaskPool::Summary summary;
+    geom_task_pool.wait_work(&summary);
+    if (summary.num_tasks_handled) {
+      VLOG(1) << "Geometry sync: " << summary.num_tasks_handled << " tasks in "
+              << summary.time_total << "s, waited " << timer.get_time()
+              << "s after object sync.";
+    }
+  }
+
   progress.set_sync_status("");
 
   if (!cancel && !motion) {
@@ -27,6 +27,7 @@
 #include "render/mesh.h"
 #include "render/object.h"
 #include "render/scene.h"
+#include "render/scene_binary.h"
 #include "render/session.h"
 #include "render/shader.h"
 #include "render/stats.h"
@@ -471,6 +472,13 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
   bool use_optix_denoising = get_boolean(crl, "use_optix_denoising");
   bool write_denoising_passes = get_boolean(crl, "denoising_store_passes");
 
+  /* Denoising needs neighbor tiles mapped on the same device, which network devices can't
+   * provide. Tiles scheduled for denoising would otherwise never be written. */
+  if (session_params.device.type == DEVICE_NETWORK) {
+    use_denoising = false;
+    write_denoising_passes = false;
+  }
+
   buffer_params.denoising_data_pass = use_denoising || write_denoising_passes;
   buffer_params.denoising_clean_pass = (scene->film->denoising_flags & DENOISING_CLEAN_ALL_PASSES);
   buffer_params.denoising_prefiltered_pass = write_denoising_passes && !use_optix_denoising;
@@ -517,6 +525,15 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
         b_render, b_depsgraph, b_v3d, b_camera_override, width, height, &python_thread_state);
     builtin_images_load();
 
+    /* Export the synchronized scene for the standalone application, for the first view only. */
+    if (view_index == 0) {
+      PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
+      const string export_filepath = get_string(cscene, "debug_export_scene_filepath");
+      if (!export_filepath.empty()) {
+        scene_binary_write(scene, blender_absolute_path(b_data, b_scene, export_filepath));
+      }
+    }
+
     /* Attempt to free all data which is held by Blender side, since at this
      * point we know that we've got everything to render current view layer.
      */
@@ -548,6 +565,22 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
     /* Update tile manager if we're doing resumable render. */
     update_resumable_tile_manager(effective_layer_samples);
 
+    /* Checkpoint file for every frame, view layer and view. */
+    PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
+    if (background && get_boolean(cscene, "use_checkpoint")) {
+      const string directory = blender_absolute_path(
+          b_data, b_scene, get_string(cscene, "checkpoint_directory"));
+      const string filename = string_printf("%s_%s_%s_%04d.exr",
+                                            b_scene.name().c_str(),
+                                            b_rlay_name.c_str(),
+                                            b_rview_name.c_str(),
+                                            b_scene.frame_current());
+      session->params.checkpoint_filepath = path_join(directory, filename);
+    }
+    else {
+      session->params.checkpoint_filepath = "";
+    }
+
     /* Update session itself. */
     session->reset(buffer_params, effective_layer_samples);
 
@@ -37,7 +37,9 @@
 #include "util/util_debug.h"
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
+#include "util/util_logging.h"
 #include "util/util_opengl.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -214,12 +216,26 @@ void BlenderSync::sync_data(BL::RenderSettings &b_render,
 {
   BL::ViewLayer b_view_layer = b_depsgraph.view_layer_eval();
 
+  /* Time spent in each step, reported with --debug-cycles. */
+  const double time_start = time_dt();
+  double time_step = time_start;
+  auto log_sync_time = [&time_step](const char *step) {
+    const double time_now = time_dt();
+    VLOG(1) << "Synchronized " << step << " in " << time_now - time_step << "s.";
+    time_step = time_now;
+  };
+
   sync_view_layer(b_v3d, b_view_layer);
   sync_integrator();
   sync_film(b_v3d);
+  log_sync_time("settings");
+
   sync_shaders(b_depsgraph, b_v3d);
+  log_sync_time("shaders");
+
   sync_images();
   sync_curve_settings();
+  log_sync_time("images");
 
   geometry_synced.clear(); /* use for objects and motion sync */
 
@@ -227,7 +243,10 @@ void BlenderSync::sync_data(BL::RenderSettings &b_render,
       scene->camera->motion_position == Camera::MOTION_POSITION_CENTER) {
     sync_objects(b_depsgraph, b_v3d);
   }
+  log_sync_time("objects and geometry");
+
   sync_motion(b_render, b_depsgraph, b_v3d, b_override, width, height, python_thread_state);
+  log_sync_time("motion");
 
   geometry_synced.clear();
 
@@ -236,6 +255,9 @@ void BlenderSync::sync_data(BL::RenderSettings &b_render,
   shader_map.post_sync(false);
 
   free_data_after_sync(b_depsgraph);
+  log_sync_time("cleanup");
+
+  VLOG(1) << "Total sync time " << time_dt() - time_start << "s.";
 }
 
 /* Integrator */
@@ -302,6 +324,12 @@ void BlenderSync::sync_integrator()
   integrator->sample_all_lights_indirect = get_boolean(cscene, "sample_all_lights_indirect");
   integrator->light_sampling_threshold = get_float(cscene, "light_sampling_threshold");
 
+  /* The light tree is built along with the light distribution. */
+  integrator->use_light_tree = get_boolean(cscene, "use_light_tree");
+  if (integrator->use_light_tree != previntegrator.use_light_tree) {
+    scene->light_manager->tag_update(scene);
+  }
+
   if (RNA_boolean_get(&cscene, "use_adaptive_sampling")) {
     integrator->sampling_pattern = SAMPLING_PATTERN_PMJ;
     integrator->adaptive_min_samples = get_int(cscene, "adaptive_min_samples");
@@ -755,6 +783,10 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  params.use_texture_cache = get_boolean(cscene, "use_texture_cache");
+  params.texture_cache_size = get_int(cscene, "texture_cache_size");
+  params.use_compressed_geometry = get_boolean(cscene, "use_compressed_geometry");
+
   /* TODO(sergey): Once OSL supports per-microarchitecture optimization get
    * rid of this.
    */
@@ -874,6 +906,9 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine &b_engine,
   params.reset_timeout = (double)get_float(cscene, "debug_reset_timeout");
   params.text_timeout = (double)get_float(cscene, "debug_text_timeout");
 
+  /* checkpoint, file path is set per view layer and view */
+  params.checkpoint_interval = (double)get_float(cscene, "checkpoint_interval");
+
   /* progressive refine */
   BL::RenderSettings b_r = b_scene.render();
   params.progressive_refine = b_engine.is_preview() ||
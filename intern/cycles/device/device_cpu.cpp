@@ -56,6 +56,7 @@
 #include "util/util_progress.h"
 #include "util/util_system.h"
 #include "util/util_thread.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -173,6 +174,21 @@ class CPUDevice : public Device {
   device_vector<TextureInfo> texture_info;
   bool need_texture_info;
 
+  /* NUMA aware placement of read-only scene data, only used with multiple nodes. With
+   * replication every node gets its own copy of the kernel globals, render threads pinned to a
+   * node use the copy local to it. */
+  struct NUMAGlobal {
+    void *host_pointer;
+    size_t data_size;
+    size_t memory_size;
+    /* Per node copies, NULL for nodes where allocation failed or which are not available. */
+    vector<void *> replicas;
+  };
+  DebugFlags::CPU::NUMAMode numa_mode;
+  int numa_num_nodes;
+  map<string, NUMAGlobal> numa_globals;
+  bool need_numa_report;
+
 #ifdef WITH_OSL
   OSLGlobals osl_globals;
 #endif
@@ -299,6 +315,17 @@ class CPUDevice : public Device {
     }
     need_texture_info = false;
 
+    numa_mode = DebugFlags().cpu.numa_mode;
+    numa_num_nodes = system_cpu_num_numa_nodes();
+    if (numa_num_nodes < 2) {
+      numa_mode = DebugFlags::CPU::NUMA_NONE;
+    }
+    if (numa_mode != DebugFlags::CPU::NUMA_NONE) {
+      VLOG(1) << "Using NUMA mode " << numa_mode_name(numa_mode) << " over " << numa_num_nodes
+              << " nodes.";
+    }
+    need_numa_report = false;
+
 #define REGISTER_SPLIT_KERNEL(name) \
   split_kernels[#name] = KernelFunctions<void (*)(KernelGlobals *, KernelData *)>( \
       KERNEL_FUNCTIONS(name))
@@ -474,6 +501,10 @@ class CPUDevice : public Device {
     mem.device_pointer = (device_ptr)mem.host_pointer;
     mem.device_size = mem.memory_size();
     stats.mem_alloc(mem.device_size);
+
+    if (numa_mode != DebugFlags::CPU::NUMA_NONE) {
+      numa_global_alloc(mem);
+    }
   }
 
   void global_free(device_memory &mem)
@@ -483,6 +514,127 @@ class CPUDevice : public Device {
       stats.mem_free(mem.device_size);
       mem.device_size = 0;
     }
+
+    if (numa_mode != DebugFlags::CPU::NUMA_NONE) {
+      numa_global_free(mem);
+    }
+  }
+
+  void numa_global_alloc(device_memory &mem)
+  {
+    const size_t size = mem.memory_size();
+    if (size == 0) {
+      return;
+    }
+
+    NUMAGlobal &global = numa_globals[mem.name];
+    global.host_pointer = mem.host_pointer;
+    global.data_size = mem.data_size;
+    global.memory_size = size;
+    need_numa_report = true;
+
+    if (numa_mode == DebugFlags::CPU::NUMA_INTERLEAVE) {
+      system_numa_interleave_memory(mem.host_pointer, size);
+      return;
+    }
+
+    global.replicas.resize(numa_num_nodes, NULL);
+    for (int node = 0; node < numa_num_nodes; node++) {
+      if (!system_cpu_is_numa_node_available(node)) {
+        continue;
+      }
+      void *replica = system_numa_alloc_on_node(size, node);
+      if (replica == NULL) {
+        VLOG(1) << "Failed to replicate " << mem.name << " on node " << node
+                << ", using shared memory.";
+        continue;
+      }
+      memcpy(replica, mem.host_pointer, size);
+      global.replicas[node] = replica;
+      stats.mem_alloc(size);
+    }
+  }
+
+  void numa_global_free(device_memory &mem)
+  {
+    map<string, NUMAGlobal>::iterator it = numa_globals.find(mem.name);
+    if (it == numa_globals.end()) {
+      return;
+    }
+
+    NUMAGlobal &global = it->second;
+    foreach (void *replica, global.replicas) {
+      if (replica) {
+        system_numa_free(replica, global.memory_size);
+        stats.mem_free(global.memory_size);
+      }
+    }
+    numa_globals.erase(it);
+  }
+
+  /* Sequentially read the scene data as seen by threads on the given node. */
+  void numa_measure_bandwidth(int node, size_t *r_size, double *r_time)
+  {
+    /* Limit the amount of data read for huge scenes. */
+    const size_t max_size = (size_t)512 * 1024 * 1024;
+    size_t size = 0;
+    uint64_t sum = 0;
+
+    const double start_time = time_dt();
+    for (map<string, NUMAGlobal>::iterator it = numa_globals.begin();
+         it != numa_globals.end() && size < max_size;
+         ++it) {
+      const NUMAGlobal &global = it->second;
+      const void *data = ((size_t)node < global.replicas.size() && global.replicas[node]) ?
+                             global.replicas[node] :
+                             global.host_pointer;
+      const uint64_t *words = (const uint64_t *)data;
+      const size_t num_words = global.memory_size / sizeof(uint64_t);
+      for (size_t i = 0; i < num_words; i++) {
+        sum += words[i];
+      }
+      size += num_words * sizeof(uint64_t);
+    }
+    *r_time = time_dt() - start_time;
+    *r_size = size;
+
+    /* Keep the reads from being optimized away. */
+    volatile uint64_t result = sum;
+    (void)result;
+  }
+
+  void numa_report_bandwidth()
+  {
+    need_numa_report = false;
+    if (!VLOG_IS_ON(1) || numa_globals.empty()) {
+      return;
+    }
+
+    vector<int> num_node_threads(numa_num_nodes, 0);
+    foreach (int node, TaskScheduler::thread_nodes()) {
+      if (node >= 0 && node < numa_num_nodes) {
+        num_node_threads[node]++;
+      }
+    }
+
+    vector<size_t> sizes(numa_num_nodes, 0);
+    vector<double> times(numa_num_nodes, 0.0);
+    for (int node = 0; node < numa_num_nodes; node++) {
+      if (!system_cpu_is_numa_node_available(node)) {
+        continue;
+      }
+      /* One node at a time, so the measurements do not compete for memory bandwidth. */
+      thread measure_thread(
+          function_bind(
+              &CPUDevice::numa_measure_bandwidth, this, node, &sizes[node], &times[node]),
+          node);
+      measure_thread.join();
+
+      const double bandwidth = (times[node] > 0.0) ? sizes[node] / times[node] : 0.0;
+      VLOG(1) << "NUMA node " << node << ": " << num_node_threads[node] << " render threads, "
+              << string_human_readable_size(sizes[node]) << " scene data read at "
+              << string_printf("%.2f", bandwidth / (1024.0 * 1024.0 * 1024.0)) << " GB/s.";
+    }
   }
 
   void tex_alloc(device_texture &mem)
@@ -495,6 +647,12 @@ class CPUDevice : public Device {
     mem.device_size = mem.memory_size();
     stats.mem_alloc(mem.device_size);
 
+    /* Images are too big to replicate, spread them over the nodes instead so no single
+     * node's memory controller serves all texture lookups. */
+    if (numa_mode != DebugFlags::CPU::NUMA_NONE && mem.host_pointer) {
+      system_numa_interleave_memory(mem.host_pointer, mem.memory_size());
+    }
+
     const uint slot = mem.slot;
     if (slot >= texture_info.size()) {
       /* Allocate some slots in advance, to reduce amount of re-allocations. */
@@ -502,7 +660,11 @@ class CPUDevice : public Device {
     }
 
     texture_info[slot] = mem.info;
-    texture_info[slot].data = (uint64_t)mem.host_pointer;
+    if (mem.info.data_type != IMAGE_DATA_TYPE_TEXTURE_CACHE &&
+        mem.info.data_type != IMAGE_DATA_TYPE_SPARSE_GRID) {
+      /* Texture cache images and sparse grids keep their handle. */
+      texture_info[slot].data = (uint64_t)mem.host_pointer;
+    }
     need_texture_info = true;
   }
 
@@ -1138,6 +1300,10 @@ class CPUDevice : public Device {
     /* Load texture info. */
     load_texture_info();
 
+    if (need_numa_report && task.type == DeviceTask::RENDER) {
+      numa_report_bandwidth();
+    }
+
     /* split task into smaller ones */
     list<DeviceTask> tasks;
 
@@ -1164,6 +1330,20 @@ class CPUDevice : public Device {
   inline KernelGlobals thread_kernel_globals_init()
   {
     KernelGlobals kg = kernel_globals;
+
+    /* Use the copies of the scene data on the node this thread runs on. */
+    const int node = thread::current_node();
+    if (numa_mode == DebugFlags::CPU::NUMA_REPLICATE && node >= 0) {
+      for (map<string, NUMAGlobal>::iterator it = numa_globals.begin(); it != numa_globals.end();
+           ++it) {
+        const NUMAGlobal &global = it->second;
+        if ((size_t)node < global.replicas.size() && global.replicas[node]) {
+          kernel_global_memory_copy(
+              &kg, it->first.c_str(), global.replicas[node], global.data_size);
+        }
+      }
+    }
+
     kg.transparent_shadow_intersections = NULL;
     const int decoupled_count = sizeof(kg.decoupled_volume_steps) /
                                 sizeof(*kg.decoupled_volume_steps);
@@ -180,6 +180,16 @@ device_texture::device_texture(Device *device,
       data_type = TYPE_UINT16;
       data_elements = 1;
       break;
+    case IMAGE_DATA_TYPE_TEXTURE_CACHE:
+      /* Pixels are owned by the texture cache, #TextureInfo.data points to the image. */
+      data_type = TYPE_UCHAR;
+      data_elements = 1;
+      break;
+    case IMAGE_DATA_TYPE_SPARSE_GRID:
+      /* Voxels are owned by the image manager, #TextureInfo.data points to the grid. */
+      data_type = TYPE_UCHAR;
+      data_elements = 1;
+      break;
     case IMAGE_DATA_NUM_TYPES:
       assert(0);
       return;
@@ -20,6 +20,8 @@
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_path.h"
+#include "util/util_unique_ptr.h"
 
 #if defined(WITH_NETWORK)
 
@@ -27,62 +29,89 @@ CCL_NAMESPACE_BEGIN
 
 typedef map<device_ptr, device_ptr> PtrMap;
 typedef vector<uint8_t> DataVector;
-typedef map<device_ptr, DataVector> DataMap;
 
-/* tile list */
-typedef vector<RenderTile> TileList;
+/* Tiles are sent back to the client as soon as they are finished, only the rows covered by
+ * the tile are sent, as the tile may be part of a larger buffer. */
 
-/* search a list of tiles and find the one that matches the passed render tile */
-static TileList::iterator tile_list_find(TileList &tile_list, RenderTile &tile)
+/* Device identifiers are "NETWORK_" followed by the server address. */
+static string device_network_address(const DeviceInfo &info)
 {
-  for (TileList::iterator it = tile_list.begin(); it != tile_list.end(); ++it)
-    if (tile.x == it->x && tile.y == it->y && tile.start_sample == it->start_sample)
-      return it;
-  return tile_list.end();
+  return info.id.substr(strlen("NETWORK_"));
 }
 
+static size_t tile_row_offset(const RenderTile &tile, int row, int pass_stride)
+{
+  return (size_t)(tile.offset + tile.x + (tile.y + row) * tile.stride) * pass_stride;
+}
+
+/* Network Device
+ *
+ * Client side of a connection to a single cycles_server. Render tasks are executed on the
+ * server, which pulls tiles from the client as its render threads become idle. When several
+ * servers are combined in a multi device they all pull from the same tile manager, so faster
+ * servers naturally take more of the work.
+ *
+ * Messages from the server are handled by a receive thread while a task is running, so
+ * multiple servers are served concurrently. */
+
 class NetworkDevice : public Device {
  public:
   boost::asio::io_service io_service;
   tcp::socket socket;
+  NetworkConnection connection;
   device_ptr mem_counter;
-  DeviceTask the_task; /* todo: handle multiple tasks */
-
-  thread_mutex rpc_lock;
+  DeviceTask the_task;
 
   virtual bool show_samples() const
   {
     return false;
   }
 
-  NetworkDevice(DeviceInfo &info, Stats &stats, Profiler &profiler, const char *address)
-      : Device(info, stats, profiler, true), socket(io_service)
+  NetworkDevice(DeviceInfo &info, Stats &stats, Profiler &profiler)
+      : Device(info, stats, profiler, true),
+        socket(io_service),
+        connection(socket, &error_func),
+        receive_thread(NULL)
   {
-    error_func = NetworkError();
-    stringstream portstr;
-    portstr << SERVER_PORT;
+    /* Address is either "host" or "host:port". */
+    string host = device_network_address(info);
+    string port = string_printf("%d", SERVER_PORT);
+    const size_t colon = host.rfind(':');
+    if (colon != string::npos) {
+      port = host.substr(colon + 1);
+      host = host.substr(0, colon);
+    }
 
     tcp::resolver resolver(io_service);
-    tcp::resolver::query query(address, portstr.str());
-    tcp::resolver::iterator endpoint_iterator = resolver.resolve(query);
+    tcp::resolver::query query(host, port);
+    boost::system::error_code error = boost::asio::error::host_not_found;
+    tcp::resolver::iterator endpoint_iterator = resolver.resolve(query, error);
     tcp::resolver::iterator end;
 
-    boost::system::error_code error = boost::asio::error::host_not_found;
     while (error && endpoint_iterator != end) {
       socket.close();
       socket.connect(*endpoint_iterator++, error);
     }
 
-    if (error)
-      error_func.network_error(error.message());
+    if (error) {
+      error_func.network_error("Can't connect to " + host + ":" + port + ": " + error.message());
+    }
+    else {
+      /* Messages are batched already, don't delay them further. */
+      socket.set_option(tcp::no_delay(true));
+      VLOG(1) << "Connected to render server " << host << ":" << port << ".";
+    }
 
     mem_counter = 0;
   }
 
   ~NetworkDevice()
   {
-    RPCSend snd(socket, &error_func, "stop");
-    snd.write();
+    if (!error_func.have_error()) {
+      RPCSend snd(connection, "stop");
+      snd.write();
+      snd.flush();
+    }
   }
 
   virtual BVHLayoutMask get_bvh_layout_mask() const
@@ -98,21 +127,20 @@ class NetworkDevice : public Device {
               << string_human_readable_size(mem.memory_size()) << ")";
     }
 
-    thread_scoped_lock lock(rpc_lock);
-
-    mem.device_pointer = ++mem_counter;
+    mem_insert(mem);
 
-    RPCSend snd(socket, &error_func, "mem_alloc");
+    RPCSend snd(connection, "mem_alloc");
     snd.add(mem);
     snd.write();
   }
 
   void mem_copy_to(device_memory &mem)
   {
-    thread_scoped_lock lock(rpc_lock);
-
-    RPCSend snd(socket, &error_func, "mem_copy_to");
+    if (!mem.device_pointer) {
+      mem_insert(mem);
+    }
 
+    RPCSend snd(connection, "mem_copy_to");
     snd.add(mem);
     snd.write();
     snd.write_buffer(mem.host_pointer, mem.memory_size());
@@ -120,29 +148,51 @@ class NetworkDevice : public Device {
 
   void mem_copy_from(device_memory &mem, int y, int w, int h, int elem)
   {
-    thread_scoped_lock lock(rpc_lock);
-
-    size_t data_size = mem.memory_size();
+    {
+      /* Tiles rendered into this buffer were already streamed back to host memory. */
+      thread_scoped_lock lock(mem_mutex);
+      if (streamed_mem.find(mem.device_pointer) != streamed_mem.end()) {
+        return;
+      }
+    }
 
-    RPCSend snd(socket, &error_func, "mem_copy_from");
+    if (receive_thread) {
+      VLOG(1) << "Network device can't copy memory while a task is running.";
+      return;
+    }
 
-    snd.add(mem);
-    snd.add(y);
-    snd.add(w);
-    snd.add(h);
-    snd.add(elem);
-    snd.write();
+    {
+      RPCSend snd(connection, "mem_copy_from");
+      snd.add(mem);
+      snd.add(y);
+      snd.add(w);
+      snd.add(h);
+      snd.add(elem);
+      snd.write();
+      snd.flush();
+    }
 
-    RPCReceive rcv(socket, &error_func);
-    rcv.read_buffer(mem.host_pointer, data_size);
+    RPCReceive rcv(connection);
+    const size_t offset = (size_t)elem * w * y;
+    rcv.read_buffer((uint8_t *)mem.host_pointer + offset, (size_t)elem * w * h);
   }
 
   void mem_zero(device_memory &mem)
   {
-    thread_scoped_lock lock(rpc_lock);
+    if (!mem.device_pointer) {
+      mem_insert(mem);
+    }
+    else {
+      thread_scoped_lock lock(mem_mutex);
+      streamed_mem.erase(mem.device_pointer);
+    }
 
-    RPCSend snd(socket, &error_func, "mem_zero");
+    /* Keep host memory in sync, for tiles streamed into part of the buffer. */
+    if (mem.host_pointer) {
+      memset(mem.host_pointer, 0, mem.memory_size());
+    }
 
+    RPCSend snd(connection, "mem_zero");
     snd.add(mem);
     snd.write();
   }
@@ -150,10 +200,13 @@ class NetworkDevice : public Device {
   void mem_free(device_memory &mem)
   {
     if (mem.device_pointer) {
-      thread_scoped_lock lock(rpc_lock);
-
-      RPCSend snd(socket, &error_func, "mem_free");
+      {
+        thread_scoped_lock lock(mem_mutex);
+        mem_map.erase(mem.device_pointer);
+        streamed_mem.erase(mem.device_pointer);
+      }
 
+      RPCSend snd(connection, "mem_free");
       snd.add(mem);
       snd.write();
 
@@ -163,9 +216,7 @@ class NetworkDevice : public Device {
 
   void const_copy_to(const char *name, void *host, size_t size)
   {
-    thread_scoped_lock lock(rpc_lock);
-
-    RPCSend snd(socket, &error_func, "const_copy_to");
+    RPCSend snd(connection, "const_copy_to");
 
     string name_string(name);
 
@@ -180,386 +231,500 @@ class NetworkDevice : public Device {
     if (error_func.have_error())
       return false;
 
-    thread_scoped_lock lock(rpc_lock);
-
-    RPCSend snd(socket, &error_func, "load_kernels");
-    snd.add(requested_features.experimental);
-    snd.add(requested_features.max_closure);
-    snd.add(requested_features.max_nodes_group);
-    snd.add(requested_features.nodes_features);
-    snd.write();
+    {
+      RPCSend snd(connection, "load_kernels");
+      snd.add(requested_features.experimental);
+      snd.add(requested_features.max_nodes_group);
+      snd.add(requested_features.nodes_features);
+      snd.add(requested_features.use_hair);
+      snd.add(requested_features.use_object_motion);
+      snd.add(requested_features.use_camera_motion);
+      snd.add(requested_features.use_baking);
+      snd.add(requested_features.use_subsurface);
+      snd.add(requested_features.use_volume);
+      snd.add(requested_features.use_integrator_branched);
+      snd.add(requested_features.use_patch_evaluation);
+      snd.add(requested_features.use_transparent);
+      snd.add(requested_features.use_shadow_tricks);
+      snd.add(requested_features.use_principled);
+      snd.add(requested_features.use_denoising);
+      snd.add(requested_features.use_shader_raytrace);
+      snd.add(requested_features.use_true_displacement);
+      snd.add(requested_features.use_background_light);
+      snd.write();
+      snd.flush();
+    }
 
-    bool result;
-    RPCReceive rcv(socket, &error_func);
+    bool result = false;
+    RPCReceive rcv(connection);
     rcv.read(result);
 
-    return result;
+    return result && !error_func.have_error();
   }
 
   void task_add(DeviceTask &task)
   {
-    thread_scoped_lock lock(rpc_lock);
-
     the_task = task;
 
-    RPCSend snd(socket, &error_func, "task_add");
-    snd.add(task);
-    snd.write();
+    /* Denoising needs neighbor tiles mapped on the same device, which is not available
+     * over the network. The session disables denoising for network devices. */
+    DeviceTask remote_task = task;
+    remote_task.tile_types &= ~RenderTile::DENOISE;
+
+    {
+      RPCSend snd(connection, "task_add");
+      snd.add(remote_task);
+      snd.write();
+      snd.flush();
+    }
+
+    receive_thread_start();
   }
 
   void task_wait()
   {
-    thread_scoped_lock lock(rpc_lock);
+    {
+      RPCSend snd(connection, "task_wait");
+      snd.write();
+      snd.flush();
+    }
+
+    /* The server replies with task_wait_done once all tasks are finished, which ends the
+     * receive thread. */
+    receive_thread_start();
+    receive_thread->join();
+    delete receive_thread;
+    receive_thread = NULL;
+  }
 
-    RPCSend snd(socket, &error_func, "task_wait");
+  void task_cancel()
+  {
+    RPCSend snd(connection, "task_cancel");
     snd.write();
+    snd.flush();
+  }
 
-    lock.unlock();
+  int get_split_task_count(DeviceTask &)
+  {
+    return 1;
+  }
 
-    TileList the_tiles;
+ protected:
+  /* Assign a client side pointer, the server maps it to its own device pointer. */
+  void mem_insert(device_memory &mem)
+  {
+    thread_scoped_lock lock(mem_mutex);
+    mem.device_pointer = ++mem_counter;
+    mem_map[mem.device_pointer] = &mem;
+  }
 
-    /* todo: run this threaded for connecting to multiple clients */
-    for (;;) {
-      if (error_func.have_error())
-        break;
+  void receive_thread_start()
+  {
+    if (receive_thread == NULL) {
+      receive_thread = new thread(function_bind(&NetworkDevice::receive_messages, this));
+    }
+  }
+
+  void receive_messages()
+  {
+    while (!error_func.have_error()) {
+      RPCReceive rcv(connection);
 
-      RenderTile tile;
-
-      lock.lock();
-      RPCReceive rcv(socket, &error_func);
-
-      if (rcv.name == "acquire_tile") {
-        lock.unlock();
-
-        /* todo: watch out for recursive calls! */
-        if (the_task.acquire_tile(this, tile)) { /* write return as bool */
-          the_tiles.push_back(tile);
-
-          lock.lock();
-          RPCSend snd(socket, &error_func, "acquire_tile");
-          snd.add(tile);
-          snd.write();
-          lock.unlock();
-        }
-        else {
-          lock.lock();
-          RPCSend snd(socket, &error_func, "acquire_tile_none");
-          snd.write();
-          lock.unlock();
-        }
+      if (error_func.have_error()) {
+        break;
+      }
+      else if (rcv.name == "acquire_tile") {
+        receive_acquire_tile(rcv);
       }
       else if (rcv.name == "release_tile") {
-        rcv.read(tile);
-        lock.unlock();
-
-        TileList::iterator it = tile_list_find(the_tiles, tile);
-        if (it != the_tiles.end()) {
-          tile.buffers = it->buffers;
-          the_tiles.erase(it);
-        }
-
-        assert(tile.buffers != NULL);
-
-        the_task.release_tile(tile);
-
-        lock.lock();
-        RPCSend snd(socket, &error_func, "release_tile");
-        snd.write();
-        lock.unlock();
+        receive_release_tile(rcv);
       }
       else if (rcv.name == "task_wait_done") {
-        lock.unlock();
         break;
       }
-      else
-        lock.unlock();
+      else {
+        error_func.network_error("Unexpected message from server: " + rcv.name);
+      }
     }
   }
 
-  void task_cancel()
+  void receive_acquire_tile(RPCReceive &rcv)
   {
-    thread_scoped_lock lock(rpc_lock);
-    RPCSend snd(socket, &error_func, "task_cancel");
+    int request;
+    uint tile_types;
+    rcv.read(request);
+    rcv.read(tile_types);
+
+    RenderTile tile;
+    const bool have_tile = the_task.acquire_tile(this, tile, tile_types);
+
+    if (have_tile) {
+      thread_scoped_lock lock(tiles_mutex);
+      active_tiles[tile.tile_index] = tile;
+    }
+
+    /* Allocation of the tile buffers was batched before this reply, so the server has them
+     * by the time it starts rendering the tile. */
+    RPCSend snd(connection, "acquire_tile");
+    snd.add(request);
+    snd.add(have_tile);
+    if (have_tile) {
+      snd.add(tile);
+    }
     snd.write();
+    snd.flush();
   }
 
-  int get_split_task_count(DeviceTask &)
+  void receive_release_tile(RPCReceive &rcv)
   {
-    return 1;
+    RenderTile tile;
+    int pass_stride;
+    rcv.read(tile);
+    rcv.read(pass_stride);
+
+    {
+      thread_scoped_lock lock(tiles_mutex);
+      map<int, RenderTile>::iterator it = active_tiles.find(tile.tile_index);
+      if (it != active_tiles.end()) {
+        tile.buffers = it->second.buffers;
+        active_tiles.erase(it);
+      }
+    }
+
+    /* Read tile pixels straight into host memory of the buffer. */
+    device_memory *mem = NULL;
+    {
+      thread_scoped_lock lock(mem_mutex);
+      map<device_ptr, device_memory *>::iterator it = mem_map.find(tile.buffer);
+      if (it != mem_map.end()) {
+        mem = it->second;
+        streamed_mem.insert(tile.buffer);
+      }
+    }
+
+    const size_t row_size = sizeof(float) * tile.w * pass_stride;
+    vector<uint8_t> discard;
+
+    for (int row = 0; row < tile.h; row++) {
+      if (mem && mem->host_pointer) {
+        float *pixels = (float *)mem->host_pointer + tile_row_offset(tile, row, pass_stride);
+        rcv.read_buffer(pixels, row_size);
+      }
+      else {
+        discard.resize(row_size);
+        rcv.read_buffer(discard.data(), row_size);
+      }
+    }
+
+    if (tile.buffers == NULL) {
+      error_func.network_error("Server released a tile that was not acquired");
+      return;
+    }
+
+    if (the_task.update_progress_sample) {
+      the_task.update_progress_sample(tile.w * tile.h * tile.num_samples, tile.sample);
+    }
+    the_task.release_tile(tile);
   }
 
+  thread *receive_thread;
+
+  thread_mutex tiles_mutex;
+  map<int, RenderTile> active_tiles;
+
+  thread_mutex mem_mutex;
+  map<device_ptr, device_memory *> mem_map;
+  set<device_ptr> streamed_mem;
+
  private:
   NetworkError error_func;
 };
 
-Device *device_network_create(DeviceInfo &info,
-                              Stats &stats,
-                              Profiler &profiler,
-                              const char *address)
+Device *device_network_create(DeviceInfo &info, Stats &stats, Profiler &profiler)
+{
+  return new NetworkDevice(info, stats, profiler);
+}
+
+/* Render servers are listed in a text file, one "host" or "host:port" per line, lines starting
+ * with # are comments. The file is read from the CYCLES_NETWORK_SERVERS environment variable
+ * when set, from network_servers.txt in the user configuration directory otherwise. Without a
+ * server list, a server on the local host is used. */
+
+static vector<string> network_server_addresses()
 {
-  return new NetworkDevice(info, stats, profiler, address);
+  const char *env_path = getenv("CYCLES_NETWORK_SERVERS");
+  const string filepath = (env_path) ? string(env_path) : path_user_get("network_servers.txt");
+
+  vector<string> addresses;
+  string text;
+
+  if (path_read_text(filepath, text)) {
+    vector<string> lines;
+    string_split(lines, text, "\n\r");
+
+    foreach (string &line, lines) {
+      const string address = string_strip(line);
+      if (!address.empty() && address[0] != '#') {
+        addresses.push_back(address);
+      }
+    }
+
+    VLOG(1) << "Read " << addresses.size() << " render servers from " << filepath << ".";
+  }
+
+  if (addresses.empty()) {
+    addresses.push_back(string_printf("127.0.0.1:%d", SERVER_PORT));
+  }
+
+  return addresses;
 }
 
 void device_network_info(vector<DeviceInfo> &devices)
 {
-  DeviceInfo info;
+  const vector<string> addresses = network_server_addresses();
 
-  info.type = DEVICE_NETWORK;
-  info.description = "Network Device";
-  info.id = "NETWORK";
-  info.num = 0;
+  for (size_t num = 0; num < addresses.size(); num++) {
+    DeviceInfo info;
 
-  /* todo: get this info from device */
-  info.has_volume_decoupled = false;
-  info.has_adaptive_stop_per_sample = false;
-  info.has_osl = false;
+    info.type = DEVICE_NETWORK;
+    info.description = "Network Device (" + addresses[num] + ")";
+    info.id = "NETWORK_" + addresses[num];
+    info.num = num;
 
-  devices.push_back(info);
+    /* todo: get this info from device */
+    info.has_volume_decoupled = false;
+    info.has_adaptive_stop_per_sample = false;
+    info.has_osl = false;
+
+    devices.push_back(info);
+  }
 }
 
+/* Device Server
+ *
+ * Executes calls from a client on a local device. Messages are read by the listen loop, tasks
+ * run on the device threads which communicate with the client through the tile callbacks.
+ * Waiting for tasks happens in a separate thread so the listen loop keeps handling replies to
+ * tile requests. */
+
 class DeviceServer {
  public:
-  thread_mutex rpc_lock;
-
-  void network_error(const string &message)
+  DeviceServer(Device *device_, tcp::socket &socket_)
+      : device(device_),
+        connection(socket_, &error_func),
+        stop(false),
+        cancel(false),
+        next_request(0),
+        pass_stride(0),
+        wait_thread(NULL)
   {
-    error_func.network_error(message);
   }
 
-  bool have_error()
+  ~DeviceServer()
   {
-    return error_func.have_error();
-  }
+    wait_thread_join();
 
-  DeviceServer(Device *device_, tcp::socket &socket_)
-      : device(device_), socket(socket_), stop(false), blocked_waiting(false)
-  {
-    error_func = NetworkError();
+    /* Free remaining device memory, in case the client disconnected without freeing. */
+    for (MemMap::iterator it = mem_map.begin(); it != mem_map.end(); it++) {
+      device->mem_free(*it->second->mem);
+    }
   }
 
   void listen()
   {
     /* receive remote function calls */
-    for (;;) {
-      listen_step();
+    while (!stop && !error_func.have_error()) {
+      RPCReceive rcv(connection);
 
-      if (stop)
+      if (error_func.have_error())
         break;
+      else if (rcv.name == "stop")
+        stop = true;
+      else
+        process(rcv);
     }
+
+    /* Wake up device threads waiting for tiles. */
+    thread_scoped_lock lock(acquire_mutex);
+    stop = true;
+    acquire_cond.notify_all();
   }
 
  protected:
-  void listen_step()
-  {
-    thread_scoped_lock lock(rpc_lock);
-    RPCReceive rcv(socket, &error_func);
+  /* Server side copy of client memory, the host data is needed for CPU devices which render
+   * directly from host memory. */
+  struct ServerMemory {
+    unique_ptr<network_device_memory> mem;
+    DataVector data;
+  };
+  typedef map<device_ptr, unique_ptr<ServerMemory>> MemMap;
 
-    if (rcv.name == "stop")
-      stop = true;
-    else
-      process(rcv, lock);
+  ServerMemory *mem_find(device_ptr client_pointer)
+  {
+    thread_scoped_lock lock(map_mutex);
+    MemMap::iterator it = mem_map.find(client_pointer);
+    return (it != mem_map.end()) ? it->second.get() : NULL;
   }
 
-  /* create a memory buffer for a device buffer and insert it into mem_data */
-  DataVector &data_vector_insert(device_ptr client_pointer, size_t data_size)
+  /* Create or update server memory from a received memory description. */
+  ServerMemory *mem_receive(RPCReceive &rcv, device_ptr *client_pointer_out, bool *is_new)
   {
-    /* create a new DataVector and insert it into mem_data */
-    pair<DataMap::iterator, bool> data_ins = mem_data.insert(
-        DataMap::value_type(client_pointer, DataVector()));
-
-    /* make sure it was a unique insertion */
-    assert(data_ins.second);
-
-    /* get a reference to the inserted vector */
-    DataVector &data_v = data_ins.first->second;
+    unique_ptr<network_device_memory> received(new network_device_memory(device));
+    rcv.read(*received);
+
+    const device_ptr client_pointer = received->device_pointer;
+    *client_pointer_out = client_pointer;
+    ServerMemory *smem = mem_find(client_pointer);
+    *is_new = (smem == NULL);
+
+    if (smem == NULL) {
+      smem = new ServerMemory();
+      smem->mem.swap(received);
+      thread_scoped_lock lock(map_mutex);
+      mem_map[client_pointer].reset(smem);
+    }
+    else {
+      network_device_memory &mem = *smem->mem;
+      const size_t old_size = mem.memory_size();
+
+      mem.data_type = received->data_type;
+      mem.data_elements = received->data_elements;
+      mem.data_size = received->data_size;
+      mem.data_width = received->data_width;
+      mem.data_height = received->data_height;
+      mem.data_depth = received->data_depth;
+
+      if (mem.memory_size() != old_size) {
+        /* Reallocate, device pointers of CPU devices point into the host data. */
+        device->mem_free(mem);
+        pointer_mapping_erase(client_pointer);
+        *is_new = true;
+      }
+    }
 
-    /* size the vector */
-    data_v.resize(data_size);
+    network_device_memory &mem = *smem->mem;
+    smem->data.resize(mem.memory_size());
+    mem.host_pointer = (smem->data.size()) ? (void *)smem->data.data() : NULL;
+    if (*is_new) {
+      mem.device_pointer = 0;
+    }
 
-    return data_v;
+    return smem;
   }
 
-  DataVector &data_vector_find(device_ptr client_pointer)
+  void pointer_mapping_insert(device_ptr client_pointer, device_ptr real_pointer)
   {
-    DataMap::iterator i = mem_data.find(client_pointer);
-    assert(i != mem_data.end());
-    return i->second;
+    thread_scoped_lock lock(map_mutex);
+    ptr_map[client_pointer] = real_pointer;
+    ptr_imap[real_pointer] = client_pointer;
   }
 
-  /* setup mapping and reverse mapping of client_pointer<->real_pointer */
-  void pointer_mapping_insert(device_ptr client_pointer, device_ptr real_pointer)
+  void pointer_mapping_erase(device_ptr client_pointer)
   {
-    pair<PtrMap::iterator, bool> mapins;
-
-    /* insert mapping from client pointer to our real device pointer */
-    mapins = ptr_map.insert(PtrMap::value_type(client_pointer, real_pointer));
-    assert(mapins.second);
-
-    /* insert reverse mapping from real our device pointer to client pointer */
-    mapins = ptr_imap.insert(PtrMap::value_type(real_pointer, client_pointer));
-    assert(mapins.second);
+    thread_scoped_lock lock(map_mutex);
+    PtrMap::iterator i = ptr_map.find(client_pointer);
+    if (i != ptr_map.end()) {
+      ptr_imap.erase(i->second);
+      ptr_map.erase(i);
+    }
   }
 
   device_ptr device_ptr_from_client_pointer(device_ptr client_pointer)
   {
+    thread_scoped_lock lock(map_mutex);
     PtrMap::iterator i = ptr_map.find(client_pointer);
-    assert(i != ptr_map.end());
-    return i->second;
+    return (i != ptr_map.end()) ? i->second : 0;
   }
 
-  device_ptr device_ptr_from_client_pointer_erase(device_ptr client_pointer)
+  device_ptr client_pointer_from_device_ptr(device_ptr real_pointer)
   {
-    PtrMap::iterator i = ptr_map.find(client_pointer);
-    assert(i != ptr_map.end());
-
-    device_ptr result = i->second;
-
-    /* erase the mapping */
-    ptr_map.erase(i);
-
-    /* erase the reverse mapping */
-    PtrMap::iterator irev = ptr_imap.find(result);
-    assert(irev != ptr_imap.end());
-    ptr_imap.erase(irev);
-
-    /* erase the data vector */
-    DataMap::iterator idata = mem_data.find(client_pointer);
-    assert(idata != mem_data.end());
-    mem_data.erase(idata);
-
-    return result;
+    thread_scoped_lock lock(map_mutex);
+    PtrMap::iterator i = ptr_imap.find(real_pointer);
+    return (i != ptr_imap.end()) ? i->second : 0;
   }
 
-  /* note that the lock must be already acquired upon entry.
-   * This is necessary because the caller often peeks at
-   * the header and delegates control to here when it doesn't
-   * specifically handle the current RPC.
-   * The lock must be unlocked before returning */
-  void process(RPCReceive &rcv, thread_scoped_lock &lock)
+  void process(RPCReceive &rcv)
   {
     if (rcv.name == "mem_alloc") {
-      string name;
-      network_device_memory mem(device);
-      rcv.read(mem, name);
-      lock.unlock();
+      device_ptr client_pointer;
+      bool is_new;
+      ServerMemory *smem = mem_receive(rcv, &client_pointer, &is_new);
 
-      /* Allocate host side data buffer. */
-      size_t data_size = mem.memory_size();
-      device_ptr client_pointer = mem.device_pointer;
-
-      DataVector &data_v = data_vector_insert(client_pointer, data_size);
-      mem.host_pointer = (data_size) ? (void *)&(data_v[0]) : 0;
-
-      /* Perform the allocation on the actual device. */
-      device->mem_alloc(mem);
-
-      /* Store a mapping to/from client_pointer and real device pointer. */
-      pointer_mapping_insert(client_pointer, mem.device_pointer);
+      if (is_new) {
+        device->mem_alloc(*smem->mem);
+        pointer_mapping_insert(client_pointer, smem->mem->device_pointer);
+      }
     }
     else if (rcv.name == "mem_copy_to") {
-      string name;
-      network_device_memory mem(device);
-      rcv.read(mem, name);
-      lock.unlock();
-
-      size_t data_size = mem.memory_size();
-      device_ptr client_pointer = mem.device_pointer;
-
-      if (client_pointer) {
-        /* Lookup existing host side data buffer. */
-        DataVector &data_v = data_vector_find(client_pointer);
-        mem.host_pointer = (void *)&data_v[0];
-
-        /* Translate the client pointer to a real device pointer. */
-        mem.device_pointer = device_ptr_from_client_pointer(client_pointer);
-      }
-      else {
-        /* Allocate host side data buffer. */
-        DataVector &data_v = data_vector_insert(client_pointer, data_size);
-        mem.host_pointer = (data_size) ? (void *)&(data_v[0]) : 0;
-      }
+      device_ptr client_pointer;
+      bool is_new;
+      ServerMemory *smem = mem_receive(rcv, &client_pointer, &is_new);
+      network_device_memory &mem = *smem->mem;
 
       /* Copy data from network into memory buffer. */
-      rcv.read_buffer((uint8_t *)mem.host_pointer, data_size);
+      rcv.read_buffer(mem.host_pointer, mem.memory_size());
 
       /* Copy the data from the memory buffer to the device buffer. */
       device->mem_copy_to(mem);
 
-      if (!client_pointer) {
-        /* Store a mapping to/from client_pointer and real device pointer. */
+      if (is_new) {
         pointer_mapping_insert(client_pointer, mem.device_pointer);
       }
     }
     else if (rcv.name == "mem_copy_from") {
-      string name;
-      network_device_memory mem(device);
+      network_device_memory received(device);
       int y, w, h, elem;
 
-      rcv.read(mem, name);
+      rcv.read(received);
       rcv.read(y);
       rcv.read(w);
       rcv.read(h);
       rcv.read(elem);
 
-      device_ptr client_pointer = mem.device_pointer;
-      mem.device_pointer = device_ptr_from_client_pointer(client_pointer);
-
-      DataVector &data_v = data_vector_find(client_pointer);
+      ServerMemory *smem = mem_find(received.device_pointer);
+      const size_t offset = (size_t)elem * w * y;
+      const size_t size = (size_t)elem * w * h;
 
-      mem.host_pointer = (device_ptr) & (data_v[0]);
-
-      device->mem_copy_from(mem, y, w, h, elem);
-
-      size_t data_size = mem.memory_size();
-
-      RPCSend snd(socket, &error_func, "mem_copy_from");
-      snd.write();
-      snd.write_buffer((uint8_t *)mem.host_pointer, data_size);
-      lock.unlock();
-    }
-    else if (rcv.name == "mem_zero") {
-      string name;
-      network_device_memory mem(device);
-      rcv.read(mem, name);
-      lock.unlock();
-
-      size_t data_size = mem.memory_size();
-      device_ptr client_pointer = mem.device_pointer;
-
-      if (client_pointer) {
-        /* Lookup existing host side data buffer. */
-        DataVector &data_v = data_vector_find(client_pointer);
-        mem.host_pointer = (void *)&data_v[0];
-
-        /* Translate the client pointer to a real device pointer. */
-        mem.device_pointer = device_ptr_from_client_pointer(client_pointer);
+      RPCSend snd(connection, "mem_copy_from");
+      if (smem && offset + size <= smem->data.size()) {
+        device->mem_copy_from(*smem->mem, y, w, h, elem);
+        snd.write_buffer(smem->data.data() + offset, size);
       }
       else {
-        /* Allocate host side data buffer. */
-        DataVector &data_v = data_vector_insert(client_pointer, data_size);
-        mem.host_pointer = (void *) ? (device_ptr) & (data_v[0]) : 0;
+        DataVector zero(size, 0);
+        snd.write_buffer(zero.data(), size);
       }
+      snd.flush();
+    }
+    else if (rcv.name == "mem_zero") {
+      device_ptr client_pointer;
+      bool is_new;
+      ServerMemory *smem = mem_receive(rcv, &client_pointer, &is_new);
+      network_device_memory &mem = *smem->mem;
 
-      /* Zero memory. */
+      if (mem.host_pointer) {
+        memset(mem.host_pointer, 0, mem.memory_size());
+      }
       device->mem_zero(mem);
 
-      if (!client_pointer) {
-        /* Store a mapping to/from client_pointer and real device pointer. */
+      if (is_new) {
         pointer_mapping_insert(client_pointer, mem.device_pointer);
       }
     }
     else if (rcv.name == "mem_free") {
-      string name;
-      network_device_memory mem(device);
+      network_device_memory received(device);
+      rcv.read(received);
 
-      rcv.read(mem, name);
-      lock.unlock();
+      const device_ptr client_pointer = received.device_pointer;
+      ServerMemory *smem = mem_find(client_pointer);
 
-      device_ptr client_pointer = mem.device_pointer;
+      if (smem) {
+        device->mem_free(*smem->mem);
+        pointer_mapping_erase(client_pointer);
 
-      mem.device_pointer = device_ptr_from_client_pointer_erase(client_pointer);
-
-      device->mem_free(mem);
+        thread_scoped_lock lock(map_mutex);
+        mem_map.erase(client_pointer);
+      }
     }
     else if (rcv.name == "const_copy_to") {
       string name_string;
@@ -570,29 +735,40 @@ class DeviceServer {
 
       vector<char> host_vector(size);
       rcv.read_buffer(&host_vector[0], size);
-      lock.unlock();
 
       device->const_copy_to(name_string.c_str(), &host_vector[0], size);
     }
     else if (rcv.name == "load_kernels") {
       DeviceRequestedFeatures requested_features;
       rcv.read(requested_features.experimental);
-      rcv.read(requested_features.max_closure);
       rcv.read(requested_features.max_nodes_group);
       rcv.read(requested_features.nodes_features);
+      rcv.read(requested_features.use_hair);
+      rcv.read(requested_features.use_object_motion);
+      rcv.read(requested_features.use_camera_motion);
+      rcv.read(requested_features.use_baking);
+      rcv.read(requested_features.use_subsurface);
+      rcv.read(requested_features.use_volume);
+      rcv.read(requested_features.use_integrator_branched);
+      rcv.read(requested_features.use_patch_evaluation);
+      rcv.read(requested_features.use_transparent);
+      rcv.read(requested_features.use_shadow_tricks);
+      rcv.read(requested_features.use_principled);
+      rcv.read(requested_features.use_denoising);
+      rcv.read(requested_features.use_shader_raytrace);
+      rcv.read(requested_features.use_true_displacement);
+      rcv.read(requested_features.use_background_light);
 
       bool result;
       result = device->load_kernels(requested_features);
-      RPCSend snd(socket, &error_func, "load_kernels");
+      RPCSend snd(connection, "load_kernels");
       snd.add(result);
       snd.write();
-      lock.unlock();
+      snd.flush();
     }
     else if (rcv.name == "task_add") {
       DeviceTask task;
-
       rcv.read(task);
-      lock.unlock();
 
       if (task.buffer)
         task.buffer = device_ptr_from_client_pointer(task.buffer);
@@ -609,100 +785,105 @@ class DeviceServer {
       if (task.shader_output)
         task.shader_output = device_ptr_from_client_pointer(task.shader_output);
 
-      task.acquire_tile = function_bind(&DeviceServer::task_acquire_tile, this, _1, _2);
+      task.acquire_tile = function_bind(&DeviceServer::task_acquire_tile, this, _1, _2, _3);
       task.release_tile = function_bind(&DeviceServer::task_release_tile, this, _1);
-      task.update_progress_sample = function_bind(&DeviceServer::task_update_progress_sample,
-                                                  this);
+      task.update_progress_sample = function_bind(
+          &DeviceServer::task_update_progress_sample, this, _1, _2);
       task.update_tile_sample = function_bind(&DeviceServer::task_update_tile_sample, this, _1);
       task.get_cancel = function_bind(&DeviceServer::task_get_cancel, this);
 
+      cancel = false;
+      pass_stride = task.pass_stride;
+
       device->task_add(task);
     }
     else if (rcv.name == "task_wait") {
-      lock.unlock();
-
-      blocked_waiting = true;
-      device->task_wait();
-      blocked_waiting = false;
-
-      lock.lock();
-      RPCSend snd(socket, &error_func, "task_wait_done");
-      snd.write();
-      lock.unlock();
+      wait_thread_join();
+      wait_thread = new thread(function_bind(&DeviceServer::task_wait, this));
     }
     else if (rcv.name == "task_cancel") {
-      lock.unlock();
+      cancel = true;
       device->task_cancel();
     }
     else if (rcv.name == "acquire_tile") {
-      AcquireEntry entry;
-      entry.name = rcv.name;
-      rcv.read(entry.tile);
-      acquire_queue.push_back(entry);
-      lock.unlock();
-    }
-    else if (rcv.name == "acquire_tile_none") {
-      AcquireEntry entry;
-      entry.name = rcv.name;
-      acquire_queue.push_back(entry);
-      lock.unlock();
-    }
-    else if (rcv.name == "release_tile") {
-      AcquireEntry entry;
-      entry.name = rcv.name;
-      acquire_queue.push_back(entry);
-      lock.unlock();
+      AcquireReply reply;
+      int request;
+      rcv.read(request);
+      rcv.read(reply.have_tile);
+      if (reply.have_tile) {
+        rcv.read(reply.tile);
+      }
+
+      thread_scoped_lock lock(acquire_mutex);
+      acquire_replies[request] = reply;
+      acquire_cond.notify_all();
     }
     else {
       cout << "Error: unexpected RPC receive call \"" + rcv.name + "\"\n";
-      lock.unlock();
     }
   }
 
-  bool task_acquire_tile(Device *, RenderTile &tile)
+  void task_wait()
   {
-    thread_scoped_lock acquire_lock(acquire_mutex);
+    device->task_wait();
 
-    bool result = false;
-
-    RPCSend snd(socket, &error_func, "acquire_tile");
+    RPCSend snd(connection, "task_wait_done");
     snd.write();
+    snd.flush();
+  }
 
-    do {
-      if (blocked_waiting)
-        listen_step();
+  void wait_thread_join()
+  {
+    if (wait_thread) {
+      wait_thread->join();
+      delete wait_thread;
+      wait_thread = NULL;
+    }
+  }
 
-      /* todo: avoid busy wait loop */
-      thread_scoped_lock lock(rpc_lock);
+  /* Called from device threads, the reply is received by the listen loop. */
+  bool task_acquire_tile(Device *, RenderTile &tile, uint tile_types)
+  {
+    thread_scoped_lock lock(acquire_mutex);
+    const int request = next_request++;
+    lock.unlock();
 
-      if (!acquire_queue.empty()) {
-        AcquireEntry entry = acquire_queue.front();
-        acquire_queue.pop_front();
+    {
+      RPCSend snd(connection, "acquire_tile");
+      snd.add(request);
+      snd.add(tile_types);
+      snd.write();
+      snd.flush();
+    }
 
-        if (entry.name == "acquire_tile") {
-          tile = entry.tile;
+    lock.lock();
+    map<int, AcquireReply>::iterator it;
+    while ((it = acquire_replies.find(request)) == acquire_replies.end()) {
+      if (stop || error_func.have_error()) {
+        return false;
+      }
+      acquire_cond.wait(lock);
+    }
 
-          if (tile.buffer)
-            tile.buffer = ptr_map[tile.buffer];
+    AcquireReply reply = it->second;
+    acquire_replies.erase(it);
+    lock.unlock();
 
-          result = true;
-          break;
-        }
-        else if (entry.name == "acquire_tile_none") {
-          break;
-        }
-        else {
-          cout << "Error: unexpected acquire RPC receive call \"" + entry.name + "\"\n";
-        }
-      }
-    } while (acquire_queue.empty() && !stop && !have_error());
+    if (!reply.have_tile) {
+      return false;
+    }
+
+    tile = reply.tile;
+    if (tile.buffer) {
+      tile.buffer = device_ptr_from_client_pointer(tile.buffer);
+    }
 
-    return result;
+    return true;
   }
 
-  void task_update_progress_sample()
+  void task_update_progress_sample(long, int)
   {
-    ; /* skip */
+    ; /* skip, the client updates progress when tiles are released */
   }
 
   void task_update_tile_sample(RenderTile &)
@@ -710,75 +891,81 @@ class DeviceServer {
     ; /* skip */
   }
 
+  /* Stream the finished tile to the client without waiting for a reply. */
   void task_release_tile(RenderTile &tile)
   {
-    thread_scoped_lock acquire_lock(acquire_mutex);
-
-    if (tile.buffer)
-      tile.buffer = ptr_imap[tile.buffer];
-
-    {
-      thread_scoped_lock lock(rpc_lock);
-      RPCSend snd(socket, &error_func, "release_tile");
-      snd.add(tile);
-      snd.write();
-      lock.unlock();
+    const device_ptr client_pointer = client_pointer_from_device_ptr(tile.buffer);
+    ServerMemory *smem = mem_find(client_pointer);
+
+    if (smem && tile.h > 0) {
+      /* Copy the rows covered by the tile from the device. */
+      network_device_memory &mem = *smem->mem;
+      const int first_row = (int)(tile_row_offset(tile, 0, 1) / tile.stride);
+      device->mem_copy_from(mem, first_row, tile.stride * pass_stride, tile.h, sizeof(float));
     }
 
-    do {
-      if (blocked_waiting)
-        listen_step();
+    RenderTile client_tile = tile;
+    client_tile.buffer = client_pointer;
 
-      /* todo: avoid busy wait loop */
-      thread_scoped_lock lock(rpc_lock);
+    RPCSend snd(connection, "release_tile");
+    snd.add(client_tile);
+    snd.add(pass_stride);
+    snd.write();
 
-      if (!acquire_queue.empty()) {
-        AcquireEntry entry = acquire_queue.front();
-        acquire_queue.pop_front();
+    const size_t row_size = sizeof(float) * tile.w * pass_stride;
+    DataVector zero;
 
-        if (entry.name == "release_tile") {
-          lock.unlock();
-          break;
-        }
-        else {
-          cout << "Error: unexpected release RPC receive call \"" + entry.name + "\"\n";
-        }
+    for (int row = 0; row < tile.h; row++) {
+      const size_t offset = tile_row_offset(tile, row, pass_stride) * sizeof(float);
+      if (smem && offset + row_size <= smem->data.size()) {
+        snd.write_buffer(smem->data.data() + offset, row_size);
       }
-    } while (acquire_queue.empty() && !stop);
+      else {
+        zero.resize(row_size, 0);
+        snd.write_buffer(zero.data(), row_size);
+      }
+    }
+
+    snd.flush();
   }
 
   bool task_get_cancel()
   {
-    return false;
+    return cancel;
   }
 
   /* properties */
   Device *device;
-  tcp::socket &socket;
+  NetworkError error_func;
+  NetworkConnection connection;
 
-  /* mapping of remote to local pointer */
+  /* mapping of remote to local pointer
+   * Modified by the listen loop while device threads look up tile buffers, so all access to
+   * the maps goes through map_mutex. */
   PtrMap ptr_map;
   PtrMap ptr_imap;
-  DataMap mem_data;
+  MemMap mem_map;
+  thread_mutex map_mutex;
 
-  struct AcquireEntry {
-    string name;
+  struct AcquireReply {
+    bool have_tile;
     RenderTile tile;
   };
 
   thread_mutex acquire_mutex;
-  list<AcquireEntry> acquire_queue;
+  thread_condition_variable acquire_cond;
+  map<int, AcquireReply> acquire_replies;
 
-  bool stop;
-  bool blocked_waiting;
-
- private:
-  NetworkError error_func;
+  volatile bool stop;
+  volatile bool cancel;
+  int next_request;
+  int pass_stride;
+  thread *wait_thread;
 
   /* todo: free memory and device (osl) on network error */
 };
 
-void Device::server_run()
+void Device::server_run(int port)
 {
   try {
     /* starts thread that responds to discovery requests */
@@ -787,16 +974,26 @@ void Device::server_run()
     for (;;) {
       /* accept connection */
       boost::asio::io_service io_service;
-      tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), SERVER_PORT));
+      tcp::acceptor acceptor(io_service);
+      tcp::endpoint endpoint(tcp::v4(), port);
+      acceptor.open(endpoint.protocol());
+      acceptor.set_option(tcp::acceptor::reuse_address(true));
+      acceptor.bind(endpoint);
+      acceptor.listen();
+
+      printf("Listening on port %d.\n", port);
 
       tcp::socket socket(io_service);
       acceptor.accept(socket);
+      socket.set_option(tcp::no_delay(true));
 
       string remote_address = socket.remote_endpoint().address().to_string();
       printf("Connected to remote client at: %s\n", remote_address.c_str());
 
-      DeviceServer server(this, socket);
-      server.listen();
+      {
+        DeviceServer server(this, socket);
+        server.listen();
+      }
 
       printf("Disconnected.\n");
     }
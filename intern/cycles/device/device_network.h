@@ -33,13 +33,17 @@
 #  include <iostream>
 #  include <sstream>
 
+#  include "device/device_task.h"
+
 #  include "render/buffers.h"
 
 #  include "util/util_foreach.h"
 #  include "util/util_list.h"
+#  include "util/util_logging.h"
 #  include "util/util_map.h"
 #  include "util/util_param.h"
 #  include "util/util_string.h"
+#  include "util/util_thread.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -77,7 +81,7 @@ class network_device_memory : public device_memory {
     device_pointer = 0;
   };
 
-  vector<char> local_data;
+  string name_string;
 };
 
 /* Common netowrk error function / object for both DeviceNetwork and DeviceServer*/
@@ -95,30 +99,100 @@ class NetworkError {
 
   void network_error(const string &message)
   {
+    thread_scoped_lock lock(mutex);
+    if (error_count == 0) {
+      fprintf(stderr, "Network error: %s\n", message.c_str());
+    }
     error = message;
     error_count += 1;
   }
 
   bool have_error()
   {
-    return true ? error_count > 0 : false;
+    thread_scoped_lock lock(mutex);
+    return error_count > 0;
   }
 
  private:
+  thread_mutex mutex;
   string error;
   int error_count;
 };
 
+/* Network Connection
+ *
+ * Outgoing calls are collected in a send buffer and written to the socket in batches, so
+ * uploading a scene made of many small buffers does not pay the network round trip for every
+ * call. The buffer is flushed whenever the other side has to act on what was sent, and when
+ * it grows past the batch size. Large buffers bypass it and are written directly.
+ *
+ * Sending is thread safe, receiving is done by a single thread per connection. */
+
+static const size_t NETWORK_BATCH_SIZE = 4 * 1024 * 1024;
+
+class NetworkConnection {
+ public:
+  NetworkConnection(tcp::socket &socket_, NetworkError *e) : socket(socket_), error_func(e)
+  {
+  }
+
+  void send(const void *data, size_t size)
+  {
+    if (size >= NETWORK_BATCH_SIZE) {
+      flush();
+      write(data, size);
+      return;
+    }
+
+    const uint8_t *bytes = (const uint8_t *)data;
+    send_buffer.insert(send_buffer.end(), bytes, bytes + size);
+
+    if (send_buffer.size() >= NETWORK_BATCH_SIZE) {
+      flush();
+    }
+  }
+
+  void flush()
+  {
+    if (!send_buffer.empty()) {
+      write(send_buffer.data(), send_buffer.size());
+      send_buffer.clear();
+    }
+  }
+
+  tcp::socket &socket;
+  NetworkError *error_func;
+
+  /* Held by RPCSend, so calls from multiple threads do not interleave. */
+  thread_mutex send_mutex;
+
+ protected:
+  void write(const void *data, size_t size)
+  {
+    boost::system::error_code error;
+    boost::asio::write(
+        socket, boost::asio::buffer(data, size), boost::asio::transfer_all(), error);
+
+    if (error.value())
+      error_func->network_error(error.message());
+  }
+
+  vector<uint8_t> send_buffer;
+};
+
 /* Remote procedure call Send */
 
 class RPCSend {
  public:
-  RPCSend(tcp::socket &socket_, NetworkError *e, const string &name_ = "")
-      : name(name_), socket(socket_), archive(archive_stream), sent(false)
+  RPCSend(NetworkConnection &connection_, const string &name_ = "")
+      : name(name_),
+        connection(connection_),
+        lock(connection_.send_mutex),
+        archive(archive_stream),
+        sent(false)
   {
     archive &name_;
-    error_func = e;
-    fprintf(stderr, "rpc send %s\n", name.c_str());
+    VLOG(4) << "RPC send " << name;
   }
 
   ~RPCSend()
@@ -127,10 +201,11 @@ class RPCSend {
 
   void add(const device_memory &mem)
   {
-    archive &mem.data_type &mem.data_elements &mem.data_size;
-    archive &mem.data_width &mem.data_height &mem.data_depth &mem.device_pointer;
-    archive &mem.type &string(mem.name);
-    archive &mem.interpolation &mem.extension;
+    int data_type = (int)mem.data_type;
+    int type = (int)mem.type;
+    archive &data_type &mem.data_elements &mem.data_size;
+    archive &mem.data_width &mem.data_height &mem.data_depth;
+    archive &type &string(mem.name ? mem.name : "");
     archive &mem.device_pointer;
   }
 
@@ -145,23 +220,26 @@ class RPCSend {
     archive &type &task.x &task.y &task.w &task.h;
     archive &task.rgba_byte &task.rgba_half &task.buffer &task.sample &task.num_samples;
     archive &task.offset &task.stride;
-    archive &task.shader_input &task.shader_output &task.shader_eval_type;
+    archive &task.shader_input &task.shader_output &task.shader_eval_type &task.shader_filter;
     archive &task.shader_x &task.shader_w;
-    archive &task.need_finish_queue;
+    archive &task.tile_types &task.pass_stride &task.frame_stride &task.target_pass_stride;
+    archive &task.pass_denoising_data &task.pass_denoising_clean;
+    archive &task.need_finish_queue &task.integrator_branched;
+    archive &task.adaptive_sampling.use &task.adaptive_sampling.adaptive_step;
+    archive &task.adaptive_sampling.min_samples;
   }
 
   void add(const RenderTile &tile)
   {
-    archive &tile.x &tile.y &tile.w &tile.h;
+    int task = (int)tile.task;
+    archive &task &tile.x &tile.y &tile.w &tile.h;
     archive &tile.start_sample &tile.num_samples &tile.sample;
-    archive &tile.resolution &tile.offset &tile.stride;
+    archive &tile.resolution &tile.offset &tile.stride &tile.tile_index;
     archive &tile.buffer;
   }
 
   void write()
   {
-    boost::system::error_code error;
-
     /* get string from stream */
     string archive_str = archive_stream.str();
 
@@ -170,50 +248,44 @@ class RPCSend {
     header_stream << setw(8) << hex << archive_str.size();
     string header_str = header_stream.str();
 
-    boost::asio::write(
-        socket, boost::asio::buffer(header_str), boost::asio::transfer_all(), error);
-
-    if (error.value())
-      error_func->network_error(error.message());
+    connection.send(header_str.data(), header_str.size());
 
     /* then send actual data */
-    boost::asio::write(
-        socket, boost::asio::buffer(archive_str), boost::asio::transfer_all(), error);
-
-    if (error.value())
-      error_func->network_error(error.message());
+    connection.send(archive_str.data(), archive_str.size());
 
     sent = true;
   }
 
-  void write_buffer(void *buffer, size_t size)
+  void write_buffer(const void *buffer, size_t size)
   {
-    boost::system::error_code error;
-
-    boost::asio::write(
-        socket, boost::asio::buffer(buffer, size), boost::asio::transfer_all(), error);
+    connection.send(buffer, size);
+  }
 
-    if (error.value())
-      error_func->network_error(error.message());
+  /* Send everything batched so far, for calls the other side has to respond to. */
+  void flush()
+  {
+    connection.flush();
   }
 
  protected:
   string name;
-  tcp::socket &socket;
+  NetworkConnection &connection;
+  thread_scoped_lock lock;
   ostringstream archive_stream;
   o_archive archive;
   bool sent;
-  NetworkError *error_func;
 };
 
 /* Remote procedure call Receive */
 
 class RPCReceive {
  public:
-  RPCReceive(tcp::socket &socket_, NetworkError *e)
-      : socket(socket_), archive_stream(NULL), archive(NULL)
+  RPCReceive(NetworkConnection &connection_)
+      : socket(connection_.socket),
+        archive_stream(NULL),
+        archive(NULL),
+        error_func(connection_.error_func)
   {
-    error_func = e;
     /* read head with fixed size */
     vector<char> header(8);
     boost::system::error_code error;
@@ -246,7 +318,7 @@ class RPCReceive {
           archive = new i_archive(*archive_stream);
 
           *archive &name;
-          fprintf(stderr, "rpc receive %s\n", name.c_str());
+          VLOG(4) << "RPC receive " << name;
         }
         else {
           error_func->network_error("Network receive error: data size doesn't match header");
@@ -267,15 +339,17 @@ class RPCReceive {
     delete archive_stream;
   }
 
-  void read(network_device_memory &mem, string &name)
+  void read(network_device_memory &mem)
   {
-    *archive &mem.data_type &mem.data_elements &mem.data_size;
-    *archive &mem.data_width &mem.data_height &mem.data_depth &mem.device_pointer;
-    *archive &mem.type &name;
-    *archive &mem.interpolation &mem.extension;
+    int data_type, type;
+    *archive &data_type &mem.data_elements &mem.data_size;
+    *archive &mem.data_width &mem.data_height &mem.data_depth;
+    *archive &type &mem.name_string;
     *archive &mem.device_pointer;
 
-    mem.name = name.c_str();
+    mem.data_type = (DataType)data_type;
+    mem.type = (MemoryType)type;
+    mem.name = mem.name_string.c_str();
     mem.host_pointer = 0;
 
     /* Can't transfer OpenGL texture over network. */
@@ -299,7 +373,7 @@ class RPCReceive {
     }
 
     if (len != size)
-      cout << "Network receive error: buffer size doesn't match expected size\n";
+      error_func->network_error("Network receive error: buffer size doesn't match");
   }
 
   void read(DeviceTask &task)
@@ -309,20 +383,26 @@ class RPCReceive {
     *archive &type &task.x &task.y &task.w &task.h;
     *archive &task.rgba_byte &task.rgba_half &task.buffer &task.sample &task.num_samples;
     *archive &task.offset &task.stride;
-    *archive &task.shader_input &task.shader_output &task.shader_eval_type;
+    *archive &task.shader_input &task.shader_output &task.shader_eval_type &task.shader_filter;
     *archive &task.shader_x &task.shader_w;
-    *archive &task.need_finish_queue;
+    *archive &task.tile_types &task.pass_stride &task.frame_stride &task.target_pass_stride;
+    *archive &task.pass_denoising_data &task.pass_denoising_clean;
+    *archive &task.need_finish_queue &task.integrator_branched;
+    *archive &task.adaptive_sampling.use &task.adaptive_sampling.adaptive_step;
+    *archive &task.adaptive_sampling.min_samples;
 
     task.type = (DeviceTask::Type)type;
   }
 
   void read(RenderTile &tile)
   {
-    *archive &tile.x &tile.y &tile.w &tile.h;
+    int task;
+    *archive &task &tile.x &tile.y &tile.w &tile.h;
     *archive &tile.start_sample &tile.num_samples &tile.sample;
-    *archive &tile.resolution &tile.offset &tile.stride;
+    *archive &tile.resolution &tile.offset &tile.stride &tile.tile_index;
     *archive &tile.buffer;
 
+    tile.task = (RenderTile::Task)task;
     tile.buffers = NULL;
   }
 
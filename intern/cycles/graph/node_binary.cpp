@@ -0,0 +1,561 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "graph/node_binary.h"
+
+#include "util/util_foreach.h"
+#include "util/util_path.h"
+#include "util/util_transform.h"
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+CCL_NAMESPACE_BEGIN
+
+/* Writer */
+
+BinaryWriter::BinaryWriter(const string &filepath) : offset(0), error(false)
+{
+  file = path_fopen(filepath, "wb");
+  if (file == NULL) {
+    error = true;
+  }
+}
+
+BinaryWriter::~BinaryWriter()
+{
+  if (file) {
+    fclose(file);
+  }
+}
+
+void BinaryWriter::write(const void *data, size_t size)
+{
+  if (file == NULL || size == 0) {
+    return;
+  }
+  if (fwrite(data, 1, size, file) != size) {
+    error = true;
+  }
+  offset += size;
+}
+
+void BinaryWriter::write_int(int value)
+{
+  write(&value, sizeof(value));
+}
+
+void BinaryWriter::write_uint(uint value)
+{
+  write(&value, sizeof(value));
+}
+
+void BinaryWriter::write_uint64(uint64_t value)
+{
+  write(&value, sizeof(value));
+}
+
+void BinaryWriter::write_float(float value)
+{
+  write(&value, sizeof(value));
+}
+
+void BinaryWriter::write_string(const string &value)
+{
+  write_uint(value.size());
+  write(value.data(), value.size());
+}
+
+void BinaryWriter::write_array(const void *data, size_t element_size, size_t num_elements)
+{
+  write_uint64(num_elements);
+  write_uint(element_size);
+
+  if (num_elements == 0) {
+    return;
+  }
+
+  const uint8_t padding[BINARY_ARRAY_ALIGNMENT] = {0};
+  write(padding, align_up(offset, BINARY_ARRAY_ALIGNMENT) - offset);
+  write(data, element_size * num_elements);
+}
+
+int BinaryWriter::add_node(const Node *node)
+{
+  const int index = node_index.size();
+  node_index[node] = index;
+  return index;
+}
+
+int BinaryWriter::find_node(const Node *node) const
+{
+  map<const Node *, int>::const_iterator it = node_index.find(node);
+  return (it != node_index.end()) ? it->second : -1;
+}
+
+/* Reader */
+
+BinaryReader::BinaryReader(const string &filepath)
+    : data(NULL), size(0), offset(0), error(false)
+{
+#ifndef _WIN32
+  mapped_data = NULL;
+  mapped_size = 0;
+
+  /* Map the file, so array data is only paged in when copied into the nodes. */
+  const int fd = open(filepath.c_str(), O_RDONLY);
+  if (fd != -1) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED) {
+        mapped_data = mapped;
+        mapped_size = st.st_size;
+        data = (const uint8_t *)mapped;
+        size = mapped_size;
+      }
+    }
+    close(fd);
+  }
+
+  if (data) {
+    return;
+  }
+#endif
+
+  if (path_read_binary(filepath, buffer) && !buffer.empty()) {
+    data = &buffer[0];
+    size = buffer.size();
+  }
+  else {
+    error = true;
+  }
+}
+
+BinaryReader::~BinaryReader()
+{
+#ifndef _WIN32
+  if (mapped_data) {
+    munmap(mapped_data, mapped_size);
+  }
+#endif
+}
+
+bool BinaryReader::read(void *value, size_t value_size)
+{
+  if (error || offset + value_size > size) {
+    error = true;
+    memset(value, 0, value_size);
+    return false;
+  }
+
+  memcpy(value, data + offset, value_size);
+  offset += value_size;
+  return true;
+}
+
+int BinaryReader::read_int()
+{
+  int value;
+  read(&value, sizeof(value));
+  return value;
+}
+
+uint BinaryReader::read_uint()
+{
+  uint value;
+  read(&value, sizeof(value));
+  return value;
+}
+
+uint64_t BinaryReader::read_uint64()
+{
+  uint64_t value;
+  read(&value, sizeof(value));
+  return value;
+}
+
+float BinaryReader::read_float()
+{
+  float value;
+  read(&value, sizeof(value));
+  return value;
+}
+
+string BinaryReader::read_string()
+{
+  const size_t length = read_uint();
+  if (error || offset + length > size) {
+    error = true;
+    return string();
+  }
+
+  string value((const char *)data + offset, length);
+  offset += length;
+  return value;
+}
+
+const void *BinaryReader::read_array(size_t element_size, size_t *num_elements)
+{
+  const size_t num = read_uint64();
+  const size_t file_element_size = read_uint();
+  *num_elements = 0;
+
+  if (error || num == 0) {
+    return NULL;
+  }
+
+  if (file_element_size == 0) {
+    error = true;
+    return NULL;
+  }
+
+  const size_t array_offset = align_up(offset, BINARY_ARRAY_ALIGNMENT);
+  const size_t array_size = file_element_size * num;
+
+  if (array_offset + array_size > size || array_size / file_element_size != num) {
+    error = true;
+    return NULL;
+  }
+
+  offset = array_offset + array_size;
+
+  /* Written by a build with a different memory layout for the type. */
+  if (file_element_size != element_size) {
+    return NULL;
+  }
+
+  *num_elements = num;
+  return data + array_offset;
+}
+
+void BinaryReader::add_node(Node *node)
+{
+  nodes.push_back(node);
+}
+
+Node *BinaryReader::find_node(int index) const
+{
+  return (index >= 0 && index < (int)nodes.size()) ? nodes[index] : NULL;
+}
+
+/* Nodes */
+
+template<typename T>
+static void binary_write_array(BinaryWriter &writer, const array<T> &value)
+{
+  writer.write_array(value.data(), sizeof(T), value.size());
+}
+
+template<typename T>
+static void binary_read_array(BinaryReader &reader,
+                              Node *node,
+                              const SocketType *socket,
+                              SocketType::Type type)
+{
+  size_t num_elements;
+  const void *data = reader.read_array(sizeof(T), &num_elements);
+
+  if (socket && socket->type == type) {
+    array<T> value;
+    if (num_elements) {
+      memcpy(value.resize(num_elements), data, sizeof(T) * num_elements);
+    }
+    node->set(*socket, value);
+  }
+}
+
+void binary_write_node(BinaryWriter &writer, const Node *node)
+{
+  writer.write_string(node->type->name.string());
+  writer.write_string(node->name.string());
+
+  vector<const SocketType *> sockets;
+  foreach (const SocketType &socket, node->type->inputs) {
+    if (socket.type == SocketType::CLOSURE || socket.type == SocketType::UNDEFINED) {
+      continue;
+    }
+    if (socket.flags & SocketType::INTERNAL) {
+      continue;
+    }
+    if (node->has_default_value(socket)) {
+      continue;
+    }
+    sockets.push_back(&socket);
+  }
+
+  writer.write_uint(sockets.size());
+
+  foreach (const SocketType *socket_ptr, sockets) {
+    const SocketType &socket = *socket_ptr;
+    writer.write_string(socket.name.string());
+    writer.write_uint(socket.type);
+
+    switch (socket.type) {
+      case SocketType::BOOLEAN:
+        writer.write_int(node->get_bool(socket));
+        break;
+      case SocketType::FLOAT:
+        writer.write_float(node->get_float(socket));
+        break;
+      case SocketType::INT:
+        writer.write_int(node->get_int(socket));
+        break;
+      case SocketType::UINT:
+        writer.write_uint(node->get_uint(socket));
+        break;
+      case SocketType::COLOR:
+      case SocketType::VECTOR:
+      case SocketType::POINT:
+      case SocketType::NORMAL: {
+        const float3 value = node->get_float3(socket);
+        writer.write_float(value.x);
+        writer.write_float(value.y);
+        writer.write_float(value.z);
+        break;
+      }
+      case SocketType::POINT2: {
+        const float2 value = node->get_float2(socket);
+        writer.write_float(value.x);
+        writer.write_float(value.y);
+        break;
+      }
+      case SocketType::STRING:
+      case SocketType::ENUM:
+        writer.write_string(node->get_string(socket).string());
+        break;
+      case SocketType::TRANSFORM: {
+        const Transform tfm = node->get_transform(socket);
+        writer.write(&tfm, sizeof(tfm));
+        break;
+      }
+      case SocketType::NODE:
+        writer.write_int(writer.find_node(node->get_node(socket)));
+        break;
+      case SocketType::BOOLEAN_ARRAY:
+        binary_write_array(writer, node->get_bool_array(socket));
+        break;
+      case SocketType::FLOAT_ARRAY:
+        binary_write_array(writer, node->get_float_array(socket));
+        break;
+      case SocketType::INT_ARRAY:
+        binary_write_array(writer, node->get_int_array(socket));
+        break;
+      case SocketType::COLOR_ARRAY:
+      case SocketType::VECTOR_ARRAY:
+      case SocketType::POINT_ARRAY:
+      case SocketType::NORMAL_ARRAY:
+        binary_write_array(writer, node->get_float3_array(socket));
+        break;
+      case SocketType::POINT2_ARRAY:
+        binary_write_array(writer, node->get_float2_array(socket));
+        break;
+      case SocketType::TRANSFORM_ARRAY:
+        binary_write_array(writer, node->get_transform_array(socket));
+        break;
+      case SocketType::STRING_ARRAY: {
+        const array<ustring> &value = node->get_string_array(socket);
+        writer.write_uint64(value.size());
+        for (size_t i = 0; i < value.size(); i++) {
+          writer.write_string(value[i].string());
+        }
+        break;
+      }
+      case SocketType::NODE_ARRAY: {
+        const array<Node *> &value = node->get_node_array(socket);
+        writer.write_uint64(value.size());
+        for (size_t i = 0; i < value.size(); i++) {
+          writer.write_int(writer.find_node(value[i]));
+        }
+        break;
+      }
+      case SocketType::CLOSURE:
+      case SocketType::UNDEFINED:
+        break;
+    }
+  }
+}
+
+bool binary_read_node(BinaryReader &reader, Node *node)
+{
+  const ustring name(reader.read_string());
+  if (node) {
+    node->name = name;
+  }
+
+  const uint num_sockets = reader.read_uint();
+
+  for (uint i = 0; i < num_sockets && !reader.has_error(); i++) {
+    const ustring socket_name(reader.read_string());
+    const SocketType::Type type = (SocketType::Type)reader.read_uint();
+
+    /* Sockets which no longer exist or changed type are read but not set. */
+    const SocketType *socket = (node) ? node->type->find_input(socket_name) : NULL;
+    if (socket && socket->type != type) {
+      socket = NULL;
+    }
+
+    switch (type) {
+      case SocketType::BOOLEAN: {
+        const bool value = reader.read_int() != 0;
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::FLOAT: {
+        const float value = reader.read_float();
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::INT: {
+        const int value = reader.read_int();
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::UINT: {
+        const uint value = reader.read_uint();
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::COLOR:
+      case SocketType::VECTOR:
+      case SocketType::POINT:
+      case SocketType::NORMAL: {
+        float3 value;
+        value.x = reader.read_float();
+        value.y = reader.read_float();
+        value.z = reader.read_float();
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::POINT2: {
+        float2 value;
+        value.x = reader.read_float();
+        value.y = reader.read_float();
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::STRING: {
+        const ustring value(reader.read_string());
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::ENUM: {
+        const ustring value(reader.read_string());
+        if (socket) {
+          if (socket->enum_values->exists(value)) {
+            node->set(*socket, value);
+          }
+          else {
+            fprintf(stderr,
+                    "Unknown value \"%s\" for attribute \"%s\".\n",
+                    value.c_str(),
+                    socket->name.c_str());
+          }
+        }
+        break;
+      }
+      case SocketType::TRANSFORM: {
+        Transform value;
+        reader.read(&value, sizeof(value));
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::NODE: {
+        Node *value = reader.find_node(reader.read_int());
+        if (socket && value && value->is_a(*(socket->node_type))) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::BOOLEAN_ARRAY:
+        binary_read_array<bool>(reader, node, socket, type);
+        break;
+      case SocketType::FLOAT_ARRAY:
+        binary_read_array<float>(reader, node, socket, type);
+        break;
+      case SocketType::INT_ARRAY:
+        binary_read_array<int>(reader, node, socket, type);
+        break;
+      case SocketType::COLOR_ARRAY:
+      case SocketType::VECTOR_ARRAY:
+      case SocketType::POINT_ARRAY:
+      case SocketType::NORMAL_ARRAY:
+        binary_read_array<float3>(reader, node, socket, type);
+        break;
+      case SocketType::POINT2_ARRAY:
+        binary_read_array<float2>(reader, node, socket, type);
+        break;
+      case SocketType::TRANSFORM_ARRAY:
+        binary_read_array<Transform>(reader, node, socket, type);
+        break;
+      case SocketType::STRING_ARRAY: {
+        array<ustring> value;
+        const size_t num_elements = reader.read_uint64();
+        for (size_t j = 0; j < num_elements && !reader.has_error(); j++) {
+          value.push_back_slow(ustring(reader.read_string()));
+        }
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::NODE_ARRAY: {
+        array<Node *> value;
+        const size_t num_elements = reader.read_uint64();
+        for (size_t j = 0; j < num_elements && !reader.has_error(); j++) {
+          Node *value_node = reader.find_node(reader.read_int());
+          if (socket && value_node && !value_node->is_a(*(socket->node_type))) {
+            value_node = NULL;
+          }
+          value.push_back_slow(value_node);
+        }
+        if (socket) {
+          node->set(*socket, value);
+        }
+        break;
+      }
+      case SocketType::CLOSURE:
+      case SocketType::UNDEFINED:
+      default:
+        /* Unknown type, the rest of the node can not be parsed. */
+        return false;
+    }
+  }
+
+  return !reader.has_error();
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+#include "graph/node.h"
+
+#include "util/util_map.h"
+#include "util/util_string.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Binary Node Files
+ *
+ * Compact storage of node socket values, the binary counterpart of node_xml. Sockets are stored
+ * by name so files survive sockets being added or reordered. Array data is stored raw and
+ * aligned, so reading it is a copy out of the memory mapped file without any parsing.
+ *
+ * Nodes referenced by NODE sockets are stored as the index of the node in the file, they must
+ * be written before the nodes referencing them. */
+
+#define BINARY_ARRAY_ALIGNMENT 16
+
+class BinaryWriter {
+ public:
+  explicit BinaryWriter(const string &filepath);
+  ~BinaryWriter();
+
+  bool is_open() const
+  {
+    return file != NULL;
+  }
+  bool has_error() const
+  {
+    return error;
+  }
+
+  void write(const void *data, size_t size);
+  void write_int(int value);
+  void write_uint(uint value);
+  void write_uint64(uint64_t value);
+  void write_float(float value);
+  void write_string(const string &value);
+  /* Element count and size, followed by the data aligned to BINARY_ARRAY_ALIGNMENT. */
+  void write_array(const void *data, size_t element_size, size_t num_elements);
+
+  /* Assign the next index to a node, for references from NODE sockets. */
+  int add_node(const Node *node);
+  int find_node(const Node *node) const;
+
+ protected:
+  FILE *file;
+  size_t offset;
+  bool error;
+  map<const Node *, int> node_index;
+};
+
+class BinaryReader {
+ public:
+  explicit BinaryReader(const string &filepath);
+  ~BinaryReader();
+
+  bool is_open() const
+  {
+    return data != NULL;
+  }
+  bool has_error() const
+  {
+    return error;
+  }
+  bool at_end() const
+  {
+    return offset >= size;
+  }
+
+  bool read(void *value, size_t value_size);
+  int read_int();
+  uint read_uint();
+  uint64_t read_uint64();
+  float read_float();
+  string read_string();
+  /* Returns a pointer to the array data in the file, valid as long as the reader. NULL is
+   * returned for empty arrays and when the element size does not match. */
+  const void *read_array(size_t element_size, size_t *num_elements);
+
+  /* Nodes in the order they were read, for resolving NODE sockets. */
+  void add_node(Node *node);
+  Node *find_node(int index) const;
+
+ protected:
+  const uint8_t *data;
+  size_t size;
+  size_t offset;
+  bool error;
+  vector<Node *> nodes;
+
+  /* Fallback when memory mapping is not available. */
+  vector<uint8_t> buffer;
+#ifndef _WIN32
+  void *mapped_data;
+  size_t mapped_size;
+#endif
+};
+
+/* The node type name is written first, for the caller to create the node before reading it.
+ * Reading into a NULL node skips over the node data. */
+void binary_write_node(BinaryWriter &writer, const Node *node);
+bool binary_read_node(BinaryReader &reader, Node *node);
+
+CCL_NAMESPACE_END
@@ -75,6 +75,16 @@ ccl_device_inline void triangle_vertices(KernelGlobals *kg, int prim, float3 P[3
   P[2] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 2));
 }
 
+/* Vertex normal, from the full precision or the octahedral encoded array. */
+
+ccl_device_inline float3 triangle_vertex_normal(KernelGlobals *kg, uint vert)
+{
+  if (kernel_data.bvh.use_compressed_normals) {
+    return oct_decode_unit_vector(kernel_tex_fetch(__tri_vnormal_oct, vert));
+  }
+  return float4_to_float3(kernel_tex_fetch(__tri_vnormal, vert));
+}
+
 /* Interpolate smooth vertex normal from vertices */
 
 ccl_device_inline float3
@@ -82,9 +92,9 @@ triangle_smooth_normal(KernelGlobals *kg, float3 Ng, int prim, float u, float v)
 {
   /* load triangle vertices */
   const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  float3 n0 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, tri_vindex.x));
-  float3 n1 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, tri_vindex.y));
-  float3 n2 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, tri_vindex.z));
+  float3 n0 = triangle_vertex_normal(kg, tri_vindex.x);
+  float3 n1 = triangle_vertex_normal(kg, tri_vindex.y);
+  float3 n2 = triangle_vertex_normal(kg, tri_vindex.z);
 
   float3 N = safe_normalize((1.0f - u - v) * n2 + u * n0 + v * n1);
 
@@ -111,6 +121,26 @@ ccl_device_inline void triangle_dPdudv(KernelGlobals *kg,
 
 /* Reading attributes on various triangle elements */
 
+ccl_device_inline float2 triangle_attribute_fetch_float2(KernelGlobals *kg,
+                                                         const AttributeDescriptor desc,
+                                                         int index)
+{
+  if (desc.flags & ATTR_PACKED) {
+    return unorm16x2_decode(kernel_tex_fetch(__attributes_float2_packed, index));
+  }
+  return kernel_tex_fetch(__attributes_float2, index);
+}
+
+ccl_device_inline float3 triangle_attribute_fetch_float3(KernelGlobals *kg,
+                                                         const AttributeDescriptor desc,
+                                                         int index)
+{
+  if (desc.flags & ATTR_PACKED) {
+    return half3_decode(kernel_tex_fetch(__attributes_float3_packed, index));
+  }
+  return float4_to_float3(kernel_tex_fetch(__attributes_float3, index));
+}
+
 ccl_device float triangle_attribute_float(
     KernelGlobals *kg, const ShaderData *sd, const AttributeDescriptor desc, float *dx, float *dy)
 {
@@ -183,14 +213,14 @@ ccl_device float2 triangle_attribute_float2(KernelGlobals *kg,
     if (dy)
       *dy = make_float2(0.0f, 0.0f);
 
-    return kernel_tex_fetch(__attributes_float2, desc.offset + sd->prim);
+    return triangle_attribute_fetch_float2(kg, desc, desc.offset + sd->prim);
   }
   else if (desc.element == ATTR_ELEMENT_VERTEX || desc.element == ATTR_ELEMENT_VERTEX_MOTION) {
     uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
 
-    float2 f0 = kernel_tex_fetch(__attributes_float2, desc.offset + tri_vindex.x);
-    float2 f1 = kernel_tex_fetch(__attributes_float2, desc.offset + tri_vindex.y);
-    float2 f2 = kernel_tex_fetch(__attributes_float2, desc.offset + tri_vindex.z);
+    float2 f0 = triangle_attribute_fetch_float2(kg, desc, desc.offset + tri_vindex.x);
+    float2 f1 = triangle_attribute_fetch_float2(kg, desc, desc.offset + tri_vindex.y);
+    float2 f2 = triangle_attribute_fetch_float2(kg, desc, desc.offset + tri_vindex.z);
 
 #ifdef __RAY_DIFFERENTIALS__
     if (dx)
@@ -206,9 +236,9 @@ ccl_device float2 triangle_attribute_float2(KernelGlobals *kg,
     float2 f0, f1, f2;
 
     if (desc.element == ATTR_ELEMENT_CORNER) {
-      f0 = kernel_tex_fetch(__attributes_float2, tri + 0);
-      f1 = kernel_tex_fetch(__attributes_float2, tri + 1);
-      f2 = kernel_tex_fetch(__attributes_float2, tri + 2);
+      f0 = triangle_attribute_fetch_float2(kg, desc, tri + 0);
+      f1 = triangle_attribute_fetch_float2(kg, desc, tri + 1);
+      f2 = triangle_attribute_fetch_float2(kg, desc, tri + 2);
     }
 
 #ifdef __RAY_DIFFERENTIALS__
@@ -250,17 +280,14 @@ ccl_device float3 triangle_attribute_float3(KernelGlobals *kg,
     if (dy)
       *dy = make_float3(0.0f, 0.0f, 0.0f);
 
-    return float4_to_float3(kernel_tex_fetch(__attributes_float3, desc.offset + sd->prim));
+    return triangle_attribute_fetch_float3(kg, desc, desc.offset + sd->prim);
   }
   else if (desc.element == ATTR_ELEMENT_VERTEX || desc.element == ATTR_ELEMENT_VERTEX_MOTION) {
     uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
 
-    float3 f0 = float4_to_float3(
-        kernel_tex_fetch(__attributes_float3, desc.offset + tri_vindex.x));
-    float3 f1 = float4_to_float3(
-        kernel_tex_fetch(__attributes_float3, desc.offset + tri_vindex.y));
-    float3 f2 = float4_to_float3(
-        kernel_tex_fetch(__attributes_float3, desc.offset + tri_vindex.z));
+    float3 f0 = triangle_attribute_fetch_float3(kg, desc, desc.offset + tri_vindex.x);
+    float3 f1 = triangle_attribute_fetch_float3(kg, desc, desc.offset + tri_vindex.y);
+    float3 f2 = triangle_attribute_fetch_float3(kg, desc, desc.offset + tri_vindex.z);
 
 #ifdef __RAY_DIFFERENTIALS__
     if (dx)
@@ -275,9 +302,9 @@ ccl_device float3 triangle_attribute_float3(KernelGlobals *kg,
     int tri = desc.offset + sd->prim * 3;
     float3 f0, f1, f2;
 
-    f0 = float4_to_float3(kernel_tex_fetch(__attributes_float3, tri + 0));
-    f1 = float4_to_float3(kernel_tex_fetch(__attributes_float3, tri + 1));
-    f2 = float4_to_float3(kernel_tex_fetch(__attributes_float3, tri + 2));
+    f0 = triangle_attribute_fetch_float3(kg, desc, tri + 0);
+    f1 = triangle_attribute_fetch_float3(kg, desc, tri + 1);
+    f2 = triangle_attribute_fetch_float3(kg, desc, tri + 2);
 
 #ifdef __RAY_DIFFERENTIALS__
     if (dx)
@@ -0,0 +1,326 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef __LIGHT_TREE__
+
+/* Light Tree
+ *
+ * Lights are selected by traversing the tree, at each node picking a child proportional to
+ * its estimated contribution to the shading point. Distant and background lights are not in
+ * the tree, they are picked by energy, against the importance of the tree root.
+ *
+ * The normal at the shading point is not taken into account, so that the same probabilities
+ * can be computed for MIS, where only the ray origin is known. */
+
+/* Importance of emitters within the bounds, see "Importance Sampling of Many Lights with
+ * Adaptive Tree Splitting", Conty Estevez and Kulla, 2018. */
+ccl_device float light_tree_importance(const float3 P,
+                                       const float3 bbox_min,
+                                       const float3 bbox_max,
+                                       const float3 axis,
+                                       const float theta_o,
+                                       const float theta_e,
+                                       const float energy)
+{
+  if (energy == 0.0f) {
+    return 0.0f;
+  }
+
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius_squared = 0.25f * len_squared(bbox_max - bbox_min);
+  const float3 centroid_to_P = P - centroid;
+  const float distance_squared = len_squared(centroid_to_P);
+
+  float cos_theta_prime = 1.0f;
+
+  /* Inside the bounding sphere any direction may be reached. */
+  if (distance_squared > radius_squared) {
+    /* Angle subtended by the bounding sphere. */
+    const float theta_u = fast_asinf(sqrtf(radius_squared / distance_squared));
+    /* Angle between the cone axis and the direction towards the shading point. */
+    const float theta = fast_acosf(dot(axis, centroid_to_P) / sqrtf(distance_squared));
+    const float theta_prime = max(theta - theta_o - theta_u, 0.0f);
+
+    if (theta_prime > theta_e) {
+      return 0.0f;
+    }
+    cos_theta_prime = fast_cosf(theta_prime);
+  }
+
+  return energy * cos_theta_prime / max(max(distance_squared, radius_squared), 1e-12f);
+}
+
+ccl_device float light_tree_node_importance(KernelGlobals *kg, const float3 P, int node_index)
+{
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes,
+                                                                   node_index);
+  return light_tree_importance(P,
+                               make_float3(knode->bounding_box_min[0],
+                                           knode->bounding_box_min[1],
+                                           knode->bounding_box_min[2]),
+                               make_float3(knode->bounding_box_max[0],
+                                           knode->bounding_box_max[1],
+                                           knode->bounding_box_max[2]),
+                               make_float3(knode->axis[0], knode->axis[1], knode->axis[2]),
+                               knode->theta_o,
+                               knode->theta_e,
+                               knode->energy);
+}
+
+ccl_device float light_tree_emitter_importance(KernelGlobals *kg,
+                                               const float3 P,
+                                               int emitter_index)
+{
+  const ccl_global KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                         emitter_index);
+  return light_tree_importance(P,
+                               make_float3(kemitter->bounding_box_min[0],
+                                           kemitter->bounding_box_min[1],
+                                           kemitter->bounding_box_min[2]),
+                               make_float3(kemitter->bounding_box_max[0],
+                                           kemitter->bounding_box_max[1],
+                                           kemitter->bounding_box_max[2]),
+                               make_float3(
+                                   kemitter->axis[0], kemitter->axis[1], kemitter->axis[2]),
+                               kemitter->theta_o,
+                               kemitter->theta_e,
+                               kemitter->energy);
+}
+
+/* Importance of all emitters in the tree. */
+ccl_device_inline float light_tree_root_importance(KernelGlobals *kg, const float3 P)
+{
+  return (kernel_data.integrator.light_tree_infinite_offset > 0) ?
+             light_tree_node_importance(kg, P, 0) :
+             0.0f;
+}
+
+/* Rescale random number after picking an option from the range [cdf, cdf + pdf). */
+ccl_device_inline float light_tree_rescale_random(float r, float cdf, float pdf)
+{
+  return clamp((r - cdf) / pdf, 0.0f, 1.0f - FLT_EPSILON);
+}
+
+/* Pick an emitter proportional to its importance for the shading point. Returns the emitter
+ * index or -1 when no emitter contributes. The random number is rescaled for reuse. */
+ccl_device int light_tree_sample(KernelGlobals *kg, const float3 P, float *randu, float *pdf)
+{
+  const int infinite_offset = kernel_data.integrator.light_tree_infinite_offset;
+  const float infinite_energy = kernel_data.integrator.light_tree_infinite_energy;
+  const float tree_importance = light_tree_root_importance(kg, P);
+  const float total_importance = tree_importance + infinite_energy;
+
+  if (total_importance == 0.0f) {
+    return -1;
+  }
+
+  float r = *randu;
+  const float infinite_pdf = infinite_energy / total_importance;
+
+  if (r < infinite_pdf) {
+    /* Distant and background lights, by energy. */
+    r = light_tree_rescale_random(r, 0.0f, infinite_pdf);
+
+    const int num_emitters = kernel_data.integrator.light_tree_num_emitters;
+    int selected = -1;
+    float selected_cdf = 0.0f, selected_pdf = 0.0f, cdf = 0.0f;
+
+    for (int i = infinite_offset; i < num_emitters; i++) {
+      const float emitter_pdf = kernel_tex_fetch(__light_tree_emitters, i).energy /
+                                infinite_energy;
+      if (emitter_pdf == 0.0f) {
+        continue;
+      }
+      selected = i;
+      selected_cdf = cdf;
+      selected_pdf = emitter_pdf;
+      cdf += emitter_pdf;
+      if (r < cdf) {
+        break;
+      }
+    }
+
+    *randu = light_tree_rescale_random(r, selected_cdf, selected_pdf);
+    *pdf = infinite_pdf * selected_pdf;
+    return selected;
+  }
+
+  r = light_tree_rescale_random(r, infinite_pdf, 1.0f - infinite_pdf);
+  float tree_pdf = 1.0f - infinite_pdf;
+
+  /* Traverse down to a leaf. */
+  int node_index = 0;
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, 0);
+
+  while (knode->num_emitters == 0) {
+    const int left_index = node_index + 1;
+    const int right_index = knode->child_index;
+    const float left_importance = light_tree_node_importance(kg, P, left_index);
+    const float right_importance = light_tree_node_importance(kg, P, right_index);
+    const float total = left_importance + right_importance;
+
+    if (total == 0.0f) {
+      return -1;
+    }
+
+    const float left_pdf = left_importance / total;
+    if (r < left_pdf) {
+      r = light_tree_rescale_random(r, 0.0f, left_pdf);
+      tree_pdf *= left_pdf;
+      node_index = left_index;
+    }
+    else {
+      const float right_pdf = right_importance / total;
+      r = light_tree_rescale_random(r, left_pdf, right_pdf);
+      tree_pdf *= right_pdf;
+      node_index = right_index;
+    }
+
+    knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+  }
+
+  /* Pick an emitter in the leaf. */
+  const int first_emitter = knode->child_index;
+  const int num_leaf_emitters = knode->num_emitters;
+  float importance[LIGHT_TREE_LEAF_SIZE];
+  float total = 0.0f;
+
+  for (int i = 0; i < num_leaf_emitters; i++) {
+    importance[i] = light_tree_emitter_importance(kg, P, first_emitter + i);
+    total += importance[i];
+  }
+
+  if (total == 0.0f) {
+    return -1;
+  }
+
+  int selected = -1;
+  float selected_cdf = 0.0f, selected_pdf = 0.0f, cdf = 0.0f;
+
+  for (int i = 0; i < num_leaf_emitters; i++) {
+    if (importance[i] == 0.0f) {
+      continue;
+    }
+    selected = first_emitter + i;
+    selected_cdf = cdf;
+    selected_pdf = importance[i] / total;
+    cdf += selected_pdf;
+    if (r < cdf) {
+      break;
+    }
+  }
+
+  *randu = light_tree_rescale_random(r, selected_cdf, selected_pdf);
+  *pdf = tree_pdf * selected_pdf;
+  return selected;
+}
+
+/* Probability of picking the emitter with light_tree_sample, for MIS. */
+ccl_device float light_tree_pdf(KernelGlobals *kg, const float3 P, int emitter_index)
+{
+  const int infinite_offset = kernel_data.integrator.light_tree_infinite_offset;
+  const float infinite_energy = kernel_data.integrator.light_tree_infinite_energy;
+  const float tree_importance = light_tree_root_importance(kg, P);
+  const float total_importance = tree_importance + infinite_energy;
+
+  if (total_importance == 0.0f) {
+    return 0.0f;
+  }
+
+  const ccl_global KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                         emitter_index);
+
+  if (emitter_index >= infinite_offset) {
+    return kemitter->energy / total_importance;
+  }
+
+  /* Probability within the leaf. */
+  int node_index = kemitter->parent_index;
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes,
+                                                                   node_index);
+  float emitter_importance = 0.0f;
+  float total = 0.0f;
+
+  for (int i = 0; i < knode->num_emitters; i++) {
+    const float importance = light_tree_emitter_importance(kg, P, knode->child_index + i);
+    if (knode->child_index + i == emitter_index) {
+      emitter_importance = importance;
+    }
+    total += importance;
+  }
+
+  if (emitter_importance == 0.0f) {
+    return 0.0f;
+  }
+
+  float pdf = (tree_importance / total_importance) * (emitter_importance / total);
+
+  /* Walk up to the root. */
+  int parent_index = knode->parent_index;
+
+  while (parent_index != -1) {
+    const ccl_global KernelLightTreeNode *kparent = &kernel_tex_fetch(__light_tree_nodes,
+                                                                       parent_index);
+    const int left_index = parent_index + 1;
+    const float left_importance = light_tree_node_importance(kg, P, left_index);
+    const float right_importance = light_tree_node_importance(kg, P, kparent->child_index);
+    const float node_importance = (node_index == left_index) ? left_importance :
+                                                               right_importance;
+
+    if (node_importance == 0.0f) {
+      return 0.0f;
+    }
+
+    pdf *= node_importance / (left_importance + right_importance);
+
+    node_index = parent_index;
+    parent_index = kparent->parent_index;
+  }
+
+  return pdf;
+}
+
+ccl_device float light_tree_pdf_lamp(KernelGlobals *kg, const float3 P, int lamp)
+{
+  const int emitter_index = kernel_tex_fetch(__light_tree_emitter_lookup, lamp);
+  return (emitter_index != -1) ? light_tree_pdf(kg, P, emitter_index) : 0.0f;
+}
+
+/* Density over the triangle area, the equivalent of pdf_triangles for the flat distribution. */
+ccl_device float light_tree_pdf_triangle_area(KernelGlobals *kg,
+                                              const float3 P,
+                                              int object,
+                                              int prim)
+{
+  const int offset = kernel_tex_fetch(__light_tree_object_lookup_offset, object);
+  if (offset == LIGHT_TREE_NO_LOOKUP) {
+    return 0.0f;
+  }
+
+  const int emitter_index = kernel_tex_fetch(__light_tree_emitter_lookup, offset + prim);
+  if (emitter_index == -1) {
+    return 0.0f;
+  }
+
+  const float area = kernel_tex_fetch(__light_tree_emitters, emitter_index).area;
+  return (area > 0.0f) ? light_tree_pdf(kg, P, emitter_index) / area : 0.0f;
+}
+
+#endif /* __LIGHT_TREE__ */
+
+CCL_NAMESPACE_END
@@ -22,6 +22,7 @@
 #include "util/util_math_fast.h"
 #include "util/util_math_intersect.h"
 #include "util/util_projection.h"
+#include "util/util_quantize.h"
 #include "util/util_texture.h"
 #include "util/util_transform.h"
 
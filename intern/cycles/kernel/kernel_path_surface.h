@@ -34,6 +34,13 @@ ccl_device_noinline_cpu void kernel_branched_path_surface_connect_light(
   /* sample illumination from lights to find path contribution */
   BsdfEval L_light ccl_optional_struct_init;
 
+#    ifdef __LIGHT_TREE__
+  /* The light tree already selects lights by their contribution. */
+  if (kernel_data.integrator.use_light_tree) {
+    sample_all_lights = false;
+  }
+#    endif
+
   int num_lights = 0;
   if (kernel_data.integrator.use_direct_light) {
     if (sample_all_lights) {
@@ -141,6 +141,13 @@ ccl_device void kernel_branched_path_volume_connect_light(KernelGlobals *kg,
 #    ifdef __EMISSION__
   BsdfEval L_light ccl_optional_struct_init;
 
+#      ifdef __LIGHT_TREE__
+  /* The light tree already selects lights by their contribution. */
+  if (kernel_data.integrator.use_light_tree) {
+    sample_all_lights = false;
+  }
+#      endif
+
   int num_lights = 1;
   if (sample_all_lights) {
     num_lights = kernel_data.integrator.num_all_lights;
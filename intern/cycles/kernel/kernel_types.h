@@ -133,6 +133,7 @@ CCL_NAMESPACE_BEGIN
 #  endif
 #  define __VOLUME_DECOUPLED__
 #  define __VOLUME_RECORD_ALL__
+#  define __LIGHT_TREE__
 #endif /* __KERNEL_CPU__ */
 
 #ifdef __KERNEL_CUDA__
@@ -767,6 +768,8 @@ typedef enum AttributeStandard {
 typedef enum AttributeFlag {
   ATTR_FINAL_SIZE = (1 << 0),
   ATTR_SUBDIVIDED = (1 << 1),
+  /* Stored quantized, float2 as 16 bit normalized and float3 as half floats. */
+  ATTR_PACKED = (1 << 2),
 } AttributeFlag;
 
 typedef struct AttributeDescriptor {
@@ -1359,7 +1362,13 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
-  int pad1;
+  /* light tree */
+  int use_light_tree;
+  int light_tree_num_emitters;
+  /* Distant and background lights are stored after the emitters in the tree. */
+  int light_tree_infinite_offset;
+  float light_tree_infinite_energy;
+  int light_tree_background_lamp;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1385,6 +1394,9 @@ typedef struct KernelBVH {
   int have_instancing;
   int bvh_layout;
   int use_bvh_steps;
+  /* Vertex normals are octahedral encoded in tri_vnormal_oct. */
+  int use_compressed_normals;
+  int pad1, pad3, pad4;
 
   /* Custom BVH */
 #ifdef __KERNEL_OPTIX__
@@ -1528,6 +1540,48 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Light Tree
+ *
+ * Bounding volume hierarchy over emitters, with a bounding cone for the emission directions
+ * in each node. Nodes are stored depth first, the left child directly follows its parent. */
+
+#define LIGHT_TREE_LEAF_SIZE 8
+#define LIGHT_TREE_NO_LOOKUP 0x7fffffff
+
+typedef struct KernelLightTreeNode {
+  float bounding_box_min[3];
+  float energy;
+  float bounding_box_max[3];
+  float theta_o;
+  float axis[3];
+  float theta_e;
+
+  /* Inner node: index of the right child. Leaf: index of the first emitter. */
+  int child_index;
+  /* Zero for inner nodes. */
+  int num_emitters;
+  int parent_index;
+  int pad;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
+typedef struct KernelLightTreeEmitter {
+  float bounding_box_min[3];
+  float energy;
+  float bounding_box_max[3];
+  float theta_o;
+  float axis[3];
+  float theta_e;
+
+  int distribution_index;
+  /* Leaf node containing the emitter, -1 for distant and background lights. */
+  int parent_index;
+  /* Triangle area, to convert the selection probability to a density over the area. */
+  float area;
+  int pad;
+} KernelLightTreeEmitter;
+static_assert_align(KernelLightTreeEmitter, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
@@ -17,6 +17,9 @@
 #ifndef __KERNEL_CPU_IMAGE_H__
 #define __KERNEL_CPU_IMAGE_H__
 
+#include "util/util_sparse_grid.h"
+#include "util/util_texture_cache.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Make template functions private so symbols don't conflict between kernels with different
@@ -470,6 +473,136 @@ template<typename T> struct TextureInterpolator {
 #undef SET_CUBIC_SPLINE_WEIGHTS
 };
 
+/* Interpolation of sparse grids, #TextureInfo.data points to a #SparseGrid. Voxels in tiles that
+ * are not stored read as zero. */
+struct SparseGridInterpolator {
+  typedef TextureInterpolator<float> Dense;
+
+  static ccl_always_inline int wrap(int x, int width, uint extension)
+  {
+    return (extension == EXTENSION_REPEAT) ? Dense::wrap_periodic(x, width) :
+                                             Dense::wrap_clamp(x, width);
+  }
+
+  static ccl_always_inline float4 interp_3d_closest(const SparseGrid *grid,
+                                                    uint extension,
+                                                    float x,
+                                                    float y,
+                                                    float z)
+  {
+    const int3 res = grid->resolution;
+    int ix, iy, iz;
+
+    Dense::frac(x * (float)res.x, &ix);
+    Dense::frac(y * (float)res.y, &iy);
+    Dense::frac(z * (float)res.z, &iz);
+
+    return grid->read(
+        wrap(ix, res.x, extension), wrap(iy, res.y, extension), wrap(iz, res.z, extension));
+  }
+
+  static ccl_always_inline float4 interp_3d_linear(const SparseGrid *grid,
+                                                   uint extension,
+                                                   float x,
+                                                   float y,
+                                                   float z)
+  {
+    const int3 res = grid->resolution;
+    int ix, iy, iz;
+
+    const float tx = Dense::frac(x * (float)res.x - 0.5f, &ix);
+    const float ty = Dense::frac(y * (float)res.y - 0.5f, &iy);
+    const float tz = Dense::frac(z * (float)res.z - 0.5f, &iz);
+
+    const int xc[2] = {wrap(ix, res.x, extension), wrap(ix + 1, res.x, extension)};
+    const int yc[2] = {wrap(iy, res.y, extension), wrap(iy + 1, res.y, extension)};
+    const int zc[2] = {wrap(iz, res.z, extension), wrap(iz + 1, res.z, extension)};
+    const float u[2] = {1.0f - tx, tx};
+    const float v[2] = {1.0f - ty, ty};
+    const float w[2] = {1.0f - tz, tz};
+
+    float4 r = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    for (int k = 0; k < 2; k++) {
+      for (int j = 0; j < 2; j++) {
+        for (int i = 0; i < 2; i++) {
+          r += (w[k] * v[j] * u[i]) * grid->read(xc[i], yc[j], zc[k]);
+        }
+      }
+    }
+    return r;
+  }
+
+  static ccl_always_inline void cubic_spline_weights(float u[4], float t)
+  {
+    u[0] = (((-1.0f / 6.0f) * t + 0.5f) * t - 0.5f) * t + (1.0f / 6.0f);
+    u[1] = ((0.5f * t - 1.0f) * t) * t + (2.0f / 3.0f);
+    u[2] = ((-0.5f * t + 0.5f) * t + 0.5f) * t + (1.0f / 6.0f);
+    u[3] = (1.0f / 6.0f) * t * t * t;
+  }
+
+  static ccl_always_inline float4 interp_3d_tricubic(const SparseGrid *grid,
+                                                     uint extension,
+                                                     float x,
+                                                     float y,
+                                                     float z)
+  {
+    const int3 res = grid->resolution;
+    int ix, iy, iz;
+
+    const float tx = Dense::frac(x * (float)res.x - 0.5f, &ix);
+    const float ty = Dense::frac(y * (float)res.y - 0.5f, &iy);
+    const float tz = Dense::frac(z * (float)res.z - 0.5f, &iz);
+
+    int xc[4], yc[4], zc[4];
+    for (int i = 0; i < 4; i++) {
+      xc[i] = wrap(ix + i - 1, res.x, extension);
+      yc[i] = wrap(iy + i - 1, res.y, extension);
+      zc[i] = wrap(iz + i - 1, res.z, extension);
+    }
+
+    float u[4], v[4], w[4];
+    cubic_spline_weights(u, tx);
+    cubic_spline_weights(v, ty);
+    cubic_spline_weights(w, tz);
+
+    float4 r = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    for (int k = 0; k < 4; k++) {
+      for (int j = 0; j < 4; j++) {
+        float4 row = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+        for (int i = 0; i < 4; i++) {
+          row += u[i] * grid->read(xc[i], yc[j], zc[k]);
+        }
+        r += (w[k] * v[j]) * row;
+      }
+    }
+    return r;
+  }
+
+  static ccl_always_inline float4
+  interp_3d(const TextureInfo &info, float x, float y, float z, InterpolationType interp)
+  {
+    const SparseGrid *grid = (const SparseGrid *)info.data;
+    if (UNLIKELY(!grid)) {
+      return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    if (info.extension == EXTENSION_CLIP) {
+      if (x < 0.0f || y < 0.0f || z < 0.0f || x > 1.0f || y > 1.0f || z > 1.0f) {
+        return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+      }
+    }
+
+    switch ((interp == INTERPOLATION_NONE) ? info.interpolation : interp) {
+      case INTERPOLATION_CLOSEST:
+        return interp_3d_closest(grid, info.extension, x, y, z);
+      case INTERPOLATION_LINEAR:
+        return interp_3d_linear(grid, info.extension, x, y, z);
+      default:
+        return interp_3d_tricubic(grid, info.extension, x, y, z);
+    }
+  }
+};
+
 ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, float y)
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
@@ -491,6 +624,8 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
       return TextureInterpolator<ushort4>::interp(info, x, y);
     case IMAGE_DATA_TYPE_FLOAT4:
       return TextureInterpolator<float4>::interp(info, x, y);
+    case IMAGE_DATA_TYPE_TEXTURE_CACHE:
+      return texture_cache_lookup(info, x, y, 0.0f, 0.0f, 0.0f, 0.0f);
     default:
       assert(0);
       return make_float4(
@@ -498,6 +633,20 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+ccl_device bool kernel_tex_image_is_cached(KernelGlobals *kg, int id)
+{
+  const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
+  return info.data_type == IMAGE_DATA_TYPE_TEXTURE_CACHE;
+}
+
+/* Texture cache lookup, with texture coordinate differentials for mip-map selection. */
+ccl_device float4
+kernel_tex_image_interp_cached(KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+  const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
+  return texture_cache_lookup(info, x, y, dx.x, dx.y, dy.x, dy.y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
                                              int id,
                                              float3 P,
@@ -526,6 +675,8 @@ ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
       return TextureInterpolator<ushort4>::interp_3d(info, P.x, P.y, P.z, interp);
     case IMAGE_DATA_TYPE_FLOAT4:
       return TextureInterpolator<float4>::interp_3d(info, P.x, P.y, P.z, interp);
+    case IMAGE_DATA_TYPE_SPARSE_GRID:
+      return SparseGridInterpolator::interp_3d(info, P.x, P.y, P.z, interp);
     default:
       assert(0);
       return make_float4(
@@ -16,14 +16,8 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+ccl_device_inline float4 svm_image_texture_flags_apply(float4 r, uint flags)
 {
-  if (id == -1) {
-    return make_float4(
-        TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
-  }
-
-  float4 r = kernel_tex_image_interp(kg, id, x, y);
   const float alpha = r.w;
 
   if ((flags & NODE_IMAGE_ALPHA_UNASSOCIATE) && alpha != 1.0f && alpha != 0.0f) {
@@ -38,6 +32,44 @@ ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y,
   return r;
 }
 
+ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+{
+  if (id == -1) {
+    return make_float4(
+        TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+  }
+
+  float4 r = kernel_tex_image_interp(kg, id, x, y);
+  return svm_image_texture_flags_apply(r, flags);
+}
+
+#ifdef __KERNEL_CPU__
+/* Same as svm_image_texture, with mip-map selection for images in the texture cache.
+ *
+ * SVM does not propagate differentials through the node graph, so the differentials of the
+ * default UV map are used to estimate the footprint of the lookup. Those only match when the
+ * image is looked up with that UV map, other lookups use the full resolution. */
+ccl_device float4 svm_image_texture_filtered(
+    KernelGlobals *kg, ShaderData *sd, int id, float x, float y, uint flags)
+{
+  if (id == -1 || !kernel_tex_image_is_cached(kg, id)) {
+    return svm_image_texture(kg, id, x, y, flags);
+  }
+
+  float2 dx = make_float2(0.0f, 0.0f);
+  float2 dy = make_float2(0.0f, 0.0f);
+  if (flags & NODE_IMAGE_DEFAULT_UV) {
+    const AttributeDescriptor desc = find_attribute(kg, sd, ATTR_STD_UV);
+    if (desc.offset != ATTR_STD_NOT_FOUND) {
+      primitive_surface_attribute_float2(kg, sd, desc, &dx, &dy);
+    }
+  }
+
+  float4 r = kernel_tex_image_interp_cached(kg, id, x, y, dx, dy);
+  return svm_image_texture_flags_apply(r, flags);
+}
+#endif
+
 /* Remap coordnate from 0..1 box to -1..-1 */
 ccl_device_inline float3 texco_remap_square(float3 co)
 {
@@ -108,7 +140,11 @@ ccl_device void svm_node_tex_image(
     id = -num_nodes;
   }
 
+#ifdef __KERNEL_CPU__
+  float4 f = svm_image_texture_filtered(kg, sd, id, tex_co.x, tex_co.y, flags);
+#else
   float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, flags);
+#endif
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
@@ -475,6 +475,8 @@ typedef enum NodeImageProjection {
 typedef enum NodeImageFlags {
   NODE_IMAGE_COMPRESS_AS_SRGB = 1,
   NODE_IMAGE_ALPHA_UNASSOCIATE = 2,
+  /* Texture coordinates are the default UV map, see #svm_image_texture_filtered. */
+  NODE_IMAGE_DEFAULT_UV = 4,
 } NodeImageFlags;
 
 typedef enum NodeEnvironmentProjection {
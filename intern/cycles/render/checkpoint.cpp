@@ -0,0 +1,567 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/checkpoint.h"
+#include "render/attribute.h"
+#include "render/background.h"
+#include "render/camera.h"
+#include "render/film.h"
+#include "render/geometry.h"
+#include "render/graph.h"
+#include "render/integrator.h"
+#include "render/light.h"
+#include "render/mesh.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "render/shader.h"
+#include "render/tile.h"
+
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_map.h"
+#include "util/util_md5.h"
+#include "util/util_path.h"
+#include "util/util_time.h"
+#include "util/util_unique_ptr.h"
+
+#include <OpenImageIO/filesystem.h>
+#include <OpenImageIO/imageio.h>
+
+OIIO_NAMESPACE_USING
+
+CCL_NAMESPACE_BEGIN
+
+/* Scene Key
+ *
+ * Node::hash() includes pointers, which differ between runs. Here strings are hashed by their
+ * contents and node references by their index in the scene. */
+
+typedef map<const Node *, int> NodeIndexMap;
+
+static void hash_int(MD5Hash &md5, int value)
+{
+  md5.append((const uint8_t *)&value, sizeof(value));
+}
+
+static void hash_string(MD5Hash &md5, ustring value)
+{
+  md5.append(value.string());
+  /* Separate consecutive strings. */
+  hash_int(md5, value.size());
+}
+
+static void hash_node_reference(MD5Hash &md5, const Node *node, const NodeIndexMap &node_index)
+{
+  NodeIndexMap::const_iterator it = node_index.find(node);
+  hash_int(md5, (it != node_index.end()) ? it->second : -1);
+}
+
+template<typename T> static void hash_array(MD5Hash &md5, const array<T> &a)
+{
+  hash_int(md5, a.size());
+  if (a.size()) {
+    md5.append((const uint8_t *)a.data(), a.size() * sizeof(T));
+  }
+}
+
+static void hash_float3_array(MD5Hash &md5, const array<float3> &a)
+{
+  /* Skip the 4th element used for padding, which is not always initialized. */
+  hash_int(md5, a.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    md5.append((const uint8_t *)&a[i], sizeof(float) * 3);
+  }
+}
+
+static void hash_node(MD5Hash &md5, const Node *node, const NodeIndexMap &node_index)
+{
+  hash_string(md5, node->type->name);
+
+  foreach (const SocketType &socket, node->type->inputs) {
+    hash_string(md5, socket.name);
+
+    switch (socket.type) {
+      case SocketType::COLOR:
+      case SocketType::VECTOR:
+      case SocketType::POINT:
+      case SocketType::NORMAL: {
+        const float3 value = node->get_float3(socket);
+        md5.append((const uint8_t *)&value, sizeof(float) * 3);
+        break;
+      }
+      case SocketType::STRING:
+        hash_string(md5, node->get_string(socket));
+        break;
+      case SocketType::NODE:
+        hash_node_reference(md5, node->get_node(socket), node_index);
+        break;
+      case SocketType::BOOLEAN_ARRAY:
+        hash_array(md5, node->get_bool_array(socket));
+        break;
+      case SocketType::FLOAT_ARRAY:
+        hash_array(md5, node->get_float_array(socket));
+        break;
+      case SocketType::INT_ARRAY:
+        hash_array(md5, node->get_int_array(socket));
+        break;
+      case SocketType::COLOR_ARRAY:
+      case SocketType::VECTOR_ARRAY:
+      case SocketType::POINT_ARRAY:
+      case SocketType::NORMAL_ARRAY:
+        hash_float3_array(md5, node->get_float3_array(socket));
+        break;
+      case SocketType::POINT2_ARRAY:
+        hash_array(md5, node->get_float2_array(socket));
+        break;
+      case SocketType::STRING_ARRAY: {
+        const array<ustring> &a = node->get_string_array(socket);
+        hash_int(md5, a.size());
+        for (size_t i = 0; i < a.size(); i++) {
+          hash_string(md5, a[i]);
+        }
+        break;
+      }
+      case SocketType::TRANSFORM_ARRAY:
+        hash_array(md5, node->get_transform_array(socket));
+        break;
+      case SocketType::NODE_ARRAY: {
+        const array<Node *> &a = node->get_node_array(socket);
+        hash_int(md5, a.size());
+        for (size_t i = 0; i < a.size(); i++) {
+          hash_node_reference(md5, a[i], node_index);
+        }
+        break;
+      }
+      case SocketType::CLOSURE:
+      case SocketType::UNDEFINED:
+        break;
+      default:
+        md5.append(((const uint8_t *)node) + socket.struct_offset, socket.size());
+        break;
+    }
+  }
+}
+
+static void hash_attributes(MD5Hash &md5, const AttributeSet &attributes)
+{
+  foreach (const Attribute &attr, attributes.attributes) {
+    hash_string(md5, attr.name);
+    hash_int(md5, attr.std);
+    hash_int(md5, attr.element);
+
+    const size_t size = attr.buffer.size();
+    const size_t data_size = attr.data_sizeof();
+    hash_int(md5, size);
+
+    if (data_size == sizeof(float3)) {
+      for (size_t offset = 0; offset + data_size <= size; offset += data_size) {
+        md5.append((const uint8_t *)&attr.buffer[offset], sizeof(float) * 3);
+      }
+    }
+    else if (size) {
+      md5.append((const uint8_t *)&attr.buffer[0], size);
+    }
+  }
+}
+
+static void hash_shader_graph(MD5Hash &md5, ShaderGraph *graph)
+{
+  foreach (ShaderNode *node, graph->nodes) {
+    hash_node(md5, node, NodeIndexMap());
+
+    foreach (ShaderInput *input, node->inputs) {
+      hash_int(md5, input->link ? input->link->parent->id : -1);
+      if (input->link) {
+        hash_string(md5, input->link->socket_type.name);
+      }
+    }
+  }
+}
+
+string RenderCheckpoint::compute_key(Scene *scene,
+                                     BufferParams &params,
+                                     int2 tile_size,
+                                     int range_start_sample)
+{
+  MD5Hash md5;
+
+  /* Render settings. */
+  hash_int(md5, params.width);
+  hash_int(md5, params.height);
+  hash_int(md5, params.full_x);
+  hash_int(md5, params.full_y);
+  hash_int(md5, params.full_width);
+  hash_int(md5, params.full_height);
+  hash_int(md5, params.get_passes_size());
+  foreach (const Pass &pass, params.passes) {
+    hash_int(md5, pass.type);
+    hash_int(md5, pass.components);
+    md5.append(pass.name);
+  }
+  hash_int(md5, tile_size.x);
+  hash_int(md5, tile_size.y);
+  hash_int(md5, range_start_sample);
+
+  /* Index nodes, for references between them. */
+  NodeIndexMap node_index;
+  foreach (Shader *shader, scene->shaders) {
+    node_index.insert(std::make_pair(shader, (int)node_index.size()));
+  }
+  foreach (Geometry *geom, scene->geometry) {
+    node_index.insert(std::make_pair(geom, (int)node_index.size()));
+  }
+
+  /* Scene contents, including the integrator seed. */
+  hash_node(md5, scene->camera, node_index);
+  hash_node(md5, scene->film, node_index);
+  hash_node(md5, scene->integrator, node_index);
+  hash_node(md5, scene->background, node_index);
+
+  foreach (Shader *shader, scene->shaders) {
+    hash_node(md5, shader, node_index);
+    if (shader->graph) {
+      hash_shader_graph(md5, shader->graph);
+    }
+  }
+  foreach (Geometry *geom, scene->geometry) {
+    hash_node(md5, geom, node_index);
+    hash_attributes(md5, geom->attributes);
+    if (geom->type == Geometry::MESH) {
+      hash_attributes(md5, ((Mesh *)geom)->subd_attributes);
+    }
+  }
+  foreach (Object *object, scene->objects) {
+    hash_node(md5, object, node_index);
+  }
+  foreach (Light *light, scene->lights) {
+    hash_node(md5, light, node_index);
+  }
+
+  return md5.get_hex();
+}
+
+/* Render Checkpoint */
+
+RenderCheckpoint::RenderCheckpoint(const string &filepath, double interval)
+    : filepath(filepath),
+      interval(interval),
+      width(0),
+      height(0),
+      pass_stride(0),
+      write_thread(NULL),
+      do_exit(false)
+{
+}
+
+RenderCheckpoint::~RenderCheckpoint()
+{
+  if (write_thread) {
+    end(false);
+  }
+}
+
+bool RenderCheckpoint::begin(const string &key_, BufferParams &params, const vector<Tile> &tiles)
+{
+  key = key_;
+  width = params.width;
+  height = params.height;
+  pass_stride = params.get_passes_size();
+
+  /* Channel names in multilayer format, so the file can be inspected in other applications. */
+  channel_names.clear();
+  foreach (const Pass &pass, params.passes) {
+    const string pass_name = pass.name.empty() ? string_printf("Pass%d", (int)pass.type) :
+                                                 pass.name;
+    for (int i = 0; i < pass.components; i++) {
+      channel_names.push_back(string_printf("Checkpoint.%s.%c", pass_name.c_str(), "RGBA"[i]));
+    }
+  }
+  while ((int)channel_names.size() < pass_stride) {
+    channel_names.push_back(string_printf("Checkpoint.Data.%d", (int)channel_names.size()));
+  }
+
+  tile_rects.resize(tiles.size());
+  for (size_t i = 0; i < tiles.size(); i++) {
+    TileRect &rect = tile_rects[i];
+    rect.x = tiles[i].x;
+    rect.y = tiles[i].y;
+    rect.w = tiles[i].w;
+    rect.h = tiles[i].h;
+  }
+
+  pixels.resize((size_t)width * height * pass_stride);
+  memset(pixels.data(), 0, pixels.size() * sizeof(float));
+  samples.clear();
+  samples.resize(tiles.size(), 0);
+
+  const bool loaded = load(key);
+  loaded_samples = samples;
+
+  do_exit = false;
+  write_thread = new thread(function_bind(&RenderCheckpoint::write_thread_run, this));
+
+  return loaded;
+}
+
+void RenderCheckpoint::end(bool completed)
+{
+  if (write_thread == NULL) {
+    return;
+  }
+
+  {
+    thread_scoped_lock lock(mutex);
+    do_exit = true;
+  }
+  cond.notify_all();
+  write_thread->join();
+  delete write_thread;
+  write_thread = NULL;
+
+  if (completed) {
+    pending.clear();
+    if (path_exists(filepath)) {
+      path_remove(filepath);
+      VLOG(1) << "Render completed, removed checkpoint " << filepath << ".";
+    }
+  }
+  else {
+    merge_pending();
+    save();
+  }
+
+  pixels.clear();
+}
+
+int RenderCheckpoint::tile_samples(int tile_index) const
+{
+  return (tile_index < (int)loaded_samples.size()) ? loaded_samples[tile_index] : 0;
+}
+
+void RenderCheckpoint::read_tile(int tile_index, RenderBuffers *buffers)
+{
+  const TileRect &rect = tile_rects[tile_index];
+  float *buffer = buffers->buffer.data();
+  const size_t row_size = (size_t)rect.w * pass_stride;
+
+  for (int y = 0; y < rect.h; y++) {
+    const float *row = pixels.data() + ((size_t)(rect.y + y) * width + rect.x) * pass_stride;
+    memcpy(buffer + y * row_size, row, row_size * sizeof(float));
+  }
+
+  buffers->buffer.copy_to_device();
+}
+
+void RenderCheckpoint::write_tile(int tile_index, RenderBuffers *buffers, int num_samples)
+{
+  if (!buffers->copy_from_device()) {
+    return;
+  }
+
+  /* Copy outside of the lock, the buffers may be freed as soon as this returns. */
+  const size_t size = (size_t)tile_rects[tile_index].w * tile_rects[tile_index].h * pass_stride;
+  array<float> tile_pixels(size);
+  memcpy(tile_pixels.data(), buffers->buffer.data(), size * sizeof(float));
+
+  thread_scoped_lock lock(mutex);
+  pending.push_back(PendingTile());
+  PendingTile &tile = pending.back();
+  tile.index = tile_index;
+  tile.samples = num_samples;
+  tile.pixels.steal_data(tile_pixels);
+}
+
+void RenderCheckpoint::merge_pending()
+{
+  list<PendingTile> tiles;
+  {
+    thread_scoped_lock lock(mutex);
+    tiles.swap(pending);
+  }
+
+  foreach (PendingTile &tile, tiles) {
+    const TileRect &rect = tile_rects[tile.index];
+    const size_t row_size = (size_t)rect.w * pass_stride;
+
+    for (int y = 0; y < rect.h; y++) {
+      float *row = pixels.data() + ((size_t)(rect.y + y) * width + rect.x) * pass_stride;
+      memcpy(row, tile.pixels.data() + y * row_size, row_size * sizeof(float));
+    }
+
+    samples[tile.index] = tile.samples;
+  }
+}
+
+void RenderCheckpoint::write_thread_run()
+{
+  thread_scoped_lock lock(mutex);
+
+  while (!do_exit) {
+    const double start_time = time_dt();
+    while (!do_exit && time_dt() - start_time < interval) {
+      cond.wait_for(lock, std::chrono::milliseconds(500));
+    }
+
+    if (do_exit || pending.empty()) {
+      continue;
+    }
+
+    lock.unlock();
+    merge_pending();
+    save();
+    lock.lock();
+  }
+}
+
+bool RenderCheckpoint::load(const string &expected_key)
+{
+  if (!path_exists(filepath)) {
+    return false;
+  }
+
+  unique_ptr<ImageInput> in(ImageInput::open(filepath));
+  if (!in) {
+    VLOG(1) << "Failed to open checkpoint " << filepath << ", starting from scratch.";
+    return false;
+  }
+
+  const ImageSpec &spec = in->spec();
+  if (spec.get_string_attribute("cycles.checkpoint.key") != expected_key) {
+    VLOG(1) << "Checkpoint " << filepath << " is for a different scene, starting from scratch.";
+    return false;
+  }
+  if (spec.width != width || spec.height != height || spec.nchannels != pass_stride) {
+    VLOG(1) << "Checkpoint " << filepath << " has a different resolution or passes.";
+    return false;
+  }
+
+  /* Tile rectangles and samples, one tile per line. */
+  vector<int> file_samples(tile_rects.size(), 0);
+  vector<string> lines;
+  string_split(lines, spec.get_string_attribute("cycles.checkpoint.tiles"), "\n");
+  if (lines.size() != tile_rects.size()) {
+    VLOG(1) << "Checkpoint " << filepath << " has a different tile layout.";
+    return false;
+  }
+  for (size_t i = 0; i < lines.size(); i++) {
+    const TileRect &rect = tile_rects[i];
+    TileRect file_rect;
+    if (sscanf(lines[i].c_str(),
+               "%d %d %d %d %d",
+               &file_rect.x,
+               &file_rect.y,
+               &file_rect.w,
+               &file_rect.h,
+               &file_samples[i]) != 5 ||
+        file_rect.x != rect.x || file_rect.y != rect.y || file_rect.w != rect.w ||
+        file_rect.h != rect.h) {
+      VLOG(1) << "Checkpoint " << filepath << " has a different tile layout.";
+      return false;
+    }
+  }
+
+  /* File formats may reorder channels (EXR sorts them by name), so map them by name. */
+  map<string, int> buffer_channel;
+  for (int i = 0; i < pass_stride; i++) {
+    buffer_channel[channel_names[i]] = i;
+  }
+
+  vector<int> file_to_buffer_channel(spec.nchannels);
+  for (int i = 0; i < spec.nchannels; i++) {
+    map<string, int>::iterator it = buffer_channel.find(spec.channelnames[i]);
+    if (it == buffer_channel.end()) {
+      VLOG(1) << "Checkpoint " << filepath << " has different passes.";
+      return false;
+    }
+    file_to_buffer_channel[i] = it->second;
+    /* Each channel must appear once, so all channels of the buffer are read. */
+    buffer_channel.erase(it);
+  }
+
+  array<float> file_pixels(pixels.size());
+  if (!in->read_image(TypeDesc::FLOAT, file_pixels.data())) {
+    VLOG(1) << "Failed to read checkpoint " << filepath << ": " << in->geterror();
+    return false;
+  }
+
+  const size_t num_pixels = (size_t)width * height;
+  for (size_t i = 0; i < num_pixels; i++) {
+    const float *file_pixel = file_pixels.data() + i * pass_stride;
+    float *pixel = pixels.data() + i * pass_stride;
+    for (int c = 0; c < pass_stride; c++) {
+      pixel[file_to_buffer_channel[c]] = file_pixel[c];
+    }
+  }
+
+  samples = file_samples;
+
+  int num_tiles = 0;
+  foreach (int num_samples, samples) {
+    num_tiles += (num_samples > 0);
+  }
+  VLOG(1) << "Resuming from checkpoint " << filepath << " with " << num_tiles << " of "
+          << samples.size() << " tiles rendered.";
+
+  return true;
+}
+
+bool RenderCheckpoint::save()
+{
+  const double start_time = time_dt();
+
+  ImageSpec spec(width, height, pass_stride, TypeDesc::FLOAT);
+  spec.channelnames = channel_names;
+  spec.attribute("cycles.checkpoint.key", key);
+
+  string tiles;
+  for (size_t i = 0; i < tile_rects.size(); i++) {
+    const TileRect &rect = tile_rects[i];
+    tiles += string_printf("%d %d %d %d %d\n", rect.x, rect.y, rect.w, rect.h, samples[i]);
+  }
+  spec.attribute("cycles.checkpoint.tiles", tiles);
+
+  /* Write to a temporary file first, so an interruption while saving does not destroy the
+   * previous checkpoint. */
+  const string tmp_filepath = filepath + ".tmp" + OIIO::Filesystem::extension(filepath);
+  path_create_directories(tmp_filepath);
+  unique_ptr<ImageOutput> out(ImageOutput::create(tmp_filepath));
+  if (!out) {
+    LOG(ERROR) << "Failed to create checkpoint " << tmp_filepath << ".";
+    return false;
+  }
+
+  bool ok = out->open(tmp_filepath, spec) && out->write_image(TypeDesc::FLOAT, pixels.data());
+  if (!ok) {
+    LOG(ERROR) << "Failed to write checkpoint " << tmp_filepath << ": " << out->geterror();
+  }
+  ok = out->close() && ok;
+  out.reset();
+
+  string rename_error;
+  if (ok && !OIIO::Filesystem::rename(tmp_filepath, filepath, rename_error)) {
+    LOG(ERROR) << "Failed to move checkpoint to " << filepath << ": " << rename_error;
+    ok = false;
+  }
+  if (!ok) {
+    path_remove(tmp_filepath);
+    return false;
+  }
+
+  VLOG(1) << "Saved checkpoint " << filepath << " in " << time_dt() - start_time << " seconds.";
+  return true;
+}
+
+CCL_NAMESPACE_END
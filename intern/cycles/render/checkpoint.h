@@ -0,0 +1,113 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include "render/buffers.h"
+
+#include "util/util_array.h"
+#include "util/util_list.h"
+#include "util/util_string.h"
+#include "util/util_thread.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class RenderBuffers;
+class Scene;
+class Tile;
+
+/* Render Checkpoint
+ *
+ * Periodically saves the render buffers of rendered tiles along with their number of samples
+ * to a multilayer OpenEXR file, so an interrupted render can continue where it stopped instead
+ * of starting over. The file is only used when it was written for a render with the same key,
+ * which covers the scene contents, random seed and render settings.
+ *
+ * Tiles are handed over from the render threads, the file is written from a separate thread to
+ * avoid stalling rendering while it is being saved. */
+
+class RenderCheckpoint {
+ public:
+  RenderCheckpoint(const string &filepath, double interval);
+  ~RenderCheckpoint();
+
+  /* Key identifying the scene and settings the render buffers were accumulated with. */
+  static string compute_key(Scene *scene,
+                            BufferParams &params,
+                            int2 tile_size,
+                            int range_start_sample);
+
+  /* Load the checkpoint file if it matches the key and tile layout, and start writing. Returns
+   * whether tiles were restored from the file. */
+  bool begin(const string &key, BufferParams &params, const vector<Tile> &tiles);
+
+  /* Stop writing. Completed renders remove the file, otherwise the latest state is saved. */
+  void end(bool completed);
+
+  /* Number of samples accumulated for the tile in the checkpoint, zero when not available. */
+  int tile_samples(int tile_index) const;
+
+  /* Copy the accumulated passes of the tile into its render buffers. */
+  void read_tile(int tile_index, RenderBuffers *buffers);
+
+  /* Store the render buffers of the tile, rendered with the given number of samples. */
+  void write_tile(int tile_index, RenderBuffers *buffers, int num_samples);
+
+ protected:
+  struct TileRect {
+    int x, y, w, h;
+  };
+
+  struct PendingTile {
+    int index;
+    int samples;
+    array<float> pixels;
+  };
+
+  bool load(const string &key);
+  bool save();
+  void merge_pending();
+  void write_thread_run();
+
+  string filepath;
+  double interval;
+
+  string key;
+  int width, height;
+  int pass_stride;
+  vector<string> channel_names;
+
+  /* Full image of accumulated passes. Once started only the write thread modifies it, render
+   * threads read the loaded regions of tiles before those are rendered again. */
+  array<float> pixels;
+  vector<TileRect> tile_rects;
+  vector<int> samples;
+
+  /* Tile samples as loaded from the file, read by the render threads. */
+  vector<int> loaded_samples;
+
+  thread *write_thread;
+  thread_mutex mutex;
+  thread_condition_variable cond;
+  list<PendingTile> pending;
+  bool do_exit;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __CHECKPOINT_H__ */
@@ -41,6 +41,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_quantize.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -265,6 +266,8 @@ GeometryManager::GeometryManager()
 {
   need_update = true;
   need_flags_update = true;
+  normals_bytes_saved = 0;
+  attributes_bytes_saved = 0;
 }
 
 GeometryManager::~GeometryManager()
@@ -474,13 +477,61 @@ void GeometryManager::update_svm_attributes(Device *,
   dscene->attributes_map.copy_to_device();
 }
 
+/* Quantized storage is only used for triangle attributes, which are decoded when interpolating
+ * them in the kernel, and only when the values fit the quantized range. */
+static bool attribute_use_packed_storage(Geometry *geom,
+                                         Attribute *mattr,
+                                         AttributePrimitive prim,
+                                         bool use_compressed_geometry)
+{
+  if (!use_compressed_geometry || geom->type != Geometry::MESH || prim != ATTR_PRIM_GEOMETRY) {
+    return false;
+  }
+  if (mattr->flags & ATTR_SUBDIVIDED) {
+    return false;
+  }
+  if (!(mattr->element == ATTR_ELEMENT_VERTEX || mattr->element == ATTR_ELEMENT_FACE ||
+        mattr->element == ATTR_ELEMENT_CORNER)) {
+    return false;
+  }
+
+  size_t size = mattr->element_size(geom, prim);
+
+  if (mattr->type == TypeFloat2) {
+    /* 16 bit normalized, for texture coordinates inside the unit square. */
+    const float2 *data = mattr->data_float2();
+    for (size_t k = 0; k < size; k++) {
+      if (!(data[k].x >= 0.0f && data[k].x <= 1.0f && data[k].y >= 0.0f && data[k].y <= 1.0f)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  else if (mattr->type == TypeDesc::TypeFloat || mattr->type == TypeDesc::TypeMatrix) {
+    return false;
+  }
+
+  /* Half floats, for values inside the half float range. */
+  const float3 *data = mattr->data_float3();
+  for (size_t k = 0; k < size; k++) {
+    if (!(fabsf(data[k].x) <= 65504.0f && fabsf(data[k].y) <= 65504.0f &&
+          fabsf(data[k].z) <= 65504.0f)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 static void update_attribute_element_size(Geometry *geom,
                                           Attribute *mattr,
                                           AttributePrimitive prim,
+                                          bool use_compressed_geometry,
                                           size_t *attr_float_size,
                                           size_t *attr_float2_size,
                                           size_t *attr_float3_size,
-                                          size_t *attr_uchar4_size)
+                                          size_t *attr_uchar4_size,
+                                          size_t *attr_float2_packed_size,
+                                          size_t *attr_float3_packed_size)
 {
   if (mattr) {
     size_t size = mattr->element_size(geom, prim);
@@ -494,6 +545,14 @@ static void update_attribute_element_size(Geometry *geom,
     else if (mattr->type == TypeDesc::TypeFloat) {
       *attr_float_size += size;
     }
+    else if (attribute_use_packed_storage(geom, mattr, prim, use_compressed_geometry)) {
+      if (mattr->type == TypeFloat2) {
+        *attr_float2_packed_size += size;
+      }
+      else {
+        *attr_float3_packed_size += size;
+      }
+    }
     else if (mattr->type == TypeFloat2) {
       *attr_float2_size += size;
     }
@@ -515,8 +574,13 @@ static void update_attribute_element_offset(Geometry *geom,
                                             size_t &attr_float3_offset,
                                             device_vector<uchar4> &attr_uchar4,
                                             size_t &attr_uchar4_offset,
+                                            device_vector<uint> &attr_float2_packed,
+                                            size_t &attr_float2_packed_offset,
+                                            device_vector<uint2> &attr_float3_packed,
+                                            size_t &attr_float3_packed_offset,
                                             Attribute *mattr,
                                             AttributePrimitive prim,
+                                            bool use_compressed_geometry,
                                             TypeDesc &type,
                                             AttributeDescriptor &desc)
 {
@@ -557,6 +621,30 @@ static void update_attribute_element_offset(Geometry *geom,
       }
       attr_float_offset += size;
     }
+    else if (attribute_use_packed_storage(geom, mattr, prim, use_compressed_geometry)) {
+      desc.flags |= ATTR_PACKED;
+
+      if (mattr->type == TypeFloat2) {
+        float2 *data = mattr->data_float2();
+        offset = attr_float2_packed_offset;
+
+        assert(attr_float2_packed.size() >= offset + size);
+        for (size_t k = 0; k < size; k++) {
+          attr_float2_packed[offset + k] = unorm16x2_encode(data[k]);
+        }
+        attr_float2_packed_offset += size;
+      }
+      else {
+        float3 *data = mattr->data_float3();
+        offset = attr_float3_packed_offset;
+
+        assert(attr_float3_packed.size() >= offset + size);
+        for (size_t k = 0; k < size; k++) {
+          attr_float3_packed[offset + k] = half3_encode(data[k]);
+        }
+        attr_float3_packed_offset += size;
+      }
+    }
     else if (mattr->type == TypeFloat2) {
       float2 *data = mattr->data_float2();
       offset = attr_float2_offset;
@@ -664,6 +752,9 @@ void GeometryManager::device_update_attributes(Device *device,
   size_t attr_float2_size = 0;
   size_t attr_float3_size = 0;
   size_t attr_uchar4_size = 0;
+  size_t attr_float2_packed_size = 0;
+  size_t attr_float3_packed_size = 0;
+  const bool use_compressed_geometry = scene->params.use_compressed_geometry;
   for (size_t i = 0; i < scene->geometry.size(); i++) {
     Geometry *geom = scene->geometry[i];
     AttributeRequestSet &attributes = geom_attributes[i];
@@ -673,10 +764,13 @@ void GeometryManager::device_update_attributes(Device *device,
       update_attribute_element_size(geom,
                                     attr,
                                     ATTR_PRIM_GEOMETRY,
+                                    use_compressed_geometry,
                                     &attr_float_size,
                                     &attr_float2_size,
                                     &attr_float3_size,
-                                    &attr_uchar4_size);
+                                    &attr_uchar4_size,
+                                    &attr_float2_packed_size,
+                                    &attr_float3_packed_size);
 
       if (geom->type == Geometry::MESH) {
         Mesh *mesh = static_cast<Mesh *>(geom);
@@ -685,10 +779,13 @@ void GeometryManager::device_update_attributes(Device *device,
         update_attribute_element_size(mesh,
                                       subd_attr,
                                       ATTR_PRIM_SUBD,
+                                      use_compressed_geometry,
                                       &attr_float_size,
                                       &attr_float2_size,
                                       &attr_float3_size,
-                                      &attr_uchar4_size);
+                                      &attr_uchar4_size,
+                                      &attr_float2_packed_size,
+                                      &attr_float3_packed_size);
       }
     }
   }
@@ -697,11 +794,18 @@ void GeometryManager::device_update_attributes(Device *device,
   dscene->attributes_float2.alloc(attr_float2_size);
   dscene->attributes_float3.alloc(attr_float3_size);
   dscene->attributes_uchar4.alloc(attr_uchar4_size);
+  dscene->attributes_float2_packed.alloc(attr_float2_packed_size);
+  dscene->attributes_float3_packed.alloc(attr_float3_packed_size);
+
+  attributes_bytes_saved = attr_float2_packed_size * (sizeof(float2) - sizeof(uint)) +
+                           attr_float3_packed_size * (sizeof(float4) - sizeof(uint2));
 
   size_t attr_float_offset = 0;
   size_t attr_float2_offset = 0;
   size_t attr_float3_offset = 0;
   size_t attr_uchar4_offset = 0;
+  size_t attr_float2_packed_offset = 0;
+  size_t attr_float3_packed_offset = 0;
 
   /* Fill in attributes. */
   for (size_t i = 0; i < scene->geometry.size(); i++) {
@@ -721,8 +825,13 @@ void GeometryManager::device_update_attributes(Device *device,
                                       attr_float3_offset,
                                       dscene->attributes_uchar4,
                                       attr_uchar4_offset,
+                                      dscene->attributes_float2_packed,
+                                      attr_float2_packed_offset,
+                                      dscene->attributes_float3_packed,
+                                      attr_float3_packed_offset,
                                       attr,
                                       ATTR_PRIM_GEOMETRY,
+                                      use_compressed_geometry,
                                       req.type,
                                       req.desc);
 
@@ -739,8 +848,13 @@ void GeometryManager::device_update_attributes(Device *device,
                                         attr_float3_offset,
                                         dscene->attributes_uchar4,
                                         attr_uchar4_offset,
+                                        dscene->attributes_float2_packed,
+                                        attr_float2_packed_offset,
+                                        dscene->attributes_float3_packed,
+                                        attr_float3_packed_offset,
                                         subd_attr,
                                         ATTR_PRIM_SUBD,
+                                        use_compressed_geometry,
                                         req.subd_type,
                                         req.subd_desc);
       }
@@ -774,6 +888,12 @@ void GeometryManager::device_update_attributes(Device *device,
   if (dscene->attributes_uchar4.size()) {
     dscene->attributes_uchar4.copy_to_device();
   }
+  if (dscene->attributes_float2_packed.size()) {
+    dscene->attributes_float2_packed.copy_to_device();
+  }
+  if (dscene->attributes_float3_packed.size()) {
+    dscene->attributes_float3_packed.copy_to_device();
+  }
 
   if (progress.get_cancel())
     return;
@@ -911,8 +1031,17 @@ void GeometryManager::device_update_mesh(
     /* normals */
     progress.set_status("Updating Mesh", "Computing normals");
 
+    /* Octahedral encoded normals take a quarter of the memory. */
+    const bool use_compressed_normals = scene->params.use_compressed_geometry;
+    dscene->data.bvh.use_compressed_normals = use_compressed_normals;
+    normals_bytes_saved = (use_compressed_normals) ?
+                              vert_size * (sizeof(float4) - sizeof(uint)) :
+                              0;
+
     uint *tri_shader = dscene->tri_shader.alloc(tri_size);
-    float4 *vnormal = dscene->tri_vnormal.alloc(vert_size);
+    float4 *vnormal = (use_compressed_normals) ? NULL : dscene->tri_vnormal.alloc(vert_size);
+    uint *vnormal_oct = (use_compressed_normals) ? dscene->tri_vnormal_oct.alloc(vert_size) :
+                                                   NULL;
     uint4 *tri_vindex = dscene->tri_vindex.alloc(tri_size);
     uint *tri_patch = dscene->tri_patch.alloc(tri_size);
     float2 *tri_patch_uv = dscene->tri_patch_uv.alloc(vert_size);
@@ -921,7 +1050,12 @@ void GeometryManager::device_update_mesh(
       if (geom->type == Geometry::MESH) {
         Mesh *mesh = static_cast<Mesh *>(geom);
         mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
-        mesh->pack_normals(&vnormal[mesh->vert_offset]);
+        if (use_compressed_normals) {
+          mesh->pack_normals_oct(&vnormal_oct[mesh->vert_offset]);
+        }
+        else {
+          mesh->pack_normals(&vnormal[mesh->vert_offset]);
+        }
         mesh->pack_verts(tri_prim_index,
                          &tri_vindex[mesh->prim_offset],
                          &tri_patch[mesh->prim_offset],
@@ -937,7 +1071,14 @@ void GeometryManager::device_update_mesh(
     progress.set_status("Updating Mesh", "Copying Mesh to device");
 
     dscene->tri_shader.copy_to_device();
-    dscene->tri_vnormal.copy_to_device();
+    if (use_compressed_normals) {
+      dscene->tri_vnormal.free();
+      dscene->tri_vnormal_oct.copy_to_device();
+    }
+    else {
+      dscene->tri_vnormal_oct.free();
+      dscene->tri_vnormal.copy_to_device();
+    }
     dscene->tri_vindex.copy_to_device();
     dscene->tri_patch.copy_to_device();
     dscene->tri_patch_uv.copy_to_device();
@@ -1289,6 +1430,18 @@ void GeometryManager::device_update(Device *device,
 
         progress.set_status("Updating Mesh", msg);
 
+        /* Keep diced grids for interactive and persistent data renders, where meshes are
+         * tessellated again after the dicing camera moved. */
+        if (!scene->params.background || scene->params.persistent_data) {
+          if (!mesh->dice_cache) {
+            mesh->dice_cache = new DiceCache();
+          }
+        }
+        else if (mesh->dice_cache) {
+          delete mesh->dice_cache;
+          mesh->dice_cache = NULL;
+        }
+
         mesh->subd_params->camera = dicing_camera;
         DiagSplit dsplit(*mesh->subd_params);
         mesh->tessellate(&dsplit);
@@ -1425,6 +1578,7 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
   dscene->prim_time.free();
   dscene->tri_shader.free();
   dscene->tri_vnormal.free();
+  dscene->tri_vnormal_oct.free();
   dscene->tri_vindex.free();
   dscene->tri_patch.free();
   dscene->tri_patch_uv.free();
@@ -1436,6 +1590,8 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
   dscene->attributes_float2.free();
   dscene->attributes_float3.free();
   dscene->attributes_uchar4.free();
+  dscene->attributes_float2_packed.free();
+  dscene->attributes_float3_packed.free();
 
   /* Signal for shaders like displacement not to do ray tracing. */
   dscene->data.bvh.bvh_layout = BVH_LAYOUT_NONE;
@@ -1465,6 +1621,7 @@ void GeometryManager::collect_statistics(const Scene *scene, RenderStats *stats)
     stats->mesh.geometry.add_entry(
         NamedSizeEntry(string(geometry->name.c_str()), geometry->get_total_size_in_bytes()));
   }
+  stats->mesh.compressed_bytes_saved = normals_bytes_saved + attributes_bytes_saved;
 }
 
 CCL_NAMESPACE_END
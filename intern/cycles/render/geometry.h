@@ -164,6 +164,10 @@ class GeometryManager {
   void collect_statistics(const Scene *scene, RenderStats *stats);
 
  protected:
+  /* Device memory saved by quantized storage, for statistics. */
+  size_t normals_bytes_saved;
+  size_t attributes_bytes_saved;
+
   bool displace(Device *device, DeviceScene *dscene, Scene *scene, Mesh *mesh, Progress &progress);
 
   void create_volume_mesh(Mesh *mesh, Progress &progress);
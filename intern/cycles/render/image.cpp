@@ -27,7 +27,9 @@
 #include "util/util_logging.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
+#include "util/util_sparse_grid.h"
 #include "util/util_texture.h"
+#include "util/util_texture_cache.h"
 #include "util/util_unique_ptr.h"
 
 #ifdef WITH_OSL
@@ -71,6 +73,10 @@ const char *name_from_type(ImageDataType type)
       return "ushort4";
     case IMAGE_DATA_TYPE_USHORT:
       return "ushort";
+    case IMAGE_DATA_TYPE_TEXTURE_CACHE:
+      return "texture_cache";
+    case IMAGE_DATA_TYPE_SPARSE_GRID:
+      return "sparse_grid";
     case IMAGE_DATA_NUM_TYPES:
       assert(!"System enumerator type, should never be used");
       return "";
@@ -247,6 +253,11 @@ ustring ImageLoader::osl_filepath() const
   return ustring();
 }
 
+bool ImageLoader::load_pixels_sparse(const ImageMetaData &, SparseGrid &)
+{
+  return false;
+}
+
 bool ImageLoader::equals(const ImageLoader *a, const ImageLoader *b)
 {
   if (a == NULL && b == NULL) {
@@ -267,6 +278,10 @@ ImageManager::ImageManager(const DeviceInfo &info)
 
   /* Set image limits */
   has_half_images = info.has_half_images;
+
+  /* Texture cache lookups and sparse grids run on the host. */
+  has_texture_cache = (info.type == DEVICE_CPU);
+  has_sparse_grids = (info.type == DEVICE_CPU);
 }
 
 ImageManager::~ImageManager()
@@ -409,6 +424,7 @@ int ImageManager::add_image_slot(ImageLoader *loader,
   img->builtin = builtin;
   img->users = 1;
   img->mem = NULL;
+  img->sparse_grid = NULL;
 
   images[slot] = img;
 
@@ -607,6 +623,101 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
   return true;
 }
 
+/* Returns the texture cache handle when the image should be read from the cache, instead of
+ * being loaded into memory in full. */
+TextureCacheImage *ImageManager::texture_cache_image(Scene *scene, Image *img)
+{
+  if (!(has_texture_cache && scene->params.use_texture_cache)) {
+    return NULL;
+  }
+
+  /* The cache reads files itself, there is no loader for generated or packed images. */
+  const ustring filepath = img->loader->osl_filepath();
+  if (filepath.empty() || img->builtin) {
+    return NULL;
+  }
+
+  /* Pixels are used as stored in the file, so images which need color space conversion or
+   * alpha handling on load are not supported. */
+  const ImageMetaData &metadata = img->metadata;
+  if (metadata.depth > 1) {
+    return NULL;
+  }
+  if (!(metadata.colorspace == u_colorspace_raw || metadata.colorspace == u_colorspace_srgb)) {
+    return NULL;
+  }
+  if (!image_associate_alpha(img) && (metadata.channels == 2 || metadata.channels == 4)) {
+    return NULL;
+  }
+
+  TextureCache *cache;
+  {
+    thread_scoped_lock cache_lock(texture_cache_mutex);
+    if (!texture_cache) {
+      texture_cache.reset(new TextureCache(scene->params.texture_cache_size));
+    }
+    cache = texture_cache.get();
+  }
+
+  /* Only files which are tiled on disk can be read partially. Untiled images are better
+   * off loaded in full, since the first lookup would read the whole file anyway. */
+  bool is_tiled;
+  if (!cache->get_image_info(filepath.string(), &is_tiled) || !is_tiled) {
+    return NULL;
+  }
+
+  VLOG(1) << "Using texture cache for " << img->loader->name();
+  return cache->add_image(filepath.string());
+}
+
+/* Drop tiles of the image file read by the texture cache, so changes to the file are seen. */
+void ImageManager::texture_cache_invalidate(Image *img)
+{
+  thread_scoped_lock cache_lock(texture_cache_mutex);
+  if (!texture_cache) {
+    return;
+  }
+
+  const ustring filepath = img->loader->osl_filepath();
+  if (!filepath.empty()) {
+    texture_cache->invalidate(filepath.string());
+  }
+}
+
+/* Returns the voxels of 3D images that can be stored sparsely, NULL when the image should be
+ * loaded densely. */
+SparseGrid *ImageManager::sparse_grid_image(Scene *scene, Image *img)
+{
+  const ImageMetaData &metadata = img->metadata;
+  if (!has_sparse_grids || metadata.depth <= 1) {
+    return NULL;
+  }
+  if (!(metadata.type == IMAGE_DATA_TYPE_FLOAT || metadata.type == IMAGE_DATA_TYPE_FLOAT4)) {
+    return NULL;
+  }
+
+  /* Resizing to the texture limit needs dense pixels. */
+  const int texture_limit = scene->params.texture_limit;
+  const size_t max_size = max(max(metadata.width, metadata.height), metadata.depth);
+  if (texture_limit > 0 && max_size > texture_limit) {
+    return NULL;
+  }
+
+  SparseGrid *grid = new SparseGrid();
+  if (!img->loader->load_pixels_sparse(metadata, *grid)) {
+    delete grid;
+    return NULL;
+  }
+
+  const size_t dense_size = metadata.width * metadata.height * metadata.depth * sizeof(float) *
+                            ((metadata.type == IMAGE_DATA_TYPE_FLOAT4) ? 4 : 1);
+  VLOG(1) << "Sparse grid for " << img->loader->name() << ": " << grid->num_active_tiles()
+          << " active tiles, " << string_human_readable_size(grid->memory_size())
+          << " instead of " << string_human_readable_size(dense_size) << " dense.";
+
+  return grid;
+}
+
 void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Progress *progress)
 {
   if (progress->get_cancel()) {
@@ -622,6 +733,22 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   load_image_metadata(img);
   ImageDataType type = img->metadata.type;
 
+  if (img->mem) {
+    /* Reloading, the file may have changed. */
+    texture_cache_invalidate(img);
+  }
+
+  TextureCacheImage *cache_image = texture_cache_image(scene, img);
+  if (cache_image) {
+    type = IMAGE_DATA_TYPE_TEXTURE_CACHE;
+  }
+
+  delete img->sparse_grid;
+  img->sparse_grid = sparse_grid_image(scene, img);
+  if (img->sparse_grid) {
+    type = IMAGE_DATA_TYPE_SPARSE_GRID;
+  }
+
   /* Name for debugging. */
   img->mem_name = string_printf("__tex_image_%s_%03d", name_from_type(type), slot);
 
@@ -638,7 +765,25 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (type == IMAGE_DATA_TYPE_TEXTURE_CACHE) {
+    /* Nothing to load, tiles are read on demand. The device still needs an allocation to
+     * upload the texture info. */
+    thread_scoped_lock device_lock(device_mutex);
+    img->mem->alloc(1, 1);
+    img->mem->info.width = img->metadata.width;
+    img->mem->info.height = img->metadata.height;
+    img->mem->info.data = (uint64_t)cache_image;
+  }
+  else if (type == IMAGE_DATA_TYPE_SPARSE_GRID) {
+    /* Voxels were already loaded into the grid, the device only needs the texture info. */
+    thread_scoped_lock device_lock(device_mutex);
+    img->mem->alloc(1, 1);
+    img->mem->info.width = img->metadata.width;
+    img->mem->info.height = img->metadata.height;
+    img->mem->info.depth = img->metadata.depth;
+    img->mem->info.data = (uint64_t)img->sparse_grid;
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -749,11 +894,14 @@ void ImageManager::device_free_image(Device *, int slot)
 #endif
   }
 
+  texture_cache_invalidate(img);
+
   if (img->mem) {
     thread_scoped_lock device_lock(device_mutex);
     delete img->mem;
   }
 
+  delete img->sparse_grid;
   delete img->loader;
   delete img;
   images[slot] = NULL;
@@ -831,13 +979,26 @@ void ImageManager::device_free(Device *device)
     device_free_image(device, slot);
   }
   images.clear();
+
+  thread_scoped_lock cache_lock(texture_cache_mutex);
+  texture_cache.reset();
 }
 
 void ImageManager::collect_statistics(RenderStats *stats)
 {
   foreach (const Image *image, images) {
-    stats->image.textures.add_entry(
-        NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
+    if (image->mem->info.data_type == IMAGE_DATA_TYPE_TEXTURE_CACHE) {
+      /* Memory is reported by the texture cache. */
+      continue;
+    }
+    const size_t memory_size = (image->sparse_grid) ? image->sparse_grid->memory_size() :
+                                                      image->mem->memory_size();
+    stats->image.textures.add_entry(NamedSizeEntry(image->loader->name(), memory_size));
+  }
+
+  if (texture_cache) {
+    stats->image.has_texture_cache = true;
+    stats->image.texture_cache = texture_cache->get_stats();
   }
 }
 
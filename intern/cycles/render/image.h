@@ -39,6 +39,9 @@ class Progress;
 class RenderStats;
 class Scene;
 class ColorSpaceProcessor;
+class SparseGrid;
+class TextureCache;
+struct TextureCacheImage;
 
 /* Image Parameters */
 class ImageParams {
@@ -117,6 +120,10 @@ class ImageLoader {
   /* Optional for OSL texture cache. */
   virtual ustring osl_filepath() const;
 
+  /* Optional loading of 3D images as tiles of active voxels, without allocating the full
+   * bounding box. Returns false when not supported or when dense storage is smaller. */
+  virtual bool load_pixels_sparse(const ImageMetaData &metadata, SparseGrid &grid);
+
   /* Free any memory used for loading metadata and pixels. */
   virtual void cleanup(){};
 
@@ -197,6 +204,7 @@ class ImageManager {
 
     string mem_name;
     device_texture *mem;
+    SparseGrid *sparse_grid;
 
     int users;
     thread_mutex mutex;
@@ -204,6 +212,8 @@ class ImageManager {
 
  private:
   bool has_half_images;
+  bool has_texture_cache;
+  bool has_sparse_grids;
 
   thread_mutex device_mutex;
   thread_mutex images_mutex;
@@ -212,6 +222,10 @@ class ImageManager {
   vector<Image *> images;
   void *osl_texture_system;
 
+  /* Created on demand when the scene uses it. */
+  unique_ptr<TextureCache> texture_cache;
+  thread_mutex texture_cache_mutex;
+
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
   void remove_image_user(int slot);
@@ -221,6 +235,10 @@ class ImageManager {
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
 
+  TextureCacheImage *texture_cache_image(Scene *scene, Image *img);
+  void texture_cache_invalidate(Image *img);
+  SparseGrid *sparse_grid_image(Scene *scene, Image *img);
+
   void device_load_image(Device *device, Scene *scene, int slot, Progress *progress);
   void device_free_image(Device *device, int slot);
 
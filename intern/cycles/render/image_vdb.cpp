@@ -16,6 +16,9 @@
 
 #include "render/image_vdb.h"
 
+#include "util/util_logging.h"
+#include "util/util_sparse_grid.h"
+
 #ifdef WITH_OPENVDB
 #  include <openvdb/openvdb.h>
 #  include <openvdb/tools/Dense.h>
@@ -161,6 +164,157 @@ bool VDBImageLoader::load_pixels(const ImageMetaData &, void *pixels, const size
 #endif
 }
 
+#ifdef WITH_OPENVDB
+template<typename T> static void sparse_grid_copy_voxel(float *voxel, const T &value)
+{
+  voxel[0] = (float)value;
+}
+
+template<typename T>
+static void sparse_grid_copy_voxel(float *voxel, const openvdb::math::Vec3<T> &value)
+{
+  voxel[0] = (float)value.x();
+  voxel[1] = (float)value.y();
+  voxel[2] = (float)value.z();
+  voxel[3] = 1.0f;
+}
+
+/* Copy leaf nodes with active voxels into tiles of the sparse grid, the leaf nodes have the same
+ * size as the tiles. Active tile values at higher levels of the tree are filled in voxel by
+ * voxel, those are rare in simulation caches. */
+template<typename GridType>
+static bool sparse_grid_from_openvdb(const openvdb::GridBase::ConstPtr &grid_base,
+                                     const openvdb::CoordBBox &bbox,
+                                     const int channels,
+                                     SparseGrid &sparse_grid)
+{
+  typedef typename GridType::TreeType TreeType;
+  typedef typename TreeType::LeafNodeType LeafNodeType;
+
+  if ((int)LeafNodeType::DIM != SPARSE_GRID_TILE_SIZE) {
+    return false;
+  }
+
+  typename GridType::ConstPtr grid = openvdb::gridConstPtrCast<GridType>(grid_base);
+  const TreeType &tree = grid->tree();
+
+  /* Dense storage is smaller when most of the bounding box is covered by leaf nodes. */
+  const openvdb::Coord dim = bbox.dim();
+  const size_t num_voxels = (size_t)dim.x() * dim.y() * dim.z();
+  if ((size_t)tree.leafCount() * SPARSE_GRID_TILE_VOXELS >= num_voxels) {
+    return false;
+  }
+
+  /* Align tiles with leaf nodes, whose origin is a multiple of the leaf size. */
+  const openvdb::Coord min = bbox.min();
+  const int3 offset = make_int3(min.x() & SPARSE_GRID_TILE_MASK,
+                                min.y() & SPARSE_GRID_TILE_MASK,
+                                min.z() & SPARSE_GRID_TILE_MASK);
+  const openvdb::Coord tiles_min = min - openvdb::Coord(offset.x, offset.y, offset.z);
+
+  sparse_grid.reset(make_int3(dim.x(), dim.y(), dim.z()), offset, channels);
+  sparse_grid.reserve_tiles(tree.leafCount());
+
+  for (typename TreeType::LeafCIter leaf = tree.cbeginLeaf(); leaf; ++leaf) {
+    if (leaf->isEmpty()) {
+      continue;
+    }
+
+    const openvdb::Coord origin = leaf->origin();
+    const openvdb::Coord tile = origin - tiles_min;
+    float *voxels = sparse_grid.ensure_tile(tile.x() >> SPARSE_GRID_TILE_SHIFT,
+                                            tile.y() >> SPARSE_GRID_TILE_SHIFT,
+                                            tile.z() >> SPARSE_GRID_TILE_SHIFT);
+    if (voxels == NULL) {
+      continue;
+    }
+
+    for (int z = 0; z < SPARSE_GRID_TILE_SIZE; z++) {
+      for (int y = 0; y < SPARSE_GRID_TILE_SIZE; y++) {
+        for (int x = 0; x < SPARSE_GRID_TILE_SIZE; x++) {
+          const int index = x + SPARSE_GRID_TILE_SIZE * (y + SPARSE_GRID_TILE_SIZE * z);
+          sparse_grid_copy_voxel(voxels + index * channels,
+                                 leaf->getValue(origin.offsetBy(x, y, z)));
+        }
+      }
+    }
+  }
+
+  for (typename GridType::ValueOnCIter iter = grid->cbeginValueOn(); iter; ++iter) {
+    if (iter.isVoxelValue()) {
+      continue;
+    }
+
+    openvdb::CoordBBox tile_bbox;
+    iter.getBoundingBox(tile_bbox);
+    tile_bbox.intersect(bbox);
+
+    for (int z = tile_bbox.min().z(); z <= tile_bbox.max().z(); z++) {
+      for (int y = tile_bbox.min().y(); y <= tile_bbox.max().y(); y++) {
+        for (int x = tile_bbox.min().x(); x <= tile_bbox.max().x(); x++) {
+          const openvdb::Coord voxel = openvdb::Coord(x, y, z) - tiles_min;
+          float *voxels = sparse_grid.ensure_tile(voxel.x() >> SPARSE_GRID_TILE_SHIFT,
+                                                  voxel.y() >> SPARSE_GRID_TILE_SHIFT,
+                                                  voxel.z() >> SPARSE_GRID_TILE_SHIFT);
+          const int index = (voxel.x() & SPARSE_GRID_TILE_MASK) +
+                            SPARSE_GRID_TILE_SIZE *
+                                ((voxel.y() & SPARSE_GRID_TILE_MASK) +
+                                 SPARSE_GRID_TILE_SIZE * (voxel.z() & SPARSE_GRID_TILE_MASK));
+          sparse_grid_copy_voxel(voxels + index * channels, iter.getValue());
+        }
+      }
+    }
+  }
+
+  return sparse_grid.memory_size() < num_voxels * channels * sizeof(float);
+}
+#endif
+
+bool VDBImageLoader::load_pixels_sparse(const ImageMetaData &metadata, SparseGrid &sparse_grid)
+{
+#ifdef WITH_OPENVDB
+  if (!grid) {
+    return false;
+  }
+
+  const int channels = (metadata.type == IMAGE_DATA_TYPE_FLOAT4) ? 4 : 1;
+
+  if (grid->isType<openvdb::FloatGrid>()) {
+    return sparse_grid_from_openvdb<openvdb::FloatGrid>(grid, bbox, channels, sparse_grid);
+  }
+  else if (grid->isType<openvdb::Vec3fGrid>()) {
+    return sparse_grid_from_openvdb<openvdb::Vec3fGrid>(grid, bbox, channels, sparse_grid);
+  }
+  else if (grid->isType<openvdb::BoolGrid>()) {
+    return sparse_grid_from_openvdb<openvdb::BoolGrid>(grid, bbox, channels, sparse_grid);
+  }
+  else if (grid->isType<openvdb::DoubleGrid>()) {
+    return sparse_grid_from_openvdb<openvdb::DoubleGrid>(grid, bbox, channels, sparse_grid);
+  }
+  else if (grid->isType<openvdb::Int32Grid>()) {
+    return sparse_grid_from_openvdb<openvdb::Int32Grid>(grid, bbox, channels, sparse_grid);
+  }
+  else if (grid->isType<openvdb::Int64Grid>()) {
+    return sparse_grid_from_openvdb<openvdb::Int64Grid>(grid, bbox, channels, sparse_grid);
+  }
+  else if (grid->isType<openvdb::Vec3IGrid>()) {
+    return sparse_grid_from_openvdb<openvdb::Vec3IGrid>(grid, bbox, channels, sparse_grid);
+  }
+  else if (grid->isType<openvdb::Vec3dGrid>()) {
+    return sparse_grid_from_openvdb<openvdb::Vec3dGrid>(grid, bbox, channels, sparse_grid);
+  }
+  else if (grid->isType<openvdb::MaskGrid>()) {
+    return sparse_grid_from_openvdb<openvdb::MaskGrid>(grid, bbox, channels, sparse_grid);
+  }
+
+  return false;
+#else
+  (void)metadata;
+  (void)sparse_grid;
+  return false;
+#endif
+}
+
 string VDBImageLoader::name() const
 {
   return grid_name;
@@ -37,6 +37,8 @@ class VDBImageLoader : public ImageLoader {
                            const size_t pixels_size,
                            const bool associate_alpha) override;
 
+  virtual bool load_pixels_sparse(const ImageMetaData &metadata, SparseGrid &grid) override;
+
   virtual string name() const override;
 
   virtual bool equals(const ImageLoader &other) const override;
@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/integrator.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -29,6 +30,7 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_logging.h"
+#include "util/util_map.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
 
@@ -257,7 +259,168 @@ bool LightManager::object_usable_as_light(Object *object)
   return false;
 }
 
-void LightManager::device_update_distribution(Device *,
+/* Light Tree */
+
+/* Rough estimate of the emitted radiance, only used to balance emitters in the light tree. */
+static float light_tree_shader_radiance(Shader *shader)
+{
+  float3 emission;
+  if (shader->is_constant_emission(&emission)) {
+    return average(fabs(emission));
+  }
+  return 1.0f;
+}
+
+/* Fill in bounds and energy of a lamp. Returns false for distant and background lights, which
+ * are not bounded in space and sampled separately from the tree. */
+static bool light_tree_lamp_primitive(const Light *light, LightTreePrimitive *prim)
+{
+  const float strength = average(fabs(light->strength));
+
+  switch (light->type) {
+    case LIGHT_POINT:
+    case LIGHT_SPOT:
+      /* Radiant intensity. */
+      prim->energy = strength * (0.25f * M_1_PI_F);
+      prim->bbox.grow(light->co, light->size);
+      if (light->type == LIGHT_SPOT) {
+        prim->cone = LightTreeCone(safe_normalize(light->dir), light->spot_angle * 0.5f, 0.0f);
+      }
+      else {
+        prim->cone = LightTreeCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+      }
+      return true;
+    case LIGHT_AREA: {
+      /* Radiant intensity along the normal. */
+      prim->energy = strength * 0.25f;
+      const float3 axisu = light->axisu * (light->sizeu * light->size * 0.5f);
+      const float3 axisv = light->axisv * (light->sizev * light->size * 0.5f);
+      prim->bbox.grow(light->co - axisu - axisv);
+      prim->bbox.grow(light->co - axisu + axisv);
+      prim->bbox.grow(light->co + axisu - axisv);
+      prim->bbox.grow(light->co + axisu + axisv);
+      /* One sided. */
+      prim->cone = LightTreeCone(safe_normalize(light->dir), 0.0f, M_PI_2_F);
+      return true;
+    }
+    case LIGHT_DISTANT:
+      /* Irradiance. */
+      prim->energy = strength;
+      return false;
+    case LIGHT_BACKGROUND:
+      /* Irradiance of a uniform environment, the actual radiance is not known here. */
+      prim->energy = strength * M_PI_F;
+      return false;
+    default:
+      prim->energy = 0.0f;
+      return false;
+  }
+}
+
+static void light_tree_pack_emitter(const LightTreePrimitive &prim,
+                                    int parent_index,
+                                    KernelLightTreeEmitter *kemitter)
+{
+  const bool is_bounded = prim.bbox.valid();
+  const float3 bbox_min = is_bounded ? prim.bbox.min : make_float3(0.0f, 0.0f, 0.0f);
+  const float3 bbox_max = is_bounded ? prim.bbox.max : make_float3(0.0f, 0.0f, 0.0f);
+
+  kemitter->bounding_box_min[0] = bbox_min.x;
+  kemitter->bounding_box_min[1] = bbox_min.y;
+  kemitter->bounding_box_min[2] = bbox_min.z;
+  kemitter->bounding_box_max[0] = bbox_max.x;
+  kemitter->bounding_box_max[1] = bbox_max.y;
+  kemitter->bounding_box_max[2] = bbox_max.z;
+  kemitter->energy = prim.energy;
+  kemitter->axis[0] = prim.cone.axis.x;
+  kemitter->axis[1] = prim.cone.axis.y;
+  kemitter->axis[2] = prim.cone.axis.z;
+  kemitter->theta_o = prim.cone.theta_o;
+  kemitter->theta_e = prim.cone.theta_e;
+  kemitter->distribution_index = prim.distribution_index;
+  kemitter->parent_index = parent_index;
+  kemitter->area = prim.area;
+  kemitter->pad = 0;
+}
+
+void LightManager::device_update_light_tree(DeviceScene *dscene,
+                                            vector<LightTreePrimitive> &prims,
+                                            const vector<LightTreePrimitive> &infinite_prims,
+                                            vector<int> &lookup,
+                                            const vector<int> &object_lookup_offsets)
+{
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+
+  /* Build tree, this reorders the primitives. */
+  LightTree tree(prims, LIGHT_TREE_LEAF_SIZE);
+  const vector<KernelLightTreeNode> &nodes = tree.get_nodes();
+
+  if (nodes.size()) {
+    KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(nodes.size());
+    memcpy(knodes, nodes.data(), sizeof(KernelLightTreeNode) * nodes.size());
+    dscene->light_tree_nodes.copy_to_device();
+  }
+  else {
+    dscene->light_tree_nodes.free();
+  }
+
+  /* Emitters, in tree order followed by the infinite lights. */
+  const size_t num_emitters = prims.size() + infinite_prims.size();
+  KernelLightTreeEmitter *kemitters = dscene->light_tree_emitters.alloc(num_emitters);
+
+  for (size_t node_index = 0; node_index < nodes.size(); node_index++) {
+    const KernelLightTreeNode &node = nodes[node_index];
+    for (int i = 0; i < node.num_emitters; i++) {
+      const int emitter_index = node.child_index + i;
+      light_tree_pack_emitter(prims[emitter_index], node_index, &kemitters[emitter_index]);
+      lookup[prims[emitter_index].lookup_index] = emitter_index;
+    }
+  }
+
+  float infinite_energy = 0.0f;
+  for (size_t i = 0; i < infinite_prims.size(); i++) {
+    const int emitter_index = prims.size() + i;
+    light_tree_pack_emitter(infinite_prims[i], -1, &kemitters[emitter_index]);
+    lookup[infinite_prims[i].lookup_index] = emitter_index;
+    infinite_energy += infinite_prims[i].energy;
+  }
+
+  dscene->light_tree_emitters.copy_to_device();
+
+  /* Lookup from lamps and triangles to emitters. */
+  int *klookup = dscene->light_tree_emitter_lookup.alloc(lookup.size());
+  memcpy(klookup, lookup.data(), sizeof(int) * lookup.size());
+  dscene->light_tree_emitter_lookup.copy_to_device();
+
+  int *koffsets = dscene->light_tree_object_lookup_offset.alloc(object_lookup_offsets.size());
+  memcpy(koffsets, object_lookup_offsets.data(), sizeof(int) * object_lookup_offsets.size());
+  dscene->light_tree_object_lookup_offset.copy_to_device();
+
+  kintegrator->use_light_tree = true;
+  kintegrator->light_tree_num_emitters = num_emitters;
+  kintegrator->light_tree_infinite_offset = prims.size();
+  kintegrator->light_tree_infinite_energy = infinite_energy;
+
+  VLOG(1) << "Light tree built with " << nodes.size() << " nodes for " << prims.size()
+          << " emitters and " << infinite_prims.size() << " distant lights.";
+}
+
+void LightManager::device_free_light_tree(DeviceScene *dscene)
+{
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_emitters.free();
+  dscene->light_tree_emitter_lookup.free();
+  dscene->light_tree_object_lookup_offset.free();
+
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  kintegrator->use_light_tree = false;
+  kintegrator->light_tree_num_emitters = 0;
+  kintegrator->light_tree_infinite_offset = 0;
+  kintegrator->light_tree_infinite_energy = 0.0f;
+  kintegrator->light_tree_background_lamp = -1;
+}
+
+void LightManager::device_update_distribution(Device *device,
                                               DeviceScene *dscene,
                                               Scene *scene,
                                               Progress &progress)
@@ -307,6 +470,23 @@ void LightManager::device_update_distribution(Device *,
   size_t num_distribution = num_triangles + num_lights;
   VLOG(1) << "Total " << num_distribution << " of light distribution primitives.";
 
+  /* The light tree is built over the same primitives as the distribution, which is still used
+   * to look up the primitive data. Lamps come first in the emitter lookup table, followed by
+   * the triangles of each object. */
+  const bool use_light_tree = scene->integrator->use_light_tree &&
+                              device->info.type == DEVICE_CPU;
+  vector<LightTreePrimitive> light_tree_prims;
+  vector<LightTreePrimitive> light_tree_infinite_prims;
+  vector<int> light_tree_lookup;
+  vector<int> light_tree_object_lookup_offsets;
+  map<Shader *, float> light_tree_radiance;
+  int light_tree_background_lamp = -1;
+
+  if (use_light_tree) {
+    light_tree_lookup.resize(num_lights, -1);
+    light_tree_object_lookup_offsets.resize(scene->objects.size(), LIGHT_TREE_NO_LOOKUP);
+  }
+
   /* emission area */
   KernelLightDistribution *distribution = dscene->light_distribution.alloc(num_distribution + 1);
   float totarea = 0.0f;
@@ -348,6 +528,13 @@ void LightManager::device_update_distribution(Device *,
     }
 
     size_t mesh_num_triangles = mesh->num_triangles();
+    size_t light_tree_lookup_offset = light_tree_lookup.size();
+    if (use_light_tree) {
+      light_tree_object_lookup_offsets[j] = (int)light_tree_lookup_offset -
+                                            (int)mesh->prim_offset;
+      light_tree_lookup.resize(light_tree_lookup_offset + mesh_num_triangles, -1);
+    }
+
     for (size_t i = 0; i < mesh_num_triangles; i++) {
       int shader_index = mesh->shader[i];
       Shader *shader = (shader_index < mesh->used_shaders.size()) ?
@@ -375,7 +562,28 @@ void LightManager::device_update_distribution(Device *,
           p3 = transform_point(&tfm, p3);
         }
 
-        totarea += triangle_area(p1, p2, p3);
+        const float area = triangle_area(p1, p2, p3);
+        totarea += area;
+
+        if (use_light_tree) {
+          auto radiance = light_tree_radiance.find(shader);
+          if (radiance == light_tree_radiance.end()) {
+            radiance = light_tree_radiance.insert(
+                std::make_pair(shader, light_tree_shader_radiance(shader))).first;
+          }
+
+          LightTreePrimitive prim;
+          prim.bbox.grow(p1);
+          prim.bbox.grow(p2);
+          prim.bbox.grow(p3);
+          /* Emission is two sided, so the cone covers all directions. */
+          prim.cone = LightTreeCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+          prim.energy = area * radiance->second;
+          prim.area = area;
+          prim.distribution_index = offset - 1;
+          prim.lookup_index = light_tree_lookup_offset + i;
+          light_tree_prims.push_back(prim);
+        }
       }
     }
 
@@ -399,6 +607,18 @@ void LightManager::device_update_distribution(Device *,
     distribution[offset].lamp.size = light->size;
     totarea += lightarea;
 
+    if (use_light_tree) {
+      LightTreePrimitive prim;
+      prim.distribution_index = offset;
+      prim.lookup_index = light_index;
+      if (light_tree_lamp_primitive(light, &prim)) {
+        light_tree_prims.push_back(prim);
+      }
+      else {
+        light_tree_infinite_prims.push_back(prim);
+      }
+    }
+
     if (light->type == LIGHT_DISTANT) {
       use_lamp_mis |= (light->angle > 0.0f && light->use_mis);
     }
@@ -411,6 +631,7 @@ void LightManager::device_update_distribution(Device *,
     else if (light->type == LIGHT_BACKGROUND) {
       num_background_lights++;
       background_mis |= light->use_mis;
+      light_tree_background_lamp = light_index;
     }
 
     light_index++;
@@ -475,6 +696,18 @@ void LightManager::device_update_distribution(Device *,
     /* CDF */
     dscene->light_distribution.copy_to_device();
 
+    /* Light tree */
+    device_free_light_tree(dscene);
+    if (use_light_tree) {
+      progress.set_status("Updating Lights", "Building light tree");
+      device_update_light_tree(dscene,
+                               light_tree_prims,
+                               light_tree_infinite_prims,
+                               light_tree_lookup,
+                               light_tree_object_lookup_offsets);
+      kintegrator->light_tree_background_lamp = light_tree_background_lamp;
+    }
+
     /* Portals */
     if (num_portals > 0) {
       kintegrator->portal_offset = light_index;
@@ -489,6 +722,7 @@ void LightManager::device_update_distribution(Device *,
   }
   else {
     dscene->light_distribution.free();
+    device_free_light_tree(dscene);
 
     kintegrator->num_distribution = 0;
     kintegrator->num_all_lights = 0;
@@ -934,6 +1168,7 @@ void LightManager::device_update(Device *device,
 void LightManager::device_free(Device *, DeviceScene *dscene)
 {
   dscene->light_distribution.free();
+  device_free_light_tree(dscene);
   dscene->lights.free();
   dscene->light_background_marginal_cdf.free();
   dscene->light_background_conditional_cdf.free();
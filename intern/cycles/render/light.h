@@ -34,6 +34,7 @@ class Object;
 class Progress;
 class Scene;
 class Shader;
+struct LightTreePrimitive;
 
 class Light : public Node {
  public:
@@ -121,6 +122,12 @@ class LightManager {
                                 Scene *scene,
                                 Progress &progress);
   void device_update_ies(DeviceScene *dscene);
+  void device_update_light_tree(DeviceScene *dscene,
+                                vector<LightTreePrimitive> &prims,
+                                const vector<LightTreePrimitive> &infinite_prims,
+                                vector<int> &lookup,
+                                const vector<int> &object_lookup_offsets);
+  void device_free_light_tree(DeviceScene *dscene);
 
   /* Check whether light manager can use the object as a light-emissive. */
   bool object_usable_as_light(Object *object);
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Cone */
+
+float LightTreeCone::measure() const
+{
+  const float theta_w = min(theta_o + theta_e, M_PI_F);
+  const float cos_theta_o = cosf(theta_o);
+  const float sin_theta_o = sinf(theta_o);
+
+  return M_2PI_F * (1.0f - cos_theta_o) +
+         M_PI_2_F * (2.0f * theta_w * sin_theta_o - cosf(theta_o - 2.0f * theta_w) -
+                     2.0f * theta_o * sin_theta_o + cos_theta_o);
+}
+
+LightTreeCone merge(const LightTreeCone &cone_a, const LightTreeCone &cone_b)
+{
+  if (cone_a.is_empty()) {
+    return cone_b;
+  }
+  if (cone_b.is_empty()) {
+    return cone_a;
+  }
+
+  /* Let cone a be the widest. */
+  const bool a_is_wider = (cone_a.theta_o >= cone_b.theta_o);
+  const LightTreeCone &a = a_is_wider ? cone_a : cone_b;
+  const LightTreeCone &b = a_is_wider ? cone_b : cone_a;
+
+  const float theta_d = safe_acosf(dot(a.axis, b.axis));
+  const float theta_e = max(a.theta_e, b.theta_e);
+
+  /* Cone a already contains cone b. */
+  if (min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    return LightTreeCone(a.axis, a.theta_o, theta_e);
+  }
+
+  const float theta_o = (a.theta_o + theta_d + b.theta_o) * 0.5f;
+  if (theta_o >= M_PI_F) {
+    return LightTreeCone(a.axis, M_PI_F, theta_e);
+  }
+
+  /* Rotate the axis of cone a towards cone b, so it covers both. */
+  const float3 rotation_axis = cross(a.axis, b.axis);
+  if (is_zero(rotation_axis)) {
+    return LightTreeCone(a.axis, M_PI_F, theta_e);
+  }
+  const float3 axis = rotate_around_axis(
+      a.axis, normalize(rotation_axis), theta_o - a.theta_o);
+
+  return LightTreeCone(normalize(axis), theta_o, theta_e);
+}
+
+/* Tree */
+
+LightTree::LightTree(vector<LightTreePrimitive> &prims, int max_prims_in_leaf)
+    : prims(prims), max_prims_in_leaf(max_prims_in_leaf)
+{
+  if (prims.empty()) {
+    return;
+  }
+
+  nodes.reserve(prims.size() * 2);
+  recursive_build(0, prims.size(), -1);
+}
+
+int LightTree::recursive_build(int start, int end, int parent)
+{
+  const int node_index = nodes.size();
+  nodes.push_back(KernelLightTreeNode());
+
+  BoundBox bbox = BoundBox::empty;
+  BoundBox centroid_bounds = BoundBox::empty;
+  LightTreeCone cone;
+  float energy = 0.0f;
+
+  for (int i = start; i < end; i++) {
+    const LightTreePrimitive &prim = prims[i];
+    bbox.grow(prim.bbox);
+    centroid_bounds.grow(prim.bbox.center());
+    cone = merge(cone, prim.cone);
+    energy += prim.energy;
+  }
+
+  const int num_prims = end - start;
+  int split = -1;
+
+  if (num_prims > 1) {
+    const float leaf_cost = energy * cone.measure() * bbox.safe_area();
+    split = find_split(start, end, centroid_bounds, leaf_cost);
+
+    if (split == -1 && num_prims > max_prims_in_leaf) {
+      /* All centroids coincide, split in the middle. */
+      split = (start + end) / 2;
+    }
+  }
+
+  int child_index = start;
+  if (split != -1) {
+    recursive_build(start, split, node_index);
+    child_index = recursive_build(split, end, node_index);
+  }
+
+  /* Fill in after building the children, they may reallocate the nodes. */
+  KernelLightTreeNode &node = nodes[node_index];
+  node.bounding_box_min[0] = bbox.min.x;
+  node.bounding_box_min[1] = bbox.min.y;
+  node.bounding_box_min[2] = bbox.min.z;
+  node.bounding_box_max[0] = bbox.max.x;
+  node.bounding_box_max[1] = bbox.max.y;
+  node.bounding_box_max[2] = bbox.max.z;
+  node.energy = energy;
+  node.axis[0] = cone.axis.x;
+  node.axis[1] = cone.axis.y;
+  node.axis[2] = cone.axis.z;
+  node.theta_o = cone.theta_o;
+  node.theta_e = cone.theta_e;
+  node.child_index = child_index;
+  node.num_emitters = (split == -1) ? num_prims : 0;
+  node.parent_index = parent;
+  node.pad = 0;
+
+  return node_index;
+}
+
+/* Surface area orientation heuristic, binned along each axis. Returns the index of the first
+ * primitive of the right child, or -1 when a leaf is cheaper. */
+int LightTree::find_split(int start, int end, const BoundBox &centroid_bounds, float leaf_cost)
+{
+  const int num_buckets = 12;
+
+  struct Bucket {
+    BoundBox bbox;
+    LightTreeCone cone;
+    float energy;
+    int count;
+  };
+
+  const float3 extent = centroid_bounds.size();
+  const float max_extent = max3(extent);
+
+  float min_cost = FLT_MAX;
+  int min_axis = -1;
+  int min_bucket = -1;
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (extent[axis] == 0.0f) {
+      continue;
+    }
+
+    Bucket buckets[num_buckets];
+    for (int b = 0; b < num_buckets; b++) {
+      buckets[b].bbox = BoundBox::empty;
+      buckets[b].energy = 0.0f;
+      buckets[b].count = 0;
+    }
+
+    const float inv_extent = 1.0f / extent[axis];
+    for (int i = start; i < end; i++) {
+      const LightTreePrimitive &prim = prims[i];
+      const float t = (prim.bbox.center()[axis] - centroid_bounds.min[axis]) * inv_extent;
+      const int b = clamp((int)(t * num_buckets), 0, num_buckets - 1);
+
+      buckets[b].bbox.grow(prim.bbox);
+      buckets[b].cone = merge(buckets[b].cone, prim.cone);
+      buckets[b].energy += prim.energy;
+      buckets[b].count++;
+    }
+
+    /* Favor splitting along the longest axis. */
+    const float regularization = max_extent * inv_extent;
+
+    for (int split = 1; split < num_buckets; split++) {
+      Bucket left, right;
+      left.bbox = right.bbox = BoundBox::empty;
+      left.energy = right.energy = 0.0f;
+      left.count = right.count = 0;
+
+      for (int b = 0; b < num_buckets; b++) {
+        Bucket &side = (b < split) ? left : right;
+        if (buckets[b].count == 0) {
+          continue;
+        }
+        side.bbox.grow(buckets[b].bbox);
+        side.cone = merge(side.cone, buckets[b].cone);
+        side.energy += buckets[b].energy;
+        side.count += buckets[b].count;
+      }
+
+      if (left.count == 0 || right.count == 0) {
+        continue;
+      }
+
+      const float cost = regularization *
+                         (left.energy * left.cone.measure() * left.bbox.safe_area() +
+                          right.energy * right.cone.measure() * right.bbox.safe_area());
+
+      if (cost < min_cost) {
+        min_cost = cost;
+        min_axis = axis;
+        min_bucket = split;
+      }
+    }
+  }
+
+  if (min_axis == -1) {
+    return -1;
+  }
+  if (end - start <= max_prims_in_leaf && min_cost >= leaf_cost) {
+    return -1;
+  }
+
+  const float inv_extent = 1.0f / extent[min_axis];
+  LightTreePrimitive *middle = std::partition(
+      &prims[start], &prims[end - 1] + 1, [&](const LightTreePrimitive &prim) {
+        const float t = (prim.bbox.center()[min_axis] - centroid_bounds.min[min_axis]) *
+                        inv_extent;
+        return clamp((int)(t * num_buckets), 0, num_buckets - 1) < min_bucket;
+      });
+
+  return middle - &prims[0];
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Bounds of emission directions: normals within theta_o of the axis, each emitting within
+ * theta_e of its normal. See "Importance Sampling of Many Lights with Adaptive Tree Splitting",
+ * Conty Estevez and Kulla, 2018. */
+
+struct LightTreeCone {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+
+  LightTreeCone() : axis(make_float3(0.0f, 0.0f, 0.0f)), theta_o(0.0f), theta_e(0.0f)
+  {
+  }
+
+  LightTreeCone(const float3 &axis, float theta_o, float theta_e)
+      : axis(axis), theta_o(theta_o), theta_e(theta_e)
+  {
+  }
+
+  bool is_empty() const
+  {
+    return is_zero(axis);
+  }
+
+  /* Solid angle measure used by the split heuristic. */
+  float measure() const;
+};
+
+LightTreeCone merge(const LightTreeCone &a, const LightTreeCone &b);
+
+struct LightTreePrimitive {
+  BoundBox bbox;
+  LightTreeCone cone;
+  float energy;
+  /* Triangle area, zero for lamps. */
+  float area;
+
+  /* Index into the light distribution. */
+  int distribution_index;
+  /* Index into the emitter lookup table. */
+  int lookup_index;
+
+  LightTreePrimitive()
+      : bbox(BoundBox::empty), energy(0.0f), area(0.0f), distribution_index(-1), lookup_index(-1)
+  {
+  }
+};
+
+/* Light Tree
+ *
+ * Binary tree built with the surface area orientation heuristic. Primitives are reordered so
+ * that each leaf references a contiguous range of them. */
+
+class LightTree {
+ public:
+  LightTree(vector<LightTreePrimitive> &prims, int max_prims_in_leaf);
+
+  const vector<KernelLightTreeNode> &get_nodes() const
+  {
+    return nodes;
+  }
+
+ protected:
+  int recursive_build(int start, int end, int parent);
+  int find_split(int start, int end, const BoundBox &centroid_bounds, float parent_cost);
+
+  vector<LightTreePrimitive> &prims;
+  vector<KernelLightTreeNode> nodes;
+  int max_prims_in_leaf;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
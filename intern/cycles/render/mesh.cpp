@@ -31,6 +31,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_quantize.h"
 #include "util/util_set.h"
 
 CCL_NAMESPACE_BEGIN
@@ -153,6 +154,7 @@ Mesh::Mesh() : Geometry(node_type, Geometry::MESH), subd_attributes(this, ATTR_P
 
   subdivision_type = SUBDIVISION_NONE;
   subd_params = NULL;
+  dice_cache = NULL;
 
   patch_table = NULL;
 }
@@ -161,6 +163,7 @@ Mesh::~Mesh()
 {
   delete patch_table;
   delete subd_params;
+  delete dice_cache;
 }
 
 void Mesh::resize_mesh(int numverts, int numtris)
@@ -606,6 +609,30 @@ void Mesh::pack_normals(float4 *vnormal)
   }
 }
 
+void Mesh::pack_normals_oct(uint *vnormal_oct)
+{
+  Attribute *attr_vN = attributes.find(ATTR_STD_VERTEX_NORMAL);
+  if (attr_vN == NULL) {
+    /* Happens on objects with just hair. */
+    return;
+  }
+
+  bool do_transform = transform_applied;
+  Transform ntfm = transform_normal;
+
+  float3 *vN = attr_vN->data_float3();
+  size_t verts_size = verts.size();
+
+  for (size_t i = 0; i < verts_size; i++) {
+    float3 vNi = vN[i];
+
+    if (do_transform)
+      vNi = safe_normalize(transform_direction(&ntfm, vNi));
+
+    vnormal_oct[i] = oct_encode_unit_vector(vNi);
+  }
+}
+
 void Mesh::pack_verts(const vector<uint> &tri_prim_index,
                       uint4 *tri_vindex,
                       uint *tri_patch,
@@ -47,6 +47,7 @@ class SceneParams;
 class AttributeRequest;
 struct SubdParams;
 class DiagSplit;
+class DiceCache;
 struct PackedPatchTable;
 
 /* Mesh */
@@ -144,6 +145,8 @@ class Mesh : public Geometry {
   array<SubdEdgeCrease> subd_creases;
 
   SubdParams *subd_params;
+  /* Diced grids of the previous tessellation, kept when the mesh is cleared. */
+  DiceCache *dice_cache;
 
   AttributeSet subd_attributes;
 
@@ -194,6 +197,7 @@ class Mesh : public Geometry {
 
   void pack_shaders(Scene *scene, uint *shader);
   void pack_normals(float4 *vnormal);
+  void pack_normals_oct(uint *vnormal_oct);
   void pack_verts(const vector<uint> &tri_prim_index,
                   uint4 *tri_vindex,
                   uint *tri_patch,
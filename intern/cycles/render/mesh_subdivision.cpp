@@ -25,6 +25,7 @@
 #include "util/util_algorithm.h"
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
+#include "util/util_murmurhash.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -161,9 +162,10 @@ class OsdData {
   Far::TopologyRefiner *refiner;
   Far::PatchTable *patch_table;
   Far::PatchMap *patch_map;
+  int isolation;
 
  public:
-  OsdData() : mesh(NULL), refiner(NULL), patch_table(NULL), patch_map(NULL)
+  OsdData() : mesh(NULL), refiner(NULL), patch_table(NULL), patch_map(NULL), isolation(0)
   {
   }
 
@@ -189,8 +191,8 @@ class OsdData {
         *mesh, Far::TopologyRefinerFactory<Mesh>::Options(type, options));
 
     /* adaptive refinement */
-    int max_isolation = calculate_max_isolation();
-    refiner->RefineAdaptive(Far::TopologyRefiner::AdaptiveOptions(max_isolation));
+    isolation = calculate_max_isolation();
+    refiner->RefineAdaptive(Far::TopologyRefiner::AdaptiveOptions(isolation));
 
     /* create patch table */
     Far::PatchTableFactory::Options patch_options;
@@ -366,6 +368,50 @@ struct OsdPatch : Patch {
 
 #endif
 
+/* Hash of the input of patch evaluation, to detect when cached diced grids are outdated. */
+static uint tessellate_input_hash(Mesh *mesh, const float3 *vN, int isolation)
+{
+  vector<uint> data;
+  data.reserve(mesh->verts.size() * 6 + mesh->subd_faces.size() * 5 +
+               mesh->subd_face_corners.size() + mesh->subd_creases.size() * 3 + 2);
+
+  data.push_back(mesh->subdivision_type);
+  data.push_back(isolation);
+
+  for (size_t i = 0; i < mesh->verts.size(); i++) {
+    data.push_back(__float_as_uint(mesh->verts[i].x));
+    data.push_back(__float_as_uint(mesh->verts[i].y));
+    data.push_back(__float_as_uint(mesh->verts[i].z));
+
+    if (vN) {
+      data.push_back(__float_as_uint(vN[i].x));
+      data.push_back(__float_as_uint(vN[i].y));
+      data.push_back(__float_as_uint(vN[i].z));
+    }
+  }
+
+  for (size_t i = 0; i < mesh->subd_faces.size(); i++) {
+    const Mesh::SubdFace &face = mesh->subd_faces[i];
+    data.push_back(face.start_corner);
+    data.push_back(face.num_corners);
+    data.push_back(face.smooth);
+    data.push_back(face.ptex_offset);
+  }
+
+  for (size_t i = 0; i < mesh->subd_face_corners.size(); i++) {
+    data.push_back(mesh->subd_face_corners[i]);
+  }
+
+  for (size_t i = 0; i < mesh->subd_creases.size(); i++) {
+    const Mesh::SubdEdgeCrease &crease = mesh->subd_creases[i];
+    data.push_back(crease.v[0]);
+    data.push_back(crease.v[1]);
+    data.push_back(__float_as_uint(crease.crease));
+  }
+
+  return util_murmur_hash3(data.data(), data.size() * sizeof(uint), 0);
+}
+
 void Mesh::tessellate(DiagSplit *split)
 {
 #ifdef WITH_OPENSUBDIV
@@ -396,6 +442,15 @@ void Mesh::tessellate(DiagSplit *split)
   Attribute *attr_vN = subd_attributes.find(ATTR_STD_VERTEX_NORMAL);
   float3 *vN = (attr_vN) ? attr_vN->data_float3() : NULL;
 
+  if (dice_cache) {
+#ifdef WITH_OPENSUBDIV
+    const int isolation = osd_data.isolation;
+#else
+    const int isolation = 0;
+#endif
+    dice_cache->begin(tessellate_input_hash(this, vN, isolation));
+  }
+
   /* count patches */
   int num_patches = 0;
   for (int f = 0; f < num_faces; f++) {
@@ -21,6 +21,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_sparse_grid.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -362,9 +363,64 @@ void VolumeMeshBuilder::convert_quads_to_tris(const vector<QuadData> &quads,
 
 struct VoxelAttributeGrid {
   float *data;
+  const SparseGrid *sparse_grid;
   int channels;
 };
 
+static bool voxel_is_visible(const float *voxel, const int channels, const float clipping)
+{
+  /* The alpha channel of 4 channel grids is always 1, only test the density channels. */
+  const int num_density_channels = min(channels, 3);
+  for (int c = 0; c < num_density_channels; c++) {
+    if (voxel[c] >= clipping) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Add nodes for visible voxels of a sparse grid, only visiting the stored tiles. */
+static void add_sparse_grid_nodes(VolumeMeshBuilder &builder,
+                                  const SparseGrid &grid,
+                                  const float clipping)
+{
+  const int3 num_tiles = grid.num_tiles;
+  const int3 resolution = grid.resolution;
+  const int channels = grid.channels;
+
+  for (int tz = 0; tz < num_tiles.z; ++tz) {
+    for (int ty = 0; ty < num_tiles.y; ++ty) {
+      for (int tx = 0; tx < num_tiles.x; ++tx) {
+        const int tile = grid.tile_index[tx + num_tiles.x * (ty + (size_t)num_tiles.y * tz)];
+        if (tile == SPARSE_GRID_TILE_EMPTY) {
+          continue;
+        }
+
+        const float *voxels = &grid.atlas[(size_t)tile * SPARSE_GRID_TILE_VOXELS * channels];
+
+        for (int lz = 0; lz < SPARSE_GRID_TILE_SIZE; ++lz) {
+          for (int ly = 0; ly < SPARSE_GRID_TILE_SIZE; ++ly) {
+            for (int lx = 0; lx < SPARSE_GRID_TILE_SIZE; ++lx) {
+              const int x = tx * SPARSE_GRID_TILE_SIZE + lx - grid.offset.x;
+              const int y = ty * SPARSE_GRID_TILE_SIZE + ly - grid.offset.y;
+              const int z = tz * SPARSE_GRID_TILE_SIZE + lz - grid.offset.z;
+              if (x < 0 || y < 0 || z < 0 || x >= resolution.x || y >= resolution.y ||
+                  z >= resolution.z) {
+                continue;
+              }
+
+              const int index = lx + SPARSE_GRID_TILE_SIZE * (ly + SPARSE_GRID_TILE_SIZE * lz);
+              if (voxel_is_visible(voxels + index * channels, channels, clipping)) {
+                builder.add_node_with_padding(x, y, z);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
 {
   string msg = string_printf("Computing Volume Mesh %s", mesh->name.c_str());
@@ -385,8 +441,14 @@ void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
 
     ImageHandle &handle = attr.data_voxel();
     device_texture *image_memory = handle.image_memory();
-    int3 resolution = make_int3(
-        image_memory->data_width, image_memory->data_height, image_memory->data_depth);
+    const SparseGrid *sparse_grid = (image_memory->info.data_type ==
+                                     IMAGE_DATA_TYPE_SPARSE_GRID) ?
+                                        (const SparseGrid *)image_memory->info.data :
+                                        NULL;
+    int3 resolution = (sparse_grid) ? sparse_grid->resolution :
+                                      make_int3(image_memory->data_width,
+                                                image_memory->data_height,
+                                                image_memory->data_depth);
 
     if (volume_params.resolution == make_int3(0, 0, 0)) {
       volume_params.resolution = resolution;
@@ -399,7 +461,8 @@ void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
 
     VoxelAttributeGrid voxel_grid;
     voxel_grid.data = static_cast<float *>(image_memory->host_pointer);
-    voxel_grid.channels = image_memory->data_elements;
+    voxel_grid.sparse_grid = sparse_grid;
+    voxel_grid.channels = (sparse_grid) ? sparse_grid->channels : image_memory->data_elements;
     voxel_grids.push_back(voxel_grid);
 
     /* TODO: support multiple transforms. */
@@ -455,20 +518,23 @@ void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
   VolumeMeshBuilder builder(&volume_params);
   const float clipping = mesh->volume_clipping;
 
-  for (int z = 0; z < resolution.z; ++z) {
-    for (int y = 0; y < resolution.y; ++y) {
-      for (int x = 0; x < resolution.x; ++x) {
-        int64_t voxel_index = compute_voxel_index(resolution, x, y, z);
+  for (size_t i = 0; i < voxel_grids.size(); ++i) {
+    const VoxelAttributeGrid &voxel_grid = voxel_grids[i];
+    const int channels = voxel_grid.channels;
 
-        for (size_t i = 0; i < voxel_grids.size(); ++i) {
-          const VoxelAttributeGrid &voxel_grid = voxel_grids[i];
-          const int channels = voxel_grid.channels;
+    /* Sparse grids skip empty space tile by tile. */
+    if (voxel_grid.sparse_grid) {
+      add_sparse_grid_nodes(builder, *voxel_grid.sparse_grid, clipping);
+      continue;
+    }
 
-          for (int c = 0; c < channels; c++) {
-            if (voxel_grid.data[voxel_index * channels + c] >= clipping) {
-              builder.add_node_with_padding(x, y, z);
-              break;
-            }
+    for (int z = 0; z < resolution.z; ++z) {
+      for (int y = 0; y < resolution.y; ++y) {
+        for (int x = 0; x < resolution.x; ++x) {
+          int64_t voxel_index = compute_voxel_index(resolution, x, y, z);
+
+          if (voxel_is_visible(voxel_grid.data + voxel_index * channels, channels, clipping)) {
+            builder.add_node_with_padding(x, y, z);
           }
         }
       }
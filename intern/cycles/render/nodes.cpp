@@ -354,6 +354,25 @@ void ImageTextureNode::attributes(Shader *shader, AttributeRequestSet *attribute
   ShaderNode::attributes(shader, attributes);
 }
 
+/* Whether the texture coordinates are the default UV map, without modifications. */
+static bool image_vector_is_default_uv(ShaderInput *vector_in)
+{
+  if (vector_in->link == NULL) {
+    return false;
+  }
+
+  ShaderNode *node = vector_in->link->parent;
+  if (node->type == UVMapNode::node_type) {
+    UVMapNode *uvmap = (UVMapNode *)node;
+    return uvmap->attribute.empty() && !uvmap->from_dupli;
+  }
+  else if (node->type == TextureCoordinateNode::node_type) {
+    TextureCoordinateNode *texco = (TextureCoordinateNode *)node;
+    return vector_in->link == node->output("UV") && !texco->from_dupli;
+  }
+  return false;
+}
+
 void ImageTextureNode::compile(SVMCompiler &compiler)
 {
   ShaderInput *vector_in = input("Vector");
@@ -387,6 +406,11 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
     }
   }
 
+  if (projection == NODE_IMAGE_PROJ_FLAT && tex_mapping.skip() &&
+      image_vector_is_default_uv(vector_in)) {
+    flags |= NODE_IMAGE_DEFAULT_UV;
+  }
+
   if (projection != NODE_IMAGE_PROJ_BOX) {
     /* If there only is one image (a very common case), we encode it as a negative value. */
     int num_nodes;
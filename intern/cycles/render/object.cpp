@@ -205,9 +205,9 @@ void Object::apply_transform(bool apply_to_motion)
    * transform_applied boolean */
 }
 
-void Object::tag_update(Scene *scene)
+void Object::tag_update(Scene *scene, bool check_geometry)
 {
-  if (geometry) {
+  if (geometry && check_geometry) {
     if (geometry->transform_applied)
       geometry->need_update = true;
 
@@ -69,7 +69,9 @@ class Object : public Node {
   Object();
   ~Object();
 
-  void tag_update(Scene *scene);
+  /* Geometry is not accessed when check_geometry is false, for when it is being synced in
+   * another thread. Geometry sync tags the same updates itself. */
+  void tag_update(Scene *scene, bool check_geometry = true);
 
   void compute_bounds(bool motion_blur);
   void apply_transform(bool apply_to_motion);
@@ -77,6 +77,7 @@ class DeviceScene {
   /* mesh */
   device_vector<uint> tri_shader;
   device_vector<float4> tri_vnormal;
+  device_vector<uint> tri_vnormal_oct;
   device_vector<uint4> tri_vindex;
   device_vector<uint> tri_patch;
   device_vector<float2> tri_patch_uv;
@@ -101,6 +102,8 @@ class DeviceScene {
   device_vector<float> attributes_float;
   device_vector<float2> attributes_float2;
   device_vector<float4> attributes_float3;
+  device_vector<uint> attributes_float2_packed;
+  device_vector<uint2> attributes_float3_packed;
   device_vector<uchar4> attributes_uchar4;
 
   /* lights */
@@ -108,6 +111,10 @@ class DeviceScene {
   device_vector<KernelLight> lights;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<KernelLightTreeEmitter> light_tree_emitters;
+  device_vector<int> light_tree_emitter_lookup;
+  device_vector<int> light_tree_object_lookup_offset;
 
   /* particles */
   device_vector<KernelParticle> particles;
@@ -171,6 +178,13 @@ class SceneParams {
   bool persistent_data;
   int texture_limit;
 
+  /* Read tiles of large images on demand on the CPU, with a memory limit in megabytes. */
+  bool use_texture_cache;
+  int texture_cache_size;
+
+  /* Store mesh normals and attributes quantized, trading precision for memory. */
+  bool use_compressed_geometry;
+
   bool background;
 
   SceneParams()
@@ -183,6 +197,9 @@ class SceneParams {
     num_bvh_time_steps = 0;
     persistent_data = false;
     texture_limit = 0;
+    use_texture_cache = false;
+    texture_cache_size = 4096;
+    use_compressed_geometry = false;
     background = true;
   }
 
@@ -193,7 +210,10 @@ class SceneParams {
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             use_texture_cache == params.use_texture_cache &&
+             texture_cache_size == params.texture_cache_size &&
+             use_compressed_geometry == params.use_compressed_geometry);
   }
 };
 
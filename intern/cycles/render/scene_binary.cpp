@@ -0,0 +1,582 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/scene_binary.h"
+
+#include "graph/node_binary.h"
+
+#include "render/background.h"
+#include "render/camera.h"
+#include "render/film.h"
+#include "render/graph.h"
+#include "render/hair.h"
+#include "render/integrator.h"
+#include "render/light.h"
+#include "render/mesh.h"
+#include "render/nodes.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "render/shader.h"
+
+#include "subd/subd_dice.h"
+
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_path.h"
+#include "util/util_time.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* File layout: magic and version, followed by records until the end of the file. Each record
+ * starts with its type and the node, followed by data not covered by sockets. */
+
+static const char scene_binary_magic[8] = {'C', 'Y', 'C', 'L', 'E', 'S', 'B', 'N'};
+static const uint scene_binary_version = 1;
+
+enum SceneBinaryRecord {
+  SCENE_BINARY_SHADER = 0,
+  SCENE_BINARY_GEOMETRY,
+  SCENE_BINARY_OBJECT,
+  SCENE_BINARY_LIGHT,
+  SCENE_BINARY_CAMERA,
+  SCENE_BINARY_FILM,
+  SCENE_BINARY_INTEGRATOR,
+  SCENE_BINARY_BACKGROUND,
+};
+
+/* Default shaders are created by the scene, so they are updated rather than added. */
+enum SceneBinaryShaderRole {
+  SCENE_BINARY_SHADER_NONE = 0,
+  SCENE_BINARY_SHADER_SURFACE,
+  SCENE_BINARY_SHADER_VOLUME,
+  SCENE_BINARY_SHADER_LIGHT,
+  SCENE_BINARY_SHADER_BACKGROUND,
+  SCENE_BINARY_SHADER_EMPTY,
+};
+
+static Shader **scene_default_shader(Scene *scene, int role)
+{
+  switch (role) {
+    case SCENE_BINARY_SHADER_SURFACE:
+      return &scene->default_surface;
+    case SCENE_BINARY_SHADER_VOLUME:
+      return &scene->default_volume;
+    case SCENE_BINARY_SHADER_LIGHT:
+      return &scene->default_light;
+    case SCENE_BINARY_SHADER_BACKGROUND:
+      return &scene->default_background;
+    case SCENE_BINARY_SHADER_EMPTY:
+      return &scene->default_empty;
+  }
+  return NULL;
+}
+
+/* Attributes */
+
+static void binary_write_attributes(BinaryWriter &writer, const AttributeSet &attributes)
+{
+  /* Voxel data is an image handle owned by the image manager. */
+  vector<const Attribute *> write_attributes;
+  foreach (const Attribute &attr, attributes.attributes) {
+    if (attr.element != ATTR_ELEMENT_VOXEL) {
+      write_attributes.push_back(&attr);
+    }
+  }
+
+  writer.write_uint(write_attributes.size());
+
+  foreach (const Attribute *attr, write_attributes) {
+    writer.write_string(attr->name.string());
+    writer.write_int(attr->std);
+    writer.write_int(attr->type.basetype);
+    writer.write_int(attr->type.aggregate);
+    writer.write_int(attr->type.vecsemantics);
+    writer.write_int(attr->type.arraylen);
+    writer.write_int(attr->element);
+    writer.write_uint(attr->flags);
+    writer.write_array(attr->buffer.data(), 1, attr->buffer.size());
+  }
+}
+
+static void binary_read_attributes(BinaryReader &reader, AttributeSet &attributes)
+{
+  const uint num_attributes = reader.read_uint();
+
+  for (uint i = 0; i < num_attributes && !reader.has_error(); i++) {
+    const ustring name(reader.read_string());
+    const AttributeStandard std = (AttributeStandard)reader.read_int();
+    const TypeDesc::BASETYPE basetype = (TypeDesc::BASETYPE)reader.read_int();
+    const TypeDesc::AGGREGATE aggregate = (TypeDesc::AGGREGATE)reader.read_int();
+    const TypeDesc::VECSEMANTICS vecsemantics = (TypeDesc::VECSEMANTICS)reader.read_int();
+    const int arraylen = reader.read_int();
+    const AttributeElement element = (AttributeElement)reader.read_int();
+    const uint flags = reader.read_uint();
+
+    size_t size;
+    const char *data = (const char *)reader.read_array(1, &size);
+
+    if (reader.has_error()) {
+      break;
+    }
+
+    const TypeDesc type(basetype, aggregate, vecsemantics, arraylen);
+    Attribute *attr = attributes.add(name, type, element);
+    attr->std = std;
+    attr->flags = flags;
+    attr->buffer.assign(data, data + size);
+  }
+}
+
+/* Shaders */
+
+static void binary_write_shader(BinaryWriter &writer, Scene *scene, Shader *shader)
+{
+  int role = SCENE_BINARY_SHADER_NONE;
+  for (int i = SCENE_BINARY_SHADER_SURFACE; i <= SCENE_BINARY_SHADER_EMPTY; i++) {
+    if (*scene_default_shader(scene, i) == shader) {
+      role = i;
+      break;
+    }
+  }
+
+  writer.write_uint(SCENE_BINARY_SHADER);
+  writer.write_int(role);
+  binary_write_node(writer, shader);
+  writer.add_node(shader);
+
+  /* Graph nodes, referenced by their index in links. */
+  ShaderGraph *graph = shader->graph;
+  map<ShaderNode *, int> node_index;
+
+  writer.write_uint((graph) ? graph->nodes.size() : 0);
+  if (graph == NULL) {
+    writer.write_uint(0);
+    return;
+  }
+
+  foreach (ShaderNode *node, graph->nodes) {
+    const int index = node_index.size();
+    node_index[node] = index;
+    binary_write_node(writer, node);
+  }
+
+  /* Links. */
+  vector<ShaderInput *> linked_inputs;
+  foreach (ShaderNode *node, graph->nodes) {
+    foreach (ShaderInput *input, node->inputs) {
+      if (input->link) {
+        linked_inputs.push_back(input);
+      }
+    }
+  }
+
+  writer.write_uint(linked_inputs.size());
+  foreach (ShaderInput *input, linked_inputs) {
+    writer.write_int(node_index[input->link->parent]);
+    writer.write_string(input->link->socket_type.name.string());
+    writer.write_int(node_index[input->parent]);
+    writer.write_string(input->socket_type.name.string());
+  }
+}
+
+static bool binary_read_shader(BinaryReader &reader, Scene *scene)
+{
+  const int role = reader.read_int();
+  const string type_name = reader.read_string();
+  if (type_name != Shader::node_type->name.string()) {
+    return false;
+  }
+
+  Shader **default_shader = scene_default_shader(scene, role);
+  Shader *shader = (default_shader) ? *default_shader : new Shader();
+
+  if (!binary_read_node(reader, shader)) {
+    if (!default_shader) {
+      delete shader;
+    }
+    return false;
+  }
+
+  if (!default_shader) {
+    scene->shaders.push_back(shader);
+  }
+  reader.add_node(shader);
+
+  /* Graph nodes. */
+  ShaderGraph *graph = new ShaderGraph();
+  vector<ShaderNode *> nodes;
+  const uint num_nodes = reader.read_uint();
+
+  for (uint i = 0; i < num_nodes && !reader.has_error(); i++) {
+    const ustring node_type_name(reader.read_string());
+    ShaderNode *snode = NULL;
+
+    if (node_type_name == OutputNode::node_type->name) {
+      snode = graph->output();
+    }
+    else {
+      const NodeType *node_type = NodeType::find(node_type_name);
+
+      if (node_type && node_type->type == NodeType::SHADER && node_type->create) {
+        snode = (ShaderNode *)node_type->create(node_type);
+        graph->add(snode);
+      }
+      else {
+        fprintf(stderr, "Unknown shader node \"%s\".\n", node_type_name.c_str());
+      }
+    }
+
+    /* Unknown nodes are skipped, links to them are ignored. */
+    binary_read_node(reader, snode);
+    nodes.push_back(snode);
+  }
+
+  /* Links. */
+  const uint num_links = reader.read_uint();
+
+  for (uint i = 0; i < num_links && !reader.has_error(); i++) {
+    const int from_index = reader.read_int();
+    const ustring from_socket_name(reader.read_string());
+    const int to_index = reader.read_int();
+    const ustring to_socket_name(reader.read_string());
+
+    if (from_index < 0 || from_index >= (int)nodes.size() || to_index < 0 ||
+        to_index >= (int)nodes.size() || !nodes[from_index] || !nodes[to_index]) {
+      continue;
+    }
+
+    ShaderOutput *output = nodes[from_index]->output(from_socket_name);
+    ShaderInput *input = nodes[to_index]->input(to_socket_name);
+
+    if (output && input) {
+      graph->connect(output, input);
+    }
+  }
+
+  shader->set_graph(graph);
+  shader->tag_update(scene);
+
+  return !reader.has_error();
+}
+
+/* Geometry */
+
+static void binary_write_geometry(BinaryWriter &writer, Geometry *geom)
+{
+  writer.write_uint(SCENE_BINARY_GEOMETRY);
+  binary_write_node(writer, geom);
+  writer.add_node(geom);
+
+  writer.write_uint(geom->used_shaders.size());
+  foreach (Shader *shader, geom->used_shaders) {
+    writer.write_int(writer.find_node(shader));
+  }
+
+  binary_write_attributes(writer, geom->attributes);
+
+  if (geom->type == Geometry::MESH) {
+    Mesh *mesh = static_cast<Mesh *>(geom);
+
+    writer.write_float(mesh->volume_clipping);
+    writer.write_float(mesh->volume_step_size);
+    writer.write_int(mesh->volume_object_space);
+
+    writer.write_int(mesh->subdivision_type);
+    if (mesh->subdivision_type != Mesh::SUBDIVISION_NONE) {
+      writer.write_array(
+          mesh->subd_faces.data(), sizeof(Mesh::SubdFace), mesh->subd_faces.size());
+      writer.write_array(
+          mesh->subd_face_corners.data(), sizeof(int), mesh->subd_face_corners.size());
+      writer.write_int(mesh->num_ngons);
+      writer.write_array(
+          mesh->subd_creases.data(), sizeof(Mesh::SubdEdgeCrease), mesh->subd_creases.size());
+
+      const SubdParams default_params(mesh);
+      const SubdParams &params = (mesh->subd_params) ? *mesh->subd_params : default_params;
+      writer.write_float(params.dicing_rate);
+      writer.write_int(params.max_level);
+      writer.write(&params.objecttoworld, sizeof(params.objecttoworld));
+
+      binary_write_attributes(writer, mesh->subd_attributes);
+    }
+  }
+}
+
+template<typename T>
+static void binary_read_raw_array(BinaryReader &reader, array<T> &value)
+{
+  size_t num_elements;
+  const void *data = reader.read_array(sizeof(T), &num_elements);
+
+  value.clear();
+  if (num_elements) {
+    memcpy(value.resize(num_elements), data, sizeof(T) * num_elements);
+  }
+}
+
+static bool binary_read_geometry(BinaryReader &reader, Scene *scene)
+{
+  const ustring type_name(reader.read_string());
+  Geometry *geom = NULL;
+
+  if (type_name == Mesh::node_type->name) {
+    geom = new Mesh();
+  }
+  else if (type_name == Hair::node_type->name) {
+    geom = new Hair();
+  }
+  else {
+    fprintf(stderr, "Unknown geometry type \"%s\".\n", type_name.c_str());
+    return false;
+  }
+
+  scene->geometry.push_back(geom);
+
+  if (!binary_read_node(reader, geom)) {
+    return false;
+  }
+  reader.add_node(geom);
+
+  const uint num_shaders = reader.read_uint();
+  for (uint i = 0; i < num_shaders && !reader.has_error(); i++) {
+    Node *shader = reader.find_node(reader.read_int());
+    geom->used_shaders.push_back((shader && shader->is_a(Shader::node_type)) ?
+                                     static_cast<Shader *>(shader) :
+                                     scene->default_surface);
+  }
+
+  binary_read_attributes(reader, geom->attributes);
+
+  if (geom->type == Geometry::MESH) {
+    Mesh *mesh = static_cast<Mesh *>(geom);
+
+    mesh->volume_clipping = reader.read_float();
+    mesh->volume_step_size = reader.read_float();
+    mesh->volume_object_space = reader.read_int() != 0;
+
+    mesh->subdivision_type = (Mesh::SubdivisionType)reader.read_int();
+    if (mesh->subdivision_type != Mesh::SUBDIVISION_NONE) {
+      binary_read_raw_array(reader, mesh->subd_faces);
+      binary_read_raw_array(reader, mesh->subd_face_corners);
+      mesh->num_ngons = reader.read_int();
+      binary_read_raw_array(reader, mesh->subd_creases);
+
+      mesh->subd_params = new SubdParams(mesh);
+      mesh->subd_params->dicing_rate = reader.read_float();
+      mesh->subd_params->max_level = reader.read_int();
+      reader.read(&mesh->subd_params->objecttoworld, sizeof(Transform));
+      mesh->subd_params->camera = scene->dicing_camera;
+
+      binary_read_attributes(reader, mesh->subd_attributes);
+    }
+  }
+
+  return !reader.has_error();
+}
+
+/* Scene */
+
+bool scene_binary_is_file(const string &filepath)
+{
+  FILE *f = path_fopen(filepath, "rb");
+  if (f == NULL) {
+    return false;
+  }
+
+  char magic[sizeof(scene_binary_magic)];
+  const bool is_binary = fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+                         memcmp(magic, scene_binary_magic, sizeof(magic)) == 0;
+  fclose(f);
+
+  return is_binary;
+}
+
+bool scene_binary_write(Scene *scene, const string &filepath)
+{
+  const double time_start = time_dt();
+  BinaryWriter writer(filepath);
+
+  if (!writer.is_open()) {
+    fprintf(stderr, "Failed to open \"%s\" for writing.\n", filepath.c_str());
+    return false;
+  }
+
+  writer.write(scene_binary_magic, sizeof(scene_binary_magic));
+  writer.write_uint(scene_binary_version);
+
+  /* Referenced nodes are written first. */
+  foreach (Shader *shader, scene->shaders) {
+    binary_write_shader(writer, scene, shader);
+  }
+
+  foreach (Geometry *geom, scene->geometry) {
+    binary_write_geometry(writer, geom);
+  }
+
+  foreach (Object *object, scene->objects) {
+    writer.write_uint(SCENE_BINARY_OBJECT);
+    binary_write_node(writer, object);
+  }
+
+  foreach (Light *light, scene->lights) {
+    writer.write_uint(SCENE_BINARY_LIGHT);
+    binary_write_node(writer, light);
+  }
+
+  Camera *cam = scene->camera;
+  writer.write_uint(SCENE_BINARY_CAMERA);
+  binary_write_node(writer, cam);
+  writer.write_int(cam->width);
+  writer.write_int(cam->height);
+  writer.write_int(cam->full_width);
+  writer.write_int(cam->full_height);
+
+  writer.write_uint(SCENE_BINARY_FILM);
+  binary_write_node(writer, scene->film);
+
+  writer.write_uint(SCENE_BINARY_INTEGRATOR);
+  binary_write_node(writer, scene->integrator);
+
+  writer.write_uint(SCENE_BINARY_BACKGROUND);
+  binary_write_node(writer, scene->background);
+
+  if (writer.has_error()) {
+    fprintf(stderr, "Failed to write \"%s\".\n", filepath.c_str());
+    return false;
+  }
+
+  VLOG(1) << "Wrote binary scene " << filepath << " with " << scene->geometry.size()
+          << " geometries and " << scene->objects.size() << " objects in "
+          << time_dt() - time_start << "s.";
+
+  return true;
+}
+
+bool scene_binary_read(Scene *scene, const string &filepath)
+{
+  const double time_start = time_dt();
+  BinaryReader reader(filepath);
+
+  if (!reader.is_open()) {
+    fprintf(stderr, "Failed to open \"%s\".\n", filepath.c_str());
+    return false;
+  }
+
+  char magic[sizeof(scene_binary_magic)];
+  reader.read(magic, sizeof(magic));
+  if (memcmp(magic, scene_binary_magic, sizeof(magic)) != 0) {
+    fprintf(stderr, "\"%s\" is not a binary scene file.\n", filepath.c_str());
+    return false;
+  }
+
+  const uint version = reader.read_uint();
+  if (version != scene_binary_version) {
+    fprintf(stderr,
+            "Binary scene \"%s\" has version %u, expected %u.\n",
+            filepath.c_str(),
+            version,
+            scene_binary_version);
+    return false;
+  }
+
+  bool success = true;
+
+  while (success && !reader.at_end()) {
+    const SceneBinaryRecord record = (SceneBinaryRecord)reader.read_uint();
+
+    switch (record) {
+      case SCENE_BINARY_SHADER:
+        success = binary_read_shader(reader, scene);
+        break;
+      case SCENE_BINARY_GEOMETRY:
+        success = binary_read_geometry(reader, scene);
+        break;
+      case SCENE_BINARY_OBJECT: {
+        success = (reader.read_string() == Object::node_type->name.string());
+        if (!success) {
+          break;
+        }
+
+        Object *object = new Object();
+        success = binary_read_node(reader, object);
+
+        /* Objects are useless without geometry, and the scene expects them to have one. */
+        if (object->geometry) {
+          scene->objects.push_back(object);
+        }
+        else {
+          delete object;
+        }
+        break;
+      }
+      case SCENE_BINARY_LIGHT: {
+        success = (reader.read_string() == Light::node_type->name.string());
+        if (!success) {
+          break;
+        }
+
+        Light *light = new Light();
+        scene->lights.push_back(light);
+        success = binary_read_node(reader, light);
+        break;
+      }
+      case SCENE_BINARY_CAMERA: {
+        Camera *cam = scene->camera;
+        success = (reader.read_string() == Camera::node_type->name.string()) &&
+                  binary_read_node(reader, cam);
+        cam->width = reader.read_int();
+        cam->height = reader.read_int();
+        cam->full_width = reader.read_int();
+        cam->full_height = reader.read_int();
+        cam->need_update = true;
+        break;
+      }
+      case SCENE_BINARY_FILM:
+        success = (reader.read_string() == Film::node_type->name.string()) &&
+                  binary_read_node(reader, scene->film);
+        scene->film->tag_update(scene);
+        break;
+      case SCENE_BINARY_INTEGRATOR:
+        success = (reader.read_string() == Integrator::node_type->name.string()) &&
+                  binary_read_node(reader, scene->integrator);
+        scene->integrator->tag_update(scene);
+        break;
+      case SCENE_BINARY_BACKGROUND:
+        success = (reader.read_string() == Background::node_type->name.string()) &&
+                  binary_read_node(reader, scene->background);
+        scene->background->tag_update(scene);
+        break;
+      default:
+        success = false;
+        break;
+    }
+  }
+
+  if (!success || reader.has_error()) {
+    fprintf(stderr, "Failed to read binary scene \"%s\".\n", filepath.c_str());
+    return false;
+  }
+
+  scene->params.bvh_type = SceneParams::BVH_STATIC;
+
+  VLOG(1) << "Read binary scene " << filepath << " with " << scene->geometry.size()
+          << " geometries and " << scene->objects.size() << " objects in "
+          << time_dt() - time_start << "s.";
+
+  return true;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SCENE_BINARY_H__
+#define __SCENE_BINARY_H__
+
+#include "util/util_string.h"
+
+CCL_NAMESPACE_BEGIN
+
+class Scene;
+
+/* Binary Scene Files
+ *
+ * Snapshot of a synchronized scene, for rendering it with the standalone application without
+ * the host application. Shaders, geometry, objects, lights, camera, film, integrator and
+ * background are stored through their node sockets, geometry arrays and attributes are stored
+ * raw so loading is dominated by copying memory.
+ *
+ * Images are referenced by file path, images that only exist in the host application (packed
+ * or generated images, volume grids) and OSL script nodes are not stored. */
+
+bool scene_binary_is_file(const string &filepath);
+bool scene_binary_write(Scene *scene, const string &filepath);
+bool scene_binary_read(Scene *scene, const string &filepath);
+
+CCL_NAMESPACE_END
+
+#endif /* __SCENE_BINARY_H__ */
@@ -21,6 +21,7 @@
 #include "render/bake.h"
 #include "render/buffers.h"
 #include "render/camera.h"
+#include "render/checkpoint.h"
 #include "render/graph.h"
 #include "render/integrator.h"
 #include "render/light.h"
@@ -74,6 +75,7 @@ Session::Session(const SessionParams &params_)
 
   session_thread = NULL;
   scene = NULL;
+  checkpoint = NULL;
 
   reset_time = 0.0;
   last_update_time = 0.0;
@@ -126,6 +128,8 @@ Session::~Session()
   /* clean up */
   tile_manager.device_free();
 
+  delete checkpoint;
+
   delete buffers;
   delete display;
   delete scene;
@@ -392,14 +396,18 @@ bool Session::acquire_tile(RenderTile &rtile, Device *tile_device, uint tile_typ
   Tile *tile;
   int device_num = device->device_number(tile_device);
 
-  while (!tile_manager.next_tile(tile, device_num, tile_types)) {
-    /* Wait for denoising tiles to become available */
-    if ((tile_types & RenderTile::DENOISE) && !progress.get_cancel() && tile_manager.has_tiles()) {
-      denoising_cond.wait(tile_lock);
-      continue;
+  do {
+    while (!tile_manager.next_tile(tile, device_num, tile_types)) {
+      /* Wait for denoising tiles to become available */
+      if ((tile_types & RenderTile::DENOISE) && !progress.get_cancel() &&
+          tile_manager.has_tiles()) {
+        denoising_cond.wait(tile_lock);
+        continue;
+      }
+      return false;
     }
-    return false;
-  }
+    /* Tiles that were completed before the render got interrupted are passed on directly. */
+  } while (checkpoint && checkpoint_restore_tile(tile, tile_device));
 
   /* fill render tile */
   rtile.x = tile_manager.state.buffer.full_x + tile->x;
@@ -441,6 +449,18 @@ bool Session::acquire_tile(RenderTile &rtile, Device *tile_device, uint tile_typ
     /* allocate buffers */
     tile->buffers = new RenderBuffers(tile_device);
     tile->buffers->reset(buffer_params);
+
+    /* Continue partially rendered tiles from the checkpoint. With adaptive sampling the
+     * buffers were already post-processed, so those tiles are rendered again. */
+    if (checkpoint && !params.adaptive_sampling) {
+      const int resume_samples = checkpoint->tile_samples(tile->index);
+      if (resume_samples > 0 && resume_samples < rtile.num_samples) {
+        checkpoint->read_tile(tile->index, tile->buffers);
+        rtile.start_sample += resume_samples;
+        rtile.num_samples -= resume_samples;
+        progress.add_samples((uint64_t)rtile.w * rtile.h * resume_samples, rtile.start_sample);
+      }
+    }
   }
 
   tile->buffers->map_neighbor_copied = false;
@@ -449,7 +469,7 @@ bool Session::acquire_tile(RenderTile &rtile, Device *tile_device, uint tile_typ
 
   rtile.buffer = tile->buffers->buffer.device_pointer;
   rtile.buffers = tile->buffers;
-  rtile.sample = tile_manager.state.sample;
+  rtile.sample = rtile.start_sample;
 
   /* this will tag tile as IN PROGRESS in blender-side render pipeline,
    * which is needed to highlight currently rendering tile before first
@@ -488,6 +508,11 @@ void Session::release_tile(RenderTile &rtile, const bool need_denoise)
       write_render_tile_cb(rtile);
     }
 
+    if (checkpoint && rtile.task == RenderTile::PATH_TRACE) {
+      checkpoint->write_tile(
+          rtile.tile_index, rtile.buffers, rtile.sample - tile_manager.state.sample);
+    }
+
     if (delete_tile) {
       delete rtile.buffers;
       tile_manager.state.tiles[rtile.tile_index].buffers = NULL;
@@ -586,6 +611,93 @@ void Session::unmap_neighbor_tiles(RenderTile *tiles, Device *tile_device)
   device->unmap_neighbor_tiles(tile_device, tiles);
 }
 
+void Session::checkpoint_begin(bool need_denoise)
+{
+  if (checkpoint || params.checkpoint_filepath.empty()) {
+    return;
+  }
+
+  /* Tiles must be rendered once with all samples, and not depend on their neighbors. */
+  if (!params.background || params.progressive_refine || buffers ||
+      (need_denoise && tile_manager.schedule_denoising)) {
+    VLOG(1) << "Render checkpoint not supported with progressive refine or denoising.";
+    return;
+  }
+
+  scoped_timer timer;
+  const string key = RenderCheckpoint::compute_key(
+      scene, tile_manager.params, params.tile_size, tile_manager.range_start_sample);
+  VLOG(1) << "Render checkpoint key " << key << " computed in " << timer.get_time()
+          << " seconds.";
+
+  checkpoint = new RenderCheckpoint(params.checkpoint_filepath, params.checkpoint_interval);
+  if (checkpoint->begin(key, tile_manager.params, tile_manager.state.tiles)) {
+    progress.set_status("Resuming from checkpoint");
+  }
+}
+
+void Session::checkpoint_end()
+{
+  if (checkpoint == NULL) {
+    return;
+  }
+
+  checkpoint->end(!progress.get_cancel() && !tile_manager.has_tiles());
+  delete checkpoint;
+  checkpoint = NULL;
+}
+
+bool Session::checkpoint_restore_tile(Tile *tile, Device *tile_device)
+{
+  if (tile->state != Tile::RENDER ||
+      checkpoint->tile_samples(tile->index) != tile_manager.state.num_samples) {
+    return false;
+  }
+
+  RenderTile rtile;
+  rtile.x = tile_manager.state.buffer.full_x + tile->x;
+  rtile.y = tile_manager.state.buffer.full_y + tile->y;
+  rtile.w = tile->w;
+  rtile.h = tile->h;
+  rtile.start_sample = tile_manager.state.sample;
+  rtile.num_samples = tile_manager.state.num_samples;
+  rtile.sample = rtile.start_sample + rtile.num_samples;
+  rtile.resolution = tile_manager.state.resolution_divider;
+  rtile.tile_index = tile->index;
+  rtile.task = RenderTile::PATH_TRACE;
+
+  BufferParams buffer_params = tile_manager.params;
+  buffer_params.full_x = rtile.x;
+  buffer_params.full_y = rtile.y;
+  buffer_params.width = rtile.w;
+  buffer_params.height = rtile.h;
+
+  tile->buffers = new RenderBuffers(tile_device);
+  tile->buffers->reset(buffer_params);
+  checkpoint->read_tile(tile->index, tile->buffers);
+
+  tile->buffers->params.get_offset_stride(rtile.offset, rtile.stride);
+  rtile.buffer = tile->buffers->buffer.device_pointer;
+  rtile.buffers = tile->buffers;
+
+  progress.add_samples((uint64_t)rtile.w * rtile.h * rtile.num_samples, rtile.sample);
+  progress.add_finished_tile(false);
+
+  bool delete_tile;
+  tile_manager.finish_tile(tile->index, false, delete_tile);
+
+  if (write_render_tile_cb) {
+    write_render_tile_cb(rtile);
+  }
+
+  if (delete_tile) {
+    delete tile->buffers;
+    tile->buffers = NULL;
+  }
+
+  return true;
+}
+
 void Session::run_cpu()
 {
   bool tiles_written = false;
@@ -840,6 +952,8 @@ void Session::run()
       run_gpu();
     else
       run_cpu();
+
+    checkpoint_end();
   }
 
   profiler.stop();
@@ -920,6 +1034,12 @@ void Session::set_denoising(bool denoising, bool optix_denoising)
   /* Lock buffers so no denoising operation is triggered while the settings are changed here. */
   thread_scoped_lock buffers_lock(buffers_mutex);
 
+  /* Network devices don't denoise, see #NetworkDevice::task_add. */
+  if (params.device.type == DEVICE_NETWORK) {
+    denoising = false;
+    optix_denoising = false;
+  }
+
   params.run_denoising = denoising;
   params.full_denoising = !optix_denoising;
   params.optix_denoising = optix_denoising;
@@ -1129,6 +1249,8 @@ void Session::render(bool need_denoise)
     return; /* Avoid empty launches. */
   }
 
+  checkpoint_begin(need_denoise);
+
   /* Add path trace task. */
   DeviceTask task(DeviceTask::RENDER);
 
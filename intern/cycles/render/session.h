@@ -32,6 +32,7 @@ CCL_NAMESPACE_BEGIN
 
 class BufferParams;
 class Device;
+class RenderCheckpoint;
 class DeviceScene;
 class DeviceRequestedFeatures;
 class DisplayBuffer;
@@ -73,6 +74,11 @@ class SessionParams {
   double text_timeout;
   double progressive_update_timeout;
 
+  /* Periodically save rendered tiles to this file and resume from it, for background
+   * renders without progressive refine. Empty to disable. */
+  string checkpoint_filepath;
+  double checkpoint_interval;
+
   ShadingSystem shadingsystem;
 
   function<bool(const uchar *pixels, int width, int height, int channels)> write_render_cb;
@@ -106,6 +112,8 @@ class SessionParams {
     text_timeout = 1.0;
     progressive_update_timeout = 1.0;
 
+    checkpoint_interval = 300.0;
+
     shadingsystem = SHADINGSYSTEM_SVM;
     tile_order = TILE_CENTER;
   }
@@ -208,6 +216,13 @@ class Session {
   void map_neighbor_tiles(RenderTile *tiles, Device *tile_device);
   void unmap_neighbor_tiles(RenderTile *tiles, Device *tile_device);
 
+  /* Render checkpoint. */
+  void checkpoint_begin(bool need_denoise);
+  void checkpoint_end();
+  bool checkpoint_restore_tile(Tile *tile, Device *tile_device);
+
+  RenderCheckpoint *checkpoint;
+
   bool device_use_gl;
 
   thread *session_thread;
@@ -200,6 +200,7 @@ string NamedSampleCountStats::full_report(int indent_level)
 
 MeshStats::MeshStats()
 {
+  compressed_bytes_saved = 0;
 }
 
 string MeshStats::full_report(int indent_level)
@@ -207,6 +208,11 @@ string MeshStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Geometry:\n" + geometry.full_report(indent_level + 1);
+  if (compressed_bytes_saved) {
+    result += string_printf("%sCompressed storage saved: %s\n",
+                            indent.c_str(),
+                            string_human_readable_size(compressed_bytes_saved).c_str());
+  }
   return result;
 }
 
@@ -214,6 +220,7 @@ string MeshStats::full_report(int indent_level)
 
 ImageStats::ImageStats()
 {
+  has_texture_cache = false;
 }
 
 string ImageStats::full_report(int indent_level)
@@ -221,6 +228,32 @@ string ImageStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+
+  if (has_texture_cache) {
+    const string sub_indent((indent_level + 1) * kIndentNumSpaces, ' ');
+    const double hit_rate = (texture_cache.lookups) ?
+                                (double)texture_cache.hits / texture_cache.lookups :
+                                0.0;
+    result += indent + "Texture Cache:\n";
+    result += string_printf("%sFiles: %d\n", sub_indent.c_str(), texture_cache.num_files);
+    result += string_printf("%sTile lookups: %s\n",
+                            sub_indent.c_str(),
+                            string_human_readable_number(texture_cache.lookups).c_str());
+    result += string_printf("%sHits: %s (%.2f%%)\n",
+                            sub_indent.c_str(),
+                            string_human_readable_number(texture_cache.hits).c_str(),
+                            hit_rate * 100.0);
+    result += string_printf("%sMisses: %s\n",
+                            sub_indent.c_str(),
+                            string_human_readable_number(texture_cache.misses).c_str());
+    result += string_printf("%sRead from disk: %s\n",
+                            sub_indent.c_str(),
+                            string_human_readable_size(texture_cache.bytes_read).c_str());
+    result += string_printf("%sMemory: %s\n",
+                            sub_indent.c_str(),
+                            string_human_readable_size(texture_cache.memory_used).c_str());
+  }
+
   return result;
 }
 
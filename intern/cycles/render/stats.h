@@ -21,6 +21,7 @@
 
 #include "util/util_stats.h"
 #include "util/util_string.h"
+#include "util/util_texture_cache.h"
 #include "util/util_vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -122,6 +123,9 @@ class MeshStats {
    * memory like BVH.
    */
   NamedSizeStats geometry;
+
+  /* Device memory saved by quantized normals and attributes. */
+  size_t compressed_bytes_saved;
 };
 
 /* Statistics about images held in memory. */
@@ -133,6 +137,10 @@ class ImageStats {
   string full_report(int indent_level = 0);
 
   NamedSizeStats textures;
+
+  /* Tile statistics when images are read through the texture cache. */
+  bool has_texture_cache;
+  TextureCacheStats texture_cache;
 };
 
 /* Render process statistics. */
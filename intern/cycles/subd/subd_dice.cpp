@@ -20,8 +20,88 @@
 #include "subd/subd_dice.h"
 #include "subd/subd_patch.h"
 
+#include "util/util_atomic.h"
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_murmurhash.h"
+#include "util/util_string.h"
+#include "util/util_task.h"
+
 CCL_NAMESPACE_BEGIN
 
+/* Subpatches diced by a single task. */
+#define DICE_SUBPATCHES_PER_TASK 64
+
+/* Diced Grid */
+
+void DicedGrid::eval(Patch *patch, int index, float2 patch_uv)
+{
+  patch->eval(&P[index], NULL, NULL, &N[index], patch_uv.x, patch_uv.y);
+  uv[index] = patch_uv;
+}
+
+/* Dice Cache */
+
+DiceCache::Key::Key(const Subpatch &sub) : patch_index(sub.patch->patch_index)
+{
+  for (int i = 0; i < 4; i++) {
+    T[i] = sub.edges[i].T;
+    corners[i] = sub.corners[i];
+  }
+}
+
+bool DiceCache::Key::operator==(const Key &other) const
+{
+  return memcmp(this, &other, sizeof(Key)) == 0;
+}
+
+size_t DiceCache::KeyHasher::operator()(const Key &key) const
+{
+  return util_murmur_hash3(&key, sizeof(Key), 0);
+}
+
+DiceCache::DiceCache() : input_hash(0)
+{
+}
+
+void DiceCache::begin(uint input_hash_)
+{
+  if (input_hash != input_hash_) {
+    grids.clear();
+    input_hash = input_hash_;
+  }
+}
+
+DicedGrid *DiceCache::find(const Subpatch &sub)
+{
+  /* Lookups from multiple threads are safe, the map is only modified in end(). */
+  unordered_map<Key, DicedGrid, KeyHasher>::iterator it = grids.find(Key(sub));
+  return (it != grids.end()) ? &it->second : NULL;
+}
+
+void DiceCache::end(const vector<Subpatch> &subpatches, vector<DicedGrid> &new_grids)
+{
+  grids.clear();
+
+  for (size_t i = 0; i < subpatches.size(); i++) {
+    DicedGrid &grid = grids[Key(subpatches[i])];
+    grid.P.swap(new_grids[i].P);
+    grid.N.swap(new_grids[i].N);
+    grid.uv.swap(new_grids[i].uv);
+  }
+}
+
+size_t DiceCache::memory_size() const
+{
+  size_t size = 0;
+  for (unordered_map<Key, DicedGrid, KeyHasher>::const_iterator it = grids.begin();
+       it != grids.end();
+       it++) {
+    size += it->second.P.size() * (sizeof(float3) * 2 + sizeof(float2));
+  }
+  return size;
+}
+
 /* EdgeDice Base */
 
 EdgeDice::EdgeDice(const SubdParams &params_) : params(params_)
@@ -45,8 +125,8 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   vert_offset = mesh->verts.size();
   tri_offset = mesh->num_triangles();
 
-  mesh->resize_mesh(mesh->verts.size() + num_verts, mesh->num_triangles());
-  mesh->reserve_mesh(mesh->verts.size() + num_verts, mesh->num_triangles() + num_triangles);
+  /* Triangles are written at known offsets, so subpatches can be diced in parallel. */
+  mesh->resize_mesh(mesh->verts.size() + num_verts, mesh->num_triangles() + num_triangles);
 
   Attribute *attr_vN = mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 
@@ -69,17 +149,22 @@ void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
   params.mesh->vert_patch_uv[index + vert_offset] = make_float2(uv.x, uv.y);
 }
 
-void EdgeDice::add_triangle(Patch *patch, int v0, int v1, int v2)
+void EdgeDice::add_triangle(Patch *patch, int tri, int v0, int v1, int v2)
 {
   Mesh *mesh = params.mesh;
+  const size_t index = tri_offset + tri;
 
-  mesh->add_triangle(v0 + vert_offset, v1 + vert_offset, v2 + vert_offset, patch->shader, true);
-  params.mesh->triangle_patch[params.mesh->num_triangles() - 1] = patch->patch_index;
+  assert(index < mesh->num_triangles());
 
-  tri_offset++;
+  mesh->triangles[index * 3 + 0] = v0 + vert_offset;
+  mesh->triangles[index * 3 + 1] = v1 + vert_offset;
+  mesh->triangles[index * 3 + 2] = v2 + vert_offset;
+  mesh->shader[index] = patch->shader;
+  mesh->smooth[index] = true;
+  mesh->triangle_patch[index] = patch->patch_index;
 }
 
-void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
+void EdgeDice::stitch_triangles(Subpatch &sub, int edge, int &tri)
 {
   int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
   int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
@@ -122,13 +207,13 @@ void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
         v2 = sub.get_vert_along_grid_edge(edge, ++i);
     }
 
-    add_triangle(sub.patch, v1, v0, v2);
+    add_triangle(sub.patch, tri++, v1, v0, v2);
   }
 }
 
 /* QuadDice */
 
-QuadDice::QuadDice(const SubdParams &params_) : EdgeDice(params_)
+QuadDice::QuadDice(const SubdParams &params_) : EdgeDice(params_), num_cache_hits(0)
 {
 }
 
@@ -152,41 +237,96 @@ float3 QuadDice::eval_projected(Subpatch &sub, float u, float v)
   return P;
 }
 
-void QuadDice::set_vert(Subpatch &sub, int index, float u, float v)
+float2 QuadDice::map_side_uv(Subpatch &sub, int edge, float f)
 {
-  EdgeDice::set_vert(sub.patch, index, map_uv(sub, u, v));
+  /* map position along the edge of the subpatch to patch parametric coordinates */
+  switch (edge) {
+    case 0:
+      return map_uv(sub, 0.0f, f);
+    case 1:
+      return map_uv(sub, f, 1.0f);
+    case 2:
+      return map_uv(sub, 1.0f, 1.0f - f);
+    case 3:
+    default:
+      return map_uv(sub, 1.0f - f, 0.0f);
+  }
 }
 
-void QuadDice::set_side(Subpatch &sub, int edge)
+void QuadDice::eval_grid(Subpatch &sub, DicedGrid &grid, bool store_inner)
 {
-  int t = sub.edges[edge].T;
-
-  /* set verts on the edge of the patch */
-  for (int i = 0; i < t; i++) {
-    float f = i / (float)t;
-
-    float u, v;
-    switch (edge) {
-      case 0:
-        u = 0;
-        v = f;
-        break;
-      case 1:
-        u = f;
-        v = 1;
-        break;
-      case 2:
-        u = 1;
-        v = 1.0f - f;
-        break;
-      case 3:
-      default:
-        u = 1.0f - f;
-        v = 0;
-        break;
+  int Mu = max(max(sub.edge_u0.T, sub.edge_u1.T), 2);
+  int Mv = max(max(sub.edge_v0.T, sub.edge_v1.T), 2);
+
+  int num_side_verts = sub.edge_v0.T + sub.edge_u1.T + sub.edge_v1.T + sub.edge_u0.T;
+  int num_inner_verts = (Mu - 1) * (Mv - 1);
+
+  grid.resize(num_side_verts + ((store_inner) ? num_inner_verts : 0));
+
+  /* verts on the edges of the patch, shared with neighbors so they are set later */
+  int index = 0;
+
+  for (int edge = 0; edge < 4; edge++) {
+    int t = sub.edges[edge].T;
+
+    for (int i = 0; i < t; i++, index++) {
+      grid.eval(sub.patch, index, map_side_uv(sub, edge, i / (float)t));
     }
+  }
+
+  /* inner grid verts are only used by this subpatch */
+  float du = 1.0f / (float)Mu;
+  float dv = 1.0f / (float)Mv;
 
-    set_vert(sub, sub.get_vert_along_edge(edge, i), u, v);
+  for (int j = 1; j < Mv; j++) {
+    for (int i = 1; i < Mu; i++) {
+      int inner_index = (i - 1) + (j - 1) * (Mu - 1);
+      float2 uv = map_uv(sub, i * du, j * dv);
+
+      if (store_inner) {
+        grid.eval(sub.patch, num_side_verts + inner_index, uv);
+      }
+      else {
+        EdgeDice::set_vert(sub.patch, sub.inner_grid_vert_offset + inner_index, uv);
+      }
+    }
+  }
+
+  if (store_inner) {
+    set_grid(sub, grid);
+  }
+}
+
+void QuadDice::set_grid(Subpatch &sub, const DicedGrid &grid)
+{
+  int num_side_verts = sub.edge_v0.T + sub.edge_u1.T + sub.edge_v1.T + sub.edge_u0.T;
+  int num_inner_verts = sub.calc_num_inner_verts();
+
+  assert(grid.P.size() == num_side_verts + num_inner_verts);
+
+  for (int i = 0; i < num_inner_verts; i++) {
+    int index = sub.inner_grid_vert_offset + i;
+
+    mesh_P[index] = grid.P[num_side_verts + i];
+    mesh_N[index] = grid.N[num_side_verts + i];
+    params.mesh->vert_patch_uv[index + vert_offset] = grid.uv[num_side_verts + i];
+  }
+}
+
+void QuadDice::set_sides(Subpatch &sub, const DicedGrid &grid)
+{
+  int index = 0;
+
+  for (int edge = 0; edge < 4; edge++) {
+    int t = sub.edges[edge].T;
+
+    for (int i = 0; i < t; i++, index++) {
+      int vert = sub.get_vert_along_edge(edge, i);
+
+      mesh_P[vert] = grid.P[index];
+      mesh_N[vert] = grid.N[index];
+      params.mesh->vert_patch_uv[vert + vert_offset] = grid.uv[index];
+    }
   }
 }
 
@@ -224,33 +364,23 @@ float QuadDice::scale_factor(Subpatch &sub, int Mu, int Mv)
   return S;
 }
 
-void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
+void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset, int &tri)
 {
-  /* create inner grid */
-  float du = 1.0f / (float)Mu;
-  float dv = 1.0f / (float)Mv;
-
-  for (int j = 1; j < Mv; j++) {
-    for (int i = 1; i < Mu; i++) {
-      float u = i * du;
-      float v = j * dv;
-
-      set_vert(sub, offset + (i - 1) + (j - 1) * (Mu - 1), u, v);
-
-      if (i < Mu - 1 && j < Mv - 1) {
-        int i1 = offset + (i - 1) + (j - 1) * (Mu - 1);
-        int i2 = offset + i + (j - 1) * (Mu - 1);
-        int i3 = offset + i + j * (Mu - 1);
-        int i4 = offset + (i - 1) + j * (Mu - 1);
-
-        add_triangle(sub.patch, i1, i2, i3);
-        add_triangle(sub.patch, i1, i3, i4);
-      }
+  /* create inner grid triangles */
+  for (int j = 1; j < Mv - 1; j++) {
+    for (int i = 1; i < Mu - 1; i++) {
+      int i1 = offset + (i - 1) + (j - 1) * (Mu - 1);
+      int i2 = offset + i + (j - 1) * (Mu - 1);
+      int i3 = offset + i + j * (Mu - 1);
+      int i4 = offset + (i - 1) + j * (Mu - 1);
+
+      add_triangle(sub.patch, tri++, i1, i2, i3);
+      add_triangle(sub.patch, tri++, i1, i3, i4);
     }
   }
 }
 
-void QuadDice::dice(Subpatch &sub)
+void QuadDice::add_triangles(Subpatch &sub)
 {
   /* compute inner grid size with scale factor */
   int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
@@ -265,19 +395,93 @@ void QuadDice::dice(Subpatch &sub)
   Mu = max((int)ceilf(S * Mu), 2);  // XXX handle 0 & 1?
   Mv = max((int)ceilf(S * Mv), 2);  // XXX handle 0 & 1?
 
+  int tri = sub.triangle_offset;
+
   /* inner grid */
-  add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
+  add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset, tri);
 
   /* sides */
-  set_side(sub, 0);
-  set_side(sub, 1);
-  set_side(sub, 2);
-  set_side(sub, 3);
-
-  stitch_triangles(sub, 0);
-  stitch_triangles(sub, 1);
-  stitch_triangles(sub, 2);
-  stitch_triangles(sub, 3);
+  stitch_triangles(sub, 0, tri);
+  stitch_triangles(sub, 1, tri);
+  stitch_triangles(sub, 2, tri);
+  stitch_triangles(sub, 3, tri);
+
+  assert(tri == sub.triangle_offset + sub.calc_num_triangles());
+}
+
+void QuadDice::dice_grids_task(vector<Subpatch> *subpatches,
+                               vector<DicedGrid> *grids,
+                               int start,
+                               int end)
+{
+  DiceCache *cache = params.mesh->dice_cache;
+  size_t num_hits = 0;
+
+  for (int i = start; i < end; i++) {
+    Subpatch &sub = (*subpatches)[i];
+    DicedGrid &grid = (*grids)[i];
+    DicedGrid *cached_grid = (cache) ? cache->find(sub) : NULL;
+
+    if (cached_grid && !cached_grid->P.empty()) {
+      /* Each subpatch has a unique key, so no other task uses this grid. */
+      grid.P.swap(cached_grid->P);
+      grid.N.swap(cached_grid->N);
+      grid.uv.swap(cached_grid->uv);
+      set_grid(sub, grid);
+      num_hits++;
+    }
+    else {
+      eval_grid(sub, grid, cache != NULL);
+    }
+  }
+
+  if (num_hits) {
+    atomic_add_and_fetch_z(&num_cache_hits, num_hits);
+  }
+}
+
+void QuadDice::add_triangles_task(vector<Subpatch> *subpatches, int start, int end)
+{
+  for (int i = start; i < end; i++) {
+    add_triangles((*subpatches)[i]);
+  }
+}
+
+void QuadDice::dice(vector<Subpatch> &subpatches)
+{
+  DiceCache *cache = params.mesh->dice_cache;
+  const int num_subpatches = subpatches.size();
+  vector<DicedGrid> grids(num_subpatches);
+  num_cache_hits = 0;
+
+  /* Evaluate vertices. */
+  TaskPool pool;
+  for (int i = 0; i < num_subpatches; i += DICE_SUBPATCHES_PER_TASK) {
+    int end = min(i + DICE_SUBPATCHES_PER_TASK, num_subpatches);
+    pool.push(function_bind(&QuadDice::dice_grids_task, this, &subpatches, &grids, i, end));
+  }
+  pool.wait_work();
+
+  /* Vertices along the sides are shared between subpatches, set them in subpatch order so the
+   * result does not depend on the order in which tasks were executed. */
+  for (int i = 0; i < num_subpatches; i++) {
+    set_sides(subpatches[i], grids[i]);
+  }
+
+  if (cache) {
+    VLOG(2) << "Reused " << num_cache_hits << " of " << subpatches.size()
+            << " diced subpatches.";
+    cache->end(subpatches, grids);
+    VLOG(2) << "Dice cache size " << string_human_readable_size(cache->memory_size()) << ".";
+  }
+  grids.clear();
+
+  /* Create triangles, once all vertices are known for stitching. */
+  for (int i = 0; i < num_subpatches; i += DICE_SUBPATCHES_PER_TASK) {
+    int end = min(i + DICE_SUBPATCHES_PER_TASK, num_subpatches);
+    pool.push(function_bind(&QuadDice::add_triangles_task, this, &subpatches, i, end));
+  }
+  pool.wait_work();
 }
 
 CCL_NAMESPACE_END
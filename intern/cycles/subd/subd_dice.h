@@ -22,6 +22,7 @@
  * DiagSplit. For more algorithm details, see the DiagSplit paper or the
  * ARB_tessellation_shader OpenGL extension, Section 2.X.2. */
 
+#include "util/util_map.h"
 #include "util/util_types.h"
 #include "util/util_vector.h"
 
@@ -57,6 +58,64 @@ struct SubdParams {
   }
 };
 
+/* Diced Grid
+ *
+ * Evaluated vertices of a subpatch, along the four sides followed by the inner grid. */
+
+struct DicedGrid {
+  vector<float3> P;
+  vector<float3> N;
+  vector<float2> uv;
+
+  void resize(size_t size)
+  {
+    P.resize(size);
+    N.resize(size);
+    uv.resize(size);
+  }
+
+  void eval(Patch *patch, int index, float2 patch_uv);
+};
+
+/* Dice Cache
+ *
+ * Diced grids of the previous tessellation of a mesh. When the mesh is tessellated again with
+ * the same patch input, only subpatches whose edge factors changed are evaluated again, for
+ * example the part of the mesh affected by a small camera move. */
+
+class DiceCache {
+ public:
+  struct Key {
+    int patch_index;
+    int T[4];
+    float2 corners[4];
+
+    explicit Key(const Subpatch &sub);
+    bool operator==(const Key &other) const;
+  };
+
+  struct KeyHasher {
+    size_t operator()(const Key &key) const;
+  };
+
+  DiceCache();
+
+  /* Discard all grids when the input of patch evaluation changed. */
+  void begin(uint input_hash);
+
+  /* Grid of an identical subpatch from the previous tessellation, NULL if there is none. */
+  DicedGrid *find(const Subpatch &sub);
+
+  /* Replace cached grids with the grids of the current tessellation. */
+  void end(const vector<Subpatch> &subpatches, vector<DicedGrid> &grids);
+
+  size_t memory_size() const;
+
+ protected:
+  uint input_hash;
+  unordered_map<Key, DicedGrid, KeyHasher> grids;
+};
+
 /* EdgeDice Base */
 
 class EdgeDice {
@@ -72,9 +131,9 @@ class EdgeDice {
   void reserve(int num_verts, int num_triangles);
 
   void set_vert(Patch *patch, int index, float2 uv);
-  void add_triangle(Patch *patch, int v0, int v1, int v2);
+  void add_triangle(Patch *patch, int tri, int v0, int v1, int v2);
 
-  void stitch_triangles(Subpatch &sub, int edge);
+  void stitch_triangles(Subpatch &sub, int edge, int &tri);
 };
 
 /* Quad EdgeDice */
@@ -86,16 +145,30 @@ class QuadDice : public EdgeDice {
   float3 eval_projected(Subpatch &sub, float u, float v);
 
   float2 map_uv(Subpatch &sub, float u, float v);
-  void set_vert(Subpatch &sub, int index, float u, float v);
+  float2 map_side_uv(Subpatch &sub, int edge, float f);
 
-  void add_grid(Subpatch &sub, int Mu, int Mv, int offset);
+  void eval_grid(Subpatch &sub, DicedGrid &grid, bool store_inner);
+  void set_grid(Subpatch &sub, const DicedGrid &grid);
+  void set_sides(Subpatch &sub, const DicedGrid &grid);
 
-  void set_side(Subpatch &sub, int edge);
+  void add_grid(Subpatch &sub, int Mu, int Mv, int offset, int &tri);
+  void add_triangles(Subpatch &sub);
 
   float quad_area(const float3 &a, const float3 &b, const float3 &c, const float3 &d);
   float scale_factor(Subpatch &sub, int Mu, int Mv);
 
-  void dice(Subpatch &sub);
+  /* Dice subpatches in parallel. Vertex and triangle offsets of the subpatches must be
+   * assigned and reserved already. */
+  void dice(vector<Subpatch> &subpatches);
+
+ protected:
+  void dice_grids_task(vector<Subpatch> *subpatches,
+                       vector<DicedGrid> *grids,
+                       int start,
+                       int end);
+  void add_triangles_task(vector<Subpatch> *subpatches, int start, int end);
+
+  size_t num_cache_hits;
 };
 
 CCL_NAMESPACE_END
@@ -24,7 +24,9 @@
 #include "util/util_algorithm.h"
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
+#include "util/util_logging.h"
 #include "util/util_math.h"
+#include "util/util_task.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -35,6 +37,10 @@ CCL_NAMESPACE_BEGIN
 #define STITCH_NGON_CENTER_VERT_INDEX_OFFSET 0x60000000
 #define STITCH_NGON_SPLIT_EDGE_CENTER_VERT_TAG (0x60000000 - 1)
 
+/* Faces split by a single task. Ranges have a fixed size so the order of vertices and
+ * triangles does not depend on the number of threads. */
+#define DSPLIT_FACES_PER_RANGE 256
+
 DiagSplit::DiagSplit(const SubdParams &params_) : params(params_)
 {
 }
@@ -157,7 +163,7 @@ void DiagSplit::resolve_edge_factors(Subpatch &sub)
   }
 }
 
-void DiagSplit::split(Subpatch &sub, int depth)
+void DiagSplit::split(Range &range, Subpatch &sub, int depth)
 {
   if (depth > 32) {
     /* We should never get here, but just in case end recursion safely. */
@@ -168,7 +174,7 @@ void DiagSplit::split(Subpatch &sub, int depth)
     sub.edge_v0.T = 1;
     sub.edge_v1.T = 1;
 
-    subpatches.push_back(sub);
+    range.subpatches.push_back(sub);
     return;
   }
 
@@ -200,8 +206,8 @@ void DiagSplit::split(Subpatch &sub, int depth)
 
   if (!split_u && !split_v) {
     /* Add the unsplit subpatch. */
-    subpatches.push_back(sub);
-    Subpatch &subpatch = subpatches[subpatches.size() - 1];
+    range.subpatches.push_back(sub);
+    Subpatch &subpatch = range.subpatches.back();
 
     /* Update T values and offsets. */
     for (int i = 0; i < 4; i++) {
@@ -287,7 +293,7 @@ void DiagSplit::split(Subpatch &sub, int depth)
     resolve_edge_factors(sub_b);
 
     /* Create new edge */
-    Edge &edge = *alloc_edge();
+    Edge &edge = *range.alloc_edge();
 
     sub_a_split->edge = &edge;
     sub_b_split->edge = &edge;
@@ -306,7 +312,7 @@ void DiagSplit::split(Subpatch &sub, int depth)
 
     /* Recurse */
     edge.T = 0;
-    split(sub_a, depth + 1);
+    split(range, sub_a, depth + 1);
 
     int edge_t = edge.T;
     (void)edge_t;
@@ -315,7 +321,7 @@ void DiagSplit::split(Subpatch &sub, int depth)
     edge.bottom_offset = sub_across_0->edge->T;
 
     edge.T = 0; /* We calculate T twice along each edge. :/ */
-    split(sub_b, depth + 1);
+    split(range, sub_b, depth + 1);
 
     assert(edge.T == edge_t); /* If this fails we will crash at some later point! */
 
@@ -331,17 +337,24 @@ int DiagSplit::alloc_verts(int n)
   return a;
 }
 
-Edge *DiagSplit::alloc_edge()
+int DiagSplit::Range::alloc_verts(int n)
+{
+  int a = num_alloced_verts;
+  num_alloced_verts += n;
+  return a;
+}
+
+Edge *DiagSplit::Range::alloc_edge()
 {
   edges.emplace_back();
   return &edges.back();
 }
 
-void DiagSplit::split_patches(Patch *patches, size_t patches_byte_stride)
+void DiagSplit::split_range(Range *range, Patch *patches, size_t patches_byte_stride)
 {
-  int patch_index = 0;
+  int patch_index = range->patch_start;
 
-  for (int f = 0; f < params.mesh->subd_faces.size(); f++) {
+  for (int f = range->face_start; f < range->face_start + range->num_faces; f++) {
     Mesh::SubdFace &face = params.mesh->subd_faces[f];
 
     Patch *patch = (Patch *)(((char *)patches) + patch_index * patches_byte_stride);
@@ -349,14 +362,43 @@ void DiagSplit::split_patches(Patch *patches, size_t patches_byte_stride)
     if (face.is_quad()) {
       patch_index++;
 
-      split_quad(face, patch);
+      split_quad(*range, face, patch);
     }
     else {
       patch_index += face.num_corners;
 
-      split_ngon(face, patch, patches_byte_stride);
+      split_ngon(*range, face, patch, patches_byte_stride);
+    }
+  }
+}
+
+void DiagSplit::split_patches(Patch *patches, size_t patches_byte_stride)
+{
+  const int num_faces = params.mesh->subd_faces.size();
+
+  ranges.resize(divide_up(num_faces, DSPLIT_FACES_PER_RANGE));
+
+  int patch_index = 0;
+
+  for (int f = 0; f < num_faces; f++) {
+    if (f % DSPLIT_FACES_PER_RANGE == 0) {
+      Range &range = ranges[f / DSPLIT_FACES_PER_RANGE];
+      range.face_start = f;
+      range.num_faces = min(DSPLIT_FACES_PER_RANGE, num_faces - f);
+      range.patch_start = patch_index;
     }
+
+    Mesh::SubdFace &face = params.mesh->subd_faces[f];
+    patch_index += (face.is_quad()) ? 1 : face.num_corners;
+  }
+
+  /* Faces are split independently, edges shared between faces are stitched afterwards. */
+  TaskPool pool;
+  foreach (Range &range, ranges) {
+    pool.push(
+        function_bind(&DiagSplit::split_range, this, &range, patches, patches_byte_stride));
   }
+  pool.wait_work();
 
   params.mesh->vert_to_stitching_key_map.clear();
   params.mesh->vert_stitching_map.clear();
@@ -364,7 +406,7 @@ void DiagSplit::split_patches(Patch *patches, size_t patches_byte_stride)
   post_split();
 }
 
-static Edge *create_edge_from_corner(DiagSplit *split,
+static Edge *create_edge_from_corner(DiagSplit::Range &range,
                                      const Mesh *mesh,
                                      const Mesh::SubdFace &face,
                                      int corner,
@@ -382,7 +424,7 @@ static Edge *create_edge_from_corner(DiagSplit *split,
     swap(v0, v1);
   }
 
-  Edge *edge = split->alloc_edge();
+  Edge *edge = range.alloc_edge();
 
   edge->is_stitch_edge = true;
   edge->stitch_start_vert_index = a;
@@ -396,21 +438,21 @@ static Edge *create_edge_from_corner(DiagSplit *split,
   return edge;
 }
 
-void DiagSplit::split_quad(const Mesh::SubdFace &face, Patch *patch)
+void DiagSplit::split_quad(Range &range, const Mesh::SubdFace &face, Patch *patch)
 {
   Subpatch subpatch(patch);
 
-  int v = alloc_verts(4);
+  int v = range.alloc_verts(4);
 
   bool v0_reversed, u1_reversed, v1_reversed, u0_reversed;
   subpatch.edge_v0.edge = create_edge_from_corner(
-      this, params.mesh, face, 3, v0_reversed, v + 3, v + 0);
+      range, params.mesh, face, 3, v0_reversed, v + 3, v + 0);
   subpatch.edge_u1.edge = create_edge_from_corner(
-      this, params.mesh, face, 2, u1_reversed, v + 2, v + 3);
+      range, params.mesh, face, 2, u1_reversed, v + 2, v + 3);
   subpatch.edge_v1.edge = create_edge_from_corner(
-      this, params.mesh, face, 1, v1_reversed, v + 1, v + 2);
+      range, params.mesh, face, 1, v1_reversed, v + 1, v + 2);
   subpatch.edge_u0.edge = create_edge_from_corner(
-      this, params.mesh, face, 0, u0_reversed, v + 0, v + 1);
+      range, params.mesh, face, 0, u0_reversed, v + 0, v + 1);
 
   subpatch.edge_v0.sub_edges_created_in_reverse_order = !v0_reversed;
   subpatch.edge_u1.sub_edges_created_in_reverse_order = u1_reversed;
@@ -428,10 +470,10 @@ void DiagSplit::split_quad(const Mesh::SubdFace &face, Patch *patch)
   subpatch.edge_v0.T = DSPLIT_NON_UNIFORM;
   subpatch.edge_v1.T = DSPLIT_NON_UNIFORM;
 
-  split(subpatch, -2);
+  split(range, subpatch, -2);
 }
 
-static Edge *create_split_edge_from_corner(DiagSplit *split,
+static Edge *create_split_edge_from_corner(DiagSplit::Range &range,
                                            const Mesh *mesh,
                                            const Mesh::SubdFace &face,
                                            int corner,
@@ -441,7 +483,7 @@ static Edge *create_split_edge_from_corner(DiagSplit *split,
                                            int v1,
                                            int vc)
 {
-  Edge *edge = split->alloc_edge();
+  Edge *edge = range.alloc_edge();
 
   int a = mesh->subd_face_corners[face.start_corner + mod(corner + 0, face.num_corners)];
   int b = mesh->subd_face_corners[face.start_corner + mod(corner + 1, face.num_corners)];
@@ -477,7 +519,10 @@ static Edge *create_split_edge_from_corner(DiagSplit *split,
   return edge;
 }
 
-void DiagSplit::split_ngon(const Mesh::SubdFace &face, Patch *patches, size_t patches_byte_stride)
+void DiagSplit::split_ngon(Range &range,
+                           const Mesh::SubdFace &face,
+                           Patch *patches,
+                           size_t patches_byte_stride)
 {
   Edge *prev_edge_u0 = nullptr;
   Edge *first_edge_v0 = nullptr;
@@ -487,11 +532,11 @@ void DiagSplit::split_ngon(const Mesh::SubdFace &face, Patch *patches, size_t pa
 
     Subpatch subpatch(patch);
 
-    int v = alloc_verts(4);
+    int v = range.alloc_verts(4);
 
     /* Setup edges. */
-    Edge *edge_u1 = alloc_edge();
-    Edge *edge_v1 = alloc_edge();
+    Edge *edge_u1 = range.alloc_edge();
+    Edge *edge_v1 = range.alloc_edge();
 
     edge_v1->is_stitch_edge = true;
     edge_u1->is_stitch_edge = true;
@@ -516,7 +561,7 @@ void DiagSplit::split_ngon(const Mesh::SubdFace &face, Patch *patches, size_t pa
 
     bool v0_reversed, u0_reversed;
 
-    subpatch.edge_v0.edge = create_split_edge_from_corner(this,
+    subpatch.edge_v0.edge = create_split_edge_from_corner(range,
                                                           params.mesh,
                                                           face,
                                                           corner - 1,
@@ -529,7 +574,7 @@ void DiagSplit::split_ngon(const Mesh::SubdFace &face, Patch *patches, size_t pa
     subpatch.edge_u1.edge = edge_u1;
     subpatch.edge_v1.edge = edge_v1;
 
-    subpatch.edge_u0.edge = create_split_edge_from_corner(this,
+    subpatch.edge_u0.edge = create_split_edge_from_corner(range,
                                                           params.mesh,
                                                           face,
                                                           corner + 0,
@@ -558,7 +603,7 @@ void DiagSplit::split_ngon(const Mesh::SubdFace &face, Patch *patches, size_t pa
 
       resolve_edge_factors(subpatch);
 
-      split(subpatch, 0);
+      split(range, subpatch, 0);
     }
 
     /* Update offsets after T is known from split. */
@@ -605,16 +650,31 @@ void DiagSplit::post_split()
 {
   int num_stitch_verts = 0;
 
-  /* All patches are now split, and all T values known. */
+  /* All patches are now split, and all T values known. Vertices of ranges are numbered in
+   * range order, as if all faces were split one after the other. */
+  foreach (Range &range, ranges) {
+    int vert_offset = alloc_verts(range.num_alloced_verts);
 
-  foreach (Edge &edge, edges) {
-    if (edge.second_vert_index < 0) {
-      edge.second_vert_index = alloc_verts(edge.T - 1);
+    foreach (Edge &edge, range.edges) {
+      if (edge.start_vert_index >= 0) {
+        edge.start_vert_index += vert_offset;
+      }
+      if (edge.end_vert_index >= 0) {
+        edge.end_vert_index += vert_offset;
+      }
     }
+  }
 
-    if (edge.is_stitch_edge) {
-      num_stitch_verts = max(num_stitch_verts,
-                             max(edge.stitch_start_vert_index, edge.stitch_end_vert_index));
+  foreach (Range &range, ranges) {
+    foreach (Edge &edge, range.edges) {
+      if (edge.second_vert_index < 0) {
+        edge.second_vert_index = alloc_verts(edge.T - 1);
+      }
+
+      if (edge.is_stitch_edge) {
+        num_stitch_verts = max(num_stitch_verts,
+                               max(edge.stitch_start_vert_index, edge.stitch_end_vert_index));
+      }
     }
   }
 
@@ -630,44 +690,52 @@ void DiagSplit::post_split()
   typedef unordered_map<pair<int, int>, int, pair_hasher> edge_stitch_verts_map_t;
   edge_stitch_verts_map_t edge_stitch_verts_map;
 
-  foreach (Edge &edge, edges) {
-    if (edge.is_stitch_edge) {
-      if (edge.stitch_edge_T == 0) {
-        edge.stitch_edge_T = edge.T;
-      }
+  foreach (Range &range, ranges) {
+    foreach (Edge &edge, range.edges) {
+      if (edge.is_stitch_edge) {
+        if (edge.stitch_edge_T == 0) {
+          edge.stitch_edge_T = edge.T;
+        }
 
-      if (edge_stitch_verts_map.find(edge.stitch_edge_key) == edge_stitch_verts_map.end()) {
-        edge_stitch_verts_map[edge.stitch_edge_key] = num_stitch_verts;
-        num_stitch_verts += edge.stitch_edge_T - 1;
+        if (edge_stitch_verts_map.find(edge.stitch_edge_key) == edge_stitch_verts_map.end()) {
+          edge_stitch_verts_map[edge.stitch_edge_key] = num_stitch_verts;
+          num_stitch_verts += edge.stitch_edge_T - 1;
+        }
       }
     }
   }
 
   /* Set start and end indices for edges generated from a split. */
-  foreach (Edge &edge, edges) {
-    if (edge.start_vert_index < 0) {
-      /* Fixup offsets. */
-      if (edge.top_indices_decrease) {
-        edge.top_offset = edge.top->T - edge.top_offset;
+  foreach (Range &range, ranges) {
+    foreach (Edge &edge, range.edges) {
+      if (edge.start_vert_index < 0) {
+        /* Fixup offsets. */
+        if (edge.top_indices_decrease) {
+          edge.top_offset = edge.top->T - edge.top_offset;
+        }
+
+        edge.start_vert_index = edge.top->get_vert_along_edge(edge.top_offset);
       }
 
-      edge.start_vert_index = edge.top->get_vert_along_edge(edge.top_offset);
-    }
+      if (edge.end_vert_index < 0) {
+        if (edge.bottom_indices_decrease) {
+          edge.bottom_offset = edge.bottom->T - edge.bottom_offset;
+        }
 
-    if (edge.end_vert_index < 0) {
-      if (edge.bottom_indices_decrease) {
-        edge.bottom_offset = edge.bottom->T - edge.bottom_offset;
+        edge.end_vert_index = edge.bottom->get_vert_along_edge(edge.bottom_offset);
       }
-
-      edge.end_vert_index = edge.bottom->get_vert_along_edge(edge.bottom_offset);
     }
   }
 
   int vert_offset = params.mesh->verts.size();
 
   /* Add verts to stitching map. */
-  foreach (const Edge &edge, edges) {
-    if (edge.is_stitch_edge) {
+  foreach (const Range &range, ranges) {
+    foreach (const Edge &edge, range.edges) {
+      if (!edge.is_stitch_edge) {
+        continue;
+      }
+
       int second_stitch_vert_index = edge_stitch_verts_map[edge.stitch_edge_key];
 
       for (int i = 0; i <= edge.T; i++) {
@@ -715,20 +783,24 @@ void DiagSplit::post_split()
     }
   }
 
+  /* Gather subpatches in face order. */
+  size_t num_subpatches = 0;
+  foreach (const Range &range, ranges) {
+    num_subpatches += range.subpatches.size();
+  }
+
+  subpatches.reserve(num_subpatches);
+  foreach (Range &range, ranges) {
+    subpatches.insert(subpatches.end(), range.subpatches.begin(), range.subpatches.end());
+    range.subpatches.clear();
+  }
+
   /* Dice; TODO(mai): Move this out of split. */
   QuadDice dice(params);
 
   int num_verts = num_alloced_verts;
   int num_triangles = 0;
 
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    subpatches[i].inner_grid_vert_offset = num_verts;
-    num_verts += subpatches[i].calc_num_inner_verts();
-    num_triangles += subpatches[i].calc_num_triangles();
-  }
-
-  dice.reserve(num_verts, num_triangles);
-
   for (size_t i = 0; i < subpatches.size(); i++) {
     Subpatch &sub = subpatches[i];
 
@@ -737,12 +809,21 @@ void DiagSplit::post_split()
     sub.edge_v0.T = max(sub.edge_v0.T, 1);
     sub.edge_v1.T = max(sub.edge_v1.T, 1);
 
-    dice.dice(sub);
+    sub.inner_grid_vert_offset = num_verts;
+    sub.triangle_offset = num_triangles;
+    num_verts += sub.calc_num_inner_verts();
+    num_triangles += sub.calc_num_triangles();
   }
 
+  dice.reserve(num_verts, num_triangles);
+  dice.dice(subpatches);
+
+  VLOG(2) << "Diced " << subpatches.size() << " subpatches into " << num_triangles
+          << " triangles.";
+
   /* Cleanup */
   subpatches.clear();
-  edges.clear();
+  ranges.clear();
 }
 
 CCL_NAMESPACE_END
@@ -37,11 +37,28 @@ class Mesh;
 class Patch;
 
 class DiagSplit {
+ public:
+  /* Split state of a range of faces. Ranges are split in parallel and merged in face order, so
+   * the result does not depend on the number of threads. */
+  struct Range {
+    int face_start = 0;
+    int num_faces = 0;
+    int patch_start = 0;
+
+    vector<Subpatch> subpatches;
+    /* deque is used so that element pointers remain vaild when size is changed. */
+    deque<Edge> edges;
+
+    int num_alloced_verts = 0;
+    int alloc_verts(int n); /* Returns start index of new verts, local to the range. */
+    Edge *alloc_edge();
+  };
+
+ private:
   SubdParams params;
 
+  vector<Range> ranges;
   vector<Subpatch> subpatches;
-  /* deque is used so that element pointers remain vaild when size is changed. */
-  deque<Edge> edges;
 
   float3 to_world(Patch *patch, float2 uv);
   int T(Patch *patch, float2 Pstart, float2 Pend, bool recursive_resolve = false);
@@ -52,20 +69,22 @@ class DiagSplit {
   void partition_edge(
       Patch *patch, float2 *P, int *t0, int *t1, float2 Pstart, float2 Pend, int t);
 
-  void split(Subpatch &sub, int depth = 0);
+  void split(Range &range, Subpatch &sub, int depth = 0);
+  void split_range(Range *range, Patch *patches, size_t patches_byte_stride);
 
   int num_alloced_verts = 0;
   int alloc_verts(int n); /* Returns start index of new verts. */
 
  public:
-  Edge *alloc_edge();
-
   explicit DiagSplit(const SubdParams &params);
 
   void split_patches(Patch *patches, size_t patches_byte_stride);
 
-  void split_quad(const Mesh::SubdFace &face, Patch *patch);
-  void split_ngon(const Mesh::SubdFace &face, Patch *patches, size_t patches_byte_stride);
+  void split_quad(Range &range, const Mesh::SubdFace &face, Patch *patch);
+  void split_ngon(Range &range,
+                  const Mesh::SubdFace &face,
+                  Patch *patches,
+                  size_t patches_byte_stride);
 
   void post_split();
 };
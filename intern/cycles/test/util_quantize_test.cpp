@@ -0,0 +1,82 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "util/util_quantize.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(util_quantize, oct_unit_vector_axes)
+{
+  const float3 axes[6] = {make_float3(1.0f, 0.0f, 0.0f),
+                          make_float3(-1.0f, 0.0f, 0.0f),
+                          make_float3(0.0f, 1.0f, 0.0f),
+                          make_float3(0.0f, -1.0f, 0.0f),
+                          make_float3(0.0f, 0.0f, 1.0f),
+                          make_float3(0.0f, 0.0f, -1.0f)};
+
+  for (int i = 0; i < 6; i++) {
+    const float3 n = oct_decode_unit_vector(oct_encode_unit_vector(axes[i]));
+    EXPECT_NEAR(n.x, axes[i].x, 1e-6f);
+    EXPECT_NEAR(n.y, axes[i].y, 1e-6f);
+    EXPECT_NEAR(n.z, axes[i].z, 1e-6f);
+  }
+}
+
+TEST(util_quantize, oct_unit_vector_sphere)
+{
+  for (int i = 0; i < 1000; i++) {
+    const float3 n = normalize(
+        make_float3(sinf(i * 1.3f), cosf(i * 0.7f), sinf(i * 0.11f + 1.0f)));
+    const float3 d = oct_decode_unit_vector(oct_encode_unit_vector(n));
+    EXPECT_NEAR(len(d), 1.0f, 1e-6f);
+    EXPECT_LT(len(d - n), 1e-4f);
+  }
+}
+
+TEST(util_quantize, oct_unit_vector_zero)
+{
+  /* Degenerate normals must not produce NaN. */
+  const float3 n = oct_decode_unit_vector(oct_encode_unit_vector(make_float3(0.0f, 0.0f, 0.0f)));
+  EXPECT_EQ(n.z, 1.0f);
+}
+
+TEST(util_quantize, unorm16x2)
+{
+  float2 f = unorm16x2_decode(unorm16x2_encode(make_float2(0.0f, 1.0f)));
+  EXPECT_EQ(f.x, 0.0f);
+  EXPECT_EQ(f.y, 1.0f);
+
+  f = unorm16x2_decode(unorm16x2_encode(make_float2(0.25f, 0.7f)));
+  EXPECT_NEAR(f.x, 0.25f, 1.0f / 65535.0f);
+  EXPECT_NEAR(f.y, 0.7f, 1.0f / 65535.0f);
+}
+
+TEST(util_quantize, half3)
+{
+  float3 f = half3_decode(half3_encode(make_float3(0.0f, 1.0f, -2.0f)));
+  EXPECT_EQ(f.x, 0.0f);
+  EXPECT_EQ(f.y, 1.0f);
+  EXPECT_EQ(f.z, -2.0f);
+
+  f = half3_decode(half3_encode(make_float3(0.1f, 1000.3f, 65504.0f)));
+  EXPECT_NEAR(f.x, 0.1f, 1e-4f);
+  EXPECT_NEAR(f.y, 1000.3f, 1.0f);
+  EXPECT_EQ(f.z, 65504.0f);
+}
+
+CCL_NAMESPACE_END
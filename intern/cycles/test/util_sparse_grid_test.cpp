@@ -0,0 +1,86 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "util/util_sparse_grid.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(util_sparse_grid, empty)
+{
+  SparseGrid grid;
+  grid.reset(make_int3(20, 10, 5), make_int3(0, 0, 0), 1);
+
+  EXPECT_EQ(grid.num_tiles.x, 3);
+  EXPECT_EQ(grid.num_tiles.y, 2);
+  EXPECT_EQ(grid.num_tiles.z, 1);
+  EXPECT_EQ(grid.num_active_tiles(), 0);
+  EXPECT_FALSE(grid.is_tile_active(19, 9, 4));
+  EXPECT_EQ(grid.read(19, 9, 4).x, 0.0f);
+}
+
+TEST(util_sparse_grid, offset)
+{
+  /* First voxel in the middle of a tile, as when aligned to OpenVDB leaf nodes. */
+  SparseGrid grid;
+  grid.reset(make_int3(8, 8, 8), make_int3(3, 0, 7), 1);
+
+  EXPECT_EQ(grid.num_tiles.x, 2);
+  EXPECT_EQ(grid.num_tiles.y, 1);
+  EXPECT_EQ(grid.num_tiles.z, 2);
+
+  /* Voxel (5, 2, 1) is at (8, 2, 8) in tile space, the first voxel of tile (1, 0, 1). */
+  float *voxels = grid.ensure_tile(1, 0, 1);
+  ASSERT_TRUE(voxels != NULL);
+  voxels[2 * SPARSE_GRID_TILE_SIZE] = 0.5f;
+
+  EXPECT_EQ(grid.num_active_tiles(), 1);
+  EXPECT_TRUE(grid.is_tile_active(5, 2, 1));
+  EXPECT_FALSE(grid.is_tile_active(4, 2, 1));
+  EXPECT_EQ(grid.read(5, 2, 1).x, 0.5f);
+  EXPECT_EQ(grid.read(5, 2, 1).w, 1.0f);
+  EXPECT_EQ(grid.read(6, 2, 1).x, 0.0f);
+
+  EXPECT_TRUE(grid.ensure_tile(2, 0, 0) == NULL);
+  EXPECT_TRUE(grid.ensure_tile(-1, 0, 0) == NULL);
+}
+
+TEST(util_sparse_grid, channels)
+{
+  SparseGrid grid;
+  grid.reset(make_int3(16, 16, 16), make_int3(0, 0, 0), 4);
+
+  float *voxels = grid.ensure_tile(1, 1, 1);
+  ASSERT_TRUE(voxels != NULL);
+  const int index = 1 + SPARSE_GRID_TILE_SIZE * (2 + SPARSE_GRID_TILE_SIZE * 3);
+  voxels[index * 4 + 0] = 1.0f;
+  voxels[index * 4 + 1] = 2.0f;
+  voxels[index * 4 + 2] = 3.0f;
+  voxels[index * 4 + 3] = 4.0f;
+
+  /* Existing tiles are returned as is. */
+  EXPECT_EQ(grid.ensure_tile(1, 1, 1), voxels);
+
+  const float4 value = grid.read(9, 10, 11);
+  EXPECT_EQ(value.x, 1.0f);
+  EXPECT_EQ(value.y, 2.0f);
+  EXPECT_EQ(value.z, 3.0f);
+  EXPECT_EQ(value.w, 4.0f);
+  EXPECT_EQ(grid.memory_size(), 8 * sizeof(int) + SPARSE_GRID_TILE_VOXELS * 4 * sizeof(float));
+}
+
+CCL_NAMESPACE_END
@@ -32,7 +32,8 @@ DebugFlags::CPU::CPU()
       sse3(true),
       sse2(true),
       bvh_layout(BVH_LAYOUT_DEFAULT),
-      split_kernel(false)
+      split_kernel(false),
+      numa_mode(NUMA_NONE)
 {
   reset();
 }
@@ -71,6 +72,17 @@ void DebugFlags::CPU::reset()
   }
 
   split_kernel = false;
+
+  numa_mode = NUMA_NONE;
+  const char *numa = getenv("CYCLES_CPU_NUMA");
+  if (numa) {
+    if (strcmp(numa, "INTERLEAVE") == 0) {
+      numa_mode = NUMA_INTERLEAVE;
+    }
+    else if (strcmp(numa, "REPLICATE") == 0) {
+      numa_mode = NUMA_REPLICATE;
+    }
+  }
 }
 
 DebugFlags::CUDA::CUDA() : adaptive_compile(false), split_kernel(false)
@@ -144,6 +156,19 @@ void DebugFlags::reset()
   opencl.reset();
 }
 
+const char *numa_mode_name(DebugFlags::CPU::NUMAMode numa_mode)
+{
+  switch (numa_mode) {
+    case DebugFlags::CPU::NUMA_NONE:
+      return "NONE";
+    case DebugFlags::CPU::NUMA_INTERLEAVE:
+      return "INTERLEAVE";
+    case DebugFlags::CPU::NUMA_REPLICATE:
+      return "REPLICATE";
+  }
+  return "UNKNOWN";
+}
+
 std::ostream &operator<<(std::ostream &os, DebugFlagsConstRef debug_flags)
 {
   os << "CPU flags:\n"
@@ -153,7 +178,8 @@ std::ostream &operator<<(std::ostream &os, DebugFlagsConstRef debug_flags)
      << "  SSE3       : " << string_from_bool(debug_flags.cpu.sse3) << "\n"
      << "  SSE2       : " << string_from_bool(debug_flags.cpu.sse2) << "\n"
      << "  BVH layout : " << bvh_layout_name(debug_flags.cpu.bvh_layout) << "\n"
-     << "  Split      : " << string_from_bool(debug_flags.cpu.split_kernel) << "\n";
+     << "  Split      : " << string_from_bool(debug_flags.cpu.split_kernel) << "\n"
+     << "  NUMA       : " << numa_mode_name(debug_flags.cpu.numa_mode) << "\n";
 
   os << "CUDA flags:\n"
      << "  Adaptive Compile : " << string_from_bool(debug_flags.cuda.adaptive_compile) << "\n";
@@ -82,6 +82,17 @@ class DebugFlags {
 
     /* Whether split kernel is used */
     bool split_kernel;
+
+    /* Placement of read-only scene data on systems with multiple NUMA nodes. */
+    enum NUMAMode {
+      /* Memory stays on the node of the thread which first wrote it. */
+      NUMA_NONE,
+      /* Pages are spread evenly over all nodes. */
+      NUMA_INTERLEAVE,
+      /* Scene data is copied to every node, image textures are interleaved. */
+      NUMA_REPLICATE,
+    };
+    NUMAMode numa_mode;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
@@ -204,6 +215,8 @@ inline DebugFlags &DebugFlags()
   return DebugFlags::get();
 }
 
+const char *numa_mode_name(DebugFlags::CPU::NUMAMode numa_mode);
+
 std::ostream &operator<<(std::ostream &os, DebugFlagsConstRef debug_flags);
 
 CCL_NAMESPACE_END
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_QUANTIZE_H__
+#define __UTIL_QUANTIZE_H__
+
+#include "util/util_half.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Quantized Storage
+ *
+ * Compact encodings of geometry data. Encoding happens on the host when filling device arrays,
+ * decoding in the kernel, so the decoding functions only use integer and float operations that
+ * are available on all devices. */
+
+/* Unit vector packed into two 16 bit signed normalized values, using the octahedral mapping
+ * so the precision is nearly uniform over the sphere. */
+
+ccl_device_inline uint oct_encode_unit_vector(float3 n)
+{
+  const float sum = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+  if (!(sum > 0.0f)) {
+    return 0;
+  }
+
+  float u = n.x / sum;
+  float v = n.y / sum;
+  if (n.z < 0.0f) {
+    /* Fold the lower hemisphere over the diagonals. */
+    const float fu = (1.0f - fabsf(v)) * signf(u);
+    const float fv = (1.0f - fabsf(u)) * signf(v);
+    u = fu;
+    v = fv;
+  }
+
+  const int qu = (int)floorf(clamp(u, -1.0f, 1.0f) * 32767.0f + 0.5f);
+  const int qv = (int)floorf(clamp(v, -1.0f, 1.0f) * 32767.0f + 0.5f);
+  return ((uint)qu & 0xFFFF) | ((uint)qv << 16);
+}
+
+ccl_device_inline float3 oct_decode_unit_vector(uint packed)
+{
+  /* Sign extend both 16 bit halves. */
+  const int qu = ((int)(packed << 16)) >> 16;
+  const int qv = ((int)packed) >> 16;
+
+  float3 n = make_float3(qu * (1.0f / 32767.0f), qv * (1.0f / 32767.0f), 0.0f);
+  n.z = 1.0f - fabsf(n.x) - fabsf(n.y);
+
+  const float t = max(-n.z, 0.0f);
+  n.x += (n.x >= 0.0f) ? -t : t;
+  n.y += (n.y >= 0.0f) ? -t : t;
+
+  return normalize(n);
+}
+
+/* Two values in the [0, 1] range packed as 16 bit unsigned normalized values. */
+
+ccl_device_inline uint unorm16x2_encode(float2 f)
+{
+  const uint x = (uint)floorf(saturate(f.x) * 65535.0f + 0.5f);
+  const uint y = (uint)floorf(saturate(f.y) * 65535.0f + 0.5f);
+  return x | (y << 16);
+}
+
+ccl_device_inline float2 unorm16x2_decode(uint packed)
+{
+  return make_float2((packed & 0xFFFF) * (1.0f / 65535.0f), (packed >> 16) * (1.0f / 65535.0f));
+}
+
+/* Three half floats packed into two integers, the last 16 bits are unused.
+ *
+ * Decoding works on the raw bits rather than the half type, which is not the same type on all
+ * devices. Encoding flushes denormals to zero, so only zero needs special handling here. */
+
+ccl_device_inline float half_bits_to_float(uint h)
+{
+  const uint sign = (h & 0x8000) << 16;
+  const uint bits = h & 0x7FFF;
+  return __uint_as_float(sign | ((bits == 0) ? 0 : ((bits + 0x1C000) << 13)));
+}
+
+ccl_device_inline float3 half3_decode(uint2 packed)
+{
+  return make_float3(half_bits_to_float(packed.x & 0xFFFF),
+                     half_bits_to_float(packed.x >> 16),
+                     half_bits_to_float(packed.y & 0xFFFF));
+}
+
+#if !defined(__KERNEL_GPU__)
+ccl_device_inline uint2 half3_encode(float3 f)
+{
+  const uint x = (unsigned short)float_to_half(f.x);
+  const uint y = (unsigned short)float_to_half(f.y);
+  const uint z = (unsigned short)float_to_half(f.z);
+  return make_uint2(x | (y << 16), z);
+}
+#endif
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_QUANTIZE_H__ */
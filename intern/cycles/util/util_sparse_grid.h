@@ -0,0 +1,153 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_SPARSE_GRID_H__
+#define __UTIL_SPARSE_GRID_H__
+
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Sparse Grid
+ *
+ * Storage for 3D images that are mostly empty, like smoke and fire caches. The volume is split
+ * into tiles of SPARSE_GRID_TILE_SIZE^3 voxels and only tiles containing active voxels are
+ * stored, packed one after another in an atlas. A dense index holds the offset of each tile in
+ * the atlas, voxels in tiles that are not stored are zero.
+ *
+ * Tiles have the same size as OpenVDB leaf nodes, so grids can be copied leaf by leaf without
+ * going through a dense buffer. */
+
+#define SPARSE_GRID_TILE_SHIFT 3
+#define SPARSE_GRID_TILE_SIZE (1 << SPARSE_GRID_TILE_SHIFT)
+#define SPARSE_GRID_TILE_MASK (SPARSE_GRID_TILE_SIZE - 1)
+#define SPARSE_GRID_TILE_VOXELS \
+  (SPARSE_GRID_TILE_SIZE * SPARSE_GRID_TILE_SIZE * SPARSE_GRID_TILE_SIZE)
+#define SPARSE_GRID_TILE_EMPTY -1
+
+class SparseGrid {
+ public:
+  SparseGrid()
+      : resolution(make_int3(0, 0, 0)),
+        offset(make_int3(0, 0, 0)),
+        num_tiles(make_int3(0, 0, 0)),
+        channels(0)
+  {
+  }
+
+  /* Create an index without any tiles. Voxel (0, 0, 0) is stored at the given offset within the
+   * first tile, so that tiles can be aligned with those of the source data. */
+  void reset(const int3 resolution_, const int3 offset_, const int channels_)
+  {
+    resolution = resolution_;
+    offset = offset_;
+    channels = channels_;
+    num_tiles = make_int3(divide_up(offset.x + resolution.x, SPARSE_GRID_TILE_SIZE),
+                          divide_up(offset.y + resolution.y, SPARSE_GRID_TILE_SIZE),
+                          divide_up(offset.z + resolution.z, SPARSE_GRID_TILE_SIZE));
+
+    tile_index.clear();
+    tile_index.resize((size_t)num_tiles.x * num_tiles.y * num_tiles.z, SPARSE_GRID_TILE_EMPTY);
+    atlas.clear();
+  }
+
+  void reserve_tiles(const size_t num_active_tiles)
+  {
+    atlas.reserve(num_active_tiles * SPARSE_GRID_TILE_VOXELS * channels);
+  }
+
+  /* Get voxels of the tile, allocating it cleared to zero when it does not exist yet. Tile
+   * coordinates outside of the index return NULL. Not thread safe. */
+  float *ensure_tile(const int tile_x, const int tile_y, const int tile_z)
+  {
+    if (tile_x < 0 || tile_y < 0 || tile_z < 0 || tile_x >= num_tiles.x ||
+        tile_y >= num_tiles.y || tile_z >= num_tiles.z) {
+      return NULL;
+    }
+
+    const size_t tile_size = SPARSE_GRID_TILE_VOXELS * channels;
+    int &tile = tile_index[tile_x + num_tiles.x * (tile_y + (size_t)num_tiles.y * tile_z)];
+
+    if (tile == SPARSE_GRID_TILE_EMPTY) {
+      tile = atlas.size() / tile_size;
+      atlas.resize(atlas.size() + tile_size, 0.0f);
+    }
+
+    return &atlas[(size_t)tile * tile_size];
+  }
+
+  /* Voxel lookup, coordinates must be within the resolution. */
+  float4 read(const int x, const int y, const int z) const
+  {
+    const int tx = x + offset.x, ty = y + offset.y, tz = z + offset.z;
+    const int tile = tile_index[(tx >> SPARSE_GRID_TILE_SHIFT) +
+                                num_tiles.x * ((ty >> SPARSE_GRID_TILE_SHIFT) +
+                                               (size_t)num_tiles.y *
+                                                   (tz >> SPARSE_GRID_TILE_SHIFT))];
+    if (tile == SPARSE_GRID_TILE_EMPTY) {
+      return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    const size_t voxel = (size_t)tile * SPARSE_GRID_TILE_VOXELS + (tx & SPARSE_GRID_TILE_MASK) +
+                         SPARSE_GRID_TILE_SIZE *
+                             ((ty & SPARSE_GRID_TILE_MASK) +
+                              SPARSE_GRID_TILE_SIZE * (tz & SPARSE_GRID_TILE_MASK));
+    if (channels == 1) {
+      const float f = atlas[voxel];
+      return make_float4(f, f, f, 1.0f);
+    }
+
+    const float *rgba = &atlas[voxel * 4];
+    return make_float4(rgba[0], rgba[1], rgba[2], rgba[3]);
+  }
+
+  /* Returns true when the tile containing the voxel is stored. */
+  bool is_tile_active(const int x, const int y, const int z) const
+  {
+    const int tx = (x + offset.x) >> SPARSE_GRID_TILE_SHIFT;
+    const int ty = (y + offset.y) >> SPARSE_GRID_TILE_SHIFT;
+    const int tz = (z + offset.z) >> SPARSE_GRID_TILE_SHIFT;
+    return tile_index[tx + num_tiles.x * (ty + (size_t)num_tiles.y * tz)] !=
+           SPARSE_GRID_TILE_EMPTY;
+  }
+
+  size_t num_active_tiles() const
+  {
+    return (channels) ? atlas.size() / (SPARSE_GRID_TILE_VOXELS * channels) : 0;
+  }
+
+  size_t memory_size() const
+  {
+    return tile_index.size() * sizeof(int) + atlas.size() * sizeof(float);
+  }
+
+  /* Resolution in voxels. */
+  int3 resolution;
+  /* Position of the first voxel within the first tile. */
+  int3 offset;
+  /* Resolution of the tile index. */
+  int3 num_tiles;
+  /* Either 1 or 4, vectors are stored as RGBA. */
+  int channels;
+
+  vector<int> tile_index;
+  vector<float> atlas;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_SPARSE_GRID_H__ */
@@ -19,6 +19,7 @@
 #include "util/util_logging.h"
 #include "util/util_string.h"
 #include "util/util_types.h"
+#include "util/util_vector.h"
 
 #include <numaapi.h>
 
@@ -39,6 +40,10 @@ OIIO_NAMESPACE_USING
 #  include <unistd.h>
 #endif
 
+#ifdef __linux__
+#  include <sys/syscall.h>
+#endif
+
 CCL_NAMESPACE_BEGIN
 
 bool system_cpu_ensure_initialized()
@@ -145,6 +150,63 @@ int system_cpu_num_active_group_processors()
   return numaAPI_GetNumCurrentNodesProcessors();
 }
 
+void *system_numa_alloc_on_node(size_t size, int node)
+{
+  if (!system_cpu_ensure_initialized()) {
+    return NULL;
+  }
+  return numaAPI_AllocateOnNode(size, node);
+}
+
+void system_numa_free(void *start, size_t size)
+{
+  numaAPI_Free(start, size);
+}
+
+bool system_numa_interleave_memory(void *start, size_t size)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+  const int num_nodes = system_cpu_num_numa_nodes();
+  if (num_nodes < 2 || size == 0) {
+    return false;
+  }
+
+  /* Constants from numaif.h, which is not installed on all systems. */
+  const int mpol_interleave = 3;
+  const unsigned mpol_mf_move = (1 << 1);
+
+  const size_t bits_per_mask = sizeof(unsigned long) * 8;
+  vector<unsigned long> nodemask((num_nodes + bits_per_mask - 1) / bits_per_mask, 0);
+  for (int node = 0; node < num_nodes; node++) {
+    if (system_cpu_is_numa_node_available(node)) {
+      nodemask[node / bits_per_mask] |= (1UL << (node % bits_per_mask));
+    }
+  }
+
+  /* Memory policies apply to whole pages. */
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  const uintptr_t begin = (uintptr_t)start & ~(page_size - 1);
+  const uintptr_t end = (uintptr_t)start + size;
+
+  const long result = syscall(SYS_mbind,
+                              begin,
+                              end - begin,
+                              mpol_interleave,
+                              nodemask.data(),
+                              nodemask.size() * bits_per_mask + 1,
+                              mpol_mf_move);
+  if (result != 0) {
+    VLOG(2) << "Failed to interleave memory over NUMA nodes.";
+    return false;
+  }
+  return true;
+#else
+  (void)start;
+  (void)size;
+  return false;
+#endif
+}
+
 #if !defined(_WIN32) || defined(FREE_WINDOWS)
 static void __cpuid(int data[4], int selector)
 {
@@ -52,6 +52,15 @@ bool system_cpu_run_thread_on_node(int node);
  * thread affinity). */
 int system_cpu_num_active_group_processors();
 
+/* Allocate memory on a specific node, NULL is returned when NUMA is not available.
+ * Memory must be freed with system_numa_free(). */
+void *system_numa_alloc_on_node(size_t size, int node);
+void system_numa_free(void *start, size_t size);
+
+/* Spread the pages of existing memory evenly over all available nodes, moving pages which
+ * were already touched. Returns truth if the memory policy was changed. */
+bool system_numa_interleave_memory(void *start, size_t size);
+
 string system_cpu_brand_string();
 int system_cpu_bits();
 bool system_cpu_support_sse2();
@@ -15,6 +15,7 @@
  */
 
 #include "util/util_task.h"
+#include "util/util_debug.h"
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_system.h"
@@ -189,6 +190,7 @@ void TaskPool::num_increase()
 thread_mutex TaskScheduler::mutex;
 int TaskScheduler::users = 0;
 vector<thread *> TaskScheduler::threads;
+vector<int> TaskScheduler::nodes;
 bool TaskScheduler::do_exit = false;
 
 list<TaskScheduler::Entry> TaskScheduler::queue;
@@ -240,7 +242,11 @@ vector<int> distribute_threads_on_nodes(const int num_threads)
   const int num_active_group_processors = system_cpu_num_active_group_processors();
   VLOG(1) << "Detected " << num_active_group_processors << " processors "
           << "in active group.";
-  if (num_active_group_processors >= num_threads) {
+  /* With NUMA aware memory placement the render threads must stay on the node their data was
+   * placed for, so affinity is always set. */
+  const bool force_affinity = DebugFlags().cpu.numa_mode != DebugFlags::CPU::NUMA_NONE &&
+                              system_cpu_num_numa_nodes() > 1;
+  if (num_active_group_processors >= num_threads && !force_affinity) {
     /* If the current thread is set up in a way that its affinity allows to
      * use at least requested number of threads we do not explicitly set
      * affinity to the worker threads.
@@ -302,6 +308,7 @@ vector<int> distribute_threads_on_nodes(const int num_threads)
       current_node_index = (current_node_index + 1) % num_nodes;
     }
     VLOG(1) << "Scheduling thread " << thread_index << " to node " << current_node_index << ".";
+    thread_nodes[thread_index] = current_node_index;
     ++thread_index;
     current_node_index = (current_node_index + 1) % num_nodes;
   }
@@ -329,13 +336,13 @@ void TaskScheduler::init(int num_threads)
   VLOG(1) << "Creating pool of " << num_threads << " threads.";
 
   /* Compute distribution on NUMA nodes. */
-  vector<int> thread_nodes = distribute_threads_on_nodes(num_threads);
+  nodes = distribute_threads_on_nodes(num_threads);
 
   /* Launch threads that will be waiting for work. */
   threads.resize(num_threads);
   for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
     threads[thread_index] = new thread(function_bind(&TaskScheduler::thread_run, thread_index + 1),
-                                       thread_nodes[thread_index]);
+                                       nodes[thread_index]);
   }
 }
 
@@ -357,6 +364,7 @@ void TaskScheduler::exit()
       delete t;
     }
     threads.clear();
+    nodes.clear();
   }
 }
 
@@ -364,6 +372,7 @@ void TaskScheduler::free_memory()
 {
   assert(users == 0);
   threads.free_memory();
+  nodes.free_memory();
 }
 
 bool TaskScheduler::thread_wait_pop(Entry &entry)
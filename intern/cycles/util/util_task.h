@@ -137,6 +137,12 @@ class TaskScheduler {
     return threads.size();
   }
 
+  /* NUMA node of each thread, -1 for threads which are not pinned to a node */
+  static const vector<int> &thread_nodes()
+  {
+    return nodes;
+  }
+
   /* test if any session is using the scheduler */
   static bool active()
   {
@@ -154,6 +160,7 @@ class TaskScheduler {
   static thread_mutex mutex;
   static int users;
   static vector<thread *> threads;
+  static vector<int> nodes;
   static bool do_exit;
 
   static list<Entry> queue;
@@ -57,6 +57,10 @@ typedef enum ImageDataType {
   IMAGE_DATA_TYPE_HALF = 5,
   IMAGE_DATA_TYPE_USHORT4 = 6,
   IMAGE_DATA_TYPE_USHORT = 7,
+  /* Tiles loaded on demand by the CPU texture cache, see #TextureCache. */
+  IMAGE_DATA_TYPE_TEXTURE_CACHE = 8,
+  /* Tiles of active voxels for 3D images on the CPU, see #SparseGrid. */
+  IMAGE_DATA_TYPE_SPARSE_GRID = 9,
 
   IMAGE_DATA_NUM_TYPES
 } ImageDataType;
@@ -73,8 +77,8 @@ typedef enum ImageAlphaType {
   IMAGE_ALPHA_NUM_TYPES,
 } ImageAlphaType;
 
-#define IMAGE_DATA_TYPE_SHIFT 3
-#define IMAGE_DATA_TYPE_MASK 0x7
+#define IMAGE_DATA_TYPE_SHIFT 4
+#define IMAGE_DATA_TYPE_MASK 0xF
 
 /* Extension types for textures.
  *
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/util_texture_cache.h"
+
+#include "util/util_logging.h"
+#include "util/util_types.h"
+
+#include <OpenImageIO/texture.h>
+
+CCL_NAMESPACE_BEGIN
+
+OIIO_NAMESPACE_USING
+
+struct TextureCacheImage {
+  TextureSystem *texture_system;
+  TextureSystem::TextureHandle *handle;
+};
+
+TextureCacheStats::TextureCacheStats()
+    : lookups(0), hits(0), misses(0), bytes_read(0), memory_used(0), num_files(0)
+{
+}
+
+TextureCache::TextureCache(int max_memory_MB)
+{
+  /* Not shared with OSL, which has its own memory limit. */
+  TextureSystem *ts = TextureSystem::create(false);
+
+  /* Files which are not tiled or mip-mapped on disk still work, but are
+   * tiled and mip-mapped in memory when first accessed. */
+  ts->attribute("automip", 1);
+  ts->attribute("autotile", 64);
+  ts->attribute("gray_to_rgb", 1);
+  ts->attribute("max_memory_MB", (float)max_memory_MB);
+
+  texture_system = ts;
+
+  VLOG(1) << "Texture cache created with " << max_memory_MB << " MB memory limit.";
+}
+
+TextureCache::~TextureCache()
+{
+  images.clear();
+  TextureSystem::destroy((TextureSystem *)texture_system);
+}
+
+bool TextureCache::get_image_info(const string &filepath, bool *r_is_tiled)
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  ImageSpec spec;
+
+  if (!ts->get_imagespec(ustring(filepath), 0, spec)) {
+    /* Clear error, it's fine to fall back to regular image loading. */
+    ts->geterror();
+    return false;
+  }
+
+  *r_is_tiled = (spec.tile_width > 0 && spec.tile_height > 0);
+  return true;
+}
+
+TextureCacheImage *TextureCache::add_image(const string &filepath)
+{
+  thread_scoped_lock lock(images_mutex);
+
+  auto it = images.find(filepath);
+  if (it != images.end()) {
+    return it->second.get();
+  }
+
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  TextureSystem::TextureHandle *handle = ts->get_texture_handle(ustring(filepath));
+  if (handle == NULL || !ts->good(handle)) {
+    ts->geterror();
+    return NULL;
+  }
+
+  TextureCacheImage *image = new TextureCacheImage();
+  image->texture_system = ts;
+  image->handle = handle;
+  images[filepath] = unique_ptr<TextureCacheImage>(image);
+
+  return image;
+}
+
+void TextureCache::invalidate(const string &filepath)
+{
+  ((TextureSystem *)texture_system)->invalidate(ustring(filepath));
+}
+
+TextureCacheStats TextureCache::get_stats()
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  TextureCacheStats stats;
+
+  long long find_tile_calls = 0, bytes_read = 0, memory_used = 0;
+  int cache_misses = 0, unique_files = 0;
+
+  ts->getattribute("stat:find_tile_calls", TypeDesc::INT64, &find_tile_calls);
+  ts->getattribute("stat:find_tile_cache_misses", TypeDesc::INT, &cache_misses);
+  ts->getattribute("stat:bytes_read", TypeDesc::INT64, &bytes_read);
+  ts->getattribute("stat:cache_memory_used", TypeDesc::INT64, &memory_used);
+  ts->getattribute("stat:unique_files", TypeDesc::INT, &unique_files);
+
+  stats.lookups = (uint64_t)find_tile_calls;
+  stats.misses = (uint64_t)cache_misses;
+  stats.hits = (stats.lookups > stats.misses) ? stats.lookups - stats.misses : 0;
+  stats.bytes_read = (uint64_t)bytes_read;
+  stats.memory_used = (uint64_t)memory_used;
+  stats.num_files = unique_files;
+
+  return stats;
+}
+
+/* Kernel Lookup */
+
+static TextureOpt::Wrap texture_cache_wrap_mode(const uint extension)
+{
+  switch (extension) {
+    case EXTENSION_REPEAT:
+      return TextureOpt::WrapPeriodic;
+    case EXTENSION_EXTEND:
+      return TextureOpt::WrapClamp;
+    case EXTENSION_CLIP:
+    default:
+      return TextureOpt::WrapBlack;
+  }
+}
+
+float4 texture_cache_lookup(const TextureInfo &info,
+                            float x,
+                            float y,
+                            float dsdx,
+                            float dtdx,
+                            float dsdy,
+                            float dtdy)
+{
+  const TextureCacheImage *image = (const TextureCacheImage *)info.data;
+  TextureSystem *ts = image->texture_system;
+
+  TextureOpt options;
+  options.swrap = options.twrap = texture_cache_wrap_mode(info.extension);
+  /* Images without alpha are opaque. */
+  options.fill = 1.0f;
+
+  switch (info.interpolation) {
+    case INTERPOLATION_CLOSEST:
+      options.interpmode = TextureOpt::InterpClosest;
+      options.mipmode = TextureOpt::MipModeOneLevel;
+      break;
+    case INTERPOLATION_CUBIC:
+    case INTERPOLATION_SMART:
+      options.interpmode = TextureOpt::InterpBicubic;
+      options.mipmode = TextureOpt::MipModeTrilinear;
+      break;
+    case INTERPOLATION_LINEAR:
+    default:
+      options.interpmode = TextureOpt::InterpBilinear;
+      options.mipmode = TextureOpt::MipModeTrilinear;
+      break;
+  }
+
+  /* Image origin is at the bottom in Cycles and at the top in OpenImageIO. */
+  float result[4];
+  if (!ts->texture(image->handle,
+                   ts->get_perthread_info(),
+                   options,
+                   x,
+                   1.0f - y,
+                   dsdx,
+                   -dtdx,
+                   dsdy,
+                   -dtdy,
+                   4,
+                   result)) {
+    ts->geterror();
+    return make_float4(
+        TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+  }
+
+  return make_float4(result[0], result[1], result[2], result[3]);
+}
+
+CCL_NAMESPACE_END
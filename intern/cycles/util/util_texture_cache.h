@@ -0,0 +1,85 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_TEXTURE_CACHE_H__
+#define __UTIL_TEXTURE_CACHE_H__
+
+#include "util/util_map.h"
+#include "util/util_string.h"
+#include "util/util_texture.h"
+#include "util/util_thread.h"
+#include "util/util_types.h"
+#include "util/util_unique_ptr.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Texture Cache
+ *
+ * Tiled and mip-mapped image access for CPU rendering. Instead of loading images fully into
+ * memory before rendering, tiles are read on demand at the mip level matching the lookup
+ * footprint, and the least recently used tiles are freed once the memory limit is reached.
+ *
+ * This wraps the OpenImageIO texture system, the same one used by OSL, so that SVM can use it
+ * too. Works best with files that are tiled and mip-mapped on disk (.tx, tiled EXR). */
+
+struct TextureCacheImage;
+
+struct TextureCacheStats {
+  TextureCacheStats();
+
+  /* Tile lookups, and how many of those found the tile in memory. */
+  uint64_t lookups;
+  uint64_t hits;
+  uint64_t misses;
+
+  uint64_t bytes_read;
+  uint64_t memory_used;
+  int num_files;
+};
+
+class TextureCache {
+ public:
+  explicit TextureCache(int max_memory_MB);
+  ~TextureCache();
+
+  /* Returns true when the file can be opened, and whether it is tiled on disk. */
+  bool get_image_info(const string &filepath, bool *r_is_tiled);
+
+  /* Get handle for an image, owned by the cache. Returns NULL on failure. */
+  TextureCacheImage *add_image(const string &filepath);
+  void invalidate(const string &filepath);
+
+  TextureCacheStats get_stats();
+
+ protected:
+  void *texture_system;
+  thread_mutex images_mutex;
+  map<string, unique_ptr<TextureCacheImage>> images;
+};
+
+/* Lookup for the kernel, #TextureInfo.data points to a #TextureCacheImage.
+ * Derivatives are in image space and select the mip level. */
+float4 texture_cache_lookup(const TextureInfo &info,
+                            float x,
+                            float y,
+                            float dsdx,
+                            float dtdx,
+                            float dsdy,
+                            float dtdy);
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_H__ */
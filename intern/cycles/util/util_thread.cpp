@@ -21,6 +21,8 @@
 
 CCL_NAMESPACE_BEGIN
 
+static thread_local int thread_current_node = -1;
+
 thread::thread(function<void()> run_cb, int node) : run_cb_(run_cb), joined_(false), node_(node)
 {
 #ifdef __APPLE__
@@ -47,7 +49,9 @@ void *thread::run(void *arg)
 {
   thread *self = (thread *)(arg);
   if (self->node_ != -1) {
-    system_cpu_run_thread_on_node(self->node_);
+    if (system_cpu_run_thread_on_node(self->node_)) {
+      thread_current_node = self->node_;
+    }
   }
   self->run_cb_();
   return NULL;
@@ -69,4 +73,9 @@ bool thread::join()
 #endif
 }
 
+int thread::current_node()
+{
+  return thread_current_node;
+}
+
 CCL_NAMESPACE_END
@@ -54,6 +54,9 @@ class thread {
   static void *run(void *arg);
   bool join();
 
+  /* Node the calling thread was pinned to, or -1 when it was not pinned. */
+  static int current_node();
+
  protected:
   function<void()> run_cb_;
 #ifdef __APPLE__
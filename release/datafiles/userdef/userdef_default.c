@@ -63,6 +63,7 @@ const UserDef U_default = {
                USER_CONTINUOUS_MOUSE | USER_SAVE_PROMPT),
     .uiflag2 = USER_REGION_OVERLAP,
     .gpu_flag = USER_GPU_FLAG_OVERLAY_SMOOTH_WIRE,
+    .gpu_shader_cache_size = 512,
     .app_flag = 0,
     /** Default language of English (1), not Automatic (0). */
     .language = 1,
@@ -129,6 +130,7 @@ const UserDef U_default = {
 
     /** Clamped by half the systems memory. */
     .memcachelimit = 4096,
+    .compositor_cache_limit = 1024,
 
     .prefetchframes = 0,
     .pad_rot_angle = 15,
@@ -606,6 +606,19 @@ class USERPREF_PT_system_memory(SystemPanel, CenterAlignMixIn, Panel):
         col.prop(system, "vbo_time_out", text="Vbo Time Out")
         col.prop(system, "vbo_collection_rate", text="Garbage Collection Rate")
 
+        layout.separator()
+
+        col = layout.column()
+        col.prop(system, "use_shader_disk_cache")
+        sub = col.column()
+        sub.active = system.use_shader_disk_cache
+        sub.prop(system, "shader_disk_cache_size", text="Limit")
+
+        layout.separator()
+
+        col = layout.column()
+        col.prop(system, "compositor_cache_limit", text="Compositor Cache Limit")
+
 
 class USERPREF_PT_system_video_sequencer(SystemPanel, CenterAlignMixIn, Panel):
     bl_label = "Video Sequencer"
@@ -701,6 +714,7 @@ class USERPREF_PT_viewport_selection(ViewportPanel, CenterAlignMixIn, Panel):
         system = prefs.system
 
         layout.prop(system, "use_select_pick_depth")
+        layout.prop(system, "use_select_cpu")
 
 
 # -----------------------------------------------------------------------------
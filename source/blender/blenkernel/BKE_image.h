@@ -179,6 +179,9 @@ bool BKE_image_has_ibuf(struct Image *ima, struct ImageUser *iuser);
 struct ImBuf *BKE_image_acquire_ibuf(struct Image *ima, struct ImageUser *iuser, void **r_lock);
 void BKE_image_release_ibuf(struct Image *ima, struct ImBuf *ibuf, void *lock);
 
+/* read an image sequence frame into the cache ahead of time, thread safe */
+bool BKE_image_prefetch_ibuf(struct Image *ima, struct ImageUser *iuser);
+
 struct ImagePool *BKE_image_pool_new(void);
 void BKE_image_pool_free(struct ImagePool *pool);
 struct ImBuf *BKE_image_pool_acquire_ibuf(struct Image *ima,
@@ -248,6 +251,14 @@ void BKE_image_multiview_index(struct Image *ima, struct ImageUser *iuser);
 
 /* for multilayer images as well as for render-viewer */
 bool BKE_image_is_multilayer(struct Image *ima);
+/* Read all passes of a multilayer image, which are otherwise loaded when first used.
+ * Returns false when a pass could not be read. */
+bool BKE_image_multilayer_ensure_passes_loaded(struct Image *ima);
+/* Read the given passes of a multilayer image together, see
+ * #BKE_image_multilayer_ensure_passes_loaded. */
+bool BKE_image_multilayer_passes_ensure_loaded(struct Image *ima,
+                                               struct RenderPass **rpasses,
+                                               int rpasses_len);
 bool BKE_image_is_multiview(struct Image *ima);
 bool BKE_image_is_stereo(struct Image *ima);
 struct RenderResult *BKE_image_acquire_renderresult(struct Scene *scene, struct Image *ima);
@@ -88,6 +88,7 @@ void BKE_sequence_iterator_end(SeqIterator *iter);
 
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
+  /* Prefetch threads use consecutive IDs starting from this one. */
   SEQ_TASK_PREFETCH_RENDER,
 } eSeqTaskId;
 
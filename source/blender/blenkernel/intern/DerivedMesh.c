@@ -57,6 +57,7 @@
 #include "BKE_mesh_mapping.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_mesh_tangent.h"
+#include "BKE_mesh_wrapper.h"
 #include "BKE_modifier.h"
 #include "BKE_multires.h"
 #include "BKE_object.h"
@@ -1401,6 +1402,15 @@ static void editbmesh_calc_modifier_final_normals(const Mesh *mesh_input,
    * simpler to generate it here as well. */
   const bool do_poly_normals = ((final_datamask->pmask & CD_MASK_NORMAL) != 0);
 
+  if (mesh_final->runtime.wrapper_type == ME_WRAPPER_TYPE_BMESH) {
+    if (!do_loop_normals && !do_poly_normals && !(final_datamask->fmask & CD_MASK_MFACE)) {
+      /* Display normals are taken from the edit-mesh, or calculated on conversion
+       * when the coordinates are deformed, see #BKE_mesh_wrapper_ensure_mdata. */
+      return;
+    }
+    BKE_mesh_wrapper_ensure_mdata(mesh_final);
+  }
+
   /* In case we also need poly normals, add the layer and compute them here
    * (BKE_mesh_calc_normals_split() assumes that if that data exists, it is always valid). */
   if (do_poly_normals) {
@@ -1501,8 +1511,7 @@ static void editbmesh_calc_modifiers(struct Depsgraph *depsgraph,
   /* Evaluate modifiers up to certain index to get the mesh cage. */
   int cageIndex = modifiers_getCageIndex(scene, ob, NULL, 1);
   if (r_cage && cageIndex == -1) {
-    mesh_cage = BKE_mesh_from_editmesh_with_coords_thin_wrap(
-        em_input, &final_datamask, NULL, mesh_input);
+    mesh_cage = BKE_mesh_wrapper_from_editmesh(em_input, &final_datamask, mesh_input);
   }
 
   /* Clear errors before evaluation. */
@@ -1657,7 +1666,7 @@ static void editbmesh_calc_modifiers(struct Depsgraph *depsgraph,
           BKE_mesh_runtime_ensure_edit_data(me_orig);
           me_orig->runtime.edit_data->vertexCos = MEM_dupallocN(deformed_verts);
         }
-        mesh_cage = BKE_mesh_from_editmesh_with_coords_thin_wrap(
+        mesh_cage = BKE_mesh_wrapper_from_editmesh_with_coords(
             em_input,
             &final_datamask,
             deformed_verts ? MEM_dupallocN(deformed_verts) : NULL,
@@ -1688,8 +1697,9 @@ static void editbmesh_calc_modifiers(struct Depsgraph *depsgraph,
     mesh_final = mesh_cage;
   }
   else {
-    /* this is just a copy of the editmesh, no need to calc normals */
-    mesh_final = BKE_mesh_from_editmesh_with_coords_thin_wrap(
+    /* This is just a wrapper of the edit-mesh, the mesh data is only
+     * created when accessed, see #BKE_mesh_wrapper_ensure_mdata. */
+    mesh_final = BKE_mesh_wrapper_from_editmesh_with_coords(
         em_input, &final_datamask, deformed_verts, mesh_input);
     deformed_verts = NULL;
   }
@@ -1700,6 +1710,8 @@ static void editbmesh_calc_modifiers(struct Depsgraph *depsgraph,
 
   /* Add orco coordinates to final and deformed mesh if requested. */
   if (final_datamask.vmask & CD_MASK_ORCO) {
+    /* The orco layer is stored with the vertex data, which wrappers don't have. */
+    BKE_mesh_wrapper_ensure_mdata(mesh_final);
     add_orco_mesh(ob, em_input, mesh_final, mesh_orco, CD_ORCO);
   }
 
@@ -2136,10 +2148,7 @@ void mesh_get_mapped_verts_coords(Mesh *me_eval, float (*r_cos)[3], const int to
     MEM_freeN(userData.vertex_visit);
   }
   else {
-    MVert *mv = me_eval->mvert;
-    for (int i = 0; i < totcos; i++, mv++) {
-      copy_v3_v3(r_cos[i], mv->co);
-    }
+    BKE_mesh_wrapper_vert_coords_copy(me_eval, r_cos, totcos);
   }
 }
 
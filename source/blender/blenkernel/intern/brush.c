@@ -2044,6 +2044,65 @@ float BKE_brush_curve_strength(const Brush *br, float p, const float len)
   return strength;
 }
 
+/**
+ * Same as #BKE_brush_curve_strength for an array of distances,
+ * the preset is resolved once so the loops can be vectorized.
+ */
+void BKE_brush_curve_strength_array(const Brush *br,
+                                    const float *dist,
+                                    const float len,
+                                    float *r_strength,
+                                    const int num)
+{
+#define CURVE_LOOP(expr) \
+  for (int i = 0; i < num; i++) { \
+    const float p = 1.0f - dist[i] / len; \
+    r_strength[i] = (dist[i] < len) ? (expr) : 0.0f; \
+  } \
+  ((void)0)
+
+  switch (br->curve_preset) {
+    case BRUSH_CURVE_CUSTOM:
+      for (int i = 0; i < num; i++) {
+        r_strength[i] = BKE_brush_curve_strength(br, dist[i], len);
+      }
+      break;
+    case BRUSH_CURVE_SHARP:
+      CURVE_LOOP(p * p);
+      break;
+    case BRUSH_CURVE_SMOOTH:
+      CURVE_LOOP(3.0f * p * p - 2.0f * p * p * p);
+      break;
+    case BRUSH_CURVE_SMOOTHER:
+      CURVE_LOOP(pow3f(p) * (p * (p * 6.0f - 15.0f) + 10.0f));
+      break;
+    case BRUSH_CURVE_ROOT:
+      CURVE_LOOP(sqrtf(max_ff(p, 0.0f)));
+      break;
+    case BRUSH_CURVE_LIN:
+      CURVE_LOOP(p);
+      break;
+    case BRUSH_CURVE_SPHERE:
+      CURVE_LOOP(sqrtf(max_ff(2 * p - p * p, 0.0f)));
+      break;
+    case BRUSH_CURVE_POW4:
+      CURVE_LOOP(p * p * p * p);
+      break;
+    case BRUSH_CURVE_INVSQUARE:
+      CURVE_LOOP(p * (2.0f - p));
+      break;
+    case BRUSH_CURVE_CONSTANT:
+    default:
+      /* Constant strength inside the radius, no falloff to evaluate. */
+      for (int i = 0; i < num; i++) {
+        r_strength[i] = (dist[i] < len) ? 1.0f : 0.0f;
+      }
+      break;
+  }
+
+#undef CURVE_LOOP
+}
+
 /* Uses the brush curve control to find a strength value between 0 and 1 */
 float BKE_brush_curve_strength_clamped(Brush *br, float p, const float len)
 {
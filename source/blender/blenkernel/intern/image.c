@@ -3349,6 +3349,8 @@ void BKE_image_signal(Main *bmain, Image *ima, ImageUser *iuser, int signal)
 
   BLI_mutex_lock(image_mutex);
 
+  ima->update_count++;
+
   switch (signal) {
     case IMA_SIGNAL_FREE:
       BKE_image_free_buffers(ima);
@@ -3883,6 +3885,140 @@ static void image_add_view(Image *ima, const char *viewname, const char *filepat
   }
 }
 
+/* Multilayer files read from disk are loaded without pixels, passes are read from the file
+ * when they are first used. All passes without pixels are read together, since the file is
+ * decoded as a whole for any number of passes. Returns false when a pass has no pixels. */
+static bool image_multilayer_passes_ensure_loaded(Image *ima,
+                                                  RenderResult *rr,
+                                                  RenderPass **rpasses,
+                                                  int rpasses_len)
+{
+#ifdef WITH_OPENEXR
+  ExrReadPass *read_passes = MEM_callocN(sizeof(*read_passes) * rpasses_len, __func__);
+  RenderPass **read_rpasses = MEM_mallocN(sizeof(*read_rpasses) * rpasses_len, __func__);
+  int read_passes_len = 0;
+
+  for (int i = 0; i < rpasses_len; i++) {
+    RenderPass *rpass = rpasses[i];
+    if (rpass->rect) {
+      continue;
+    }
+
+    RenderLayer *rl;
+    for (rl = rr->layers.first; rl; rl = rl->next) {
+      if (BLI_findindex(&rl->passes, rpass) != -1) {
+        break;
+      }
+    }
+    if (rl == NULL) {
+      continue;
+    }
+
+    read_rpasses[read_passes_len] = rpass;
+    ExrReadPass *read_pass = &read_passes[read_passes_len++];
+    read_pass->layname = rl->name;
+    read_pass->passname = rpass->name;
+    read_pass->viewname = rpass->view;
+    read_pass->totchan = rpass->channels;
+  }
+
+  if (read_passes_len) {
+    ImageUser iuser_t = {0};
+    char filepath[FILE_MAX];
+
+    iuser_t.framenr = rr->framenr;
+    BKE_image_user_file_path(&iuser_t, ima, filepath);
+
+    IMB_exr_read_passes(filepath, rr->rectx, rr->recty, read_passes, read_passes_len);
+  }
+
+  const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(
+      COLOR_ROLE_SCENE_LINEAR);
+
+  for (int i = 0; i < read_passes_len; i++) {
+    /* Passes listed more than once are only read once. */
+    RenderPass *rpass = read_rpasses[i];
+    if (read_passes[i].rect == NULL) {
+      continue;
+    }
+
+    rpass->rect = read_passes[i].rect;
+
+    /* Same conversion as done for all passes by #RE_MultilayerConvert. */
+    if (rpass->channels >= 3) {
+      IMB_colormanagement_transform(rpass->rect,
+                                    rpass->rectx,
+                                    rpass->recty,
+                                    rpass->channels,
+                                    ima->colorspace_settings.name,
+                                    to_colorspace,
+                                    ima->alpha_mode == IMA_ALPHA_PREMUL);
+    }
+  }
+
+  MEM_freeN(read_passes);
+  MEM_freeN(read_rpasses);
+#else
+  UNUSED_VARS(ima, rr);
+#endif
+
+  for (int i = 0; i < rpasses_len; i++) {
+    if (rpasses[i]->rect == NULL) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool image_multilayer_pass_ensure_loaded(Image *ima, RenderResult *rr, RenderPass *rpass)
+{
+  return image_multilayer_passes_ensure_loaded(ima, rr, &rpass, 1);
+}
+
+bool BKE_image_multilayer_passes_ensure_loaded(Image *ima, RenderPass **rpasses, int rpasses_len)
+{
+  bool ok = false;
+
+  BLI_mutex_lock(image_mutex);
+
+  if (ima->rr && ima->type == IMA_TYPE_MULTILAYER) {
+    ok = image_multilayer_passes_ensure_loaded(ima, ima->rr, rpasses, rpasses_len);
+  }
+
+  BLI_mutex_unlock(image_mutex);
+
+  return ok;
+}
+
+bool BKE_image_multilayer_ensure_passes_loaded(Image *ima)
+{
+  bool ok = true;
+
+  BLI_mutex_lock(image_mutex);
+
+  if (ima->rr && ima->type == IMA_TYPE_MULTILAYER) {
+    int rpasses_len = 0;
+    LISTBASE_FOREACH (RenderLayer *, rl, &ima->rr->layers) {
+      rpasses_len += BLI_listbase_count(&rl->passes);
+    }
+
+    RenderPass **rpasses = MEM_mallocN(sizeof(*rpasses) * rpasses_len, __func__);
+    int i = 0;
+    LISTBASE_FOREACH (RenderLayer *, rl, &ima->rr->layers) {
+      LISTBASE_FOREACH (RenderPass *, rpass, &rl->passes) {
+        rpasses[i++] = rpass;
+      }
+    }
+
+    ok = image_multilayer_passes_ensure_loaded(ima, ima->rr, rpasses, rpasses_len);
+    MEM_freeN(rpasses);
+  }
+
+  BLI_mutex_unlock(image_mutex);
+
+  return ok;
+}
+
 /* after imbuf load, openexr type can return with a exrhandle open */
 /* in that case we have to build a render-result */
 #ifdef WITH_OPENEXR
@@ -3985,7 +4121,7 @@ static ImBuf *load_sequence_single(
   iuser_t.view = view_id;
   BKE_image_user_file_path(&iuser_t, ima, name);
 
-  flag = IB_rect | IB_multilayer | IB_metadata;
+  flag = IB_rect | IB_multilayer | IB_multilayer_deferred | IB_metadata;
   flag |= imbuf_alpha_flags_for_image(ima);
 
   /* read ibuf */
@@ -4111,7 +4247,7 @@ static ImBuf *image_load_sequence_multilayer(Image *ima, ImageUser *iuser, int e
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-    if (rpass) {
+    if (rpass && image_multilayer_pass_ensure_loaded(ima, ima->rr, rpass)) {
       // printf("load from pass %s\n", rpass->name);
       /* since we free  render results, we copy the rect */
       ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
@@ -4295,7 +4431,7 @@ static ImBuf *load_image_single(Image *ima,
   else {
     ImageUser iuser_t;
 
-    flag = IB_rect | IB_multilayer | IB_metadata;
+    flag = IB_rect | IB_multilayer | IB_multilayer_deferred | IB_metadata;
     flag |= imbuf_alpha_flags_for_image(ima);
 
     /* get the correct filepath */
@@ -4442,7 +4578,7 @@ static ImBuf *image_get_ibuf_multilayer(Image *ima, ImageUser *iuser)
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-    if (rpass) {
+    if (rpass && image_multilayer_pass_ensure_loaded(ima, ima->rr, rpass)) {
       ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
 
       image_initialize_after_load(ima, iuser, ibuf);
@@ -4980,6 +5116,87 @@ void BKE_image_release_ibuf(Image *ima, ImBuf *ibuf, void *lock)
   }
 }
 
+/* Load the image buffer of an image sequence frame into the image cache, so a later acquire
+ * does not have to wait for the file to be read. The file is read without holding the image
+ * lock, so other threads can keep acquiring buffers meanwhile.
+ *
+ * Only regular image sequences are supported, multilayer and multiview sequences store the
+ * loaded frame in the image itself. Returns true when a buffer was added to the cache. */
+bool BKE_image_prefetch_ibuf(Image *ima, ImageUser *iuser)
+{
+  char name[FILE_MAX];
+  char colorspace[sizeof(ima->colorspace_settings.name)];
+  ImBuf *ibuf;
+  int flag, index, entry;
+
+  BLI_mutex_lock(image_mutex);
+
+  if (ima->source != IMA_SRC_SEQUENCE || ima->type != IMA_TYPE_IMAGE ||
+      BKE_image_is_multiview(ima)) {
+    BLI_mutex_unlock(image_mutex);
+    return false;
+  }
+
+  index = image_get_multiview_index(ima, iuser);
+  entry = iuser->framenr;
+  ibuf = image_get_cached_ibuf_for_index_entry(ima, index, entry);
+  if (ibuf) {
+    IMB_freeImBuf(ibuf);
+    BLI_mutex_unlock(image_mutex);
+    return false;
+  }
+
+  BKE_image_user_file_path(iuser, ima, name);
+  flag = IB_rect | IB_multilayer | IB_metadata;
+  flag |= imbuf_alpha_flags_for_image(ima);
+  BLI_strncpy(colorspace, ima->colorspace_settings.name, sizeof(colorspace));
+
+  BLI_mutex_unlock(image_mutex);
+
+  ibuf = IMB_loadiffname(name, flag, colorspace);
+  if (ibuf == NULL) {
+    return false;
+  }
+
+  bool assigned = false;
+
+  BLI_mutex_lock(image_mutex);
+
+#ifdef WITH_OPENEXR
+  /* Multilayer files are handled by image_acquire_ibuf, which changes the image type. */
+  const bool is_multilayer = (ibuf->ftype == IMB_FTYPE_OPENEXR && ibuf->userdata);
+#else
+  const bool is_multilayer = false;
+#endif
+
+  if (!is_multilayer && ima->source == IMA_SRC_SEQUENCE && ima->type == IMA_TYPE_IMAGE) {
+    ImBuf *cached_ibuf = image_get_cached_ibuf_for_index_entry(ima, index, entry);
+    if (cached_ibuf) {
+      /* Loaded by another thread meanwhile. */
+      IMB_freeImBuf(cached_ibuf);
+    }
+    else {
+      image_initialize_after_load(ima, iuser, ibuf);
+      image_assign_ibuf(ima, ibuf, index, entry);
+      assigned = true;
+    }
+  }
+
+#ifdef WITH_OPENEXR
+  if (is_multilayer) {
+    /* The open file is not closed when freeing the buffer. */
+    IMB_exr_close(ibuf->userdata);
+    ibuf->userdata = NULL;
+  }
+#endif
+
+  IMB_freeImBuf(ibuf);
+
+  BLI_mutex_unlock(image_mutex);
+
+  return assigned;
+}
+
 /* checks whether there's an image buffer for given image and user */
 bool BKE_image_has_ibuf(Image *ima, ImageUser *iuser)
 {
@@ -5527,9 +5744,10 @@ bool BKE_image_is_dirty(Image *image)
   return BKE_image_is_dirty_writable(image, NULL);
 }
 
-void BKE_image_mark_dirty(Image *UNUSED(image), ImBuf *ibuf)
+void BKE_image_mark_dirty(Image *image, ImBuf *ibuf)
 {
   ibuf->userflags |= IB_BITMAPDIRTY;
+  image->update_count++;
 }
 
 bool BKE_image_buffer_format_writable(ImBuf *ibuf)
@@ -178,6 +178,13 @@ static bool image_save_single(ReportList *reports,
     }
   }
 
+  /* passes of multilayer images are read on demand, all of them are written */
+  if (!BKE_image_multilayer_ensure_passes_loaded(ima)) {
+    BKE_report(reports, RPT_ERROR, "Did not write, could not read all passes of the image");
+    BKE_image_release_ibuf(ima, ibuf, lock);
+    goto cleanup;
+  }
+
   /* we need renderresult for exr and rendered multiview */
   rr = BKE_image_acquire_renderresult(opts->scene, ima);
   bool is_mono = rr ? BLI_listbase_count_at_most(&rr->views, 2) < 2 :
@@ -854,7 +854,8 @@ Mesh *BKE_mesh_from_bmesh_for_eval_nomain(BMesh *bm,
 }
 
 /**
- * TODO(campbell): support mesh with only an edit-mesh which is lazy initialized.
+ * \note Prefer #BKE_mesh_wrapper_from_editmesh_with_coords for evaluated meshes,
+ * which only converts the edit-mesh when the mesh data is accessed.
  */
 Mesh *BKE_mesh_from_editmesh_with_coords_thin_wrap(BMEditMesh *em,
                                                    const CustomData_MeshMasks *cd_mask_extra,
@@ -47,6 +47,7 @@
 #include "BKE_mball.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_runtime.h"
+#include "BKE_mesh_wrapper.h"
 #include "BKE_modifier.h"
 /* these 2 are only used by conversion functions */
 #include "BKE_curve.h"
@@ -1128,6 +1129,7 @@ static Mesh *mesh_new_from_mesh_object(Depsgraph *depsgraph,
    * viewport is using for visualization. */
   if (mesh_input->edit_mesh != NULL && mesh_input->edit_mesh->mesh_eval_final) {
     mesh_input = mesh_input->edit_mesh->mesh_eval_final;
+    BKE_mesh_wrapper_ensure_mdata(mesh_input);
   }
   return mesh_new_from_mesh(object, mesh_input);
 }
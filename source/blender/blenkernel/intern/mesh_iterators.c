@@ -24,14 +24,39 @@
 #include "DNA_meshdata_types.h"
 
 #include "BKE_customdata.h"
+#include "BKE_editmesh.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_iterators.h"
+#include "BKE_mesh_wrapper.h"
 
 #include "BLI_bitmap.h"
 #include "BLI_math.h"
 
 #include "MEM_guardedalloc.h"
 
+/**
+ * Edit-mesh wrappers (see #BKE_mesh_wrapper_from_editmesh) are iterated directly,
+ * unless normals are requested which are only available once converted.
+ */
+static BMesh *mesh_foreach_wrapper_bmesh_get(Mesh *mesh,
+                                             MeshForeachFlag flag,
+                                             const float (**r_vert_coords)[3])
+{
+  if (mesh->runtime.wrapper_type == ME_WRAPPER_TYPE_BMESH) {
+    if ((flag & MESH_FOREACH_USE_NORMAL) == 0) {
+      BMesh *bm = mesh->runtime.edit_mesh_wrap->bm;
+      *r_vert_coords = (const float(*)[3])mesh->runtime.edit_data->vertexCos;
+      if (*r_vert_coords != NULL) {
+        BM_mesh_elem_index_ensure(bm, BM_VERT);
+      }
+      return bm;
+    }
+    BKE_mesh_wrapper_ensure_mdata(mesh);
+  }
+  *r_vert_coords = NULL;
+  return NULL;
+}
+
 /* Copied from cdDM_foreachMappedVert */
 void BKE_mesh_foreach_mapped_vert(Mesh *mesh,
                                   void (*func)(void *userData,
@@ -42,6 +67,18 @@ void BKE_mesh_foreach_mapped_vert(Mesh *mesh,
                                   void *userData,
                                   MeshForeachFlag flag)
 {
+  const float(*vert_coords)[3];
+  BMesh *bm = mesh_foreach_wrapper_bmesh_get(mesh, flag, &vert_coords);
+  if (bm != NULL) {
+    BMIter iter;
+    BMVert *eve;
+    int i;
+    BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, i) {
+      func(userData, i, vert_coords ? vert_coords[i] : eve->co, NULL, NULL);
+    }
+    return;
+  }
+
   const MVert *mv = mesh->mvert;
   const int *index = CustomData_get_layer(&mesh->vdata, CD_ORIGINDEX);
 
@@ -69,6 +106,28 @@ void BKE_mesh_foreach_mapped_edge(
     void (*func)(void *userData, int index, const float v0co[3], const float v1co[3]),
     void *userData)
 {
+  const float(*vert_coords)[3];
+  BMesh *bm = mesh_foreach_wrapper_bmesh_get(mesh, MESH_FOREACH_NOP, &vert_coords);
+  if (bm != NULL) {
+    BMIter iter;
+    BMEdge *eed;
+    int i;
+    if (vert_coords) {
+      BM_ITER_MESH_INDEX (eed, &iter, bm, BM_EDGES_OF_MESH, i) {
+        func(userData,
+             i,
+             vert_coords[BM_elem_index_get(eed->v1)],
+             vert_coords[BM_elem_index_get(eed->v2)]);
+      }
+    }
+    else {
+      BM_ITER_MESH_INDEX (eed, &iter, bm, BM_EDGES_OF_MESH, i) {
+        func(userData, i, eed->v1->co, eed->v2->co);
+      }
+    }
+    return;
+  }
+
   const MVert *mv = mesh->mvert;
   const MEdge *med = mesh->medge;
   const int *index = CustomData_get_layer(&mesh->edata, CD_ORIGINDEX);
@@ -99,6 +158,9 @@ void BKE_mesh_foreach_mapped_loop(Mesh *mesh,
                                   void *userData,
                                   MeshForeachFlag flag)
 {
+  /* Loops are always iterated from mesh data. */
+  BKE_mesh_wrapper_ensure_mdata(mesh);
+
   /* We can't use dm->getLoopDataLayout(dm) here,
    * we want to always access dm->loopData, EditDerivedBMesh would
    * return loop data from bmesh itself. */
@@ -145,6 +207,25 @@ void BKE_mesh_foreach_mapped_face_center(
     void *userData,
     MeshForeachFlag flag)
 {
+  const float(*vert_coords)[3];
+  BMesh *bm = mesh_foreach_wrapper_bmesh_get(mesh, flag, &vert_coords);
+  if (bm != NULL) {
+    BMIter iter;
+    BMFace *efa;
+    int i;
+    BM_ITER_MESH_INDEX (efa, &iter, bm, BM_FACES_OF_MESH, i) {
+      float cent[3];
+      if (vert_coords) {
+        BM_face_calc_center_median_vcos(bm, efa, cent, vert_coords);
+      }
+      else {
+        BM_face_calc_center_median(efa, cent);
+      }
+      func(userData, i, cent, NULL);
+    }
+    return;
+  }
+
   const MVert *mvert = mesh->mvert;
   const MPoly *mp = mesh->mpoly;
   const MLoop *ml;
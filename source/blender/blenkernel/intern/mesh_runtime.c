@@ -62,8 +62,18 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
 {
   Mesh_Runtime *runtime = &mesh->runtime;
 
+  /* A wrapped edit-mesh keeps its deformed coordinates in the edit data,
+   * the copy needs its own array to remain a valid wrapper. */
+  const EditMeshData *edit_data_src = runtime->edit_data;
+
   runtime->mesh_eval = NULL;
   runtime->edit_data = NULL;
+  if (runtime->wrapper_type == ME_WRAPPER_TYPE_BMESH) {
+    BKE_mesh_runtime_ensure_edit_data(mesh);
+    if (edit_data_src && edit_data_src->vertexCos) {
+      runtime->edit_data->vertexCos = MEM_dupallocN(edit_data_src->vertexCos);
+    }
+  }
   runtime->batch_cache = NULL;
   runtime->subdiv_ccg = NULL;
   memset(&runtime->looptris, 0, sizeof(runtime->looptris));
@@ -0,0 +1,201 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ *
+ * The primary purpose of this API is to avoid unnecessary mesh conversion for the final
+ * output of a modified mesh in edit-mode.
+ *
+ * This API handles the case when the modifier stack outputs a mesh which does not have
+ * #Mesh data (#Mesh.mpoly, #Mesh.mloop, #Mesh.medge, #Mesh.mvert).
+ * Currently this is used so the resulting mesh can have #BMEditMesh data,
+ * postponing the converting until it's needed or avoiding conversion entirely
+ * which can be an expensive operation.
+ * Once converted, the mesh is the same as any other (#ME_WRAPPER_TYPE_MDATA).
+ *
+ * Callers which access mesh data directly must call #BKE_mesh_wrapper_ensure_mdata first,
+ * callers which only need vertex locations can use #BKE_mesh_wrapper_vert_coords_copy.
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_editmesh.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
+#include "BKE_mesh_wrapper.h"
+
+#include "bmesh.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Wrapper Creation
+ * \{ */
+
+/**
+ * Create a mesh which exposes the edit-mesh without copying any of its data.
+ *
+ * \param vert_coords: Optional deformed coordinates, ownership is transferred to the mesh.
+ */
+Mesh *BKE_mesh_wrapper_from_editmesh_with_coords(BMEditMesh *em,
+                                                 const CustomData_MeshMasks *cd_mask_extra,
+                                                 float (*vert_coords)[3],
+                                                 const Mesh *me_settings)
+{
+  Mesh *me = BKE_id_new_nomain(ID_ME, NULL);
+  BKE_mesh_copy_settings(me, me_settings);
+  BKE_mesh_runtime_ensure_edit_data(me);
+
+  me->runtime.wrapper_type = ME_WRAPPER_TYPE_BMESH;
+  me->runtime.edit_mesh_wrap = em;
+  if (cd_mask_extra) {
+    me->runtime.cd_mask_extra = *cd_mask_extra;
+  }
+
+  /* Use edit-mesh directly where possible. */
+  me->runtime.is_original = true;
+  me->runtime.deformed_only = true;
+
+  me->runtime.edit_data->vertexCos = vert_coords;
+  if (vert_coords) {
+    me->runtime.is_original = false;
+  }
+
+  return me;
+}
+
+Mesh *BKE_mesh_wrapper_from_editmesh(BMEditMesh *em,
+                                     const CustomData_MeshMasks *cd_mask_extra,
+                                     const Mesh *me_settings)
+{
+  return BKE_mesh_wrapper_from_editmesh_with_coords(em, cd_mask_extra, NULL, me_settings);
+}
+
+/**
+ * Convert the wrapped edit-mesh into regular mesh data, does nothing for other meshes.
+ * Safe to call from multiple threads.
+ */
+void BKE_mesh_wrapper_ensure_mdata(Mesh *me)
+{
+  ThreadMutex *mesh_eval_mutex = (ThreadMutex *)me->runtime.eval_mutex;
+  BLI_mutex_lock(mesh_eval_mutex);
+
+  if (me->runtime.wrapper_type == ME_WRAPPER_TYPE_MDATA) {
+    BLI_mutex_unlock(mesh_eval_mutex);
+    return;
+  }
+
+  BMEditMesh *em = me->runtime.edit_mesh_wrap;
+  EditMeshData *edit_data = me->runtime.edit_data;
+  BLI_assert(em != NULL);
+
+  BM_mesh_bm_to_me_for_eval(em->bm, me, &me->runtime.cd_mask_extra);
+
+  if (edit_data && edit_data->vertexCos) {
+    BKE_mesh_vert_coords_apply(me, (const float(*)[3])edit_data->vertexCos);
+    me->runtime.is_original = false;
+    /* Normals of the edit-mesh don't match the deformed coordinates. */
+    BKE_mesh_ensure_normals_for_display(me);
+  }
+  else {
+    /* Same as #BKE_mesh_from_editmesh_with_coords_thin_wrap. */
+    me->runtime.is_original = true;
+  }
+
+  /* Only set once the data is complete, other threads may test this without locking. */
+  me->runtime.wrapper_type = ME_WRAPPER_TYPE_MDATA;
+
+  BLI_mutex_unlock(mesh_eval_mutex);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Wrapper Access
+ * \{ */
+
+bool BKE_mesh_wrapper_minmax(const Mesh *me, float min[3], float max[3])
+{
+  switch ((eMeshWrapperType)me->runtime.wrapper_type) {
+    case ME_WRAPPER_TYPE_BMESH: {
+      const BMesh *bm = me->runtime.edit_mesh_wrap->bm;
+      const EditMeshData *edit_data = me->runtime.edit_data;
+      if (edit_data->vertexCos) {
+        for (int i = 0; i < bm->totvert; i++) {
+          minmax_v3v3_v3(min, max, edit_data->vertexCos[i]);
+        }
+      }
+      else {
+        BMIter iter;
+        BMVert *eve;
+        BM_ITER_MESH (eve, &iter, (BMesh *)bm, BM_VERTS_OF_MESH) {
+          minmax_v3v3_v3(min, max, eve->co);
+        }
+      }
+      return (bm->totvert != 0);
+    }
+    case ME_WRAPPER_TYPE_MDATA:
+      return BKE_mesh_minmax(me, min, max);
+  }
+  BLI_assert(0);
+  return false;
+}
+
+void BKE_mesh_wrapper_vert_coords_copy(const Mesh *me,
+                                       float (*vert_coords)[3],
+                                       int vert_coords_len)
+{
+  switch ((eMeshWrapperType)me->runtime.wrapper_type) {
+    case ME_WRAPPER_TYPE_BMESH: {
+      BMesh *bm = me->runtime.edit_mesh_wrap->bm;
+      const EditMeshData *edit_data = me->runtime.edit_data;
+      BLI_assert(vert_coords_len <= bm->totvert);
+      if (edit_data->vertexCos != NULL) {
+        memcpy(vert_coords, edit_data->vertexCos, sizeof(*vert_coords) * vert_coords_len);
+      }
+      else {
+        BMIter iter;
+        BMVert *eve;
+        int i;
+        BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, i) {
+          if (i == vert_coords_len) {
+            break;
+          }
+          copy_v3_v3(vert_coords[i], eve->co);
+        }
+      }
+      return;
+    }
+    case ME_WRAPPER_TYPE_MDATA: {
+      BLI_assert(vert_coords_len <= me->totvert);
+      const MVert *mvert = me->mvert;
+      for (int i = 0; i < vert_coords_len; i++) {
+        copy_v3_v3(vert_coords[i], mvert[i].co);
+      }
+      return;
+    }
+  }
+  BLI_assert(0);
+}
+
+/** \} */
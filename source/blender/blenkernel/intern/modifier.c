@@ -56,6 +56,7 @@
 #include "BKE_lib_id.h"
 #include "BKE_lib_query.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_wrapper.h"
 #include "BKE_multires.h"
 #include "BKE_object.h"
 
@@ -1019,6 +1020,10 @@ Mesh *BKE_modifier_get_evaluated_mesh_from_evaluated_object(Object *ob_eval,
              ob_eval->runtime.mesh_deform_eval :
              BKE_object_get_evaluated_mesh(ob_eval);
   }
+  else {
+    /* Modifiers read the mesh data directly. */
+    BKE_mesh_wrapper_ensure_mdata(me);
+  }
 
   return me;
 }
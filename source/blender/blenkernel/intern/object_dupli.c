@@ -51,6 +51,7 @@
 #include "BKE_mesh.h"
 #include "BKE_mesh_iterators.h"
 #include "BKE_mesh_runtime.h"
+#include "BKE_mesh_wrapper.h"
 #include "BKE_object.h"
 #include "BKE_particle.h"
 #include "BKE_scene.h"
@@ -432,6 +433,8 @@ static void make_duplis_verts(const DupliContext *ctx)
       return;
     }
 
+    BKE_mesh_wrapper_ensure_mdata(vdd.me_eval);
+
     vdd.orco = CustomData_get_layer(&vdd.me_eval->vdata, CD_ORCO);
     vdd.totvert = vdd.me_eval->totvert;
   }
@@ -708,6 +711,8 @@ static void make_duplis_faces(const DupliContext *ctx)
       return;
     }
 
+    BKE_mesh_wrapper_ensure_mdata(fdd.me_eval);
+
     fdd.orco = CustomData_get_layer(&fdd.me_eval->vdata, CD_ORCO);
     const int uv_idx = CustomData_get_render_layer(&fdd.me_eval->ldata, CD_MLOOPUV);
     fdd.mloopuv = CustomData_get_layer_n(&fdd.me_eval->ldata, CD_MLOOPUV, uv_idx);
@@ -49,6 +49,14 @@
 #include "BKE_scene.h"
 #include "BKE_sequencer.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#endif
+
 /**
  * Sequencer Cache Design Notes
  * ============================
@@ -81,8 +89,10 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
+ * Image data can be stored uncompressed, or compressed with LZO or Zlib (per image).
  * Images are written in order in which they are rendered.
+ * Writing happens on a separate thread, images are queued and written in batches per file.
+ * Invalidation removes queued images from the queue, so they can't be written afterwards.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
  * size specified in user preferences.
@@ -94,11 +104,20 @@
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 2
+#define DCACHE_MAX_QUEUED_WRITES 16
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
 
+/* #DiskCacheHeaderEntry.compression */
+enum {
+  DCACHE_COMPRESSION_NONE = 0,
+  DCACHE_COMPRESSION_ZLIB = 1,
+  DCACHE_COMPRESSION_LZO = 2,
+};
+
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char compression;
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -116,8 +135,23 @@ typedef struct SeqDiskCache {
   ListBase files;
   ThreadMutex read_write_mutex;
   size_t size_total;
+
+  /* Images waiting to be written by the write thread, protected by read_write_mutex. */
+  ListBase write_queue;
+  int write_queue_len;
+  ThreadCondition write_queue_cond;
+  ListBase write_thread;
+  bool write_thread_exit;
 } SeqDiskCache;
 
+typedef struct DiskCacheWriteItem {
+  struct DiskCacheWriteItem *next, *prev;
+  char path[FILE_MAX];
+  int cache_type;
+  float nfra;
+  struct ImBuf *ibuf;
+} DiskCacheWriteItem;
+
 typedef struct DiskCacheFile {
   struct DiskCacheFile *next, *prev;
   char path[FILE_MAX];
@@ -172,11 +206,28 @@ static char *seq_disk_cache_base_dir(void)
   return U.sequencer_disk_cache_dir;
 }
 
+static int seq_disk_cache_compression(void)
+{
+  switch (U.sequencer_disk_cache_compression) {
+    case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
+      return DCACHE_COMPRESSION_NONE;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
+#ifdef WITH_LZO
+      return DCACHE_COMPRESSION_LZO;
+#else
+      return DCACHE_COMPRESSION_ZLIB;
+#endif
+  }
+
+  return DCACHE_COMPRESSION_ZLIB;
+}
+
 static int seq_disk_cache_compression_level(void)
 {
   switch (U.sequencer_disk_cache_compression) {
     case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
       return 0;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
       return 1;
     case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
@@ -453,6 +504,26 @@ static void seq_disk_cache_delete_invalid_files(SeqDiskCache *disk_cache,
     }
     cache_file = next_file;
   }
+
+  /* Images waiting to be written to the deleted files are outdated as well. */
+  LISTBASE_FOREACH_MUTABLE (DiskCacheWriteItem *, item, &disk_cache->write_queue) {
+    if (item->cache_type & invalidate_types) {
+      char item_dir[FILE_MAXDIR];
+      BLI_split_dir_part(item->path, item_dir, sizeof(item_dir));
+      if (strcmp(cache_dir, item_dir) == 0) {
+        int start_frame = ((int)item->nfra / DCACHE_IMAGES_PER_FILE) * DCACHE_IMAGES_PER_FILE;
+        int cfra_start = seq_cache_frame_index_to_cfra(seq, start_frame);
+        if (cfra_start > range_start && cfra_start <= range_end) {
+          BLI_remlink(&disk_cache->write_queue, item);
+          disk_cache->write_queue_len--;
+          IMB_freeImBuf(item->ibuf);
+          MEM_freeN(item);
+        }
+      }
+    }
+  }
+
+  BLI_condition_notify_all(&disk_cache->write_queue_cond);
 }
 
 static void seq_disk_cache_invalidate(Scene *scene,
@@ -474,31 +545,127 @@ static void seq_disk_cache_invalidate(Scene *scene,
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
-static size_t deflate_imbuf_to_file(ImBuf *ibuf,
-                                    FILE *file,
-                                    int level,
-                                    DiskCacheHeaderEntry *header_entry)
+static void *seq_disk_cache_imbuf_data(ImBuf *ibuf)
 {
   if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
+    return ibuf->rect;
   }
-  else {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
+  return ibuf->rect_float;
+}
+
+static size_t seq_disk_cache_write_uncompressed(void *data, FILE *file, size_t size)
+{
+  if (fwrite(data, 1, size, file) != size || ferror(file)) {
+    return 0;
   }
+
+  return size;
 }
 
-static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
+#ifdef WITH_LZO
+#  define DCACHE_LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+
+static size_t seq_disk_cache_write_lzo(void *data, FILE *file, size_t size)
 {
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
+  unsigned char *out = MEM_mallocN(DCACHE_LZO_OUT_LEN(size), "seq disk cache lzo buffer");
+  void *wrkmem = MEM_mallocN(LZO1X_MEM_COMPRESS, "seq disk cache lzo work memory");
+  lzo_uint out_len = DCACHE_LZO_OUT_LEN(size);
+  size_t bytes_written = 0;
+
+  int r = lzo1x_1_compress(data, (lzo_uint)size, out, &out_len, wrkmem);
+  if (r == LZO_E_OK && out_len < size) {
+    bytes_written = seq_disk_cache_write_uncompressed(out, file, out_len);
   }
-  else {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
+
+  MEM_freeN(wrkmem);
+  MEM_freeN(out);
+
+  return bytes_written;
+}
+
+static size_t seq_disk_cache_read_lzo(void *data, FILE *file, size_t size, size_t size_compressed)
+{
+  unsigned char *in = MEM_mallocN(size_compressed, "seq disk cache lzo buffer");
+  lzo_uint out_len = size;
+  size_t bytes_read = 0;
+
+  if (fread(in, 1, size_compressed, file) == size_compressed) {
+    int r = lzo1x_decompress_safe(in, (lzo_uint)size_compressed, data, &out_len, NULL);
+    if (r == LZO_E_OK) {
+      bytes_read = out_len;
+    }
   }
+
+  MEM_freeN(in);
+
+  return bytes_read;
+}
+
+#  undef DCACHE_LZO_OUT_LEN
+#endif
+
+/* Returns number of bytes written to the file, stores the compression that was used in the
+ * header entry. Data that doesn't get smaller with LZO is stored uncompressed. */
+static size_t seq_disk_cache_write_imbuf(ImBuf *ibuf,
+                                         FILE *file,
+                                         int compression,
+                                         DiskCacheHeaderEntry *header_entry)
+{
+  void *data = seq_disk_cache_imbuf_data(ibuf);
+  size_t bytes_written = 0;
+
+  if (compression == DCACHE_COMPRESSION_ZLIB) {
+    header_entry->compression = DCACHE_COMPRESSION_ZLIB;
+    return BLI_gzip_mem_to_file_at_pos(data,
+                                       header_entry->size_raw,
+                                       file,
+                                       header_entry->offset,
+                                       seq_disk_cache_compression_level());
+  }
+
+  fseek(file, header_entry->offset, SEEK_SET);
+
+#ifdef WITH_LZO
+  if (compression == DCACHE_COMPRESSION_LZO) {
+    header_entry->compression = DCACHE_COMPRESSION_LZO;
+    bytes_written = seq_disk_cache_write_lzo(data, file, header_entry->size_raw);
+    if (bytes_written != 0) {
+      return bytes_written;
+    }
+    fseek(file, header_entry->offset, SEEK_SET);
+  }
+#endif
+
+  header_entry->compression = DCACHE_COMPRESSION_NONE;
+  bytes_written = seq_disk_cache_write_uncompressed(data, file, header_entry->size_raw);
+
+  return bytes_written;
+}
+
+/* Returns number of bytes of image data read from the file. */
+static size_t seq_disk_cache_read_imbuf(ImBuf *ibuf,
+                                        FILE *file,
+                                        DiskCacheHeaderEntry *header_entry)
+{
+  void *data = seq_disk_cache_imbuf_data(ibuf);
+
+  switch (header_entry->compression) {
+    case DCACHE_COMPRESSION_ZLIB:
+      return BLI_ungzip_file_to_mem_at_pos(
+          data, header_entry->size_raw, file, header_entry->offset);
+    case DCACHE_COMPRESSION_NONE:
+      /* Read directly into the image buffer, without any intermediate copies. */
+      fseek(file, header_entry->offset, SEEK_SET);
+      return fread(data, 1, header_entry->size_raw, file);
+#ifdef WITH_LZO
+    case DCACHE_COMPRESSION_LZO:
+      fseek(file, header_entry->offset, SEEK_SET);
+      return seq_disk_cache_read_lzo(
+          data, file, header_entry->size_raw, header_entry->size_compressed);
+#endif
+  }
+
+  return 0;
 }
 
 static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
@@ -522,7 +689,7 @@ static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
   return fwrite(header, sizeof(*header), 1, file);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+static int seq_disk_cache_add_header_entry(float nfra, ImBuf *ibuf, DiskCacheHeader *header)
 {
   int i;
   uint64_t offset = sizeof(*header);
@@ -555,7 +722,7 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
   }
 
   header->entry[i].offset = offset;
-  header->entry[i].frameno = key->nfra;
+  header->entry[i].frameno = nfra;
 
   /* Store colorspace name of ibuf. */
   const char *colorspace_name;
@@ -584,11 +751,12 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *he
   return -1;
 }
 
-static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+/* Write a batch of queued images, which all belong to the same file. */
+static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, ListBase *batch)
 {
-  char path[FILE_MAX];
+  DiskCacheWriteItem *first_item = batch->first;
+  char *path = first_item->path;
 
-  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
   BLI_make_existing_file(path);
 
   FILE *file = BLI_fopen(path, "rb+");
@@ -603,23 +771,102 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
   DiskCacheHeader header;
   memset(&header, 0, sizeof(header));
   seq_disk_cache_read_header(file, &header);
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
 
-  if (bytes_written != 0) {
+  const int compression = seq_disk_cache_compression();
+  bool written = false;
+
+  LISTBASE_FOREACH (DiskCacheWriteItem *, item, batch) {
+    int entry_index = seq_disk_cache_add_header_entry(item->nfra, item->ibuf, &header);
+    size_t bytes_written = seq_disk_cache_write_imbuf(
+        item->ibuf, file, compression, &header.entry[entry_index]);
+
+    if (bytes_written != 0) {
+      header.entry[entry_index].size_compressed = bytes_written;
+      written = true;
+    }
+  }
+
+  if (written) {
     /* Last step is writing header, as image data can be overwritten,
      * but missing data would cause problems.
      */
-    header.entry[entry_index].size_compressed = bytes_written;
     seq_disk_cache_write_header(file, &header);
+  }
+  fclose(file);
+
+  if (written) {
     seq_disk_cache_update_file(disk_cache, path);
-    fclose(file);
+  }
 
-    return true;
+  return written;
+}
+
+static void *seq_disk_cache_write_thread(void *disk_cache_v)
+{
+  SeqDiskCache *disk_cache = disk_cache_v;
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+
+  while (true) {
+    if (BLI_listbase_is_empty(&disk_cache->write_queue)) {
+      if (disk_cache->write_thread_exit) {
+        break;
+      }
+      BLI_condition_wait(&disk_cache->write_queue_cond, &disk_cache->read_write_mutex);
+      continue;
+    }
+
+    /* Take all queued images that go into the same file as the oldest one. */
+    ListBase batch = {NULL, NULL};
+    DiskCacheWriteItem *first_item = disk_cache->write_queue.first;
+
+    LISTBASE_FOREACH_MUTABLE (DiskCacheWriteItem *, item, &disk_cache->write_queue) {
+      if (item == first_item || STREQ(item->path, first_item->path)) {
+        BLI_remlink(&disk_cache->write_queue, item);
+        BLI_addtail(&batch, item);
+        disk_cache->write_queue_len--;
+      }
+    }
+
+    /* The mutex stays locked while writing, so the files can't be read or invalidated
+     * halfway through. */
+    seq_disk_cache_write_file(disk_cache, &batch);
+    BLI_condition_notify_all(&disk_cache->write_queue_cond);
+
+    LISTBASE_FOREACH_MUTABLE (DiskCacheWriteItem *, item, &batch) {
+      IMB_freeImBuf(item->ibuf);
+      MEM_freeN(item);
+    }
+
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+    seq_disk_cache_enforce_limits(disk_cache);
+    BLI_mutex_lock(&disk_cache->read_write_mutex);
   }
 
-  return false;
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+  return NULL;
+}
+
+/* Queue image to be written by the write thread, which takes ownership of \a ibuf. Waits when
+ * too many images are queued already, so rendering can't get far ahead of slow storage. */
+static void seq_disk_cache_queue_write(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+{
+  DiskCacheWriteItem *item = MEM_callocN(sizeof(DiskCacheWriteItem), "DiskCacheWriteItem");
+
+  seq_disk_cache_get_file_path(disk_cache, key, item->path, sizeof(item->path));
+  item->cache_type = key->type;
+  item->nfra = key->nfra;
+  item->ibuf = ibuf;
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  while (disk_cache->write_queue_len >= DCACHE_MAX_QUEUED_WRITES) {
+    BLI_condition_wait(&disk_cache->write_queue_cond, &disk_cache->read_write_mutex);
+  }
+  BLI_addtail(&disk_cache->write_queue, item);
+  disk_cache->write_queue_len++;
+  BLI_condition_notify_all(&disk_cache->write_queue_cond);
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
 static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
@@ -664,7 +911,7 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
     return NULL;
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  size_t bytes_read = seq_disk_cache_read_imbuf(ibuf, file, &header.entry[entry_index]);
 
   /* Sanity check. */
   if (bytes_read != expected_size) {
@@ -683,6 +930,7 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
 #undef DCACHE_IMAGES_PER_FILE
 #undef COLORSPACE_NAME_MAX
 #undef DCACHE_CURRENT_VERSION
+#undef DCACHE_MAX_QUEUED_WRITES
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
 {
@@ -1048,9 +1296,13 @@ static void seq_disk_cache_create(Main *bmain, Scene *scene)
   cache->disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
   cache->disk_cache->bmain = bmain;
   BLI_mutex_init(&cache->disk_cache->read_write_mutex);
+  BLI_condition_init(&cache->disk_cache->write_queue_cond);
   seq_disk_cache_handle_versioning(cache->disk_cache);
   seq_disk_cache_get_files(cache->disk_cache, seq_disk_cache_base_dir());
   cache->disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+
+  BLI_threadpool_init(&cache->disk_cache->write_thread, seq_disk_cache_write_thread, 1);
+  BLI_threadpool_insert(&cache->disk_cache->write_thread, cache->disk_cache);
   BLI_mutex_unlock(&cache_create_lock);
 }
 
@@ -1112,9 +1364,19 @@ void BKE_sequencer_cache_destruct(Scene *scene)
   BLI_mutex_end(&cache->iterator_mutex);
 
   if (cache->disk_cache != NULL) {
-    BLI_freelistN(&cache->disk_cache->files);
-    BLI_mutex_end(&cache->disk_cache->read_write_mutex);
-    MEM_freeN(cache->disk_cache);
+    SeqDiskCache *disk_cache = cache->disk_cache;
+
+    /* Finish writing queued images. */
+    BLI_mutex_lock(&disk_cache->read_write_mutex);
+    disk_cache->write_thread_exit = true;
+    BLI_condition_notify_all(&disk_cache->write_queue_cond);
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+    BLI_threadpool_end(&disk_cache->write_thread);
+
+    BLI_freelistN(&disk_cache->files);
+    BLI_condition_end(&disk_cache->write_queue_cond);
+    BLI_mutex_end(&disk_cache->read_write_mutex);
+    MEM_freeN(disk_cache);
   }
 
   MEM_freeN(cache);
@@ -1329,9 +1591,6 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
     seq_cache_create(context->bmain, scene);
   }
 
-  seq_cache_lock(scene);
-
-  SeqCache *cache = seq_cache_get_from_scene(scene);
   int flag;
 
   if (seq->cache_flag & SEQ_CACHE_OVERRIDE) {
@@ -1345,6 +1604,17 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
     flag = scene->ed->cache_flag;
   }
 
+  /* The disk cache is written from a separate thread. Cached images can be modified in place
+   * by render threads once they are in the cache, so the write thread gets a private copy. */
+  ImBuf *disk_ibuf = NULL;
+  if ((flag & type) && !skip_disk_cache && seq_disk_cache_is_enabled(context->bmain)) {
+    disk_ibuf = IMB_dupImBuf(i);
+  }
+
+  seq_cache_lock(scene);
+
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+
   if (cost > SEQ_CACHE_COST_MAX) {
     cost = SEQ_CACHE_COST_MAX;
   }
@@ -1390,17 +1660,12 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
 
   seq_cache_unlock(scene);
 
-  if (!key->is_temp_cache && !skip_disk_cache) {
-    if (seq_disk_cache_is_enabled(context->bmain)) {
-      if (cache->disk_cache == NULL) {
-        seq_disk_cache_create(context->bmain, context->scene);
-      }
-
-      BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_write_file(cache->disk_cache, key, i);
-      BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
+  if (disk_ibuf) {
+    if (cache->disk_cache == NULL) {
+      seq_disk_cache_create(context->bmain, context->scene);
     }
+
+    seq_disk_cache_queue_write(cache->disk_cache, key, disk_ibuf);
   }
 }
 
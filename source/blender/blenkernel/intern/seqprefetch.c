@@ -34,6 +34,7 @@
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.h"
@@ -53,31 +54,46 @@
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
+/* Upper limit of frames rendered concurrently. Effects are multi-threaded themselves, so
+ * there is little to gain from using more. */
+#define SEQ_PREFETCH_MAX_THREADS 8
+
+struct PrefetchJob;
+
+/* Frames are rendered by several threads, each with its own depsgraph and render context. */
+typedef struct PrefetchThread {
+  struct PrefetchJob *pfjob;
+
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+
+  /* context */
+  struct SeqRenderData context;
+  struct SeqRenderData context_cpy;
+} PrefetchThread;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
   struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
 
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
 
   ListBase threads;
+  PrefetchThread thread_data[SEQ_PREFETCH_MAX_THREADS];
+  int max_threads;
+  int num_threads;
 
-  /* context */
-  struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
-  struct ListBase *seqbasep;
-  struct ListBase *seqbasep_cpy;
-
-  /* prefetch area */
+  /* prefetch area, frames up to `cfra + num_frames_prefetched` are rendered or being rendered */
   float cfra;
   int num_frames_prefetched;
 
   /* control */
+  int num_running;
+  int num_waiting;
   bool running;
   bool waiting;
   bool stop;
@@ -154,7 +170,14 @@ SeqRenderData *BKE_sequencer_prefetch_get_original_context(const SeqRenderData *
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
 
-  return &pfjob->context;
+  for (int i = 0; i < pfjob->num_threads; i++) {
+    if (pfjob->thread_data[i].scene_eval == context->scene) {
+      return &pfjob->thread_data[i].context;
+    }
+  }
+
+  BLI_assert(!"Render context of prefetch thread not found");
+  return &pfjob->thread_data[0].context;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -176,38 +199,54 @@ void BKE_sequencer_prefetch_get_time_range(Scene *scene, int *start, int *end)
   *end = pfjob->cfra + pfjob->num_frames_prefetched;
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchThread *pfthread)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (pfthread->depsgraph != NULL) {
+    DEG_graph_free(pfthread->depsgraph);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
+  pfthread->depsgraph = NULL;
+  pfthread->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchThread *pfthread, int cfra)
 {
-  DEG_evaluate_on_framechange(
-      pfjob->bmain_eval, pfjob->depsgraph, pfjob->cfra + pfjob->num_frames_prefetched);
+  DEG_evaluate_on_framechange(pfthread->pfjob->bmain_eval, pfthread->depsgraph, cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_init_depsgraph(PrefetchThread *pfthread)
 {
+  PrefetchJob *pfjob = pfthread->pfjob;
   Main *bmain = pfjob->bmain_eval;
   Scene *scene = pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  pfthread->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(pfthread->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph, bmain, scene, view_layer);
+  DEG_graph_build_for_render_pipeline(pfthread->depsgraph, bmain, scene, view_layer);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  seq_prefetch_update_depsgraph(pfthread, pfjob->cfra + pfjob->num_frames_prefetched);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  pfthread->scene_eval = DEG_get_evaluated_scene(pfthread->depsgraph);
+  pfthread->scene_eval->ed->cache_flag = 0;
+}
+
+/* Scene strips use the render pipeline or the viewport, and text strips share fonts between
+ * renders. Frames using those can't be rendered concurrently. */
+static int seq_prefetch_num_threads(PrefetchJob *pfjob)
+{
+  Sequence *seq;
+
+  SEQ_BEGIN (pfjob->scene->ed, seq) {
+    if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_TEXT)) {
+      return 1;
+    }
+  }
+  SEQ_END;
+
+  return pfjob->max_threads;
 }
 
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
@@ -247,7 +286,7 @@ void BKE_sequencer_prefetch_stop(Scene *scene)
   pfjob->stop = true;
 
   while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -256,32 +295,37 @@ static void seq_prefetch_update_context(const SeqRenderData *context)
   PrefetchJob *pfjob;
   pfjob = seq_prefetch_job_get(context->scene);
 
-  BKE_sequencer_new_render_data(pfjob->bmain_eval,
-                                pfjob->depsgraph,
-                                pfjob->scene_eval,
-                                context->rectx,
-                                context->recty,
-                                context->preview_render_size,
-                                false,
-                                &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
-
-  BKE_sequencer_new_render_data(pfjob->bmain,
-                                pfjob->depsgraph,
-                                pfjob->scene,
-                                context->rectx,
-                                context->recty,
-                                context->preview_render_size,
-                                false,
-                                &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
-
-  /* Same ID as prefetch context, because context will be swapped, but we still
-   * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
-   */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  for (int i = 0; i < pfjob->num_threads; i++) {
+    PrefetchThread *pfthread = &pfjob->thread_data[i];
+    const eSeqTaskId task_id = (eSeqTaskId)(SEQ_TASK_PREFETCH_RENDER + i);
+
+    BKE_sequencer_new_render_data(pfjob->bmain_eval,
+                                  pfthread->depsgraph,
+                                  pfthread->scene_eval,
+                                  context->rectx,
+                                  context->recty,
+                                  context->preview_render_size,
+                                  false,
+                                  &pfthread->context_cpy);
+    pfthread->context_cpy.is_prefetch_render = true;
+    pfthread->context_cpy.task_id = task_id;
+
+    BKE_sequencer_new_render_data(pfjob->bmain,
+                                  pfthread->depsgraph,
+                                  pfjob->scene,
+                                  context->rectx,
+                                  context->recty,
+                                  context->preview_render_size,
+                                  false,
+                                  &pfthread->context);
+    pfthread->context.is_prefetch_render = false;
+
+    /* Same ID as prefetch context, because context will be swapped, but we still
+     * want to assign this ID to cache entries created in this thread.
+     * This is to allow "temp cache" work correctly for all threads.
+     */
+    pfthread->context.task_id = task_id;
+  }
 }
 
 static void seq_prefetch_update_scene(Scene *scene)
@@ -292,16 +336,22 @@ static void seq_prefetch_update_scene(Scene *scene)
     return;
   }
 
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  for (int i = 0; i < pfjob->max_threads; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->thread_data[i]);
+  }
+
+  pfjob->num_threads = seq_prefetch_num_threads(pfjob);
+  for (int i = 0; i < pfjob->num_threads; i++) {
+    seq_prefetch_init_depsgraph(&pfjob->thread_data[i]);
+  }
 }
 
 static void seq_prefetch_resume(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  if (pfjob && pfjob->num_waiting > 0) {
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -314,74 +364,102 @@ void BKE_sequencer_prefetch_free(Scene *scene)
 
   BKE_sequencer_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
+  for (int i = 0; i < pfjob->max_threads; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->thread_data[i]);
+  }
   BKE_main_free(pfjob->bmain_eval);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
 }
 
-static void *seq_prefetch_frames(void *job)
+/* Claim the next frame to render, nearest to the playhead first. Waits while the cache is full
+ * or the user is scrubbing, returns false when prefetching should stop. Called with the suspend
+ * mutex locked. */
+static bool seq_prefetch_next_frame(PrefetchJob *pfjob, int *r_cfra)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  while ((seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain)) &&
+         pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE && !pfjob->stop) {
+    pfjob->num_waiting++;
+    pfjob->waiting = (pfjob->num_waiting == pfjob->num_running);
+    BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+    pfjob->num_waiting--;
+    pfjob->waiting = false;
+    seq_prefetch_update_area(pfjob);
+  }
 
-  while (pfjob->cfra + pfjob->num_frames_prefetched <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+  if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
+    return false;
+  }
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    BKE_animsys_evaluate_animdata(&pfjob->context_cpy.scene->id,
-                                  adt,
-                                  pfjob->cfra + pfjob->num_frames_prefetched,
-                                  ADT_RECALC_ALL,
-                                  false);
+  seq_prefetch_update_area(pfjob);
 
-    /* This is quite hacky solution:
-     * We need cross-reference original scene with copy for cache.
-     * However depsgraph must not have this data, because it will try to kill this job.
-     * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
-     * Set to NULL before return!
-     */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+  /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+  if (pfjob->num_frames_prefetched > 5 &&
+      (pfjob->cfra + pfjob->num_frames_prefetched - pfjob->scene->r.cfra) < 2) {
+    return false;
+  }
 
-    ImBuf *ibuf = BKE_sequencer_give_ibuf(
-        &pfjob->context_cpy, pfjob->cfra + pfjob->num_frames_prefetched, 0);
-    BKE_sequencer_cache_free_temp_cache(
-        pfjob->scene, pfjob->context.task_id, pfjob->cfra + pfjob->num_frames_prefetched);
-    IMB_freeImBuf(ibuf);
+  if (pfjob->cfra + pfjob->num_frames_prefetched > pfjob->scene->r.efra) {
+    return false;
+  }
 
-    /* suspend thread */
+  *r_cfra = pfjob->cfra + pfjob->num_frames_prefetched;
+  pfjob->num_frames_prefetched++;
+  return true;
+}
+
+static void *seq_prefetch_frames(void *thread_data)
+{
+  PrefetchThread *pfthread = (PrefetchThread *)thread_data;
+  PrefetchJob *pfjob = pfthread->pfjob;
+  int cfra;
+
+  for (;;) {
     BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
-    while ((seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain)) &&
-           pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE && !pfjob->stop) {
-      pfjob->waiting = true;
-      BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
-      seq_prefetch_update_area(pfjob);
-    }
-    pfjob->waiting = false;
+    const bool has_frame = seq_prefetch_next_frame(pfjob, &cfra);
     BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 &&
-        (pfjob->cfra + pfjob->num_frames_prefetched - pfjob->scene->r.cfra) < 2) {
+    if (!has_frame) {
       break;
     }
 
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
-    }
+    pfthread->scene_eval->ed->prefetch_job = NULL;
 
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
+    seq_prefetch_update_depsgraph(pfthread, cfra);
+    AnimData *adt = BKE_animdata_from_id(&pfthread->context_cpy.scene->id);
+    BKE_animsys_evaluate_animdata(
+        &pfthread->context_cpy.scene->id, adt, cfra, ADT_RECALC_ALL, false);
+
+    /* This is quite hacky solution:
+     * We need cross-reference original scene with copy for cache.
+     * However depsgraph must not have this data, because it will try to kill this job.
+     * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
+     * Set to NULL before return!
+     */
+    pfthread->scene_eval->ed->prefetch_job = pfjob;
+
+    ImBuf *ibuf = BKE_sequencer_give_ibuf(&pfthread->context_cpy, cfra, 0);
+    BKE_sequencer_cache_free_temp_cache(pfjob->scene, pfthread->context.task_id, cfra);
+    IMB_freeImBuf(ibuf);
   }
 
   BKE_sequencer_cache_free_temp_cache(
-      pfjob->scene, pfjob->context.task_id, pfjob->cfra + pfjob->num_frames_prefetched);
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+      pfjob->scene, pfthread->context.task_id, pfjob->cfra + pfjob->num_frames_prefetched);
+  pfthread->scene_eval->ed->prefetch_job = NULL;
+
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->num_running--;
+  if (pfjob->num_running == 0) {
+    pfjob->running = false;
+  }
+  else {
+    /* Remaining threads may all be suspended now. */
+    pfjob->waiting = (pfjob->num_waiting == pfjob->num_running);
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
   return 0;
 }
@@ -395,7 +473,8 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
+      pfjob->max_threads = clamp_i(BLI_system_thread_count() / 4, 1, SEQ_PREFETCH_MAX_THREADS);
+      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, pfjob->max_threads);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
@@ -403,21 +482,30 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
       pfjob->bmain_eval = BKE_main_new();
 
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
+      for (int i = 0; i < pfjob->max_threads; i++) {
+        pfjob->thread_data[i].pfjob = pfjob;
+      }
     }
   }
-  seq_prefetch_update_scene(context->scene);
-  seq_prefetch_update_context(context);
+
+  /* Join threads of the previous run. */
+  BLI_threadpool_clear(&pfjob->threads);
 
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
 
+  seq_prefetch_update_scene(context->scene);
+  seq_prefetch_update_context(context);
+
+  pfjob->num_waiting = 0;
   pfjob->waiting = false;
   pfjob->stop = false;
+  pfjob->num_running = pfjob->num_threads;
   pfjob->running = true;
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->num_threads; i++) {
+    BLI_threadpool_insert(&pfjob->threads, &pfjob->thread_data[i]);
+  }
 
   return pfjob;
 }
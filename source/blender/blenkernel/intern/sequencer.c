@@ -123,7 +123,16 @@ static ImBuf *seq_render_mask(const SeqRenderData *context, Mask *mask, float nr
 static int seq_num_files(Scene *scene, char views_format, const bool is_multiview);
 static void seq_anim_add_suffix(Scene *scene, struct anim *anim, const int view_id);
 
-static ThreadMutex seq_render_mutex = BLI_MUTEX_INITIALIZER;
+/* Strips are rendered by one thread at a time, except for prefetch threads. Those render
+ * different frames concurrently, each with its own evaluated copy of the scene. Other renders
+ * pass the turnstile before waiting for exclusive access, which blocks new prefetch renders
+ * meanwhile, so prefetching can't keep the main thread waiting for more than a frame. */
+static ThreadRWMutex seq_render_mutex = BLI_RWLOCK_INITIALIZER;
+static ThreadMutex seq_render_turnstile = BLI_MUTEX_INITIALIZER;
+
+/* Proxies of movie strips are built from their own copy of the movie, so they can be built
+ * concurrently. Other strips are rendered to build their proxies, one strip at a time. */
+static ThreadMutex seq_proxy_render_mutex = BLI_MUTEX_INITIALIZER;
 
 /* **** XXX ******** */
 #define SELECT 1
@@ -2215,6 +2224,8 @@ void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context,
   SeqRenderState state;
   sequencer_state_init(&state);
 
+  BLI_mutex_lock(&seq_proxy_render_mutex);
+
   for (cfra = seq->startdisp + seq->startstill; cfra < seq->enddisp - seq->endstill; cfra++) {
     if (context->size_flags & IMB_PROXY_25) {
       seq_proxy_build_frame(&render_context, &state, seq, cfra, 25, overwrite);
@@ -2237,6 +2248,8 @@ void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context,
       break;
     }
   }
+
+  BLI_mutex_unlock(&seq_proxy_render_mutex);
 }
 
 void BKE_sequencer_proxy_rebuild_finish(SeqIndexBuildContext *context, bool stop)
@@ -4084,7 +4097,16 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
   float cost = 0;
 
   if (count && !out) {
-    BLI_mutex_lock(&seq_render_mutex);
+    BLI_mutex_lock(&seq_render_turnstile);
+    if (context->is_prefetch_render) {
+      BLI_mutex_unlock(&seq_render_turnstile);
+      BLI_rw_mutex_lock(&seq_render_mutex, THREAD_LOCK_READ);
+    }
+    else {
+      BLI_rw_mutex_lock(&seq_render_mutex, THREAD_LOCK_WRITE);
+      BLI_mutex_unlock(&seq_render_turnstile);
+    }
+
     out = seq_render_strip_stack(context, &state, seqbasep, cfra, chanshown);
     cost = seq_estimate_render_cost_end(context->scene, begin);
 
@@ -4096,7 +4118,7 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
       BKE_sequencer_cache_put_if_possible(
           context, seq_arr[count - 1], cfra, SEQ_CACHE_STORE_FINAL_OUT, out, cost, false);
     }
-    BLI_mutex_unlock(&seq_render_mutex);
+    BLI_rw_mutex_unlock(&seq_render_mutex);
   }
 
   BKE_sequencer_prefetch_start(context, cfra, cost);
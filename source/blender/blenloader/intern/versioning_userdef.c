@@ -764,6 +764,12 @@ void BLO_version_defaults_userpref_blend(Main *bmain, UserDef *userdef)
    */
   {
     /* Keep this block, even when empty. */
+    if (userdef->gpu_shader_cache_size == 0) {
+      userdef->gpu_shader_cache_size = U_default.gpu_shader_cache_size;
+    }
+    if (userdef->compositor_cache_limit == 0) {
+      userdef->compositor_cache_limit = U_default.compositor_cache_limit;
+    }
   }
 
   if (userdef->pixelsize == 0.0f) {
@@ -107,6 +107,24 @@ typedef enum OrderOfChunks {
 #define COM_NUM_CHANNELS_VECTOR 3
 #define COM_NUM_CHANNELS_COLOR 4
 
+/**
+ * \brief Maximum number of pixels of a row calculated at once by SocketReader::executeRow.
+ * Operations keep their input rows on the stack, so this should stay small.
+ */
+#define COM_ROW_WIDTH 64
+
 #define COM_BLUR_BOKEH_PIXELS 512
 
+/**
+ * \brief Blur radius in pixels from which bokeh blurs convolve the whole image in the frequency
+ * domain, below it evaluating the kernel for every pixel is faster.
+ */
+#define COM_BOKEH_FFT_MIN_RADIUS 24
+
+/**
+ * \brief Maximum defocus radius in pixels from which defocus is approximated by blurring layers
+ * of similar radius in the frequency domain.
+ */
+#define COM_DEFOCUS_LAYERED_MIN_RADIUS 32
+
 #endif /* __COM_DEFINES_H__ */
@@ -0,0 +1,357 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include "COM_BufferCache.h"
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_Node.h"
+
+#include <list>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_hash_md5.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_color_types.h"
+#include "DNA_image_types.h"
+#include "DNA_node_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_node.h"
+}
+
+struct BufferCacheEntry {
+  MemoryBuffer *buffer;
+  size_t size;
+  int users;
+  unsigned int last_used;
+};
+
+typedef std::map<std::string, BufferCacheEntry> BufferCacheEntries;
+
+static ThreadMutex s_cache_mutex = BLI_MUTEX_INITIALIZER;
+static BufferCacheEntries s_entries;
+/* buffers cleared from the cache while still in use, freed when released */
+static std::list<MemoryBuffer *> s_orphans;
+static size_t s_total_size = 0;
+static unsigned int s_clock = 0;
+
+static size_t buffer_size(MemoryBuffer *buffer)
+{
+  return (size_t)buffer->getWidth() * buffer->getHeight() * buffer->get_num_channels() *
+         sizeof(float);
+}
+
+static size_t cache_limit()
+{
+  return (size_t)max_ii(U.compositor_cache_limit, 0) * 1024 * 1024;
+}
+
+/* Free least recently used results that are not in use until the extra size fits. */
+static bool make_room(size_t size)
+{
+  const size_t limit = cache_limit();
+  while (s_total_size + size > limit) {
+    BufferCacheEntries::iterator oldest = s_entries.end();
+    for (BufferCacheEntries::iterator it = s_entries.begin(); it != s_entries.end(); ++it) {
+      if (it->second.users == 0 &&
+          (oldest == s_entries.end() || it->second.last_used < oldest->second.last_used)) {
+        oldest = it;
+      }
+    }
+    if (oldest == s_entries.end()) {
+      return false;
+    }
+    s_total_size -= oldest->second.size;
+    delete oldest->second.buffer;
+    s_entries.erase(oldest);
+  }
+  return true;
+}
+
+MemoryBuffer *BufferCache::acquire(const std::string &key)
+{
+  MemoryBuffer *buffer = NULL;
+
+  BLI_mutex_lock(&s_cache_mutex);
+  BufferCacheEntries::iterator it = s_entries.find(key);
+  if (it != s_entries.end()) {
+    it->second.users++;
+    it->second.last_used = ++s_clock;
+    buffer = it->second.buffer;
+  }
+  BLI_mutex_unlock(&s_cache_mutex);
+
+  return buffer;
+}
+
+void BufferCache::release(MemoryBuffer *buffer)
+{
+  BLI_mutex_lock(&s_cache_mutex);
+  for (BufferCacheEntries::iterator it = s_entries.begin(); it != s_entries.end(); ++it) {
+    if (it->second.buffer == buffer) {
+      BLI_assert(it->second.users > 0);
+      it->second.users--;
+      BLI_mutex_unlock(&s_cache_mutex);
+      return;
+    }
+  }
+  /* the cache was cleared while the buffer was in use */
+  for (std::list<MemoryBuffer *>::iterator it = s_orphans.begin(); it != s_orphans.end(); ++it) {
+    if (*it == buffer) {
+      s_orphans.erase(it);
+      delete buffer;
+      break;
+    }
+  }
+  BLI_mutex_unlock(&s_cache_mutex);
+}
+
+void BufferCache::store(const std::string &key, MemoryBuffer *buffer)
+{
+  const size_t size = buffer_size(buffer);
+  if (size > cache_limit()) {
+    return;
+  }
+
+  BLI_mutex_lock(&s_cache_mutex);
+  if (s_entries.find(key) == s_entries.end() && make_room(size)) {
+    BufferCacheEntry entry;
+    entry.buffer = new MemoryBuffer(buffer->getDataType(), buffer->getRect());
+    entry.buffer->copyContentFrom(buffer);
+    entry.size = size;
+    entry.users = 0;
+    entry.last_used = ++s_clock;
+    s_entries[key] = entry;
+    s_total_size += size;
+  }
+  BLI_mutex_unlock(&s_cache_mutex);
+}
+
+void BufferCache::clear()
+{
+  BLI_mutex_lock(&s_cache_mutex);
+  for (BufferCacheEntries::iterator it = s_entries.begin(); it != s_entries.end(); ++it) {
+    if (it->second.users > 0) {
+      s_orphans.push_back(it->second.buffer);
+    }
+    else {
+      delete it->second.buffer;
+    }
+  }
+  s_entries.clear();
+  s_total_size = 0;
+  BLI_mutex_unlock(&s_cache_mutex);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Keys
+ *
+ * Keys are MD5 digests of the settings that affect a result. Data is hashed by value, pointers
+ * in node storage change every time the tree is localized for execution, so storage that
+ * contains pointers is hashed with the data they point to.
+ * \{ */
+
+class KeyBuilder {
+  std::string m_data;
+
+ public:
+  void add(const void *data, size_t size)
+  {
+    m_data.append((const char *)data, size);
+  }
+  template<typename T> void add(const T &value)
+  {
+    add(&value, sizeof(T));
+  }
+  void add_string(const char *str)
+  {
+    add(str, strlen(str) + 1);
+  }
+  void add_key(const std::string &key)
+  {
+    add(key.data(), key.size());
+  }
+  void add_alloc(const void *data)
+  {
+    add(data != NULL);
+    if (data) {
+      add(data, MEM_allocN_len(data));
+    }
+  }
+  void add_curve_mapping(const CurveMapping *cumap)
+  {
+    add(cumap != NULL);
+    if (cumap == NULL) {
+      return;
+    }
+    add(cumap->flag);
+    add(cumap->preset);
+    add(cumap->clipr);
+    add(cumap->black);
+    add(cumap->white);
+    add(cumap->tone);
+    for (int i = 0; i < CM_TOT; i++) {
+      const CurveMap *cuma = &cumap->cm[i];
+      add(cuma->totpoint);
+      add(cuma->ext_in);
+      add(cuma->ext_out);
+      if (cuma->curve) {
+        add(cuma->curve, sizeof(CurveMapPoint) * cuma->totpoint);
+      }
+    }
+  }
+
+  std::string digest() const
+  {
+    char result[16];
+    BLI_hash_md5_buffer(m_data.data(), m_data.size(), result);
+    return std::string(result, sizeof(result));
+  }
+};
+
+std::string BufferCache::context_key(const CompositorContext &context)
+{
+  KeyBuilder key;
+  const RenderData *rd = context.getRenderData();
+  key.add(context.getFramenumber());
+  key.add(context.getQuality());
+  key.add(context.isFastCalculation());
+  key.add(rd->size);
+  key.add(rd->xsch);
+  key.add(rd->ysch);
+  key.add_string(context.getViewName() ? context.getViewName() : "");
+
+  const ColorManagedViewSettings *view_settings = context.getViewSettings();
+  if (view_settings) {
+    key.add(view_settings->flag);
+    key.add_string(view_settings->look);
+    key.add_string(view_settings->view_transform);
+    key.add(view_settings->exposure);
+    key.add(view_settings->gamma);
+    key.add_curve_mapping(view_settings->curve_mapping);
+  }
+  const ColorManagedDisplaySettings *display_settings = context.getDisplaySettings();
+  if (display_settings) {
+    key.add_string(display_settings->display_device);
+  }
+
+  return key.digest();
+}
+
+/* Nodes using data that is not part of the key, the cache is not updated when it changes. */
+static bool node_is_cacheable(bNode *bnode)
+{
+  if (bnode->type == CMP_NODE_DEFOCUS) {
+    /* uses the scene camera */
+    return false;
+  }
+  /* images, clips and masks clear the cache when edited, render results when rendering */
+  return (bnode->id == NULL || ELEM(GS(bnode->id->name), ID_IM, ID_MC, ID_MSK, ID_SCE));
+}
+
+static void add_node_storage(KeyBuilder &key, bNode *bnode)
+{
+  key.add(bnode->storage != NULL);
+  if (bnode->storage == NULL) {
+    return;
+  }
+  if (STREQ(bnode->typeinfo->storagename, "CurveMapping")) {
+    key.add_curve_mapping((const CurveMapping *)bnode->storage);
+  }
+  else if (bnode->type == CMP_NODE_CRYPTOMATTE) {
+    NodeCryptomatte crypto = *(const NodeCryptomatte *)bnode->storage;
+    key.add_string(crypto.matte_id ? crypto.matte_id : "");
+    crypto.matte_id = NULL;
+    key.add(crypto);
+  }
+  else {
+    key.add_alloc(bnode->storage);
+  }
+}
+
+std::string BufferCache::node_key(Node *node, NodeKeys &keys)
+{
+  NodeKeys::const_iterator found = keys.find(node);
+  if (found != keys.end()) {
+    return found->second;
+  }
+  /* a node is not reached again while its inputs are hashed, links don't form cycles */
+  keys[node] = std::string();
+
+  bNode *bnode = node->getbNode();
+  if (bnode && !node_is_cacheable(bnode)) {
+    return std::string();
+  }
+
+  KeyBuilder key;
+  key.add(bnode != NULL);
+  if (bnode) {
+    key.add(bnode->type);
+    key.add_string(bnode->idname);
+    key.add(bnode->custom1);
+    key.add(bnode->custom2);
+    key.add(bnode->custom3);
+    key.add(bnode->custom4);
+    key.add((bnode->flag & NODE_MUTED) != 0);
+    add_node_storage(key, bnode);
+    key.add(bnode->id);
+    if (bnode->id) {
+      key.add(bnode->id->session_uuid);
+      key.add_string(bnode->id->name);
+      /* Images can be edited while no compositor editor is open to clear the cache. */
+      if (GS(bnode->id->name) == ID_IM) {
+        key.add(((const Image *)bnode->id)->update_count);
+      }
+    }
+  }
+
+  key.add(node->getNumberOfInputSockets());
+  key.add(node->getNumberOfOutputSockets());
+  for (unsigned int index = 0; index < node->getNumberOfInputSockets(); index++) {
+    NodeInput *input = node->getInputSocket(index);
+    NodeOutput *link = input->getLink();
+    key.add(input->getDataType());
+    key.add(link != NULL);
+    if (link) {
+      Node *from_node = link->getNode();
+      const std::string from_key = node_key(from_node, keys);
+      if (from_key.empty()) {
+        return std::string();
+      }
+      key.add_key(from_key);
+      for (unsigned int i = 0; i < from_node->getNumberOfOutputSockets(); i++) {
+        if (from_node->getOutputSocket(i) == link) {
+          key.add(i);
+        }
+      }
+    }
+    else if (input->getbNodeSocket()) {
+      key.add_alloc(input->getbNodeSocket()->default_value);
+    }
+  }
+
+  const std::string result = key.digest();
+  keys[node] = result;
+  return result;
+}
+
+/** \} */
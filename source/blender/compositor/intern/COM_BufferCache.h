@@ -0,0 +1,78 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_BUFFERCACHE_H__
+#define __COM_BUFFERCACHE_H__
+
+#include <map>
+#include <string>
+
+class CompositorContext;
+class MemoryBuffer;
+class Node;
+
+/**
+ * \brief Cache of operation results, kept between executions of the node tree.
+ *
+ * Results are stored under a key built from the operation, the settings of the node it belongs
+ * to and of all nodes it depends on, so editing a node only invalidates the results downstream
+ * of it. When the key of an operation is found the cached result is used instead, and the
+ * operation and its inputs are not executed at all.
+ *
+ * The total size of the cache is limited by the user preferences, the least recently used
+ * results are freed first.
+ * \ingroup Memory
+ */
+class BufferCache {
+ public:
+  typedef std::map<Node *, std::string> NodeKeys;
+
+  /**
+   * \brief find the result stored for the key
+   * \return the buffer which is kept until it is released, or NULL when not cached
+   */
+  static MemoryBuffer *acquire(const std::string &key);
+
+  /**
+   * \brief release a buffer returned by acquire
+   */
+  static void release(MemoryBuffer *buffer);
+
+  /**
+   * \brief store a copy of the buffer under the key, freeing older results when over the limit
+   */
+  static void store(const std::string &key, MemoryBuffer *buffer);
+
+  /**
+   * \brief free all cached results
+   */
+  static void clear();
+
+  /**
+   * \brief key of the execution settings that affect the results of all operations
+   */
+  static std::string context_key(const CompositorContext &context);
+
+  /**
+   * \brief key of the node settings, including the keys of all nodes linked to its inputs
+   * \param keys: keys of the nodes that were visited already
+   */
+  static std::string node_key(Node *node, NodeKeys &keys);
+};
+
+#endif /* __COM_BUFFERCACHE_H__ */
@@ -394,6 +394,19 @@ MemoryBuffer **ExecutionGroup::getInputBuffersOpenCL(int chunkNumber)
   return memoryBuffers;
 }
 
+bool ExecutionGroup::isFullyExecuted() const
+{
+  if (this->m_chunkExecutionStates == NULL || this->m_numberOfChunks == 0) {
+    return false;
+  }
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+      return false;
+    }
+  }
+  return true;
+}
+
 MemoryBuffer *ExecutionGroup::constructConsolidatedMemoryBuffer(MemoryProxy *memoryProxy,
                                                                 rcti *rect)
 {
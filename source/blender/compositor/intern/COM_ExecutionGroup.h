@@ -333,6 +333,11 @@ class ExecutionGroup {
    */
   NodeOperation *getOutputOperation() const;
 
+  /**
+   * \brief have all chunks of this ExecutionGroup been executed
+   */
+  bool isFullyExecuted() const;
+
   /**
    * \brief compose multiple chunks into a single chunk
    * \return Memorybuffer *consolidated chunk
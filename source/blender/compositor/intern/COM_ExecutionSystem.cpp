@@ -26,6 +26,7 @@ extern "C" {
 
 #include "BLT_translation.h"
 
+#include "COM_BufferCache.h"
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionGroup.h"
@@ -33,6 +34,7 @@ extern "C" {
 #include "COM_NodeOperationBuilder.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_WorkScheduler.h"
+#include "COM_WriteBufferOperation.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
 #  include "MEM_guardedalloc.h"
@@ -189,6 +191,10 @@ void ExecutionSystem::execute()
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  if (!editingtree->test_break(editingtree->tbh)) {
+    storeCachedBuffers();
+  }
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -200,6 +206,22 @@ void ExecutionSystem::execute()
   }
 }
 
+void ExecutionSystem::storeCachedBuffers()
+{
+  for (unsigned int index = 0; index < this->m_groups.size(); index++) {
+    ExecutionGroup *executionGroup = this->m_groups[index];
+    NodeOperation *operation = executionGroup->getOutputOperation();
+    if (!operation->isWriteBufferOperation()) {
+      continue;
+    }
+    WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+    if (!writeOperation->getCacheKey().empty() && executionGroup->isFullyExecuted()) {
+      BufferCache::store(writeOperation->getCacheKey(),
+                         writeOperation->getMemoryProxy()->getBuffer());
+    }
+  }
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
   unsigned int index;
@@ -189,6 +189,11 @@ class ExecutionSystem {
  private:
   void executeGroups(CompositorPriority priority);
 
+  /**
+   * \brief store the results of fully executed write buffers that have a cache key
+   */
+  void storeCachedBuffers();
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
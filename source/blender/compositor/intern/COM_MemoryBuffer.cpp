@@ -58,8 +58,18 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
   this->m_memoryProxy = memoryProxy;
   this->m_chunkNumber = chunkNumber;
   this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
-  this->m_buffer = (float *)MEM_mallocN_aligned(
-      sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+  if (memoryProxy->getUseHalfFloat()) {
+    this->m_buffer = NULL;
+    this->m_half_buffer = (unsigned short *)MEM_mallocN_aligned(
+        sizeof(unsigned short) * determineBufferSize() * this->m_num_channels,
+        16,
+        "COM_MemoryBuffer half");
+  }
+  else {
+    this->m_buffer = (float *)MEM_mallocN_aligned(
+        sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+    this->m_half_buffer = NULL;
+  }
   this->m_state = COM_MB_ALLOCATED;
   this->m_datatype = memoryProxy->getDataType();
 }
@@ -74,6 +84,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
   this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+  this->m_half_buffer = NULL;
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = memoryProxy->getDataType();
 }
@@ -88,11 +99,13 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
   this->m_num_channels = determine_num_channels(dataType);
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+  this->m_half_buffer = NULL;
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = dataType;
 }
 MemoryBuffer *MemoryBuffer::duplicate()
 {
+  BLI_assert(this->m_half_buffer == NULL);
   MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
   memcpy(result->m_buffer,
          this->m_buffer,
@@ -101,11 +114,18 @@ MemoryBuffer *MemoryBuffer::duplicate()
 }
 void MemoryBuffer::clear()
 {
+  if (this->m_half_buffer) {
+    memset(this->m_half_buffer,
+           0,
+           this->determineBufferSize() * this->m_num_channels * sizeof(unsigned short));
+    return;
+  }
   memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
 }
 
 float MemoryBuffer::getMaximumValue()
 {
+  BLI_assert(this->m_half_buffer == NULL);
   float result = this->m_buffer[0];
   const unsigned int size = this->determineBufferSize();
   unsigned int i;
@@ -148,6 +168,10 @@ MemoryBuffer::~MemoryBuffer()
     MEM_freeN(this->m_buffer);
     this->m_buffer = NULL;
   }
+  if (this->m_half_buffer) {
+    MEM_freeN(this->m_half_buffer);
+    this->m_half_buffer = NULL;
+  }
 }
 
 void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
@@ -170,9 +194,29 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
                   this->m_num_channels;
     offset = ((otherY - this->m_rect.ymin) * this->m_width + minX - this->m_rect.xmin) *
              this->m_num_channels;
-    memcpy(&this->m_buffer[offset],
-           &otherBuffer->m_buffer[otherOffset],
-           (maxX - minX) * this->m_num_channels * sizeof(float));
+    const int num_values = (maxX - minX) * this->m_num_channels;
+    if (this->m_half_buffer && otherBuffer->m_half_buffer) {
+      memcpy(&this->m_half_buffer[offset],
+             &otherBuffer->m_half_buffer[otherOffset],
+             num_values * sizeof(unsigned short));
+    }
+    else if (this->m_half_buffer) {
+      for (int i = 0; i < num_values; i++) {
+        const float value = otherBuffer->m_buffer[otherOffset + i];
+        this->m_half_buffer[offset + i] = com_float_to_half(value);
+      }
+    }
+    else if (otherBuffer->m_half_buffer) {
+      for (int i = 0; i < num_values; i++) {
+        const unsigned short value = otherBuffer->m_half_buffer[otherOffset + i];
+        this->m_buffer[offset + i] = com_half_to_float(value);
+      }
+    }
+    else {
+      memcpy(&this->m_buffer[offset],
+             &otherBuffer->m_buffer[otherOffset],
+             num_values * sizeof(float));
+    }
   }
 }
 
@@ -182,6 +226,12 @@ void MemoryBuffer::writePixel(int x, int y, const float color[4])
       y < this->m_rect.ymax) {
     const int offset = (this->m_width * (y - this->m_rect.ymin) + x - this->m_rect.xmin) *
                        this->m_num_channels;
+    if (this->m_half_buffer) {
+      for (int i = 0; i < this->m_num_channels; i++) {
+        this->m_half_buffer[offset + i] = com_float_to_half(color[i]);
+      }
+      return;
+    }
     memcpy(&this->m_buffer[offset], color, sizeof(float) * this->m_num_channels);
   }
 }
@@ -192,6 +242,13 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
       y < this->m_rect.ymax) {
     const int offset = (this->m_width * (y - this->m_rect.ymin) + x - this->m_rect.xmin) *
                        this->m_num_channels;
+    if (this->m_half_buffer) {
+      for (int i = 0; i < this->m_num_channels; i++) {
+        this->m_half_buffer[offset + i] = com_float_to_half(
+            com_half_to_float(this->m_half_buffer[offset + i]) + color[i]);
+      }
+      return;
+    }
     float *dst = &this->m_buffer[offset];
     const float *src = color;
     for (int i = 0; i < this->m_num_channels; i++, dst++, src++) {
@@ -200,6 +257,61 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
   }
 }
 
+/* Same as BLI_bilinear_interpolation_wrap_fl, reading half floats. */
+void MemoryBuffer::readBilinearHalf(float *result, float u, float v, bool wrap_x, bool wrap_y)
+{
+  const int num_channels = this->m_num_channels;
+  int x1 = (int)floorf(u);
+  int x2 = (int)ceilf(u);
+  int y1 = (int)floorf(v);
+  int y2 = (int)ceilf(v);
+
+  /* pixel value must be already wrapped, however values at boundaries may flip */
+  if (wrap_x) {
+    if (x1 < 0) {
+      x1 = this->m_width - 1;
+    }
+    if (x2 >= this->m_width) {
+      x2 = 0;
+    }
+  }
+  else if (x2 < 0 || x1 >= this->m_width) {
+    copy_vn_fl(result, num_channels, 0.0f);
+    return;
+  }
+  if (wrap_y) {
+    if (y1 < 0) {
+      y1 = this->m_height - 1;
+    }
+    if (y2 >= this->m_height) {
+      y2 = 0;
+    }
+  }
+  else if (y2 < 0 || y1 >= this->m_height) {
+    copy_vn_fl(result, num_channels, 0.0f);
+    return;
+  }
+
+  const int xs[4] = {x1, x1, x2, x2};
+  const int ys[4] = {y1, y2, y1, y2};
+  const float a = u - floorf(u);
+  const float b = v - floorf(v);
+  const float weights[4] = {(1.0f - a) * (1.0f - b), (1.0f - a) * b, a * (1.0f - b), a * b};
+
+  copy_vn_fl(result, num_channels, 0.0f);
+  for (int i = 0; i < 4; i++) {
+    /* sample including outside of edges of image */
+    if (xs[i] < 0 || ys[i] < 0 || xs[i] >= this->m_width || ys[i] >= this->m_height) {
+      continue;
+    }
+    const unsigned short *half =
+        &this->m_half_buffer[(this->m_width * ys[i] + xs[i]) * num_channels];
+    for (int c = 0; c < num_channels; c++) {
+      result[c] += weights[i] * com_half_to_float(half[c]);
+    }
+  }
+}
+
 static void read_ewa_pixel_sampled(void *userdata, int x, int y, float result[4])
 {
   MemoryBuffer *buffer = (MemoryBuffer *)userdata;
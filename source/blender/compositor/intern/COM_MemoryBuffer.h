@@ -52,6 +52,56 @@ typedef enum MemoryBufferExtend {
 
 class MemoryProxy;
 
+/**
+ * \brief convert to half float, values outside of the half float range are clamped and
+ * denormals are flushed to zero
+ */
+BLI_INLINE unsigned short com_float_to_half(float f)
+{
+  union {
+    float f;
+    unsigned int i;
+  } u;
+  u.f = f;
+  const unsigned int sign = (u.i >> 16) & 0x8000;
+  unsigned int bits = u.i & 0x7FFFFFFF;
+  if (bits > 0x7F800000) {
+    /* NaN */
+    return sign | 0x7E00;
+  }
+  if (bits >= 0x477FF000) {
+    /* would round to infinity */
+    return sign | 0x7BFF;
+  }
+  if (bits < 0x38800000) {
+    /* below the smallest normal half float */
+    return sign;
+  }
+  /* round to nearest even and rebias the exponent */
+  bits += 0x00000FFF + ((bits >> 13) & 1);
+  return sign | ((bits - 0x38000000) >> 13);
+}
+
+BLI_INLINE float com_half_to_float(unsigned short h)
+{
+  union {
+    unsigned int i;
+    float f;
+  } u;
+  const unsigned int sign = (unsigned int)(h & 0x8000) << 16;
+  const unsigned int bits = h & 0x7FFF;
+  if (bits == 0) {
+    u.i = sign;
+  }
+  else if (bits >= 0x7C00) {
+    u.i = sign | 0x7F800000 | ((bits & 0x3FF) << 13);
+  }
+  else {
+    u.i = sign | ((bits << 13) + 0x38000000);
+  }
+  return u.f;
+}
+
 /**
  * \brief a MemoryBuffer contains access to the data of a chunk
  */
@@ -88,6 +138,12 @@ class MemoryBuffer {
    */
   float *m_buffer;
 
+  /**
+   * \brief half float data, used instead of m_buffer when the MemoryProxy uses half floats.
+   * Only accessible through the read and write functions.
+   */
+  unsigned short *m_half_buffer;
+
   /**
    * \brief the number of channels of a single value in the buffer.
    * For value buffers this is 1, vector 3 and color 4
@@ -131,15 +187,30 @@ class MemoryBuffer {
     return this->m_num_channels;
   }
 
+  DataType getDataType() const
+  {
+    return this->m_datatype;
+  }
+
   /**
    * \brief get the data of this MemoryBuffer
    * \note buffer should already be available in memory
+   * \note NULL for half float buffers
    */
   float *getBuffer()
   {
+    BLI_assert(this->m_half_buffer == NULL);
     return this->m_buffer;
   }
 
+  /**
+   * \brief is the data stored with half float precision
+   */
+  bool isHalfFloat() const
+  {
+    return this->m_half_buffer != NULL;
+  }
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
@@ -248,6 +319,10 @@ class MemoryBuffer {
       int v = y;
       this->wrap_pixel(u, v, extend_x, extend_y);
       const int offset = (this->m_width * y + x) * this->m_num_channels;
+      if (this->m_half_buffer) {
+        readHalf(result, offset, 1);
+        return;
+      }
       float *buffer = &this->m_buffer[offset];
       memcpy(result, buffer, sizeof(float) * this->m_num_channels);
     }
@@ -274,10 +349,63 @@ class MemoryBuffer {
     BLI_assert((int)(MEM_allocN_len(this->m_buffer) / sizeof(*this->m_buffer)) ==
                (int)(this->determineBufferSize() * COM_NUMBER_OF_CHANNELS));
 #endif
+    if (this->m_half_buffer) {
+      readHalf(result, offset, 1);
+      return;
+    }
     float *buffer = &this->m_buffer[offset];
     memcpy(result, buffer, sizeof(float) * this->m_num_channels);
   }
 
+  /**
+   * \brief read a row of pixels, pixels outside the rect are zero like in read()
+   */
+  inline void readRow(float *result, int x, int y, int width)
+  {
+    const int num_channels = this->m_num_channels;
+    const int x_end = x + width;
+    const int xmin = (y < m_rect.ymin || y >= m_rect.ymax) ? x_end : max_ii(x, m_rect.xmin);
+    const int xmax = max_ii(xmin, min_ii(x_end, m_rect.xmax));
+
+    if (xmin > x) {
+      memset(result, 0, sizeof(float) * num_channels * (xmin - x));
+    }
+    if (xmax > xmin) {
+      const int offset = (this->m_width * y + xmin) * num_channels;
+      if (this->m_half_buffer) {
+        readHalf(&result[(xmin - x) * num_channels], offset, xmax - xmin);
+      }
+      else {
+        memcpy(&result[(xmin - x) * num_channels],
+               &this->m_buffer[offset],
+               sizeof(float) * num_channels * (xmax - xmin));
+      }
+    }
+    if (x_end > xmax) {
+      memset(&result[(xmax - x) * num_channels], 0, sizeof(float) * num_channels * (x_end - xmax));
+    }
+  }
+
+  /**
+   * \brief write a row of pixels that lies inside the rect
+   */
+  inline void writeRow(const float *data, int x, int y, int width)
+  {
+    BLI_assert(x >= m_rect.xmin && x + width <= m_rect.xmax);
+    BLI_assert(y >= m_rect.ymin && y < m_rect.ymax);
+    const int offset = (this->m_width * (y - m_rect.ymin) + x - m_rect.xmin) *
+                       this->m_num_channels;
+    if (this->m_half_buffer) {
+      unsigned short *half = &this->m_half_buffer[offset];
+      for (int i = 0; i < width * (int)this->m_num_channels; i++) {
+        half[i] = com_float_to_half(data[i]);
+      }
+    }
+    else {
+      memcpy(&this->m_buffer[offset], data, sizeof(float) * this->m_num_channels * width);
+    }
+  }
+
   void writePixel(int x, int y, const float color[4]);
   void addPixel(int x, int y, const float color[4]);
   inline void readBilinear(float *result,
@@ -294,6 +422,10 @@ class MemoryBuffer {
       copy_vn_fl(result, this->m_num_channels, 0.0f);
       return;
     }
+    if (this->m_half_buffer) {
+      readBilinearHalf(result, u, v, extend_x == COM_MB_REPEAT, extend_y == COM_MB_REPEAT);
+      return;
+    }
     BLI_bilinear_interpolation_wrap_fl(this->m_buffer,
                                        result,
                                        this->m_width,
@@ -355,6 +487,19 @@ class MemoryBuffer {
  private:
   unsigned int determineBufferSize();
 
+  /**
+   * \brief convert num_pixels pixels of half float data starting at offset
+   */
+  inline void readHalf(float *result, int offset, int num_pixels)
+  {
+    const unsigned short *half = &this->m_half_buffer[offset];
+    for (int i = 0; i < num_pixels * (int)this->m_num_channels; i++) {
+      result[i] = com_half_to_float(half[i]);
+    }
+  }
+
+  void readBilinearHalf(float *result, float u, float v, bool wrap_x, bool wrap_y);
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryBuffer")
 #endif
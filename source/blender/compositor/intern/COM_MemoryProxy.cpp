@@ -23,6 +23,7 @@ MemoryProxy::MemoryProxy(DataType datatype)
   this->m_writeBufferOperation = NULL;
   this->m_executor = NULL;
   this->m_datatype = datatype;
+  this->m_use_half_float = false;
 }
 
 void MemoryProxy::allocate(unsigned int width, unsigned int height)
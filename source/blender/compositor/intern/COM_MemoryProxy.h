@@ -64,6 +64,11 @@ class MemoryProxy {
    */
   DataType m_datatype;
 
+  /**
+   * \brief store the buffer with half float precision
+   */
+  bool m_use_half_float;
+
  public:
   MemoryProxy(DataType type);
 
@@ -125,6 +130,20 @@ class MemoryProxy {
     return this->m_datatype;
   }
 
+  /**
+   * \brief store the buffer with half float precision.
+   * Only allowed when all operations read it through the MemoryBuffer read functions.
+   */
+  void setUseHalfFloat(bool use_half_float)
+  {
+    this->m_use_half_float = use_half_float;
+  }
+
+  bool getUseHalfFloat() const
+  {
+    return this->m_use_half_float;
+  }
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryProxy")
 #endif
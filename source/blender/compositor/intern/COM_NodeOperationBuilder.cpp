@@ -27,6 +27,7 @@ extern "C" {
 #include "COM_NodeConverter.h"
 #include "COM_SocketProxyNode.h"
 
+#include "COM_CachedBufferOperation.h"
 #include "COM_NodeOperation.h"
 #include "COM_PreviewOperation.h"
 #include "COM_ReadBufferOperation.h"
@@ -109,6 +110,10 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
   /* surround complex ops with read/write buffer */
   add_complex_operation_buffers();
 
+  if (m_context->isHalfFloatBufferEnabled()) {
+    determine_half_float_buffers();
+  }
+
   /* links not available from here on */
   /* XXX make m_links a local variable to avoid confusion! */
   m_links.clear();
@@ -128,6 +133,9 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
   m_operations.push_back(operation);
+  if (m_current_node) {
+    m_operation_nodes[operation] = m_current_node;
+  }
 }
 
 void NodeOperationBuilder::mapInputSocket(NodeInput *node_socket,
@@ -584,6 +592,12 @@ void NodeOperationBuilder::add_complex_operation_buffers()
     }
   }
 
+  /* results are only cached while editing, renders are composited once */
+  const bool use_cache = !m_context->isRendering();
+  const std::string context_key = use_cache ? BufferCache::context_key(*m_context) :
+                                              std::string();
+  BufferCache::NodeKeys node_keys;
+
   for (Operations::const_iterator it = complex_ops.begin(); it != complex_ops.end(); ++it) {
     NodeOperation *op = *it;
 
@@ -596,6 +610,89 @@ void NodeOperationBuilder::add_complex_operation_buffers()
     for (int index = 0; index < op->getNumberOfOutputSockets(); index++) {
       add_output_buffers(op, op->getOutputSocket(index));
     }
+
+    if (use_cache && op->getNumberOfOutputSockets() == 1) {
+      add_cached_buffer(op, context_key, node_keys);
+    }
+  }
+}
+
+void NodeOperationBuilder::determine_half_float_buffers()
+{
+  /* complex operations access the float data of their input buffers directly */
+  std::set<MemoryProxy *> float_proxies;
+  for (Links::const_iterator it = m_links.begin(); it != m_links.end(); ++it) {
+    const Link &link = *it;
+    NodeOperation *from = &link.from()->getOperation();
+    if (from->isReadBufferOperation() && link.to()->getOperation().isComplex()) {
+      float_proxies.insert(((ReadBufferOperation *)from)->getMemoryProxy());
+    }
+  }
+
+  for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+    NodeOperation *op = *it;
+    if (!op->isWriteBufferOperation()) {
+      continue;
+    }
+    MemoryProxy *proxy = ((WriteBufferOperation *)op)->getMemoryProxy();
+    /* values and vectors keep full precision, they often hold depth or motion */
+    if (proxy->getDataType() == COM_DT_COLOR &&
+        float_proxies.find(proxy) == float_proxies.end()) {
+      proxy->setUseHalfFloat(true);
+    }
+  }
+}
+
+void NodeOperationBuilder::add_cached_buffer(NodeOperation *operation,
+                                             const std::string &context_key,
+                                             BufferCache::NodeKeys &node_keys)
+{
+  WriteBufferOperation *writeOperation = find_attached_write_buffer_operation(
+      operation->getOutputSocket());
+  if (!writeOperation || operation->getWidth() == 0 || operation->getHeight() == 0) {
+    return;
+  }
+
+  OperationNodeMap::const_iterator found = m_operation_nodes.find(operation);
+  if (found == m_operation_nodes.end()) {
+    return;
+  }
+  Node *node = found->second;
+  const std::string node_key = BufferCache::node_key(node, node_keys);
+  if (node_key.empty()) {
+    return;
+  }
+
+  /* nodes can create multiple operations, identify this one by creation order */
+  int node_index = 0;
+  for (Operations::const_iterator it = m_operations.begin(); *it != operation; ++it) {
+    OperationNodeMap::const_iterator op_node = m_operation_nodes.find(*it);
+    if (op_node != m_operation_nodes.end() && op_node->second == node) {
+      node_index++;
+    }
+  }
+
+  std::string key = context_key + node_key;
+  const int values[4] = {node_index,
+                         (int)operation->getWidth(),
+                         (int)operation->getHeight(),
+                         (int)operation->getOutputSocket()->getDataType()};
+  key.append((const char *)values, sizeof(values));
+
+  MemoryBuffer *buffer = BufferCache::acquire(key);
+  if (buffer) {
+    /* write the cached result instead, the operation and its inputs are pruned when unused */
+    CachedBufferOperation *cachedOperation = new CachedBufferOperation(buffer);
+    unsigned int resolution[2] = {(unsigned int)buffer->getWidth(),
+                                  (unsigned int)buffer->getHeight()};
+    cachedOperation->setResolution(resolution);
+    addOperation(cachedOperation);
+
+    removeInputLink(writeOperation->getInputSocket(0));
+    addLink(cachedOperation->getOutputSocket(), writeOperation->getInputSocket(0));
+  }
+  else {
+    writeOperation->setCacheKey(key);
   }
 }
 
@@ -23,6 +23,7 @@
 #include <set>
 #include <vector>
 
+#include "COM_BufferCache.h"
 #include "COM_NodeGraph.h"
 
 using std::vector;
@@ -75,6 +76,8 @@ class NodeOperationBuilder {
   typedef std::vector<NodeOperationInput *> OpInputs;
   typedef std::map<NodeInput *, OpInputs> OpInputInverseMap;
 
+  typedef std::map<NodeOperation *, Node *> OperationNodeMap;
+
  private:
   const CompositorContext *m_context;
   NodeGraph m_graph;
@@ -90,6 +93,9 @@ class NodeOperationBuilder {
 
   Node *m_current_node;
 
+  /** Maps operations to the node they were created for */
+  OperationNodeMap m_operation_nodes;
+
   /** Operation that will be writing to the viewer image
    *  Only one operation can occupy this place at a time,
    *  to avoid race conditions
@@ -158,6 +164,12 @@ class NodeOperationBuilder {
   void add_complex_operation_buffers();
   void add_input_buffers(NodeOperation *operation, NodeOperationInput *input);
   void add_output_buffers(NodeOperation *operation, NodeOperationOutput *output);
+  /** Store color buffers only read by non-complex operations as half float */
+  void determine_half_float_buffers();
+  /** Use the cached result of a buffered operation, or store it after execution */
+  void add_cached_buffer(NodeOperation *operation,
+                         const std::string &context_key,
+                         BufferCache::NodeKeys &node_keys);
 
   /** Remove unreachable operations */
   void prune_operations();
@@ -16,4 +16,15 @@
  * Copyright 2011, Blender Foundation.
  */
 
+#include <string.h>
+
 #include "COM_SocketReader.h"
+
+void SocketReader::executeRow(float *output, int x, int y, int width, int num_channels)
+{
+  float color[4];
+  for (int i = 0; i < width; i++) {
+    executePixelSampled(color, x + i, y, COM_PS_NEAREST);
+    memcpy(&output[i * num_channels], color, sizeof(float) * num_channels);
+  }
+}
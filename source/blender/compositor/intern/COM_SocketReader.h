@@ -94,6 +94,19 @@ class SocketReader {
   {
   }
 
+  /**
+   * \brief calculate a row of pixels
+   * \note this method is called for non-complex, pixels are sampled with COM_PS_NEAREST.
+   * The default implementation calculates the pixels one by one, operations doing pixel-wise
+   * math override it to process the whole row in a single loop.
+   * \param output: is an array of width * num_channels floats to store the result
+   * \param x: the x-coordinate of the first pixel to calculate in image space
+   * \param y: the y-coordinate of the row to calculate in image space
+   * \param width: the number of pixels to calculate, at most COM_ROW_WIDTH
+   * \param num_channels: the number of channels of the output socket
+   */
+  virtual void executeRow(float *output, int x, int y, int width, int num_channels);
+
  public:
   inline void readSampled(float result[4], float x, float y, PixelSampler sampler)
   {
@@ -103,6 +116,10 @@ class SocketReader {
   {
     executePixel(result, x, y, chunkData);
   }
+  inline void readRow(float *result, int x, int y, int width, int num_channels)
+  {
+    executeRow(result, x, y, width, num_channels);
+  }
   inline void readFiltered(float result[4], float x, float y, float dx[2], float dy[2])
   {
     executePixelFiltered(result, x, y, dx, dy);
@@ -25,6 +25,7 @@ extern "C" {
 
 #include "BKE_scene.h"
 
+#include "COM_BufferCache.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_MovieDistortionOperation.h"
 #include "COM_WorkScheduler.h"
@@ -78,6 +79,11 @@ void COM_execute(RenderData *rd,
   }
   BKE_node_preview_init_tree(editingtree, preview_width, preview_height, false);
 
+  /* results of render layers are cached while editing, rendering replaces them */
+  if (rendering) {
+    BufferCache::clear();
+  }
+
   /* initialize workscheduler, will check if already done. TODO deinitialize somewhere */
   bool use_opencl = (editingtree->flag & NTREE_COM_OPENCL) != 0;
   WorkScheduler::initialize(use_opencl, BKE_render_num_threads(rd));
@@ -119,4 +125,10 @@ void COM_deinitialize()
     BLI_mutex_unlock(&s_compositorMutex);
     BLI_mutex_end(&s_compositorMutex);
   }
+  BufferCache::clear();
+}
+
+void COM_clearCaches()
+{
+  BufferCache::clear();
 }
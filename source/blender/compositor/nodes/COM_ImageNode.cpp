@@ -93,6 +93,26 @@ void ImageNode::convertToOperations(NodeConverter &converter,
 
         is_multilayer_ok = true;
 
+        /* Passes are read from the file on first use, read the passes of all used outputs
+         * together since the file is decoded as a whole for any number of passes. */
+        std::vector<RenderPass *> used_passes;
+        for (index = 0; index < numberOfOutputs; index++) {
+          bNodeSocket *bnodeSocket = this->getOutputSocket(index)->getbNodeSocket();
+          if ((bnodeSocket->flag & SOCK_IN_USE) == 0) {
+            continue;
+          }
+          NodeImageLayer *storage = (NodeImageLayer *)bnodeSocket->storage;
+          RenderPass *rpass = (RenderPass *)BLI_findstring(
+              &rl->passes, storage->pass_name, offsetof(RenderPass, name));
+          if (rpass) {
+            used_passes.push_back(rpass);
+          }
+        }
+        if (!used_passes.empty()) {
+          BKE_image_multilayer_passes_ensure_loaded(
+              image, used_passes.data(), (int)used_passes.size());
+        }
+
         for (index = 0; index < numberOfOutputs; index++) {
           NodeOperation *operation = NULL;
           socket = this->getOutputSocket(index);
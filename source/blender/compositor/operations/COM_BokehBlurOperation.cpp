@@ -18,8 +18,11 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
+#include "COM_FFTConvolution.h"
 #include "COM_OpenCLDevice.h"
 
+#include "MEM_guardedalloc.h"
+
 extern "C" {
 #include "RE_pipeline.h"
 }
@@ -41,6 +44,8 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
   this->m_inputBoundingBoxReader = NULL;
 
   this->m_extend_bounds = false;
+  this->m_fft_result = NULL;
+  this->m_fft_done = false;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -50,10 +55,92 @@ void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
     updateSize();
   }
   void *buffer = getInputOperation(0)->initializeTileData(NULL);
+  if (!this->m_fft_done) {
+    const float max_dim = max(this->getWidth(), this->getHeight());
+    const int pixelSize = this->m_size * max_dim / 100.0f;
+    if (pixelSize >= COM_BOKEH_FFT_MIN_RADIUS) {
+      updateFFTResult((MemoryBuffer *)buffer, pixelSize);
+    }
+    this->m_fft_done = true;
+  }
   unlockMutex();
   return buffer;
 }
 
+/* Convolve the whole input at once, the cost of this does not grow with the square of the
+ * radius like evaluating all kernel taps per pixel does. Gives the same result as executePixel
+ * at full quality: taps outside of the input are skipped and the result is normalized by the
+ * kernel weights inside it. */
+void BokehBlurOperation::updateFFTResult(MemoryBuffer *inputBuffer, int radius)
+{
+  const int width = inputBuffer->getWidth();
+  const int height = inputBuffer->getHeight();
+  const int kernel_size = 2 * radius + 1;
+  const float m = this->m_bokehDimension / radius;
+
+  /* kernel index i is the tap at offset (radius - i), taps run from -radius to radius - 1 */
+  float *kernel = (float *)MEM_callocN(
+      sizeof(float) * kernel_size * kernel_size * COM_NUM_CHANNELS_COLOR, "bokeh fft kernel");
+  for (int ky = 1; ky < kernel_size; ky++) {
+    for (int kx = 1; kx < kernel_size; kx++) {
+      const float u = this->m_bokehMidX - (radius - kx) * m;
+      const float v = this->m_bokehMidY - (radius - ky) * m;
+      this->m_inputBokehProgram->readSampled(
+          &kernel[(ky * kernel_size + kx) * COM_NUM_CHANNELS_COLOR], u, v, COM_PS_NEAREST);
+    }
+  }
+
+  /* summed area table of the kernel, to find the weights of the taps inside the input */
+  const int table_size = kernel_size + 1;
+  double *table = (double *)MEM_callocN(
+      sizeof(double) * table_size * table_size * COM_NUM_CHANNELS_COLOR, "bokeh fft weights");
+  for (int ky = 0; ky < kernel_size; ky++) {
+    for (int kx = 0; kx < kernel_size; kx++) {
+      const float *weight = &kernel[(ky * kernel_size + kx) * COM_NUM_CHANNELS_COLOR];
+      double *sum = &table[((ky + 1) * table_size + kx + 1) * COM_NUM_CHANNELS_COLOR];
+      const double *sum_left = sum - COM_NUM_CHANNELS_COLOR;
+      const double *sum_up = sum - table_size * COM_NUM_CHANNELS_COLOR;
+      const double *sum_diag = sum_up - COM_NUM_CHANNELS_COLOR;
+      for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+        sum[c] = weight[c] + sum_left[c] + sum_up[c] - sum_diag[c];
+      }
+    }
+  }
+
+  this->m_fft_result = (float *)MEM_mallocN(
+      sizeof(float) * width * height * COM_NUM_CHANNELS_COLOR, "bokeh fft result");
+  convolve_fft(this->m_fft_result,
+               inputBuffer->getBuffer(),
+               width,
+               height,
+               kernel,
+               kernel_size,
+               kernel_size,
+               COM_NUM_CHANNELS_COLOR,
+               COM_NUM_CHANNELS_COLOR);
+
+  for (int y = 0; y < height; y++) {
+    /* kernel rows of the taps inside the input */
+    const int ky_min = radius - min(radius - 1, height - 1 - y);
+    const int ky_max = radius + min(radius, y) + 1;
+    for (int x = 0; x < width; x++) {
+      const int kx_min = radius - min(radius - 1, width - 1 - x);
+      const int kx_max = radius + min(radius, x) + 1;
+      float *result = &this->m_fft_result[(y * width + x) * COM_NUM_CHANNELS_COLOR];
+      for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+        const double weight = table[(ky_max * table_size + kx_max) * COM_NUM_CHANNELS_COLOR + c] -
+                              table[(ky_min * table_size + kx_max) * COM_NUM_CHANNELS_COLOR + c] -
+                              table[(ky_max * table_size + kx_min) * COM_NUM_CHANNELS_COLOR + c] +
+                              table[(ky_min * table_size + kx_min) * COM_NUM_CHANNELS_COLOR + c];
+        result[c] = (weight != 0.0) ? (float)(result[c] / weight) : 0.0f;
+      }
+    }
+  }
+
+  MEM_freeN(table);
+  MEM_freeN(kernel);
+}
+
 void BokehBlurOperation::initExecution()
 {
   initMutex();
@@ -79,7 +166,18 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
   float bokeh[4];
 
   this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
-  if (tempBoundingBox[0] > 0.0f) {
+  if (tempBoundingBox[0] > 0.0f && this->m_fft_result) {
+    MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
+    const rcti *rect = inputBuffer->getRect();
+    if (x >= rect->xmin && x < rect->xmax && y >= rect->ymin && y < rect->ymax) {
+      const int offset = (y - rect->ymin) * inputBuffer->getWidth() + (x - rect->xmin);
+      copy_v4_v4(output, &this->m_fft_result[offset * COM_NUM_CHANNELS_COLOR]);
+    }
+    else {
+      zero_v4(output);
+    }
+  }
+  else if (tempBoundingBox[0] > 0.0f) {
     float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
     MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
     float *buffer = inputBuffer->getBuffer();
@@ -135,6 +233,11 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 void BokehBlurOperation::deinitExecution()
 {
   deinitMutex();
+  if (this->m_fft_result) {
+    MEM_freeN(this->m_fft_result);
+    this->m_fft_result = NULL;
+  }
+  this->m_fft_done = false;
   this->m_inputProgram = NULL;
   this->m_inputBokehProgram = NULL;
   this->m_inputBoundingBoxReader = NULL;
@@ -34,6 +34,11 @@ class BokehBlurOperation : public NodeOperation, public QualityStepHelper {
   float m_bokehMidY;
   float m_bokehDimension;
   bool m_extend_bounds;
+  /* whole image result of large blurs, calculated in the frequency domain */
+  float *m_fft_result;
+  bool m_fft_done;
+
+  void updateFFTResult(MemoryBuffer *inputBuffer, int radius);
 
  public:
   BokehBlurOperation();
@@ -40,20 +40,10 @@ void BrightnessOperation::initExecution()
   this->m_inputContrastProgram = this->getInputSocketReader(2);
 }
 
-void BrightnessOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+static void brightness_contrast(
+    float output[4], float inputValue[4], float brightness, float contrast, bool use_premultiply)
 {
-  float inputValue[4];
   float a, b;
-  float inputBrightness[4];
-  float inputContrast[4];
-  this->m_inputProgram->readSampled(inputValue, x, y, sampler);
-  this->m_inputBrightnessProgram->readSampled(inputBrightness, x, y, sampler);
-  this->m_inputContrastProgram->readSampled(inputContrast, x, y, sampler);
-  float brightness = inputBrightness[0];
-  float contrast = inputContrast[0];
   brightness /= 100.0f;
   float delta = contrast / 200.0f;
   /*
@@ -71,18 +61,48 @@ void BrightnessOperation::executePixelSampled(float output[4],
     a = max_ff(1.0f - delta * 2.0f, 0.0f);
     b = a * brightness + delta;
   }
-  if (this->m_use_premultiply) {
+  if (use_premultiply) {
     premul_to_straight_v4(inputValue);
   }
   output[0] = a * inputValue[0] + b;
   output[1] = a * inputValue[1] + b;
   output[2] = a * inputValue[2] + b;
   output[3] = inputValue[3];
-  if (this->m_use_premultiply) {
+  if (use_premultiply) {
     straight_to_premul_v4(output);
   }
 }
 
+void BrightnessOperation::executePixelSampled(float output[4],
+                                              float x,
+                                              float y,
+                                              PixelSampler sampler)
+{
+  float inputValue[4];
+  float inputBrightness[4];
+  float inputContrast[4];
+  this->m_inputProgram->readSampled(inputValue, x, y, sampler);
+  this->m_inputBrightnessProgram->readSampled(inputBrightness, x, y, sampler);
+  this->m_inputContrastProgram->readSampled(inputContrast, x, y, sampler);
+  brightness_contrast(
+      output, inputValue, inputBrightness[0], inputContrast[0], this->m_use_premultiply);
+}
+
+void BrightnessOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  float inputBrightness[COM_ROW_WIDTH];
+  float inputContrast[COM_ROW_WIDTH];
+  this->m_inputProgram->readRow(output, x, y, width, COM_NUM_CHANNELS_COLOR);
+  this->m_inputBrightnessProgram->readRow(inputBrightness, x, y, width, COM_NUM_CHANNELS_VALUE);
+  this->m_inputContrastProgram->readRow(inputContrast, x, y, width, COM_NUM_CHANNELS_VALUE);
+  for (int i = 0; i < width; i++, output += COM_NUM_CHANNELS_COLOR) {
+    float inputValue[4];
+    copy_v4_v4(inputValue, output);
+    brightness_contrast(
+        output, inputValue, inputBrightness[i], inputContrast[i], this->m_use_premultiply);
+  }
+}
+
 void BrightnessOperation::deinitExecution()
 {
   this->m_inputProgram = NULL;
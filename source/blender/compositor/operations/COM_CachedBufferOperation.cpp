@@ -0,0 +1,57 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include "COM_CachedBufferOperation.h"
+#include "COM_BufferCache.h"
+
+CachedBufferOperation::CachedBufferOperation(MemoryBuffer *buffer) : NodeOperation()
+{
+  this->m_buffer = buffer;
+  this->addOutputSocket(buffer->getDataType());
+}
+
+CachedBufferOperation::~CachedBufferOperation()
+{
+  BufferCache::release(this->m_buffer);
+}
+
+void CachedBufferOperation::executePixelSampled(float output[4],
+                                                float x,
+                                                float y,
+                                                PixelSampler sampler)
+{
+  if (sampler == COM_PS_NEAREST) {
+    this->m_buffer->read(output, x, y);
+  }
+  else {
+    this->m_buffer->readBilinear(output, x, y);
+  }
+}
+
+void CachedBufferOperation::executeRow(
+    float *output, int x, int y, int width, int /*num_channels*/)
+{
+  this->m_buffer->readRow(output, x, y, width);
+}
+
+void CachedBufferOperation::determineResolution(unsigned int resolution[2],
+                                                unsigned int /*preferredResolution*/[2])
+{
+  resolution[0] = this->m_buffer->getWidth();
+  resolution[1] = this->m_buffer->getHeight();
+}
@@ -0,0 +1,45 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_CACHEDBUFFEROPERATION_H__
+#define __COM_CACHEDBUFFEROPERATION_H__
+
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+
+/**
+ * \brief provides a result stored in the BufferCache by an earlier execution
+ * \ingroup Operation
+ */
+class CachedBufferOperation : public NodeOperation {
+ private:
+  MemoryBuffer *m_buffer;
+
+ public:
+  /**
+   * \param buffer: acquired from the BufferCache, released when the operation is freed
+   */
+  CachedBufferOperation(MemoryBuffer *buffer);
+  ~CachedBufferOperation();
+
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
+  void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
+};
+
+#endif
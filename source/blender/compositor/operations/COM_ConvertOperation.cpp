@@ -56,6 +56,20 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::executeRow(float *output,
+                                              int x,
+                                              int y,
+                                              int width,
+                                              int /*num_channels*/)
+{
+  float input[COM_ROW_WIDTH];
+  this->m_inputOperation->readRow(input, x, y, width, COM_NUM_CHANNELS_VALUE);
+  for (int i = 0; i < width; i++, output += COM_NUM_CHANNELS_COLOR) {
+    output[0] = output[1] = output[2] = input[i];
+    output[3] = 1.0f;
+  }
+}
+
 /* ******** Color to Value ******** */
 
 ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperation()
@@ -74,6 +88,20 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4],
   output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::executeRow(float *output,
+                                              int x,
+                                              int y,
+                                              int width,
+                                              int /*num_channels*/)
+{
+  float input[COM_ROW_WIDTH * COM_NUM_CHANNELS_COLOR];
+  this->m_inputOperation->readRow(input, x, y, width, COM_NUM_CHANNELS_COLOR);
+  for (int i = 0; i < width; i++) {
+    const float *inputColor = &input[i * COM_NUM_CHANNELS_COLOR];
+    output[i] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
+  }
+}
+
 /* ******** Color to BW ******** */
 
 ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
@@ -92,6 +120,19 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4],
   output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::executeRow(float *output,
+                                           int x,
+                                           int y,
+                                           int width,
+                                           int /*num_channels*/)
+{
+  float input[COM_ROW_WIDTH * COM_NUM_CHANNELS_COLOR];
+  this->m_inputOperation->readRow(input, x, y, width, COM_NUM_CHANNELS_COLOR);
+  for (int i = 0; i < width; i++) {
+    output[i] = IMB_colormanagement_get_luminance(&input[i * COM_NUM_CHANNELS_COLOR]);
+  }
+}
+
 /* ******** Color to Vector ******** */
 
 ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOperation()
@@ -110,6 +151,19 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4],
   copy_v3_v3(output, color);
 }
 
+void ConvertColorToVectorOperation::executeRow(float *output,
+                                               int x,
+                                               int y,
+                                               int width,
+                                               int /*num_channels*/)
+{
+  float input[COM_ROW_WIDTH * COM_NUM_CHANNELS_COLOR];
+  this->m_inputOperation->readRow(input, x, y, width, COM_NUM_CHANNELS_COLOR);
+  for (int i = 0; i < width; i++) {
+    copy_v3_v3(&output[i * COM_NUM_CHANNELS_VECTOR], &input[i * COM_NUM_CHANNELS_COLOR]);
+  }
+}
+
 /* ******** Value to Vector ******** */
 
 ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOperation()
@@ -128,6 +182,19 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4],
   output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::executeRow(float *output,
+                                               int x,
+                                               int y,
+                                               int width,
+                                               int /*num_channels*/)
+{
+  float input[COM_ROW_WIDTH];
+  this->m_inputOperation->readRow(input, x, y, width, COM_NUM_CHANNELS_VALUE);
+  for (int i = 0; i < width; i++, output += COM_NUM_CHANNELS_VECTOR) {
+    output[0] = output[1] = output[2] = input[i];
+  }
+}
+
 /* ******** Vector to Color ******** */
 
 ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOperation()
@@ -145,6 +212,20 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::executeRow(float *output,
+                                               int x,
+                                               int y,
+                                               int width,
+                                               int /*num_channels*/)
+{
+  float input[COM_ROW_WIDTH * COM_NUM_CHANNELS_VECTOR];
+  this->m_inputOperation->readRow(input, x, y, width, COM_NUM_CHANNELS_VECTOR);
+  for (int i = 0; i < width; i++) {
+    copy_v3_v3(&output[i * COM_NUM_CHANNELS_COLOR], &input[i * COM_NUM_CHANNELS_VECTOR]);
+    output[i * COM_NUM_CHANNELS_COLOR + 3] = 1.0f;
+  }
+}
+
 /* ******** Vector to Value ******** */
 
 ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOperation()
@@ -163,6 +244,20 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4],
   output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::executeRow(float *output,
+                                               int x,
+                                               int y,
+                                               int width,
+                                               int /*num_channels*/)
+{
+  float input[COM_ROW_WIDTH * COM_NUM_CHANNELS_VECTOR];
+  this->m_inputOperation->readRow(input, x, y, width, COM_NUM_CHANNELS_VECTOR);
+  for (int i = 0; i < width; i++) {
+    const float *vector = &input[i * COM_NUM_CHANNELS_VECTOR];
+    output[i] = (vector[0] + vector[1] + vector[2]) / 3.0f;
+  }
+}
+
 /* ******** RGB to YCC ******** */
 
 ConvertRGBToYCCOperation::ConvertRGBToYCCOperation() : ConvertBaseOperation()
@@ -372,6 +467,24 @@ void ConvertPremulToStraightOperation::executePixelSampled(float output[4],
   output[3] = alpha;
 }
 
+void ConvertPremulToStraightOperation::executeRow(float *output,
+                                                  int x,
+                                                  int y,
+                                                  int width,
+                                                  int /*num_channels*/)
+{
+  this->m_inputOperation->readRow(output, x, y, width, COM_NUM_CHANNELS_COLOR);
+  for (int i = 0; i < width; i++, output += COM_NUM_CHANNELS_COLOR) {
+    const float alpha = output[3];
+    if (fabsf(alpha) < 1e-5f) {
+      zero_v3(output);
+    }
+    else {
+      mul_v3_fl(output, 1.0f / alpha);
+    }
+  }
+}
+
 /* ******** Straight to Premul ******** */
 
 ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : ConvertBaseOperation()
@@ -397,6 +510,18 @@ void ConvertStraightToPremulOperation::executePixelSampled(float output[4],
   output[3] = alpha;
 }
 
+void ConvertStraightToPremulOperation::executeRow(float *output,
+                                                  int x,
+                                                  int y,
+                                                  int width,
+                                                  int /*num_channels*/)
+{
+  this->m_inputOperation->readRow(output, x, y, width, COM_NUM_CHANNELS_COLOR);
+  for (int i = 0; i < width; i++, output += COM_NUM_CHANNELS_COLOR) {
+    mul_v3_fl(output, output[3]);
+  }
+}
+
 /* ******** Separate Channels ******** */
 
 SeparateChannelOperation::SeparateChannelOperation() : NodeOperation()
@@ -425,6 +550,19 @@ void SeparateChannelOperation::executePixelSampled(float output[4],
   output[0] = input[this->m_channel];
 }
 
+void SeparateChannelOperation::executeRow(float *output,
+                                          int x,
+                                          int y,
+                                          int width,
+                                          int /*num_channels*/)
+{
+  float input[COM_ROW_WIDTH * COM_NUM_CHANNELS_COLOR];
+  this->m_inputOperation->readRow(input, x, y, width, COM_NUM_CHANNELS_COLOR);
+  for (int i = 0; i < width; i++) {
+    output[i] = input[i * COM_NUM_CHANNELS_COLOR + this->m_channel];
+  }
+}
+
 /* ******** Combine Channels ******** */
 
 CombineChannelsOperation::CombineChannelsOperation() : NodeOperation()
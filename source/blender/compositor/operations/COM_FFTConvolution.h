@@ -0,0 +1,41 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_FFTCONVOLUTION_H__
+#define __COM_FFTCONVOLUTION_H__
+
+/**
+ * Convolve an image with a kernel in the frequency domain, using the 2D Fast Hartley Transform.
+ * The cost depends on the image size and only grows with the logarithm of the kernel size.
+ *
+ * Image, kernel and result store `stride` floats per pixel, the first `num_channels` of them
+ * are convolved with the same channel of the kernel, the others are set to zero in the result.
+ * The kernel is centered at (kernel_width / 2, kernel_height / 2), pixels outside of the image
+ * are zero. Channels are convolved in parallel.
+ */
+void convolve_fft(float *dst,
+                  const float *image,
+                  int width,
+                  int height,
+                  const float *kernel,
+                  int kernel_width,
+                  int kernel_height,
+                  int stride,
+                  int num_channels);
+
+#endif
@@ -49,6 +49,21 @@ void GammaOperation::executePixelSampled(float output[4], float x, float y, Pixe
   output[3] = inputValue[3];
 }
 
+void GammaOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  float inputGamma[COM_ROW_WIDTH];
+
+  this->m_inputProgram->readRow(output, x, y, width, COM_NUM_CHANNELS_COLOR);
+  this->m_inputGammaProgram->readRow(inputGamma, x, y, width, COM_NUM_CHANNELS_VALUE);
+  for (int i = 0; i < width; i++, output += COM_NUM_CHANNELS_COLOR) {
+    const float gamma = inputGamma[i];
+    /* check for negative to avoid nan's */
+    output[0] = output[0] > 0.0f ? powf(output[0], gamma) : output[0];
+    output[1] = output[1] > 0.0f ? powf(output[1], gamma) : output[1];
+    output[2] = output[2] > 0.0f ? powf(output[2], gamma) : output[2];
+  }
+}
+
 void GammaOperation::deinitExecution()
 {
   this->m_inputProgram = NULL;
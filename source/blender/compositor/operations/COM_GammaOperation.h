@@ -36,6 +36,11 @@ class GammaOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  /**
+   * the inner loop of this program, for a whole row
+   */
+  void executeRow(float *output, int x, int y, int width, int num_channels);
+
   /**
    * Initialize the execution
    */
@@ -72,6 +72,15 @@ void MathBaseOperation::clampIfNeeded(float *color)
   }
 }
 
+void MathBaseOperation::clampRowIfNeeded(float *output, int width)
+{
+  if (this->m_useClamp) {
+    for (int i = 0; i < width; i++) {
+      CLAMP(output[i], 0.0f, 1.0f);
+    }
+  }
+}
+
 void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
   float inputValue1[4];
@@ -85,6 +94,11 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
   clampIfNeeded(output);
 }
 
+void MathAddOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowBinary(output, x, y, width, [](float a, float b) { return a + b; });
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -101,6 +115,15 @@ void MathSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathSubtractOperation::executeRow(float *output,
+                                       int x,
+                                       int y,
+                                       int width,
+                                       int /*num_channels*/)
+{
+  executeRowBinary(output, x, y, width, [](float a, float b) { return a - b; });
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -117,6 +140,15 @@ void MathMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::executeRow(float *output,
+                                       int x,
+                                       int y,
+                                       int width,
+                                       int /*num_channels*/)
+{
+  executeRowBinary(output, x, y, width, [](float a, float b) { return a * b; });
+}
+
 void MathDivideOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -138,6 +170,14 @@ void MathDivideOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathDivideOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowBinary(output, x, y, width, [](float a, float b) -> float {
+    /* We don't want to divide by zero. */
+    return (b == 0.0f) ? 0.0f : a / b;
+  });
+}
+
 void MathSineOperation::executePixelSampled(float output[4],
                                             float x,
                                             float y,
@@ -320,6 +360,21 @@ void MathPowerOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathPowerOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowBinary(output, x, y, width, [](float a, float b) -> float {
+    if (a >= 0) {
+      return pow(a, b);
+    }
+    float y_mod_1 = fmod(b, 1);
+    /* if input value is not nearly an integer, fall back to zero, nicer than straight rounding */
+    if (y_mod_1 > 0.999f || y_mod_1 < 0.001f) {
+      return pow(a, floorf(b + 0.5f));
+    }
+    return 0.0f;
+  });
+}
+
 void MathLogarithmOperation::executePixelSampled(float output[4],
                                                  float x,
                                                  float y,
@@ -357,6 +412,11 @@ void MathMinimumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMinimumOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowBinary(output, x, y, width, [](float a, float b) { return min(a, b); });
+}
+
 void MathMaximumOperation::executePixelSampled(float output[4],
                                                float x,
                                                float y,
@@ -373,6 +433,11 @@ void MathMaximumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMaximumOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowBinary(output, x, y, width, [](float a, float b) { return max(a, b); });
+}
+
 void MathRoundOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -389,6 +454,11 @@ void MathRoundOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathRoundOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowUnary(output, x, y, width, [](float a) { return round(a); });
+}
+
 void MathLessThanOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -405,6 +475,15 @@ void MathLessThanOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathLessThanOperation::executeRow(float *output,
+                                       int x,
+                                       int y,
+                                       int width,
+                                       int /*num_channels*/)
+{
+  executeRowBinary(output, x, y, width, [](float a, float b) { return a < b ? 1.0f : 0.0f; });
+}
+
 void MathGreaterThanOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -421,6 +500,15 @@ void MathGreaterThanOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathGreaterThanOperation::executeRow(float *output,
+                                          int x,
+                                          int y,
+                                          int width,
+                                          int /*num_channels*/)
+{
+  executeRowBinary(output, x, y, width, [](float a, float b) { return a > b ? 1.0f : 0.0f; });
+}
+
 void MathModuloOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -456,6 +544,15 @@ void MathAbsoluteOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathAbsoluteOperation::executeRow(float *output,
+                                       int x,
+                                       int y,
+                                       int width,
+                                       int /*num_channels*/)
+{
+  executeRowUnary(output, x, y, width, [](float a) { return fabs(a); });
+}
+
 void MathRadiansOperation::executePixelSampled(float output[4],
                                                float x,
                                                float y,
@@ -514,6 +611,11 @@ void MathFloorOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathFloorOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowUnary(output, x, y, width, [](float a) { return floor(a); });
+}
+
 void MathCeilOperation::executePixelSampled(float output[4],
                                             float x,
                                             float y,
@@ -528,6 +630,11 @@ void MathCeilOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathCeilOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowUnary(output, x, y, width, [](float a) { return ceil(a); });
+}
+
 void MathFractOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -542,6 +649,11 @@ void MathFractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathFractOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowUnary(output, x, y, width, [](float a) { return a - floor(a); });
+}
+
 void MathSqrtOperation::executePixelSampled(float output[4],
                                             float x,
                                             float y,
@@ -561,6 +673,11 @@ void MathSqrtOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathSqrtOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowUnary(output, x, y, width, [](float a) { return (a > 0) ? sqrt(a) : 0.0f; });
+}
+
 void MathInverseSqrtOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -698,6 +815,13 @@ void MathCompareOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathCompareOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowTernary(output, x, y, width, [](float a, float b, float c) {
+    return (fabsf(a - b) <= MAX2(c, 1e-5f)) ? 1.0f : 0.0f;
+  });
+}
+
 void MathMultiplyAddOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -716,6 +840,15 @@ void MathMultiplyAddOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMultiplyAddOperation::executeRow(float *output,
+                                          int x,
+                                          int y,
+                                          int width,
+                                          int /*num_channels*/)
+{
+  executeRowTernary(output, x, y, width, [](float a, float b, float c) { return a * b + c; });
+}
+
 void MathSmoothMinOperation::executePixelSampled(float output[4],
                                                  float x,
                                                  float y,
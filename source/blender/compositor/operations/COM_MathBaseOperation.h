@@ -42,6 +42,56 @@ class MathBaseOperation : public NodeOperation {
   MathBaseOperation();
 
   void clampIfNeeded(float color[4]);
+  void clampRowIfNeeded(float *output, int width);
+
+  /**
+   * Helpers for the row kernels, evaluating a function of the input values for every pixel.
+   */
+  template<typename Func> void executeRowUnary(float *output, int x, int y, int width, Func func)
+  {
+    float inputValue1[COM_ROW_WIDTH];
+
+    this->m_inputValue1Operation->readRow(inputValue1, x, y, width, COM_NUM_CHANNELS_VALUE);
+
+    for (int i = 0; i < width; i++) {
+      output[i] = func(inputValue1[i]);
+    }
+
+    clampRowIfNeeded(output, width);
+  }
+
+  template<typename Func> void executeRowBinary(float *output, int x, int y, int width, Func func)
+  {
+    float inputValue1[COM_ROW_WIDTH];
+    float inputValue2[COM_ROW_WIDTH];
+
+    this->m_inputValue1Operation->readRow(inputValue1, x, y, width, COM_NUM_CHANNELS_VALUE);
+    this->m_inputValue2Operation->readRow(inputValue2, x, y, width, COM_NUM_CHANNELS_VALUE);
+
+    for (int i = 0; i < width; i++) {
+      output[i] = func(inputValue1[i], inputValue2[i]);
+    }
+
+    clampRowIfNeeded(output, width);
+  }
+
+  template<typename Func>
+  void executeRowTernary(float *output, int x, int y, int width, Func func)
+  {
+    float inputValue1[COM_ROW_WIDTH];
+    float inputValue2[COM_ROW_WIDTH];
+    float inputValue3[COM_ROW_WIDTH];
+
+    this->m_inputValue1Operation->readRow(inputValue1, x, y, width, COM_NUM_CHANNELS_VALUE);
+    this->m_inputValue2Operation->readRow(inputValue2, x, y, width, COM_NUM_CHANNELS_VALUE);
+    this->m_inputValue3Operation->readRow(inputValue3, x, y, width, COM_NUM_CHANNELS_VALUE);
+
+    for (int i = 0; i < width; i++) {
+      output[i] = func(inputValue1[i], inputValue2[i], inputValue3[i]);
+    }
+
+    clampRowIfNeeded(output, width);
+  }
 
  public:
   /**
@@ -76,6 +126,7 @@ class MathAddOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 class MathSubtractOperation : public MathBaseOperation {
  public:
@@ -83,6 +134,7 @@ class MathSubtractOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 class MathMultiplyOperation : public MathBaseOperation {
  public:
@@ -90,6 +142,7 @@ class MathMultiplyOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 class MathDivideOperation : public MathBaseOperation {
  public:
@@ -97,6 +150,7 @@ class MathDivideOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 class MathSineOperation : public MathBaseOperation {
  public:
@@ -169,6 +223,7 @@ class MathPowerOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 class MathLogarithmOperation : public MathBaseOperation {
  public:
@@ -183,6 +238,7 @@ class MathMinimumOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 class MathMaximumOperation : public MathBaseOperation {
  public:
@@ -190,6 +246,7 @@ class MathMaximumOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 class MathRoundOperation : public MathBaseOperation {
  public:
@@ -197,6 +254,7 @@ class MathRoundOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 class MathLessThanOperation : public MathBaseOperation {
  public:
@@ -204,6 +262,7 @@ class MathLessThanOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 class MathGreaterThanOperation : public MathBaseOperation {
  public:
@@ -211,6 +270,7 @@ class MathGreaterThanOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MathModuloOperation : public MathBaseOperation {
@@ -227,6 +287,7 @@ class MathAbsoluteOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MathRadiansOperation : public MathBaseOperation {
@@ -259,6 +320,7 @@ class MathFloorOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MathCeilOperation : public MathBaseOperation {
@@ -267,6 +329,7 @@ class MathCeilOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MathFractOperation : public MathBaseOperation {
@@ -275,6 +338,7 @@ class MathFractOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MathSqrtOperation : public MathBaseOperation {
@@ -283,6 +347,7 @@ class MathSqrtOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MathInverseSqrtOperation : public MathBaseOperation {
@@ -347,6 +412,7 @@ class MathCompareOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MathMultiplyAddOperation : public MathBaseOperation {
@@ -355,6 +421,7 @@ class MathMultiplyAddOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MathSmoothMinOperation : public MathBaseOperation {
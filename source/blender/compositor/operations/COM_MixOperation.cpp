@@ -126,6 +126,13 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   clampIfNeeded(output);
 }
 
+void MixAddOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) {
+    return c1 + value * c2;
+  });
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
@@ -160,6 +167,13 @@ void MixBlendOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) {
+    return (1.0f - value) * c1 + value * c2;
+  });
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixColorBurnOperation::MixColorBurnOperation() : MixBaseOperation()
@@ -321,6 +335,13 @@ void MixDarkenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDarkenOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) {
+    return min_ff(c1, c2) * value + c1 * (1.0f - value);
+  });
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDifferenceOperation::MixDifferenceOperation() : MixBaseOperation()
@@ -354,6 +375,17 @@ void MixDifferenceOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDifferenceOperation::executeRow(float *output,
+                                        int x,
+                                        int y,
+                                        int width,
+                                        int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) {
+    return (1.0f - value) * c1 + value * fabsf(c1 - c2);
+  });
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDivideOperation::MixDivideOperation() : MixBaseOperation()
@@ -404,6 +436,13 @@ void MixDivideOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDivideOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) {
+    return (c2 != 0.0f) ? (1.0f - value) * c1 + value * c1 / c2 : 0.0f;
+  });
+}
+
 /* ******** Mix Dodge Operation ******** */
 
 MixDodgeOperation::MixDodgeOperation() : MixBaseOperation()
@@ -626,6 +665,14 @@ void MixLightenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixLightenOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) {
+    float tmp = value * c2;
+    return (tmp > c1) ? tmp : c1;
+  });
+}
+
 /* ******** Mix Linear Light Operation ******** */
 
 MixLinearLightOperation::MixLinearLightOperation() : MixBaseOperation()
@@ -707,6 +754,13 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) {
+    return c1 * ((1.0f - value) + value * c2);
+  });
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -757,6 +811,17 @@ void MixOverlayOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixOverlayOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) -> float {
+    const float valuem = 1.0f - value;
+    if (c1 < 0.5f) {
+      return c1 * (valuem + 2.0f * value * c2);
+    }
+    return 1.0f - (valuem + 2.0f * value * (1.0f - c2)) * (1.0f - c1);
+  });
+}
+
 /* ******** Mix Saturation Operation ******** */
 
 MixSaturationOperation::MixSaturationOperation() : MixBaseOperation()
@@ -833,6 +898,13 @@ void MixScreenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixScreenOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) {
+    return 1.0f - ((1.0f - value) + value * (1.0f - c2)) * (1.0f - c1);
+  });
+}
+
 /* ******** Mix Soft Light Operation ******** */
 
 MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
@@ -879,6 +951,19 @@ void MixSoftLightOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixSoftLightOperation::executeRow(float *output,
+                                       int x,
+                                       int y,
+                                       int width,
+                                       int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) {
+    /* first calculate non-fac based Screen mix */
+    const float scr = 1.0f - (1.0f - c2) * (1.0f - c1);
+    return (1.0f - value) * c1 + value * (((1.0f - c1) * c2 * c1) + (c1 * scr));
+  });
+}
+
 /* ******** Mix Subtract Operation ******** */
 
 MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
@@ -911,6 +996,13 @@ void MixSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeRow(float *output, int x, int y, int width, int /*num_channels*/)
+{
+  executeRowPerChannel(output, x, y, width, [](float c1, float c2, float value) {
+    return c1 - value * c2;
+  });
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
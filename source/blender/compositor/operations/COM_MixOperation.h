@@ -43,6 +43,46 @@ class MixBaseOperation : public NodeOperation {
     }
   }
 
+  /**
+   * Helper for the row kernels of blend modes working on each color channel separately.
+   * \a func is called with the channel of both colors and the mix factor, alpha is taken from
+   * the first color.
+   */
+  template<typename Func>
+  void executeRowPerChannel(float *output, int x, int y, int width, Func func)
+  {
+    float inputValue[COM_ROW_WIDTH];
+    float inputColor1[COM_ROW_WIDTH * COM_NUM_CHANNELS_COLOR];
+    float inputColor2[COM_ROW_WIDTH * COM_NUM_CHANNELS_COLOR];
+
+    this->m_inputValueOperation->readRow(inputValue, x, y, width, COM_NUM_CHANNELS_VALUE);
+    this->m_inputColor1Operation->readRow(inputColor1, x, y, width, COM_NUM_CHANNELS_COLOR);
+    this->m_inputColor2Operation->readRow(inputColor2, x, y, width, COM_NUM_CHANNELS_COLOR);
+
+    if (this->useValueAlphaMultiply()) {
+      for (int i = 0; i < width; i++) {
+        inputValue[i] *= inputColor2[i * COM_NUM_CHANNELS_COLOR + 3];
+      }
+    }
+
+    for (int i = 0; i < width; i++) {
+      const float *color1 = &inputColor1[i * COM_NUM_CHANNELS_COLOR];
+      const float *color2 = &inputColor2[i * COM_NUM_CHANNELS_COLOR];
+      const float value = inputValue[i];
+      float *color = &output[i * COM_NUM_CHANNELS_COLOR];
+      color[0] = func(color1[0], color2[0], value);
+      color[1] = func(color1[1], color2[1], value);
+      color[2] = func(color1[2], color2[2], value);
+      color[3] = color1[3];
+    }
+
+    if (m_useClamp) {
+      for (int i = 0; i < width; i++) {
+        clamp_v4(&output[i * COM_NUM_CHANNELS_COLOR], 0.0f, 1.0f);
+      }
+    }
+  }
+
  public:
   /**
    * Default constructor
@@ -84,12 +124,14 @@ class MixAddOperation : public MixBaseOperation {
  public:
   MixAddOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
   MixBlendOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
@@ -108,18 +150,21 @@ class MixDarkenOperation : public MixBaseOperation {
  public:
   MixDarkenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
  public:
   MixDifferenceOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixDivideOperation : public MixBaseOperation {
  public:
   MixDivideOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixDodgeOperation : public MixBaseOperation {
@@ -144,6 +189,7 @@ class MixLightenOperation : public MixBaseOperation {
  public:
   MixLightenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
@@ -156,12 +202,14 @@ class MixMultiplyOperation : public MixBaseOperation {
  public:
   MixMultiplyOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
  public:
   MixOverlayOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixSaturationOperation : public MixBaseOperation {
@@ -174,18 +222,21 @@ class MixScreenOperation : public MixBaseOperation {
  public:
   MixScreenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
  public:
   MixSoftLightOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixSubtractOperation : public MixBaseOperation {
  public:
   MixSubtractOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels);
 };
 
 class MixValueOperation : public MixBaseOperation {
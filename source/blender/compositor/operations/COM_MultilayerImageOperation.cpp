@@ -46,6 +46,29 @@ ImBuf *MultilayerBaseOperation::getImBuf()
   return NULL;
 }
 
+void MultilayerBaseOperation::determineResolution(unsigned int resolution[2],
+                                                  unsigned int preferredResolution[2])
+{
+  /* Passes of multilayer files are read when first used, take the resolution from the render
+   * result so passes of unused outputs are not loaded before their operations are removed. */
+  if (this->m_image->rr) {
+    resolution[0] = 0;
+    resolution[1] = 0;
+
+    ImageUser iuser = *this->m_imageUser;
+    iuser.view = this->m_view;
+    iuser.pass = this->m_passId;
+
+    if (BKE_image_multilayer_index(this->m_image->rr, &iuser)) {
+      resolution[0] = this->m_image->rr->rectx;
+      resolution[1] = this->m_image->rr->recty;
+    }
+    return;
+  }
+
+  BaseImageOperation::determineResolution(resolution, preferredResolution);
+}
+
 void MultilayerColorOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
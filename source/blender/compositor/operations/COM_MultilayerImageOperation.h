@@ -39,6 +39,7 @@ class MultilayerBaseOperation : public BaseImageOperation {
   {
     this->m_renderlayer = renderlayer;
   }
+  void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 };
 
 class MultilayerColorOperation : public MultilayerBaseOperation {
@@ -74,6 +74,20 @@ void ReadBufferOperation::executePixelSampled(float output[4],
   }
 }
 
+void ReadBufferOperation::executeRow(float *output, int x, int y, int width, int num_channels)
+{
+  if (m_single_value) {
+    /* write buffer has a single value stored at (0,0) */
+    m_buffer->read(output, 0, 0);
+    for (int i = 1; i < width; i++) {
+      memcpy(&output[i * num_channels], output, sizeof(float) * num_channels);
+    }
+  }
+  else {
+    m_buffer->readRow(output, x, y, width);
+  }
+}
+
 void ReadBufferOperation::executePixelExtend(float output[4],
                                              float x,
                                              float y,
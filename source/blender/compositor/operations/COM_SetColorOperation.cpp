@@ -31,6 +31,19 @@ void SetColorOperation::executePixelSampled(float output[4],
   copy_v4_v4(output, this->m_color);
 }
 
+void SetColorOperation::executeRow(float *output,
+                                   int /*x*/,
+                                   int /*y*/,
+                                   int width,
+                                   int num_channels)
+{
+  BLI_assert(num_channels == COM_NUM_CHANNELS_COLOR);
+  UNUSED_VARS_NDEBUG(num_channels);
+  for (int i = 0; i < width; i++) {
+    copy_v4_v4(&output[i * COM_NUM_CHANNELS_COLOR], this->m_color);
+  }
+}
+
 void SetColorOperation::determineResolution(unsigned int resolution[2],
                                             unsigned int preferredResolution[2])
 {
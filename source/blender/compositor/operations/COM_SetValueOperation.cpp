@@ -31,6 +31,17 @@ void SetValueOperation::executePixelSampled(float output[4],
   output[0] = this->m_value;
 }
 
+void SetValueOperation::executeRow(float *output,
+                                   int /*x*/,
+                                   int /*y*/,
+                                   int width,
+                                   int num_channels)
+{
+  BLI_assert(num_channels == COM_NUM_CHANNELS_VALUE);
+  UNUSED_VARS_NDEBUG(num_channels);
+  copy_vn_fl(output, width, this->m_value);
+}
+
 void SetValueOperation::determineResolution(unsigned int resolution[2],
                                             unsigned int preferredResolution[2])
 {
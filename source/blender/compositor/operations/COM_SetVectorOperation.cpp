@@ -34,6 +34,21 @@ void SetVectorOperation::executePixelSampled(float output[4],
   output[2] = this->m_z;
 }
 
+void SetVectorOperation::executeRow(float *output,
+                                    int /*x*/,
+                                    int /*y*/,
+                                    int width,
+                                    int num_channels)
+{
+  BLI_assert(num_channels == COM_NUM_CHANNELS_VECTOR);
+  UNUSED_VARS_NDEBUG(num_channels);
+  for (int i = 0; i < width; i++, output += COM_NUM_CHANNELS_VECTOR) {
+    output[0] = this->m_x;
+    output[1] = this->m_y;
+    output[2] = this->m_z;
+  }
+}
+
 void SetVectorOperation::determineResolution(unsigned int resolution[2],
                                              unsigned int preferredResolution[2])
 {
@@ -18,8 +18,13 @@
 
 #include "COM_VariableSizeBokehBlurOperation.h"
 #include "BLI_math.h"
+#include "COM_FFTConvolution.h"
 #include "COM_OpenCLDevice.h"
 
+#include "MEM_guardedalloc.h"
+
+#include <vector>
+
 extern "C" {
 #include "RE_pipeline.h"
 }
@@ -46,6 +51,8 @@ VariableSizeBokehBlurOperation::VariableSizeBokehBlurOperation() : NodeOperation
 #ifdef COM_DEFOCUS_SEARCH
   this->m_inputSearchProgram = NULL;
 #endif
+  this->m_layered_result = NULL;
+  this->m_layered_done = false;
 }
 
 void VariableSizeBokehBlurOperation::initExecution()
@@ -57,6 +64,7 @@ void VariableSizeBokehBlurOperation::initExecution()
   this->m_inputSearchProgram = getInputSocketReader(3);
 #endif
   QualityStepHelper::initExecution(COM_QH_INCREASE);
+  initMutex();
 }
 struct VariableSizeBokehBlurTileData {
   MemoryBuffer *color;
@@ -81,9 +89,171 @@ void *VariableSizeBokehBlurOperation::initializeTileData(rcti *rect)
 
   data->maxBlurScalar = (int)(data->size->getMaximumValue(&rect2) * scalar);
   CLAMP(data->maxBlurScalar, 1.0f, this->m_maxBlur);
+
+  lockMutex();
+  if (!this->m_layered_done) {
+    /* decide for the whole image, mixing methods between tiles would show seams */
+    const int maxBlur = min_ii((int)(data->size->getMaximumValue() * scalar), this->m_maxBlur);
+    if (maxBlur >= COM_DEFOCUS_LAYERED_MIN_RADIUS) {
+      updateLayeredResult(data->color, data->bokeh, data->size, maxBlur);
+    }
+    this->m_layered_done = true;
+  }
+  unlockMutex();
+
   return data;
 }
 
+/* Weight of a pixel of the given size in a layer, pixels are split between the two layers with
+ * the radii closest to their size. */
+static float defocus_layer_weight(const std::vector<float> &radii, int layer, float size)
+{
+  const float radius = radii[layer];
+  if (size <= radius) {
+    if (layer == 0) {
+      return 1.0f;
+    }
+    const float prev = radii[layer - 1];
+    return (size > prev) ? (size - prev) / (radius - prev) : 0.0f;
+  }
+  if (layer == (int)radii.size() - 1) {
+    return 1.0f;
+  }
+  const float next = radii[layer + 1];
+  return (size < next) ? (next - size) / (next - radius) : 0.0f;
+}
+
+/* Approximate the defocus of the whole image by scattering: pixels are distributed over layers
+ * by their size, each layer is convolved with the bokeh at its radius in the frequency domain.
+ * The cost grows with the number of pixels and the logarithm of the maximum radius, instead of
+ * the square of the radius for every pixel. Unlike executePixel, blurred pixels also spread
+ * over pixels in focus in front of them, in focus pixels themselves stay sharp. */
+void VariableSizeBokehBlurOperation::updateLayeredResult(MemoryBuffer *color,
+                                                         MemoryBuffer *bokeh,
+                                                         MemoryBuffer *size,
+                                                         int maxBlur)
+{
+  const int width = color->getWidth();
+  const int height = color->getHeight();
+  const size_t num_pixels = (size_t)width * height;
+  const float max_dim = max(m_width, m_height);
+  const float scalar = this->m_do_size_scale ? (max_dim / 100.0f) : 1.0f;
+  const float *colorBuffer = color->getBuffer();
+  const float *sizeBuffer = size->getBuffer();
+
+  BLI_assert(size->getWidth() == width && size->getHeight() == height);
+
+  /* layer radii grow by a factor of sqrt(2) up to the maximum blur */
+  std::vector<float> radii;
+  for (float radius = max_ff(this->m_threshold, 1.0f); radius < maxBlur; radius *= M_SQRT2) {
+    radii.push_back(radius);
+  }
+  radii.push_back(maxBlur);
+
+  const size_t buffer_size = sizeof(float) * num_pixels * COM_NUM_CHANNELS_COLOR;
+  float *layer = (float *)MEM_mallocN(buffer_size, "defocus layer");
+  float *blurred = (float *)MEM_mallocN(buffer_size, "defocus blurred layer");
+  float *color_accum = (float *)MEM_callocN(buffer_size, "defocus color");
+  float *multiplier_accum = (float *)MEM_callocN(buffer_size, "defocus weights");
+
+  for (int index = 0; index < (int)radii.size(); index++) {
+    const float radius = radii[index];
+
+    /* color of the pixels in this layer, multiplied by their weight */
+    bool is_empty = true;
+    for (size_t i = 0; i < num_pixels; i++) {
+      const float pixel_size = min_ff(sizeBuffer[i] * scalar, maxBlur);
+      const float weight = (pixel_size > this->m_threshold) ?
+                               defocus_layer_weight(radii, index, pixel_size) :
+                               0.0f;
+      mul_v4_v4fl(&layer[i * COM_NUM_CHANNELS_COLOR],
+                  &colorBuffer[i * COM_NUM_CHANNELS_COLOR],
+                  weight);
+      is_empty &= (weight == 0.0f);
+    }
+    if (is_empty) {
+      continue;
+    }
+
+    /* kernel index i is the tap at offset (half_size - i), like the taps of executePixel */
+    const int half_size = max_ii((int)ceilf(radius) - 1, 0);
+    const int kernel_size = 2 * half_size + 1;
+    float *kernel = (float *)MEM_mallocN(
+        sizeof(float) * kernel_size * kernel_size * COM_NUM_CHANNELS_COLOR, "defocus kernel");
+    for (int ky = 0; ky < kernel_size; ky++) {
+      const float dy = half_size - ky;
+      for (int kx = 0; kx < kernel_size; kx++) {
+        const float dx = half_size - kx;
+        const float u = (float)(COM_BLUR_BOKEH_PIXELS / 2) +
+                        (dx / radius) * (float)((COM_BLUR_BOKEH_PIXELS / 2) - 1);
+        const float v = (float)(COM_BLUR_BOKEH_PIXELS / 2) +
+                        (dy / radius) * (float)((COM_BLUR_BOKEH_PIXELS / 2) - 1);
+        bokeh->read(&kernel[(ky * kernel_size + kx) * COM_NUM_CHANNELS_COLOR], u, v);
+      }
+    }
+
+    convolve_fft(blurred,
+                 layer,
+                 width,
+                 height,
+                 kernel,
+                 kernel_size,
+                 kernel_size,
+                 COM_NUM_CHANNELS_COLOR,
+                 COM_NUM_CHANNELS_COLOR);
+    add_vn_vn(color_accum, blurred, num_pixels * COM_NUM_CHANNELS_COLOR);
+
+    /* weights of the pixels, to normalize the result */
+    for (size_t i = 0; i < num_pixels; i++) {
+      const float pixel_size = min_ff(sizeBuffer[i] * scalar, maxBlur);
+      const float weight = (pixel_size > this->m_threshold) ?
+                               defocus_layer_weight(radii, index, pixel_size) :
+                               0.0f;
+      copy_v4_fl(&layer[i * COM_NUM_CHANNELS_COLOR], weight);
+    }
+    convolve_fft(blurred,
+                 layer,
+                 width,
+                 height,
+                 kernel,
+                 kernel_size,
+                 kernel_size,
+                 COM_NUM_CHANNELS_COLOR,
+                 COM_NUM_CHANNELS_COLOR);
+    add_vn_vn(multiplier_accum, blurred, num_pixels * COM_NUM_CHANNELS_COLOR);
+
+    MEM_freeN(kernel);
+  }
+
+  this->m_layered_result = layer;
+  for (size_t i = 0; i < num_pixels; i++) {
+    const float *readColor = &colorBuffer[i * COM_NUM_CHANNELS_COLOR];
+    float *output = &this->m_layered_result[i * COM_NUM_CHANNELS_COLOR];
+    const float size_center = sizeBuffer[i] * scalar;
+
+    copy_v4_v4(output, readColor);
+    if (size_center > this->m_threshold) {
+      for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+        const float multiplier = multiplier_accum[i * COM_NUM_CHANNELS_COLOR + c];
+        if (multiplier > 0.0f) {
+          output[c] = color_accum[i * COM_NUM_CHANNELS_COLOR + c] / multiplier;
+        }
+      }
+
+      /* blend in out values over the threshold, otherwise we get sharp, ugly transitions */
+      if (size_center < this->m_threshold * 2.0f) {
+        /* factor from 0-1 */
+        float fac = (size_center - this->m_threshold) / this->m_threshold;
+        interp_v4_v4v4(output, readColor, output, fac);
+      }
+    }
+  }
+
+  MEM_freeN(multiplier_accum);
+  MEM_freeN(color_accum);
+  MEM_freeN(blurred);
+}
+
 void VariableSizeBokehBlurOperation::deinitializeTileData(rcti * /*rect*/, void *data)
 {
   VariableSizeBokehBlurTileData *result = (VariableSizeBokehBlurTileData *)data;
@@ -92,6 +262,16 @@ void VariableSizeBokehBlurOperation::deinitializeTileData(rcti * /*rect*/, void
 
 void VariableSizeBokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
+  if (this->m_layered_result) {
+    if (x >= 0 && y >= 0 && x < (int)m_width && y < (int)m_height) {
+      copy_v4_v4(output, &this->m_layered_result[(y * m_width + x) * COM_NUM_CHANNELS_COLOR]);
+    }
+    else {
+      zero_v4(output);
+    }
+    return;
+  }
+
   VariableSizeBokehBlurTileData *tileData = (VariableSizeBokehBlurTileData *)data;
   MemoryBuffer *inputProgramBuffer = tileData->color;
   MemoryBuffer *inputBokehBuffer = tileData->bokeh;
@@ -223,6 +403,12 @@ void VariableSizeBokehBlurOperation::executeOpenCL(OpenCLDevice *device,
 
 void VariableSizeBokehBlurOperation::deinitExecution()
 {
+  deinitMutex();
+  if (this->m_layered_result) {
+    MEM_freeN(this->m_layered_result);
+    this->m_layered_result = NULL;
+  }
+  this->m_layered_done = false;
   this->m_inputProgram = NULL;
   this->m_inputBokehProgram = NULL;
   this->m_inputSizeProgram = NULL;
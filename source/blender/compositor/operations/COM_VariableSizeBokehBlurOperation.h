@@ -34,6 +34,14 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
 #ifdef COM_DEFOCUS_SEARCH
   SocketReader *m_inputSearchProgram;
 #endif
+  /* whole image result of large blurs, approximated by blurring layers of similar size */
+  float *m_layered_result;
+  bool m_layered_done;
+
+  void updateLayeredResult(MemoryBuffer *color,
+                           MemoryBuffer *bokeh,
+                           MemoryBuffer *size,
+                           int maxBlur);
 
  public:
   VariableSizeBokehBlurOperation();
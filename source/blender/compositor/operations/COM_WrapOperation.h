@@ -31,6 +31,11 @@ class WrapOperation : public ReadBufferOperation {
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeRow(float *output, int x, int y, int width, int num_channels)
+  {
+    /* Wrapped coordinates are not contiguous in the buffer, read pixel by pixel. */
+    NodeOperation::executeRow(output, x, y, width, num_channels);
+  }
 
   void setWrapping(int wrapping_type);
   float getWrappedOriginalXPos(float x);
@@ -59,6 +59,11 @@ void WriteBufferOperation::deinitExecution()
 void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
 {
   MemoryBuffer *memoryBuffer = this->m_memoryProxy->getBuffer();
+  if (memoryBuffer->isHalfFloat()) {
+    executeRegionHalfFloat(memoryBuffer, rect);
+    memoryBuffer->setCreatedState();
+    return;
+  }
   float *buffer = memoryBuffer->getBuffer();
   const int num_channels = memoryBuffer->get_num_channels();
   if (this->m_input->isComplex()) {
@@ -96,9 +101,10 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
     bool breaked = false;
     for (y = y1; y < y2 && (!breaked); y++) {
       int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
-      for (x = x1; x < x2; x++) {
-        this->m_input->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-        offset4 += num_channels;
+      for (x = x1; x < x2; x += COM_ROW_WIDTH) {
+        const int width = min_ii(x2 - x, COM_ROW_WIDTH);
+        this->m_input->readRow(&(buffer[offset4]), x, y, width, num_channels);
+        offset4 += width * num_channels;
       }
       if (isBraked()) {
         breaked = true;
@@ -108,6 +114,38 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
   memoryBuffer->setCreatedState();
 }
 
+/* Half float buffers are filled one row segment at a time, converting from a float row. */
+void WriteBufferOperation::executeRegionHalfFloat(MemoryBuffer *memoryBuffer, rcti *rect)
+{
+  float row[COM_ROW_WIDTH * COM_NUM_CHANNELS_COLOR];
+  const int num_channels = memoryBuffer->get_num_channels();
+  BLI_assert(num_channels <= COM_NUM_CHANNELS_COLOR);
+  void *data = NULL;
+  if (this->m_input->isComplex()) {
+    data = this->m_input->initializeTileData(rect);
+  }
+  for (int y = rect->ymin; y < rect->ymax; y++) {
+    for (int x = rect->xmin; x < rect->xmax; x += COM_ROW_WIDTH) {
+      const int width = min_ii(rect->xmax - x, COM_ROW_WIDTH);
+      if (this->m_input->isComplex()) {
+        for (int i = 0; i < width; i++) {
+          this->m_input->read(&row[i * num_channels], x + i, y, data);
+        }
+      }
+      else {
+        this->m_input->readRow(row, x, y, width, num_channels);
+      }
+      memoryBuffer->writeRow(row, x, y, width);
+    }
+    if (isBraked()) {
+      break;
+    }
+  }
+  if (data) {
+    this->m_input->deinitializeTileData(rect, data);
+  }
+}
+
 void WriteBufferOperation::executeOpenCLRegion(OpenCLDevice *device,
                                                rcti * /*rect*/,
                                                unsigned int /*chunkNumber*/,
@@ -22,6 +22,9 @@
 #include "COM_MemoryProxy.h"
 #include "COM_NodeOperation.h"
 #include "COM_SocketReader.h"
+
+#include <string>
+
 /**
  * \brief NodeOperation to write to a tile
  * \ingroup Operation
@@ -30,6 +33,8 @@ class WriteBufferOperation : public NodeOperation {
   MemoryProxy *m_memoryProxy;
   bool m_single_value; /* single value stored in buffer */
   NodeOperation *m_input;
+  /* key to store the result in the BufferCache after execution, empty when not cached */
+  std::string m_cache_key;
 
  public:
   WriteBufferOperation(DataType datatype);
@@ -62,5 +67,16 @@ class WriteBufferOperation : public NodeOperation {
   {
     return m_input;
   }
+  void setCacheKey(const std::string &key)
+  {
+    this->m_cache_key = key;
+  }
+  const std::string &getCacheKey() const
+  {
+    return this->m_cache_key;
+  }
+
+ private:
+  void executeRegionHalfFloat(MemoryBuffer *memoryBuffer, rcti *rect);
 };
 #endif
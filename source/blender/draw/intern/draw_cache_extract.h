@@ -247,9 +247,23 @@ typedef struct MeshBatchCache {
   float tot_area, tot_uv_area;
 
   bool no_loose_wire;
+
+  /** Number of extraction jobs still writing to the buffers of this cache,
+   * see #MeshExtractScheduler. */
+  int32_t extract_job_len;
 } MeshBatchCache;
 
-void mesh_buffer_cache_create_requested(MeshBatchCache *cache,
+typedef struct MeshExtractScheduler MeshExtractScheduler;
+
+MeshExtractScheduler *mesh_extract_scheduler_create(void);
+void mesh_extract_scheduler_wait(MeshExtractScheduler *scheduler);
+void mesh_extract_scheduler_free(MeshExtractScheduler *scheduler);
+
+/* Implemented in `draw_manager.c`, NULL when buffers must be extracted immediately. */
+MeshExtractScheduler *DRW_mesh_extract_scheduler_get(void);
+
+void mesh_buffer_cache_create_requested(MeshExtractScheduler *scheduler,
+                                        MeshBatchCache *cache,
                                         MeshBufferCache mbc,
                                         Mesh *me,
                                         const bool is_editmode,
@@ -105,6 +105,12 @@ typedef struct MeshRenderData {
   BMEditMesh *edit_bmesh;
   BMesh *bm;
   EditMeshData *edit_data;
+
+  /* For deformed edit-mesh data. */
+  /* Use for #ME_WRAPPER_TYPE_BMESH. */
+  const float (*bm_vert_coords)[3];
+  const float (*bm_vert_normals)[3];
+  const float (*bm_poly_normals)[3];
   int *v_origindex, *e_origindex, *p_origindex;
   int crease_ofs;
   int bweight_ofs;
@@ -127,6 +133,35 @@ typedef struct MeshRenderData {
   int *lverts, *ledges;
 } MeshRenderData;
 
+/* Deformed coordinates and normals of edit-mesh wrappers, or the BMesh ones otherwise. */
+
+BLI_INLINE const float *bm_vert_co_get(const MeshRenderData *mr, const BMVert *eve)
+{
+  const float(*vert_coords)[3] = mr->bm_vert_coords;
+  if (vert_coords != NULL) {
+    return vert_coords[BM_elem_index_get(eve)];
+  }
+  return eve->co;
+}
+
+BLI_INLINE const float *bm_vert_no_get(const MeshRenderData *mr, const BMVert *eve)
+{
+  const float(*vert_normals)[3] = mr->bm_vert_normals;
+  if (vert_normals != NULL) {
+    return vert_normals[BM_elem_index_get(eve)];
+  }
+  return eve->no;
+}
+
+BLI_INLINE const float *bm_face_no_get(const MeshRenderData *mr, const BMFace *efa)
+{
+  const float(*poly_normals)[3] = mr->bm_poly_normals;
+  if (poly_normals != NULL) {
+    return poly_normals[BM_elem_index_get(efa)];
+  }
+  return efa->no;
+}
+
 static MeshRenderData *mesh_render_data_create(Mesh *me,
                                                const bool is_editmode,
                                                const bool is_paint_mode,
@@ -151,13 +186,26 @@ static MeshRenderData *mesh_render_data_create(Mesh *me,
     BLI_assert(me->edit_mesh->mesh_eval_cage && me->edit_mesh->mesh_eval_final);
     mr->bm = me->edit_mesh->bm;
     mr->edit_bmesh = me->edit_mesh;
-    mr->edit_data = me->runtime.edit_data;
     mr->me = (do_final) ? me->edit_mesh->mesh_eval_final : me->edit_mesh->mesh_eval_cage;
-    bool use_mapped = !do_uvedit && mr->me && !mr->me->runtime.is_original;
+    mr->edit_data = mr->me ? mr->me->runtime.edit_data : NULL;
 
     int bm_ensure_types = BM_VERT | BM_EDGE | BM_LOOP | BM_FACE;
 
     BM_mesh_elem_index_ensure(mr->bm, bm_ensure_types);
+
+    /* Edit-mesh wrappers are drawn from the BMesh, using their deformed coordinates. */
+    if (mr->edit_data && mr->edit_data->vertexCos) {
+      EditMeshData *emd = mr->edit_data;
+      BKE_editmesh_cache_ensure_vert_normals(mr->edit_bmesh, emd);
+      BKE_editmesh_cache_ensure_poly_normals(mr->edit_bmesh, emd);
+
+      mr->bm_vert_coords = emd->vertexCos;
+      mr->bm_vert_normals = emd->vertexNos;
+      mr->bm_poly_normals = emd->polyNos;
+    }
+
+    const bool has_mdata = mr->me && (mr->me->runtime.wrapper_type == ME_WRAPPER_TYPE_MDATA);
+    bool use_mapped = has_mdata && !do_uvedit && !mr->me->runtime.is_original;
     BM_mesh_elem_table_ensure(mr->bm, bm_ensure_types & ~BM_LOOP);
 
     mr->efa_act_uv = EDBM_uv_active_face_get(mr->edit_bmesh, false, false);
@@ -184,7 +232,8 @@ static MeshRenderData *mesh_render_data_create(Mesh *me,
 
     /* Seems like the mesh_eval_final do not have the right origin indices.
      * Force not mapped in this case. */
-    if (do_final && me->edit_mesh->mesh_eval_final != me->edit_mesh->mesh_eval_cage) {
+    if (has_mdata && do_final &&
+        me->edit_mesh->mesh_eval_final != me->edit_mesh->mesh_eval_cage) {
       // mr->edit_bmesh = NULL;
       mr->extract_type = MR_EXTRACT_MESH;
     }
@@ -314,9 +363,9 @@ static MeshRenderData *mesh_render_data_create(Mesh *me,
       mr->loop_normals = MEM_mallocN(sizeof(*mr->loop_normals) * mr->loop_len, __func__);
       int clnors_offset = CustomData_get_offset(&mr->bm->ldata, CD_CUSTOMLOOPNORMAL);
       BM_loops_calc_normal_vcos(mr->bm,
-                                NULL,
-                                NULL,
-                                NULL,
+                                mr->bm_vert_coords,
+                                mr->bm_vert_normals,
+                                mr->bm_poly_normals,
                                 is_auto_smooth,
                                 split_angle,
                                 mr->loop_normals,
@@ -1480,7 +1529,7 @@ static void *extract_pos_nor_init(const MeshRenderData *mr, void *buf)
     BMVert *eve;
     int v;
     BM_ITER_MESH_INDEX (eve, &iter, mr->bm, BM_VERTS_OF_MESH, v) {
-      data->packed_nor[v] = GPU_normal_convert_i10_v3(eve->no);
+      data->packed_nor[v] = GPU_normal_convert_i10_v3(bm_vert_no_get(mr, eve));
     }
   }
   else {
@@ -1492,14 +1541,14 @@ static void *extract_pos_nor_init(const MeshRenderData *mr, void *buf)
   return data;
 }
 
-static void extract_pos_nor_loop_bmesh(const MeshRenderData *UNUSED(mr),
+static void extract_pos_nor_loop_bmesh(const MeshRenderData *mr,
                                        int l,
                                        BMLoop *loop,
                                        void *_data)
 {
   MeshExtract_PosNor_Data *data = _data;
   PosNorLoop *vert = data->vbo_data + l;
-  copy_v3_v3(vert->pos, loop->v->co);
+  copy_v3_v3(vert->pos, bm_vert_co_get(mr, loop->v));
   vert->nor = data->packed_nor[BM_elem_index_get(loop->v)];
   BMFace *efa = loop->f;
   vert->nor.w = BM_elem_flag_test(efa, BM_ELEM_HIDDEN) ? -1 : 0;
@@ -1536,8 +1585,8 @@ static void extract_pos_nor_ledge_bmesh(const MeshRenderData *mr, int e, BMEdge
   int l = mr->loop_len + e * 2;
   MeshExtract_PosNor_Data *data = _data;
   PosNorLoop *vert = data->vbo_data + l;
-  copy_v3_v3(vert[0].pos, eed->v1->co);
-  copy_v3_v3(vert[1].pos, eed->v2->co);
+  copy_v3_v3(vert[0].pos, bm_vert_co_get(mr, eed->v1));
+  copy_v3_v3(vert[1].pos, bm_vert_co_get(mr, eed->v2));
   vert[0].nor = data->packed_nor[BM_elem_index_get(eed->v1)];
   vert[1].nor = data->packed_nor[BM_elem_index_get(eed->v2)];
 }
@@ -1561,7 +1610,7 @@ static void extract_pos_nor_lvert_bmesh(const MeshRenderData *mr, int v, BMVert
   int l = mr->loop_len + mr->edge_loose_len * 2 + v;
   MeshExtract_PosNor_Data *data = _data;
   PosNorLoop *vert = data->vbo_data + l;
-  copy_v3_v3(vert->pos, eve->co);
+  copy_v3_v3(vert->pos, bm_vert_co_get(mr, eve));
   vert->nor = data->packed_nor[BM_elem_index_get(eve)];
 }
 
@@ -1627,10 +1676,10 @@ static void extract_lnor_hq_loop_bmesh(const MeshRenderData *mr, int l, BMLoop *
     normal_float_to_short_v3(&((gpuHQNor *)data)[l].x, mr->loop_normals[l]);
   }
   else if (BM_elem_flag_test(loop->f, BM_ELEM_SMOOTH)) {
-    normal_float_to_short_v3(&((gpuHQNor *)data)[l].x, loop->v->no);
+    normal_float_to_short_v3(&((gpuHQNor *)data)[l].x, bm_vert_no_get(mr, loop->v));
   }
   else {
-    normal_float_to_short_v3(&((gpuHQNor *)data)[l].x, loop->f->no);
+    normal_float_to_short_v3(&((gpuHQNor *)data)[l].x, bm_face_no_get(mr, loop->f));
   }
 }
 
@@ -1704,10 +1753,10 @@ static void extract_lnor_loop_bmesh(const MeshRenderData *mr, int l, BMLoop *loo
     ((GPUPackedNormal *)data)[l] = GPU_normal_convert_i10_v3(mr->loop_normals[l]);
   }
   else if (BM_elem_flag_test(loop->f, BM_ELEM_SMOOTH)) {
-    ((GPUPackedNormal *)data)[l] = GPU_normal_convert_i10_v3(loop->v->no);
+    ((GPUPackedNormal *)data)[l] = GPU_normal_convert_i10_v3(bm_vert_no_get(mr, loop->v));
   }
   else {
-    ((GPUPackedNormal *)data)[l] = GPU_normal_convert_i10_v3(loop->f->no);
+    ((GPUPackedNormal *)data)[l] = GPU_normal_convert_i10_v3(bm_face_no_get(mr, loop->f));
   }
   BMFace *efa = loop->f;
   ((GPUPackedNormal *)data)[l].w = BM_elem_flag_test(efa, BM_ELEM_HIDDEN) ? -1 : 0;
@@ -2092,7 +2141,7 @@ static void *extract_vcol_init(const MeshRenderData *mr, void *buf)
   GPUVertFormat format = {0};
   GPU_vertformat_deinterleave(&format);
 
-  CustomData *cd_ldata = &mr->me->ldata;
+  CustomData *cd_ldata = (mr->extract_type == MR_EXTRACT_BMESH) ? &mr->bm->ldata : &mr->me->ldata;
   uint32_t vcol_layers = mr->cache->cd_used.vcol;
 
   for (int i = 0; i < 8; i++) {
@@ -2129,12 +2178,31 @@ static void *extract_vcol_init(const MeshRenderData *mr, void *buf)
   gpuMeshVcol *vcol_data = (gpuMeshVcol *)vbo->data;
   for (int i = 0; i < 8; i++) {
     if (vcol_layers & (1 << i)) {
-      MLoopCol *mcol = (MLoopCol *)CustomData_get_layer_n(cd_ldata, CD_MLOOPCOL, i);
-      for (int l = 0; l < mr->loop_len; l++, mcol++, vcol_data++) {
-        vcol_data->r = unit_float_to_ushort_clamp(BLI_color_from_srgb_table[mcol->r]);
-        vcol_data->g = unit_float_to_ushort_clamp(BLI_color_from_srgb_table[mcol->g]);
-        vcol_data->b = unit_float_to_ushort_clamp(BLI_color_from_srgb_table[mcol->b]);
-        vcol_data->a = unit_float_to_ushort_clamp(mcol->a * (1.0f / 255.0f));
+      if (mr->extract_type == MR_EXTRACT_BMESH) {
+        const int cd_ofs = CustomData_get_n_offset(cd_ldata, CD_MLOOPCOL, i);
+        BMIter f_iter, l_iter;
+        BMFace *efa;
+        BMLoop *loop;
+        BM_ITER_MESH (efa, &f_iter, mr->bm, BM_FACES_OF_MESH) {
+          BM_ITER_ELEM (loop, &l_iter, efa, BM_LOOPS_OF_FACE) {
+            const MLoopCol *mcol = BM_ELEM_CD_GET_VOID_P(loop, cd_ofs);
+            vcol_data->r = unit_float_to_ushort_clamp(BLI_color_from_srgb_table[mcol->r]);
+            vcol_data->g = unit_float_to_ushort_clamp(BLI_color_from_srgb_table[mcol->g]);
+            vcol_data->b = unit_float_to_ushort_clamp(BLI_color_from_srgb_table[mcol->b]);
+            vcol_data->a = unit_float_to_ushort_clamp(mcol->a * (1.0f / 255.0f));
+            vcol_data++;
+          }
+        }
+      }
+      else {
+        const MLoopCol *mcol = (const MLoopCol *)CustomData_get_layer_n(
+            cd_ldata, CD_MLOOPCOL, i);
+        for (int l = 0; l < mr->loop_len; l++, mcol++, vcol_data++) {
+          vcol_data->r = unit_float_to_ushort_clamp(BLI_color_from_srgb_table[mcol->r]);
+          vcol_data->g = unit_float_to_ushort_clamp(BLI_color_from_srgb_table[mcol->g]);
+          vcol_data->b = unit_float_to_ushort_clamp(BLI_color_from_srgb_table[mcol->b]);
+          vcol_data->a = unit_float_to_ushort_clamp(mcol->a * (1.0f / 255.0f));
+        }
       }
     }
   }
@@ -2301,14 +2369,17 @@ static void *extract_edge_fac_init(const MeshRenderData *mr, void *buf)
   return data;
 }
 
-static void extract_edge_fac_loop_bmesh(const MeshRenderData *UNUSED(mr),
+static void extract_edge_fac_loop_bmesh(const MeshRenderData *mr,
                                         int l,
                                         BMLoop *loop,
                                         void *_data)
 {
   MeshExtract_EdgeFac_Data *data = (MeshExtract_EdgeFac_Data *)_data;
   if (BM_edge_is_manifold(loop->e)) {
-    float ratio = loop_edge_factor_get(loop->f->no, loop->v->co, loop->v->no, loop->next->v->co);
+    float ratio = loop_edge_factor_get(bm_face_no_get(mr, loop->f),
+                                       bm_vert_co_get(mr, loop->v),
+                                       bm_vert_no_get(mr, loop->v),
+                                       bm_vert_co_get(mr, loop->next->v));
     data->vbo_data[l] = ratio * 253 + 1;
   }
   else {
@@ -3133,7 +3204,7 @@ static void *extract_stretch_angle_init(const MeshRenderData *mr, void *buf)
   return data;
 }
 
-static void extract_stretch_angle_loop_bmesh(const MeshRenderData *UNUSED(mr),
+static void extract_stretch_angle_loop_bmesh(const MeshRenderData *mr,
                                              int l,
                                              BMLoop *loop,
                                              void *_data)
@@ -3150,8 +3221,12 @@ static void extract_stretch_angle_loop_bmesh(const MeshRenderData *UNUSED(mr),
     BMLoop *l_next_tmp = loop;
     luv = BM_ELEM_CD_GET_VOID_P(l_tmp, data->cd_ofs);
     luv_next = BM_ELEM_CD_GET_VOID_P(l_next_tmp, data->cd_ofs);
-    compute_normalize_edge_vectors(
-        auv, av, luv->uv, luv_next->uv, l_tmp->v->co, l_next_tmp->v->co);
+    compute_normalize_edge_vectors(auv,
+                                   av,
+                                   luv->uv,
+                                   luv_next->uv,
+                                   bm_vert_co_get(mr, l_tmp->v),
+                                   bm_vert_co_get(mr, l_next_tmp->v));
     /* Save last edge. */
     copy_v2_v2(last_auv, auv[1]);
     copy_v3_v3(last_av, av[1]);
@@ -3167,7 +3242,12 @@ static void extract_stretch_angle_loop_bmesh(const MeshRenderData *UNUSED(mr),
   else {
     luv = BM_ELEM_CD_GET_VOID_P(loop, data->cd_ofs);
     luv_next = BM_ELEM_CD_GET_VOID_P(l_next, data->cd_ofs);
-    compute_normalize_edge_vectors(auv, av, luv->uv, luv_next->uv, loop->v->co, l_next->v->co);
+    compute_normalize_edge_vectors(auv,
+                                   av,
+                                   luv->uv,
+                                   luv_next->uv,
+                                   bm_vert_co_get(mr, loop->v),
+                                   bm_vert_co_get(mr, l_next->v));
   }
   edituv_get_stretch_angle(auv, av, data->vbo_data + l);
 }
@@ -3307,7 +3387,7 @@ static void statvis_calc_overhang(const MeshRenderData *mr, float *r_overhang)
   if (mr->extract_type == MR_EXTRACT_BMESH) {
     int l = 0;
     BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-      float fac = angle_normalized_v3v3(f->no, dir) / (float)M_PI;
+      float fac = angle_normalized_v3v3(bm_face_no_get(mr, f), dir) / (float)M_PI;
       fac = overhang_remap(fac, min, max, minmax_irange);
       for (int i = 0; i < f->len; i++, l++) {
         r_overhang[l] = fac;
@@ -3380,12 +3460,16 @@ static void statvis_calc_thickness(const MeshRenderData *mr, float *r_thickness)
     BMesh *bm = em->bm;
     BM_mesh_elem_index_ensure(bm, BM_FACE);
 
-    struct BMBVHTree *bmtree = BKE_bmbvh_new_from_editmesh(em, 0, NULL, false);
+    struct BMBVHTree *bmtree = BKE_bmbvh_new_from_editmesh(em, 0, mr->bm_vert_coords, false);
     struct BMLoop *(*looptris)[3] = em->looptris;
     for (int i = 0; i < mr->tri_len; i++) {
       BMLoop **ltri = looptris[i];
       const int index = BM_elem_index_get(ltri[0]->f);
-      const float *cos[3] = {ltri[0]->v->co, ltri[1]->v->co, ltri[2]->v->co};
+      const float *cos[3] = {
+          bm_vert_co_get(mr, ltri[0]->v),
+          bm_vert_co_get(mr, ltri[1]->v),
+          bm_vert_co_get(mr, ltri[2]->v),
+      };
       float ray_co[3];
       float ray_no[3];
 
@@ -3398,7 +3482,8 @@ static void statvis_calc_thickness(const MeshRenderData *mr, float *r_thickness)
 
         BMFace *f_hit = BKE_bmbvh_ray_cast(bmtree, ray_co, ray_no, 0.0f, &dist, NULL, NULL);
         if (f_hit && dist < face_dists[index]) {
-          float angle_fac = fabsf(dot_v3v3(ltri[0]->f->no, f_hit->no));
+          float angle_fac = fabsf(
+              dot_v3v3(bm_face_no_get(mr, ltri[0]->f), bm_face_no_get(mr, f_hit)));
           angle_fac = 1.0f - angle_fac;
           angle_fac = angle_fac * angle_fac * angle_fac;
           angle_fac = 1.0f - angle_fac;
@@ -3525,7 +3610,7 @@ static void statvis_calc_intersect(const MeshRenderData *mr, float *r_intersect)
 
     BM_mesh_elem_index_ensure(bm, BM_FACE);
 
-    struct BMBVHTree *bmtree = BKE_bmbvh_new_from_editmesh(em, 0, NULL, false);
+    struct BMBVHTree *bmtree = BKE_bmbvh_new_from_editmesh(em, 0, mr->bm_vert_coords, false);
     BVHTreeOverlap *overlap = BKE_bmbvh_overlap(bmtree, bmtree, &overlap_len);
 
     if (overlap) {
@@ -3611,15 +3696,24 @@ static void statvis_calc_distort(const MeshRenderData *mr, float *r_distort)
         BMLoop *l_iter, *l_first;
 
         fac = 0.0f;
+        const float *f_no = bm_face_no_get(mr, f);
         l_iter = l_first = BM_FACE_FIRST_LOOP(f);
         do {
           float no_corner[3];
-          BM_loop_calc_face_normal_safe(l_iter, no_corner);
+          if (mr->bm_vert_coords) {
+            normal_tri_v3(no_corner,
+                          bm_vert_co_get(mr, l_iter->prev->v),
+                          bm_vert_co_get(mr, l_iter->v),
+                          bm_vert_co_get(mr, l_iter->next->v));
+          }
+          else {
+            BM_loop_calc_face_normal_safe(l_iter, no_corner);
+          }
           /* simple way to detect (what is most likely) concave */
-          if (dot_v3v3(f->no, no_corner) < 0.0f) {
+          if (dot_v3v3(f_no, no_corner) < 0.0f) {
             negate_v3(no_corner);
           }
-          fac = max_ff(fac, angle_normalized_v3v3(f->no, no_corner));
+          fac = max_ff(fac, angle_normalized_v3v3(f_no, no_corner));
         } while ((l_iter = l_iter->next) != l_first);
         fac *= 2.0f;
       }
@@ -3694,12 +3788,29 @@ static void statvis_calc_sharp(const MeshRenderData *mr, float *r_sharp)
   if (mr->extract_type == MR_EXTRACT_BMESH) {
     BMIter iter, l_iter;
     BMesh *bm = em->bm;
-    BMFace *efa;
+    BMFace *efa, *f_a, *f_b;
     BMEdge *e;
     BMLoop *loop;
     /* first assign float values to verts */
     BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-      float angle = BM_edge_calc_face_angle_signed(e);
+      float angle;
+      if (mr->bm_vert_coords == NULL) {
+        angle = BM_edge_calc_face_angle_signed(e);
+      }
+      else if (BM_edge_face_pair(e, &f_a, &f_b)) {
+        /* Same as the mesh data case below. */
+        const float *f1_no = bm_face_no_get(mr, f_a);
+        const float *f2_no = bm_face_no_get(mr, f_b);
+        angle = angle_normalized_v3v3(f1_no, f2_no);
+        angle = is_edge_convex_v3(
+                    bm_vert_co_get(mr, e->v1), bm_vert_co_get(mr, e->v2), f1_no, f2_no) ?
+                    angle :
+                    -angle;
+      }
+      else {
+        /* non-manifold edge */
+        angle = DEG2RADF(90.0f);
+      }
       float *col1 = &vert_angles[BM_elem_index_get(e->v1)];
       float *col2 = &vert_angles[BM_elem_index_get(e->v2)];
       *col1 = max_ff(*col1, angle);
@@ -3842,14 +3953,14 @@ static void *extract_fdots_pos_init(const MeshRenderData *mr, void *buf)
   return vbo->data;
 }
 
-static void extract_fdots_pos_loop_bmesh(const MeshRenderData *UNUSED(mr),
+static void extract_fdots_pos_loop_bmesh(const MeshRenderData *mr,
                                          int UNUSED(l),
                                          BMLoop *loop,
                                          void *data)
 {
   float(*center)[3] = (float(*)[3])data;
   float w = 1.0f / (float)loop->f->len;
-  madd_v3_v3fl(center[BM_elem_index_get(loop->f)], loop->v->co, w);
+  madd_v3_v3fl(center[BM_elem_index_get(loop->f)], bm_vert_co_get(mr, loop->v), w);
 }
 
 static void extract_fdots_pos_loop_mesh(const MeshRenderData *mr,
@@ -3928,7 +4039,7 @@ static void extract_fdots_nor_finish(const MeshRenderData *mr, void *buf, void *
         nor[f].w = NOR_AND_FLAG_HIDDEN;
       }
       else {
-        nor[f] = GPU_normal_convert_i10_v3(efa->no);
+        nor[f] = GPU_normal_convert_i10_v3(bm_face_no_get(mr, efa));
         /* Select / Active Flag. */
         nor[f].w = (BM_elem_flag_test(efa, BM_ELEM_SELECT) ?
                         ((efa == mr->efa_act) ? NOR_AND_FLAG_ACTIVE : NOR_AND_FLAG_SELECT) :
@@ -4171,7 +4282,7 @@ static void *extract_skin_roots_init(const MeshRenderData *mr, void *buf)
     const MVertSkin *vs = BM_ELEM_CD_GET_VOID_P(eve, cd_ofs);
     if (vs->flag & MVERT_SKIN_ROOT) {
       vbo_data->size = (vs->radius[0] + vs->radius[1]) * 0.5f;
-      copy_v3_v3(vbo_data->local_pos, eve->co);
+      copy_v3_v3(vbo_data->local_pos, bm_vert_co_get(mr, eve));
       vbo_data++;
       root_len++;
     }
@@ -4422,7 +4533,11 @@ static const MeshExtract extract_fdot_idx = {
 /** \name Extract Loop
  * \{ */
 
+struct MeshExtractJob;
+
 typedef struct ExtractTaskData {
+  /** Next task of the same job, only used by serial jobs (see #MeshExtractJob.serial_tasks). */
+  struct ExtractTaskData *next;
   const MeshRenderData *mr;
   const MeshExtract *extract;
   eMRIterType iter_type;
@@ -4431,8 +4546,48 @@ typedef struct ExtractTaskData {
   int32_t *task_counter;
   void *buf;
   void *user_data;
+  /** Owning job when extracted through a #MeshExtractScheduler, NULL otherwise. */
+  struct MeshExtractJob *job;
 } ExtractTaskData;
 
+/**
+ * Extraction of all requested buffers of one #MeshBufferCache,
+ * scheduled with the other meshes of the redraw (see #MeshExtractScheduler).
+ */
+typedef struct MeshExtractJob {
+  /** Next job in #MeshExtractScheduler.batch. */
+  struct MeshExtractJob *next;
+  MeshBatchCache *cache;
+  MeshBufferCache mbc;
+  MeshRenderData *mr;
+  const Scene *scene;
+  int32_t *task_counters;
+  /** Tasks which did not finish yet, the job is freed when it reaches zero. */
+  int32_t tasks_left;
+  /** Tasks of small meshes, executed one after another in a single batch task. */
+  ExtractTaskData *serial_tasks;
+} MeshExtractJob;
+
+/**
+ * Collects the extraction of all meshes of a redraw into a single task pool.
+ *
+ * Extraction runs while the draw manager keeps populating the caches of the other objects,
+ * it is only waited for before the engines finish their caches. Meshes that are too small
+ * to be threaded on their own are batched together, to avoid the per task overhead of
+ * scenes with many small unique meshes.
+ */
+struct MeshExtractScheduler {
+  TaskPool *task_pool;
+  /** Small jobs waiting to be pushed as a single task. */
+  MeshExtractJob *batch;
+  int batch_loop_len;
+};
+
+/* Number of loops below which a mesh is extracted without splitting its buffers into tasks. */
+#define MESH_EXTRACT_THREAD_LOOP_LEN 8192
+/* Number of loops gathered from small meshes before their extraction is pushed as one task. */
+#define MESH_EXTRACT_BATCH_LOOP_LEN 8192
+
 BLI_INLINE void mesh_extract_iter(const MeshRenderData *mr,
                                   const eMRIterType iter_type,
                                   int start,
@@ -4509,6 +4664,8 @@ BLI_INLINE void mesh_extract_iter(const MeshRenderData *mr,
   }
 }
 
+static void mesh_extract_job_task_done(MeshExtractJob *job);
+
 static void extract_run(TaskPool *__restrict UNUSED(pool), void *taskdata)
 {
   ExtractTaskData *data = taskdata;
@@ -4520,20 +4677,48 @@ static void extract_run(TaskPool *__restrict UNUSED(pool), void *taskdata)
   if (remainin_tasks == 0 && data->extract->finish != NULL) {
     data->extract->finish(data->mr, data->buf, data->user_data);
   }
+
+  if (data->job != NULL) {
+    mesh_extract_job_task_done(data->job);
+  }
 }
 
 static void extract_range_task_create(
     TaskPool *task_pool, ExtractTaskData *taskdata, const eMRIterType type, int start, int length)
 {
   taskdata = MEM_dupallocN(taskdata);
-  atomic_add_and_fetch_int32(taskdata->task_counter, 1);
   taskdata->iter_type = type;
   taskdata->start = start;
   taskdata->end = start + length;
   BLI_task_pool_push(task_pool, extract_run, taskdata, true, NULL);
 }
 
+static int extract_range_task_len(const MeshRenderData *mr, const eMRIterType iter_type)
+{
+  const int chunk_size = MESH_EXTRACT_THREAD_LOOP_LEN;
+  int len = 0;
+  if (iter_type & MR_ITER_LOOPTRI) {
+    len += (mr->tri_len + chunk_size - 1) / chunk_size;
+  }
+  if (iter_type & MR_ITER_LOOP) {
+    len += (mr->poly_len + chunk_size - 1) / chunk_size;
+  }
+  if (iter_type & MR_ITER_LEDGE) {
+    len += (mr->edge_loose_len + chunk_size - 1) / chunk_size;
+  }
+  if (iter_type & MR_ITER_LVERT) {
+    len += (mr->vert_loose_len + chunk_size - 1) / chunk_size;
+  }
+  return len;
+}
+
+/**
+ * \param task_pool: Pool to push the tasks to, can be NULL for single threaded extraction.
+ * \param job: When not NULL, the tasks are accounted in the job, small meshes are added to
+ * its serial tasks instead of being extracted immediately.
+ */
 static void extract_task_create(TaskPool *task_pool,
+                                MeshExtractJob *job,
                                 const Scene *scene,
                                 const MeshRenderData *mr,
                                 const MeshExtract *extract,
@@ -4559,12 +4744,22 @@ static void extract_task_create(TaskPool *task_pool,
   taskdata->task_counter = task_counter;
   taskdata->start = 0;
   taskdata->end = INT_MAX;
+  taskdata->job = job;
+  taskdata->next = NULL;
 
   /* Simple heuristic. */
-  const bool use_thread = (mr->loop_len + mr->loop_loose_len) > 8192;
+  const bool use_thread = (task_pool != NULL) &&
+                          (mr->loop_len + mr->loop_loose_len) > MESH_EXTRACT_THREAD_LOOP_LEN;
   if (use_thread && extract->use_threading) {
     /* Divide task into sensible chunks. */
-    const int chunk_size = 8192;
+    const int chunk_size = MESH_EXTRACT_THREAD_LOOP_LEN;
+    /* Account for all tasks before pushing any of them: the pool may already be running,
+     * the finish function and the job must only run once all chunks are extracted. */
+    const int task_len = extract_range_task_len(mr, taskdata->iter_type);
+    atomic_add_and_fetch_int32(task_counter, task_len);
+    if (job != NULL) {
+      atomic_add_and_fetch_int32(&job->tasks_left, task_len);
+    }
     if (taskdata->iter_type & MR_ITER_LOOPTRI) {
       for (int i = 0; i < mr->tri_len; i += chunk_size) {
         extract_range_task_create(task_pool, taskdata, MR_ITER_LOOPTRI, i, chunk_size);
@@ -4590,8 +4785,18 @@ static void extract_task_create(TaskPool *task_pool,
   else if (use_thread) {
     /* One task for the whole VBO. */
     (*task_counter)++;
+    if (job != NULL) {
+      atomic_add_and_fetch_int32(&job->tasks_left, 1);
+    }
     BLI_task_pool_push(task_pool, extract_run, taskdata, true, NULL);
   }
+  else if (job != NULL) {
+    /* Extracted later, together with the other small meshes of the batch. */
+    (*task_counter)++;
+    atomic_add_and_fetch_int32(&job->tasks_left, 1);
+    taskdata->next = job->serial_tasks;
+    job->serial_tasks = taskdata;
+  }
   else {
     /* Single threaded extraction. */
     (*task_counter)++;
@@ -4600,7 +4805,100 @@ static void extract_task_create(TaskPool *task_pool,
   }
 }
 
-void mesh_buffer_cache_create_requested(MeshBatchCache *cache,
+/* Extract Scheduler */
+
+static void mesh_extract_job_finish(MeshExtractJob *job)
+{
+  /* The `lines_loose` is a sub buffer from `ibo.lines`, it can only be
+   * created once all the other buffers of this mesh are extracted. */
+  if (job->mbc.ibo.lines_loose) {
+    int32_t task_counter = 0;
+    extract_task_create(NULL,
+                        NULL,
+                        job->scene,
+                        job->mr,
+                        &extract_lines_loose,
+                        job->mbc.ibo.lines_loose,
+                        &task_counter);
+  }
+
+  mesh_render_data_free(job->mr);
+  MEM_freeN(job->task_counters);
+  atomic_sub_and_fetch_int32(&job->cache->extract_job_len, 1);
+  MEM_freeN(job);
+}
+
+static void mesh_extract_job_task_done(MeshExtractJob *job)
+{
+  if (atomic_sub_and_fetch_int32(&job->tasks_left, 1) == 0) {
+    mesh_extract_job_finish(job);
+  }
+}
+
+static void mesh_extract_batch_run(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  MeshExtractJob *job_next;
+  for (MeshExtractJob *job = taskdata; job; job = job_next) {
+    /* The job is freed once its last task is done. */
+    job_next = job->next;
+    ExtractTaskData *data_next;
+    for (ExtractTaskData *data = job->serial_tasks; data; data = data_next) {
+      data_next = data->next;
+      extract_run(NULL, data);
+      MEM_freeN(data);
+    }
+  }
+}
+
+static void mesh_extract_scheduler_batch_flush(MeshExtractScheduler *scheduler)
+{
+  if (scheduler->batch != NULL) {
+    BLI_task_pool_push(scheduler->task_pool, mesh_extract_batch_run, scheduler->batch, false, NULL);
+    scheduler->batch = NULL;
+    scheduler->batch_loop_len = 0;
+  }
+}
+
+static void mesh_extract_scheduler_job_add(MeshExtractScheduler *scheduler, MeshExtractJob *job)
+{
+  if (job->serial_tasks != NULL) {
+    job->next = scheduler->batch;
+    scheduler->batch = job;
+    scheduler->batch_loop_len += job->mr->loop_len + job->mr->loop_loose_len;
+    if (scheduler->batch_loop_len >= MESH_EXTRACT_BATCH_LOOP_LEN) {
+      mesh_extract_scheduler_batch_flush(scheduler);
+    }
+  }
+  /* Release the reference held while the tasks were created. */
+  mesh_extract_job_task_done(job);
+}
+
+MeshExtractScheduler *mesh_extract_scheduler_create(void)
+{
+  MeshExtractScheduler *scheduler = MEM_callocN(sizeof(*scheduler), __func__);
+  scheduler->task_pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+  return scheduler;
+}
+
+/**
+ * Wait until all the extraction pushed so far is finished,
+ * the scheduler can still be used afterwards.
+ */
+void mesh_extract_scheduler_wait(MeshExtractScheduler *scheduler)
+{
+  mesh_extract_scheduler_batch_flush(scheduler);
+  BLI_task_pool_work_and_wait(scheduler->task_pool);
+}
+
+void mesh_extract_scheduler_free(MeshExtractScheduler *scheduler)
+{
+  mesh_extract_scheduler_wait(scheduler);
+  BLI_task_pool_free(scheduler->task_pool);
+  MEM_freeN(scheduler);
+}
+
+void mesh_buffer_cache_create_requested(MeshExtractScheduler *scheduler,
+                                        MeshBatchCache *cache,
                                         MeshBufferCache mbc,
                                         Mesh *me,
                                         const bool is_editmode,
@@ -4686,19 +4984,40 @@ void mesh_buffer_cache_create_requested(MeshBatchCache *cache,
 #endif
 
   TaskPool *task_pool;
-
-  /* Create a suspended pool as the finalize method could be called too early.
-   * See `extract_run`. */
-  task_pool = BLI_task_pool_create_suspended(NULL, TASK_PRIORITY_HIGH);
+  MeshExtractJob *job = NULL;
 
   size_t counters_size = (sizeof(mbc) / sizeof(void *)) * sizeof(int32_t);
   int32_t *task_counters = MEM_callocN(counters_size, __func__);
   int counter_used = 0;
 
+  if (scheduler != NULL) {
+    /* Extraction is finished in the scheduler pool, the job owns the render data. */
+    task_pool = scheduler->task_pool;
+    job = MEM_callocN(sizeof(*job), __func__);
+    job->cache = cache;
+    job->mbc = mbc;
+    job->mr = mr;
+    job->scene = scene;
+    job->task_counters = task_counters;
+    /* Reference held until all tasks are created, see `mesh_extract_scheduler_job_add`. */
+    job->tasks_left = 1;
+    atomic_add_and_fetch_int32(&cache->extract_job_len, 1);
+  }
+  else {
+    /* Create a suspended pool as the finalize method could be called too early.
+     * See `extract_run`. */
+    task_pool = BLI_task_pool_create_suspended(NULL, TASK_PRIORITY_HIGH);
+  }
+
 #define EXTRACT(buf, name) \
   if (mbc.buf.name) { \
-    extract_task_create( \
-        task_pool, scene, mr, &extract_##name, mbc.buf.name, &task_counters[counter_used++]); \
+    extract_task_create(task_pool, \
+                        job, \
+                        scene, \
+                        mr, \
+                        &extract_##name, \
+                        mbc.buf.name, \
+                        &task_counters[counter_used++]); \
   } \
   ((void)0)
 
@@ -4736,9 +5055,13 @@ void mesh_buffer_cache_create_requested(MeshBatchCache *cache,
   EXTRACT(ibo, edituv_points);
   EXTRACT(ibo, edituv_fdots);
 
-  /* TODO(fclem) Ideally, we should have one global pool for all
-   * objects and wait for finish only before drawing when buffers
-   * need to be ready. */
+  if (job != NULL) {
+    /* The `lines_loose` and the freeing of the render data are handled
+     * once the last task of the job is done, see `mesh_extract_job_finish`. */
+    mesh_extract_scheduler_job_add(scheduler, job);
+    return;
+  }
+
   BLI_task_pool_work_and_wait(task_pool);
 
   /* The next task(s) rely on the result of the tasks above. */
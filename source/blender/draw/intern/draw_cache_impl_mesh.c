@@ -96,10 +96,24 @@ static void mesh_cd_calc_edit_uv_layer(const Mesh *UNUSED(me), DRW_MeshCDMask *c
   cd_used->edit_uv = 1;
 }
 
+/* Edit-mesh wrappers don't have loop data until converted, use the edit-mesh layers. */
+static const CustomData *mesh_cd_ldata_get_from_mesh(const Mesh *me)
+{
+  switch ((eMeshWrapperType)me->runtime.wrapper_type) {
+    case ME_WRAPPER_TYPE_MDATA:
+      return &me->ldata;
+    case ME_WRAPPER_TYPE_BMESH:
+      return &me->runtime.edit_mesh_wrap->bm->ldata;
+  }
+
+  BLI_assert(0);
+  return &me->ldata;
+}
+
 static void mesh_cd_calc_active_uv_layer(const Mesh *me, DRW_MeshCDMask *cd_used)
 {
   const Mesh *me_final = (me->edit_mesh) ? me->edit_mesh->mesh_eval_final : me;
-  const CustomData *cd_ldata = &me_final->ldata;
+  const CustomData *cd_ldata = mesh_cd_ldata_get_from_mesh(me_final);
 
   int layer = CustomData_get_active_layer(cd_ldata, CD_MLOOPUV);
   if (layer != -1) {
@@ -110,7 +124,7 @@ static void mesh_cd_calc_active_uv_layer(const Mesh *me, DRW_MeshCDMask *cd_used
 static void mesh_cd_calc_active_mask_uv_layer(const Mesh *me, DRW_MeshCDMask *cd_used)
 {
   const Mesh *me_final = (me->edit_mesh) ? me->edit_mesh->mesh_eval_final : me;
-  const CustomData *cd_ldata = &me_final->ldata;
+  const CustomData *cd_ldata = mesh_cd_ldata_get_from_mesh(me_final);
 
   int layer = CustomData_get_stencil_layer(cd_ldata, CD_MLOOPUV);
   if (layer != -1) {
@@ -121,7 +135,7 @@ static void mesh_cd_calc_active_mask_uv_layer(const Mesh *me, DRW_MeshCDMask *cd
 static void mesh_cd_calc_active_vcol_layer(const Mesh *me, DRW_MeshCDMask *cd_used)
 {
   const Mesh *me_final = (me->edit_mesh) ? me->edit_mesh->mesh_eval_final : me;
-  const CustomData *cd_ldata = &me_final->ldata;
+  const CustomData *cd_ldata = mesh_cd_ldata_get_from_mesh(me_final);
 
   int layer = CustomData_get_active_layer(cd_ldata, CD_MLOOPCOL);
   if (layer != -1) {
@@ -134,7 +148,7 @@ static DRW_MeshCDMask mesh_cd_calc_used_gpu_layers(const Mesh *me,
                                                    int gpumat_array_len)
 {
   const Mesh *me_final = (me->edit_mesh) ? me->edit_mesh->mesh_eval_final : me;
-  const CustomData *cd_ldata = &me_final->ldata;
+  const CustomData *cd_ldata = mesh_cd_ldata_get_from_mesh(me_final);
 
   /* See: DM_vertex_attributes_from_gpu for similar logic */
   DRW_MeshCDMask cd_used;
@@ -420,8 +434,22 @@ static void mesh_batch_cache_init(Mesh *me)
   drw_mesh_weight_state_clear(&cache->weight_state);
 }
 
+/* Buffers may still be written by a previous request of the same redraw,
+ * they must be complete before they are discarded or requested again. */
+static void mesh_batch_cache_extract_wait(MeshBatchCache *cache)
+{
+  if (atomic_fetch_and_add_int32(&cache->extract_job_len, 0) != 0) {
+    MeshExtractScheduler *scheduler = DRW_mesh_extract_scheduler_get();
+    BLI_assert(scheduler != NULL);
+    mesh_extract_scheduler_wait(scheduler);
+  }
+}
+
 void DRW_mesh_batch_cache_validate(Mesh *me)
 {
+  if (me->runtime.batch_cache != NULL) {
+    mesh_batch_cache_extract_wait(me->runtime.batch_cache);
+  }
   if (!mesh_batch_cache_valid(me)) {
     mesh_batch_cache_clear(me);
     mesh_batch_cache_init(me);
@@ -1027,6 +1055,9 @@ void DRW_mesh_batch_cache_create_requested(
 #endif
   }
 
+  MeshExtractScheduler *scheduler = DRW_mesh_extract_scheduler_get();
+  mesh_batch_cache_extract_wait(cache);
+
   /* Sanity check. */
   if ((me->edit_mesh != NULL) && (ob->mode & OB_MODE_EDIT)) {
     BLI_assert(me->edit_mesh->mesh_eval_final != NULL);
@@ -1365,7 +1396,8 @@ void DRW_mesh_batch_cache_create_requested(
   const bool use_subsurf_fdots = scene ? modifiers_usesSubsurfFacedots((Scene *)scene, ob) : false;
 
   if (do_uvcage) {
-    mesh_buffer_cache_create_requested(cache,
+    mesh_buffer_cache_create_requested(scheduler,
+                                       cache,
                                        cache->uv_cage,
                                        me,
                                        is_editmode,
@@ -1381,7 +1413,8 @@ void DRW_mesh_batch_cache_create_requested(
   }
 
   if (do_cage) {
-    mesh_buffer_cache_create_requested(cache,
+    mesh_buffer_cache_create_requested(scheduler,
+                                       cache,
                                        cache->cage,
                                        me,
                                        is_editmode,
@@ -1396,7 +1429,8 @@ void DRW_mesh_batch_cache_create_requested(
                                        true);
   }
 
-  mesh_buffer_cache_create_requested(cache,
+  mesh_buffer_cache_create_requested(scheduler,
+                                     cache,
                                      cache->final,
                                      me,
                                      is_editmode,
@@ -1412,6 +1446,8 @@ void DRW_mesh_batch_cache_create_requested(
 
 #ifdef DEBUG
 check:
+  /* Index buffers are only considered created once their extraction is done. */
+  mesh_batch_cache_extract_wait(cache);
   /* Make sure all requested batches have been setup. */
   for (int i = 0; i < sizeof(cache->batch) / sizeof(void *); i++) {
     BLI_assert(!DRW_batch_requested(((GPUBatch **)&cache->batch)[i], 0));
@@ -86,6 +86,7 @@
 #include "draw_manager_text.h"
 
 /* only for callbacks */
+#include "draw_cache_extract.h"
 #include "draw_cache_impl.h"
 
 #include "engines/basic/basic_engine.h"
@@ -667,6 +668,11 @@ static void drw_duplidata_free(void)
   }
 }
 
+MeshExtractScheduler *DRW_mesh_extract_scheduler_get(void)
+{
+  return DST.mesh_extract_scheduler;
+}
+
 /* Return NULL if not a dupli or a pointer of pointer to the engine data */
 void **DRW_duplidata_get(void *vedata)
 {
@@ -939,6 +945,9 @@ static void drw_engines_cache_init(void)
   DST.enabled_engine_count = BLI_listbase_count(&DST.enabled_engines);
   DST.vedata_array = MEM_mallocN(sizeof(void *) * DST.enabled_engine_count, __func__);
 
+  /* Extract the mesh buffers of all objects while the caches are populated. */
+  DST.mesh_extract_scheduler = mesh_extract_scheduler_create();
+
   int i = 0;
   for (LinkData *link = DST.enabled_engines.first; link; link = link->next, i++) {
     DrawEngineType *engine = link->data;
@@ -1017,6 +1026,10 @@ static void drw_engines_cache_populate(Object *ob)
 
 static void drw_engines_cache_finish(void)
 {
+  /* Engines may read the extracted buffers from here on. */
+  mesh_extract_scheduler_free(DST.mesh_extract_scheduler);
+  DST.mesh_extract_scheduler = NULL;
+
   int i = 0;
   for (LinkData *link = DST.enabled_engines.first; link; link = link->next, i++) {
     DrawEngineType *engine = link->data;
@@ -475,6 +475,9 @@ typedef struct DRWManager {
   /* Array of dupli_data (one for each enabled engine) to handle duplis. */
   void **dupli_datas;
 
+  /** Mesh buffers extraction shared by all objects, valid during cache population. */
+  struct MeshExtractScheduler *mesh_extract_scheduler;
+
   /* Rendering state */
   GPUShader *shader;
   GPUBatch *batch;
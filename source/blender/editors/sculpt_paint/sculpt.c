@@ -2181,16 +2181,11 @@ static float brush_strength(const Sculpt *sd,
   }
 }
 
-/* Return a multiplier for brush strength on a particular vertex. */
-float SCULPT_brush_strength_factor(SculptSession *ss,
-                                   const Brush *br,
-                                   const float brush_point[3],
-                                   const float len,
-                                   const short vno[3],
-                                   const float fno[3],
-                                   const float mask,
-                                   const int vertex_index,
-                                   const int thread_id)
+/* Return the brush texture strength at a point, 1.0 when the brush has no texture. */
+float SCULPT_brush_texture_factor(SculptSession *ss,
+                                  const Brush *br,
+                                  const float brush_point[3],
+                                  const int thread_id)
 {
   StrokeCache *cache = ss->cache;
   const Scene *scene = cache->vc->scene;
@@ -2253,6 +2248,23 @@ float SCULPT_brush_strength_factor(SculptSession *ss,
     }
   }
 
+  return avg;
+}
+
+/* Return a multiplier for brush strength on a particular vertex. */
+float SCULPT_brush_strength_factor(SculptSession *ss,
+                                   const Brush *br,
+                                   const float brush_point[3],
+                                   const float len,
+                                   const short vno[3],
+                                   const float fno[3],
+                                   const float mask,
+                                   const int vertex_index,
+                                   const int thread_id)
+{
+  StrokeCache *cache = ss->cache;
+  float avg = SCULPT_brush_texture_factor(ss, br, brush_point, thread_id);
+
   /* Hardness. */
   float final_len = len;
   const float hardness = br->hardness;
@@ -2756,38 +2768,29 @@ static void do_draw_brush_task_cb_ex(void *__restrict userdata,
   const Brush *brush = data->brush;
   const float *offset = data->offset;
 
-  PBVHVertexIter vd;
+  SculptBrushBatch batch;
   float(*proxy)[3];
 
   proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
   SculptBrushTest test;
-  SculptBrushTestFn sculpt_brush_test_sq_fn = SCULPT_brush_test_init_with_falloff_shape(
-      ss, &test, data->brush->falloff_shape);
+  SCULPT_brush_test_init_with_falloff_shape(ss, &test, data->brush->falloff_shape);
   const int thread_id = BLI_task_parallel_thread_id(tls);
 
-  BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
-  {
-    if (sculpt_brush_test_sq_fn(&test, vd.co)) {
-      /* Offset vertex. */
-      const float fade = SCULPT_brush_strength_factor(ss,
-                                                      brush,
-                                                      vd.co,
-                                                      sqrtf(test.dist),
-                                                      vd.no,
-                                                      vd.fno,
-                                                      vd.mask ? *vd.mask : 0.0f,
-                                                      vd.index,
-                                                      thread_id);
-
-      mul_v3_v3fl(proxy[vd.i], offset, fade);
+  SCULPT_brush_batch_gather(&batch,
+                            data->ob,
+                            data->nodes[n],
+                            (brush->flag & BRUSH_FRONTFACE) ? SCULPT_BATCH_NORMALS : 0);
+  SCULPT_brush_batch_test(&batch, &test, brush->falloff_shape);
+  SCULPT_brush_batch_strength_factor(&batch, ss, brush, 1.0f, true, thread_id);
 
-      if (vd.mvert) {
-        vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-      }
-    }
+  /* Offset vertex. */
+  for (int i = 0; i < batch.len; i++) {
+    mul_v3_v3fl(proxy[batch.proxy_index[i]], offset, batch.fade[i]);
   }
-  BKE_pbvh_vertex_iter_end;
+
+  SCULPT_brush_batch_tag_update(&batch);
+  SCULPT_brush_batch_free(&batch);
 }
 
 static void do_draw_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
@@ -3417,43 +3420,30 @@ static void do_grab_brush_task_cb_ex(void *__restrict userdata,
   const Brush *brush = data->brush;
   const float *grab_delta = data->grab_delta;
 
-  PBVHVertexIter vd;
-  SculptOrigVertData orig_data;
+  SculptBrushBatch batch;
   float(*proxy)[3];
   const float bstrength = ss->cache->bstrength;
 
-  SCULPT_orig_vert_data_init(&orig_data, data->ob, data->nodes[n]);
-
   proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
   SculptBrushTest test;
-  SculptBrushTestFn sculpt_brush_test_sq_fn = SCULPT_brush_test_init_with_falloff_shape(
-      ss, &test, data->brush->falloff_shape);
+  SCULPT_brush_test_init_with_falloff_shape(ss, &test, data->brush->falloff_shape);
   const int thread_id = BLI_task_parallel_thread_id(tls);
 
-  BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
-  {
-    SCULPT_orig_vert_data_update(&orig_data, &vd);
+  SCULPT_brush_batch_gather(&batch,
+                            data->ob,
+                            data->nodes[n],
+                            SCULPT_BATCH_ORIGINAL |
+                                ((brush->flag & BRUSH_FRONTFACE) ? SCULPT_BATCH_NORMALS : 0));
+  SCULPT_brush_batch_test(&batch, &test, brush->falloff_shape);
+  SCULPT_brush_batch_strength_factor(&batch, ss, brush, bstrength, true, thread_id);
 
-    if (sculpt_brush_test_sq_fn(&test, orig_data.co)) {
-      const float fade = bstrength * SCULPT_brush_strength_factor(ss,
-                                                                  brush,
-                                                                  orig_data.co,
-                                                                  sqrtf(test.dist),
-                                                                  orig_data.no,
-                                                                  NULL,
-                                                                  vd.mask ? *vd.mask : 0.0f,
-                                                                  vd.index,
-                                                                  thread_id);
-
-      mul_v3_v3fl(proxy[vd.i], grab_delta, fade);
-
-      if (vd.mvert) {
-        vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-      }
-    }
+  for (int i = 0; i < batch.len; i++) {
+    mul_v3_v3fl(proxy[batch.proxy_index[i]], grab_delta, batch.fade[i]);
   }
-  BKE_pbvh_vertex_iter_end;
+
+  SCULPT_brush_batch_tag_update(&batch);
+  SCULPT_brush_batch_free(&batch);
 }
 
 static void do_grab_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
@@ -4568,7 +4558,7 @@ static void do_clay_strips_brush_task_cb_ex(void *__restrict userdata,
   const float *area_no_sp = data->area_no_sp;
   const float *area_co = data->area_co;
 
-  PBVHVertexIter vd;
+  SculptBrushBatch batch;
   SculptBrushTest test;
   float(*proxy)[3];
   const bool flip = (ss->cache->bstrength < 0.0f);
@@ -4580,40 +4570,51 @@ static void do_clay_strips_brush_task_cb_ex(void *__restrict userdata,
   plane_from_point_normal_v3(test.plane_tool, area_co, area_no_sp);
   const int thread_id = BLI_task_parallel_thread_id(tls);
 
-  BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
-  {
-    if (SCULPT_brush_test_cube(&test, vd.co, mat, brush->tip_roundness)) {
-      if (plane_point_side_flip(vd.co, test.plane_tool, flip)) {
+  SCULPT_brush_batch_gather(&batch,
+                            data->ob,
+                            data->nodes[n],
+                            (brush->flag & BRUSH_FRONTFACE) ? SCULPT_BATCH_NORMALS : 0);
+
+  /* The cube test and plane trimming are evaluated per vertex. */
+  for (int i = 0; i < batch.len; i++) {
+    const float co[3] = {batch.co[0][i], batch.co[1][i], batch.co[2][i]};
+    batch.test_pass[i] = false;
+
+    if (SCULPT_brush_test_cube(&test, co, mat, brush->tip_roundness)) {
+      if (plane_point_side_flip(co, test.plane_tool, flip)) {
         float intr[3];
         float val[3];
 
-        closest_to_plane_normalized_v3(intr, test.plane_tool, vd.co);
+        closest_to_plane_normalized_v3(intr, test.plane_tool, co);
 
-        sub_v3_v3v3(val, intr, vd.co);
+        sub_v3_v3v3(val, intr, co);
 
         if (SCULPT_plane_trim(ss->cache, brush, val)) {
-          /* The normal from the vertices is ignored, it causes glitch with planes, see: T44390. */
-          const float fade = bstrength *
-                             SCULPT_brush_strength_factor(ss,
-                                                          brush,
-                                                          vd.co,
-                                                          ss->cache->radius * test.dist,
-                                                          vd.no,
-                                                          vd.fno,
-                                                          vd.mask ? *vd.mask : 0.0f,
-                                                          vd.index,
-                                                          thread_id);
-
-          mul_v3_v3fl(proxy[vd.i], val, fade);
-
-          if (vd.mvert) {
-            vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-          }
+          batch.test_pass[i] = true;
+          batch.dist[i] = ss->cache->radius * test.dist;
         }
       }
     }
   }
-  BKE_pbvh_vertex_iter_end;
+  SCULPT_brush_batch_compact(&batch);
+
+  /* The normal from the vertices is ignored, it causes glitch with planes, see: T44390. */
+  SCULPT_brush_batch_strength_factor(&batch, ss, brush, bstrength, true, thread_id);
+
+  for (int i = 0; i < batch.len; i++) {
+    const float co[3] = {batch.co[0][i], batch.co[1][i], batch.co[2][i]};
+    float intr[3];
+    float val[3];
+
+    closest_to_plane_normalized_v3(intr, test.plane_tool, co);
+
+    sub_v3_v3v3(val, intr, co);
+
+    mul_v3_v3fl(proxy[batch.proxy_index[i]], val, batch.fade[i]);
+  }
+
+  SCULPT_brush_batch_tag_update(&batch);
+  SCULPT_brush_batch_free(&batch);
 }
 
 static void do_clay_strips_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
@@ -0,0 +1,387 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software  Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup edsculpt
+ *
+ * Batched evaluation of brush tests and falloff for all vertices of a PBVH node.
+ *
+ * Evaluating the falloff per vertex with #SCULPT_brush_strength_factor goes through
+ * several branches and function calls for each vertex. Here the vertices are gathered
+ * into one array per component first, after which each step (distance, hardness, curve,
+ * front-face, mask, auto-masking) is a simple loop over the arrays. Only brush textures
+ * and view clipping still need per vertex calls.
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_brush_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_brush.h"
+#include "BKE_context.h"
+#include "BKE_paint.h"
+#include "BKE_pbvh.h"
+
+#include "ED_view3d.h"
+
+#include "paint_intern.h"
+#include "sculpt_intern.h"
+
+#include "bmesh.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/* -------------------------------------------------------------------- */
+/** \name Gather
+ * \{ */
+
+static void sculpt_brush_batch_alloc(SculptBrushBatch *batch, const int totvert)
+{
+  const size_t elem_size = sizeof(float *) * 2 + sizeof(MVert *) + sizeof(float) * 9 +
+                           sizeof(int) * 2 + sizeof(bool);
+  char *mem = MEM_mallocN(elem_size * (size_t)max_ii(totvert, 1), __func__);
+
+  batch->memory = mem;
+  batch->len = 0;
+  batch->flag = 0;
+
+  /* Largest types first to keep the arrays aligned. */
+  batch->co_ref = (float **)mem;
+  mem += sizeof(float *) * totvert;
+  batch->mask_ref = (float **)mem;
+  mem += sizeof(float *) * totvert;
+  batch->mvert = (MVert **)mem;
+  mem += sizeof(MVert *) * totvert;
+
+  for (int i = 0; i < 3; i++) {
+    batch->co[i] = (float *)mem;
+    mem += sizeof(float) * totvert;
+  }
+  for (int i = 0; i < 3; i++) {
+    batch->no[i] = (float *)mem;
+    mem += sizeof(float) * totvert;
+  }
+  batch->mask = (float *)mem;
+  mem += sizeof(float) * totvert;
+  batch->dist = (float *)mem;
+  mem += sizeof(float) * totvert;
+  batch->fade = (float *)mem;
+  mem += sizeof(float) * totvert;
+
+  batch->index = (int *)mem;
+  mem += sizeof(int) * totvert;
+  batch->proxy_index = (int *)mem;
+  mem += sizeof(int) * totvert;
+
+  batch->test_pass = (bool *)mem;
+}
+
+/**
+ * Gather the unique vertices of \a node, see #eSculptBrushBatchFlag for options.
+ * Must be freed with #SCULPT_brush_batch_free.
+ */
+void SCULPT_brush_batch_gather(SculptBrushBatch *batch,
+                               Object *ob,
+                               PBVHNode *node,
+                               const int flag)
+{
+  SculptSession *ss = ob->sculpt;
+  const bool use_original = (flag & SCULPT_BATCH_ORIGINAL) != 0;
+  const bool use_normals = (flag & SCULPT_BATCH_NORMALS) != 0;
+  PBVHVertexIter vd;
+  SculptOrigVertData orig_data;
+  int totvert;
+
+  BKE_pbvh_node_num_verts(ss->pbvh, node, &totvert, NULL);
+  sculpt_brush_batch_alloc(batch, totvert);
+  batch->flag = flag;
+
+  if (use_original) {
+    SCULPT_orig_vert_data_init(&orig_data, ob, node);
+  }
+
+  float **co = batch->co;
+  float **no = batch->no;
+  int len = 0;
+
+  BKE_pbvh_vertex_iter_begin(ss->pbvh, node, vd, PBVH_ITER_UNIQUE)
+  {
+    BLI_assert(len < totvert);
+
+    const float *vco = vd.co;
+    if (use_original) {
+      SCULPT_orig_vert_data_update(&orig_data, &vd);
+      vco = orig_data.co;
+    }
+    co[0][len] = vco[0];
+    co[1][len] = vco[1];
+    co[2][len] = vco[2];
+
+    if (use_normals) {
+      /* Same precedence as the front-face test: short normals before float normals. */
+      const short *vno = use_original ? orig_data.no : vd.no;
+      float vno_fl[3];
+      if (vno) {
+        normal_short_to_float_v3(vno_fl, vno);
+      }
+      else {
+        copy_v3_v3(vno_fl, vd.fno);
+      }
+      no[0][len] = vno_fl[0];
+      no[1][len] = vno_fl[1];
+      no[2][len] = vno_fl[2];
+    }
+
+    batch->mask[len] = vd.mask ? *vd.mask : 0.0f;
+    batch->index[len] = vd.index;
+    batch->proxy_index[len] = vd.i;
+    batch->co_ref[len] = vd.co;
+    batch->mask_ref[len] = vd.mask;
+    batch->mvert[len] = vd.mvert;
+    len++;
+  }
+  BKE_pbvh_vertex_iter_end;
+
+  batch->len = len;
+}
+
+void SCULPT_brush_batch_free(SculptBrushBatch *batch)
+{
+  MEM_SAFE_FREE(batch->memory);
+  batch->len = 0;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Brush Test
+ * \{ */
+
+/**
+ * Remove the vertices which didn't pass the test (#SculptBrushBatch.test_pass),
+ * keeping the order of the remaining vertices.
+ */
+void SCULPT_brush_batch_compact(SculptBrushBatch *batch)
+{
+  const bool *test_pass = batch->test_pass;
+  const int len = batch->len;
+  int len_new = 0;
+
+  for (int i = 0; i < len; i++) {
+    if (!test_pass[i]) {
+      continue;
+    }
+    if (i != len_new) {
+      const int j = len_new;
+      batch->co[0][j] = batch->co[0][i];
+      batch->co[1][j] = batch->co[1][i];
+      batch->co[2][j] = batch->co[2][i];
+      if (batch->flag & SCULPT_BATCH_NORMALS) {
+        batch->no[0][j] = batch->no[0][i];
+        batch->no[1][j] = batch->no[1][i];
+        batch->no[2][j] = batch->no[2][i];
+      }
+      batch->mask[j] = batch->mask[i];
+      batch->dist[j] = batch->dist[i];
+      batch->index[j] = batch->index[i];
+      batch->proxy_index[j] = batch->proxy_index[i];
+      batch->co_ref[j] = batch->co_ref[i];
+      batch->mask_ref[j] = batch->mask_ref[i];
+      batch->mvert[j] = batch->mvert[i];
+    }
+    len_new++;
+  }
+
+  batch->len = len_new;
+}
+
+/**
+ * Batched version of the tests returned by #SCULPT_brush_test_init_with_falloff_shape,
+ * \a test must be initialized by it. Vertices outside the brush are removed and
+ * #SculptBrushBatch.dist is set to the (non squared) distance.
+ */
+void SCULPT_brush_batch_test(SculptBrushBatch *batch,
+                             const SculptBrushTest *test,
+                             const char falloff_shape)
+{
+  const int len = batch->len;
+  const float *co_x = batch->co[0];
+  const float *co_y = batch->co[1];
+  const float *co_z = batch->co[2];
+  float *dist = batch->dist;
+  bool *test_pass = batch->test_pass;
+  const float *loc = test->location;
+  const float radius_squared = test->radius_squared;
+
+  if (falloff_shape == PAINT_FALLOFF_SHAPE_SPHERE) {
+    for (int i = 0; i < len; i++) {
+      const float d[3] = {co_x[i] - loc[0], co_y[i] - loc[1], co_z[i] - loc[2]};
+      const float distsq = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+      test_pass[i] = (distsq <= radius_squared);
+      dist[i] = sqrtf(distsq);
+    }
+  }
+  else {
+    /* PAINT_FALLOFF_SHAPE_TUBE, distance in the view plane. */
+    const float *plane = test->plane_view;
+    for (int i = 0; i < len; i++) {
+      const float side = co_x[i] * plane[0] + co_y[i] * plane[1] + co_z[i] * plane[2] +
+                         plane[3];
+      const float d[3] = {
+          (co_x[i] + plane[0] * -side) - loc[0],
+          (co_y[i] + plane[1] * -side) - loc[1],
+          (co_z[i] + plane[2] * -side) - loc[2],
+      };
+      const float distsq = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+      test_pass[i] = (distsq <= radius_squared);
+      dist[i] = sqrtf(distsq);
+    }
+  }
+
+  if (test->clip_rv3d) {
+    for (int i = 0; i < len; i++) {
+      if (test_pass[i]) {
+        const float co[3] = {co_x[i], co_y[i], co_z[i]};
+        float symm_co[3];
+        flip_v3_v3(symm_co, co, test->mirror_symmetry_pass);
+        if (ED_view3d_clipping_test(test->clip_rv3d, symm_co, true)) {
+          test_pass[i] = false;
+        }
+      }
+    }
+  }
+
+  SCULPT_brush_batch_compact(batch);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Strength Factor
+ * \{ */
+
+/**
+ * Batched #SCULPT_brush_strength_factor, the result multiplied by \a strength
+ * is written to #SculptBrushBatch.fade.
+ *
+ * \param use_mask: When false the paint mask is ignored (same as passing a zero mask).
+ */
+void SCULPT_brush_batch_strength_factor(SculptBrushBatch *batch,
+                                        SculptSession *ss,
+                                        const Brush *br,
+                                        const float strength,
+                                        const bool use_mask,
+                                        const int thread_id)
+{
+  const StrokeCache *cache = ss->cache;
+  const int len = batch->len;
+  const float radius = cache->radius;
+  float *fade = batch->fade;
+  /* Final falloff distance, the distance array is re-used since it's not needed after this. */
+  float *final_len = batch->dist;
+
+  /* Texture. */
+  if (br->mtex.tex) {
+    for (int i = 0; i < len; i++) {
+      const float co[3] = {batch->co[0][i], batch->co[1][i], batch->co[2][i]};
+      fade[i] = SCULPT_brush_texture_factor(ss, br, co, thread_id);
+    }
+  }
+  else {
+    copy_vn_fl(fade, len, 1.0f);
+  }
+
+  /* Hardness. */
+  const float hardness = br->hardness;
+  if (hardness == 1.0f) {
+    for (int i = 0; i < len; i++) {
+      const float p = final_len[i] / radius;
+      final_len[i] = (p < hardness) ? 0.0f : radius;
+    }
+  }
+  else {
+    const float hardness_fac = 1.0f - hardness;
+    for (int i = 0; i < len; i++) {
+      const float p = final_len[i] / radius;
+      final_len[i] = (p < hardness) ? 0.0f : ((p - hardness) / hardness_fac) * radius;
+    }
+  }
+
+  /* Falloff curve, written to the distance array. */
+  BKE_brush_curve_strength_array(br, final_len, radius, final_len, len);
+  for (int i = 0; i < len; i++) {
+    fade[i] *= final_len[i];
+  }
+
+  /* Front-face. */
+  if (br->flag & BRUSH_FRONTFACE) {
+    BLI_assert(batch->flag & SCULPT_BATCH_NORMALS);
+    const float *view_no = cache->view_normal;
+    const float *no_x = batch->no[0];
+    const float *no_y = batch->no[1];
+    const float *no_z = batch->no[2];
+    for (int i = 0; i < len; i++) {
+      const float dot = no_x[i] * view_no[0] + no_y[i] * view_no[1] + no_z[i] * view_no[2];
+      fade[i] *= dot > 0.0f ? dot : 0.0f;
+    }
+  }
+
+  /* Paint mask. */
+  if (use_mask) {
+    const float *mask = batch->mask;
+    for (int i = 0; i < len; i++) {
+      fade[i] *= 1.0f - mask[i];
+    }
+  }
+
+  /* Automasking. */
+  if (cache->automask) {
+    const float *automask = cache->automask;
+    const int *index = batch->index;
+    for (int i = 0; i < len; i++) {
+      fade[i] *= automask[index[i]];
+    }
+  }
+
+  if (strength != 1.0f) {
+    for (int i = 0; i < len; i++) {
+      fade[i] = strength * fade[i];
+    }
+  }
+}
+
+/* Tag the vertices which remain in the batch for a PBVH update. */
+void SCULPT_brush_batch_tag_update(const SculptBrushBatch *batch)
+{
+  for (int i = 0; i < batch->len; i++) {
+    if (batch->mvert[i]) {
+      batch->mvert[i]->flag |= ME_VERT_PBVH_UPDATE;
+    }
+  }
+}
+
+/** \} */
@@ -661,6 +661,67 @@ float SCULPT_brush_strength_factor(struct SculptSession *ss,
                                    const float mask,
                                    const int vertex_index,
                                    const int thread_id);
+float SCULPT_brush_texture_factor(struct SculptSession *ss,
+                                  const struct Brush *br,
+                                  const float brush_point[3],
+                                  const int thread_id);
+
+/* Batched brush evaluation.
+ *
+ * Vertices of a node are gathered into separate arrays per component, so the brush test
+ * and falloff can be computed for all vertices at once in loops the compiler vectorizes.
+ * The results match #SCULPT_brush_test_init_with_falloff_shape and
+ * #SCULPT_brush_strength_factor used per vertex. */
+typedef enum eSculptBrushBatchFlag {
+  /* Use original coordinates and normals from the undo data (grab-like brushes). */
+  SCULPT_BATCH_ORIGINAL = (1 << 0),
+  /* Gather normals for front-face tests. */
+  SCULPT_BATCH_NORMALS = (1 << 1),
+} eSculptBrushBatchFlag;
+
+typedef struct SculptBrushBatch {
+  int len;
+  /* #eSculptBrushBatchFlag. */
+  int flag;
+
+  /* Brush space data. */
+  float *co[3];
+  float *no[3];
+  float *mask;
+  /* Distance from the brush center, set by the brush test
+   * (overwritten by #SCULPT_brush_batch_strength_factor). */
+  float *dist;
+  /* Strength factor, set by #SCULPT_brush_batch_strength_factor. */
+  float *fade;
+
+  /* Vertex index (#PBVHVertexIter.index) and proxy index (#PBVHVertexIter.i). */
+  int *index;
+  int *proxy_index;
+  /* Pointers back to the vertex data to write results to. */
+  float **co_ref;
+  float **mask_ref;
+  struct MVert **mvert;
+
+  bool *test_pass;
+  void *memory;
+} SculptBrushBatch;
+
+void SCULPT_brush_batch_gather(SculptBrushBatch *batch,
+                               struct Object *ob,
+                               PBVHNode *node,
+                               const int flag);
+void SCULPT_brush_batch_free(SculptBrushBatch *batch);
+void SCULPT_brush_batch_test(SculptBrushBatch *batch,
+                             const SculptBrushTest *test,
+                             const char falloff_shape);
+void SCULPT_brush_batch_compact(SculptBrushBatch *batch);
+void SCULPT_brush_batch_strength_factor(SculptBrushBatch *batch,
+                                        struct SculptSession *ss,
+                                        const struct Brush *br,
+                                        const float strength,
+                                        const bool use_mask,
+                                        const int thread_id);
+void SCULPT_brush_batch_tag_update(const SculptBrushBatch *batch);
 
 /* just for vertex paint. */
 bool SCULPT_pbvh_calc_area_normal(const struct Brush *brush,
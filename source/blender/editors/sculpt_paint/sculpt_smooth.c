@@ -237,52 +237,48 @@ static void do_smooth_brush_mesh_task_cb_ex(void *__restrict userdata,
   const bool smooth_mask = data->smooth_mask;
   float bstrength = data->strength;
 
-  PBVHVertexIter vd;
+  SculptBrushBatch batch;
 
   CLAMP(bstrength, 0.0f, 1.0f);
 
   SculptBrushTest test;
-  SculptBrushTestFn sculpt_brush_test_sq_fn = SCULPT_brush_test_init_with_falloff_shape(
-      ss, &test, data->brush->falloff_shape);
+  SCULPT_brush_test_init_with_falloff_shape(ss, &test, data->brush->falloff_shape);
 
   const int thread_id = BLI_task_parallel_thread_id(tls);
 
-  BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
-  {
-    if (sculpt_brush_test_sq_fn(&test, vd.co)) {
-      const float fade = bstrength * SCULPT_brush_strength_factor(
-                                         ss,
-                                         brush,
-                                         vd.co,
-                                         sqrtf(test.dist),
-                                         vd.no,
-                                         vd.fno,
-                                         smooth_mask ? 0.0f : (vd.mask ? *vd.mask : 0.0f),
-                                         vd.index,
-                                         thread_id);
-      if (smooth_mask) {
-        float val = SCULPT_neighbor_mask_average(ss, vd.vert_indices[vd.i]) - *vd.mask;
-        val *= fade * bstrength;
-        *vd.mask += val;
-        CLAMP(*vd.mask, 0.0f, 1.0f);
-      }
-      else {
-        float avg[3], val[3];
-
-        SCULPT_neighbor_average(ss, avg, vd.vert_indices[vd.i]);
-        sub_v3_v3v3(val, avg, vd.co);
+  SCULPT_brush_batch_gather(&batch,
+                            data->ob,
+                            data->nodes[n],
+                            (brush->flag & BRUSH_FRONTFACE) ? SCULPT_BATCH_NORMALS : 0);
+  SCULPT_brush_batch_test(&batch, &test, brush->falloff_shape);
+  SCULPT_brush_batch_strength_factor(&batch, ss, brush, bstrength, !smooth_mask, thread_id);
+
+  /* Vertices are written to in the same order as the iterator,
+   * so the neighbor averages match the per vertex evaluation. */
+  for (int i = 0; i < batch.len; i++) {
+    const float fade = batch.fade[i];
+    if (smooth_mask) {
+      float *mask = batch.mask_ref[i];
+      float val = SCULPT_neighbor_mask_average(ss, batch.index[i]) - *mask;
+      val *= fade * bstrength;
+      *mask += val;
+      CLAMP(*mask, 0.0f, 1.0f);
+    }
+    else {
+      float *co = batch.co_ref[i];
+      float avg[3], val[3];
 
-        madd_v3_v3v3fl(val, vd.co, val, fade);
+      SCULPT_neighbor_average(ss, avg, batch.index[i]);
+      sub_v3_v3v3(val, avg, co);
 
-        SCULPT_clip(sd, ss, vd.co, val);
-      }
+      madd_v3_v3v3fl(val, co, val, fade);
 
-      if (vd.mvert) {
-        vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-      }
+      SCULPT_clip(sd, ss, co, val);
     }
   }
-  BKE_pbvh_vertex_iter_end;
+
+  SCULPT_brush_batch_tag_update(&batch);
+  SCULPT_brush_batch_free(&batch);
 }
 
 static void do_smooth_brush_bmesh_task_cb_ex(void *__restrict userdata,
@@ -55,6 +55,10 @@
 
 #include "node_intern.h" /* own include */
 
+#ifdef WITH_COMPOSITOR
+#  include "COM_compositor.h"
+#endif
+
 /* ******************** tree path ********************* */
 
 void ED_node_tree_start(SpaceNode *snode, bNodeTree *ntree, ID *id, ID *from)
@@ -332,6 +336,14 @@ static void node_init(struct wmWindowManager *UNUSED(wm), ScrArea *UNUSED(area))
 {
 }
 
+/* Cached compositor results depend on images, clips and masks used by the tree. */
+static void node_compositor_clear_caches(void)
+{
+#ifdef WITH_COMPOSITOR
+  COM_clearCaches();
+#endif
+}
+
 static void node_area_listener(wmWindow *UNUSED(win),
                                ScrArea *area,
                                wmNotifier *wmn,
@@ -439,6 +451,7 @@ static void node_area_listener(wmWindow *UNUSED(win),
     case NC_MASK:
       if (wmn->action == NA_EDITED) {
         if (snode->nodetree && snode->nodetree->type == NTREE_COMPOSIT) {
+          node_compositor_clear_caches();
           ED_area_tag_refresh(area);
         }
       }
@@ -451,6 +464,7 @@ static void node_area_listener(wmWindow *UNUSED(win),
            * scenes so really this is just to know if the images is used in the compo else
            * painting on images could become very slow when the compositor is open. */
           if (nodeUpdateID(snode->nodetree, wmn->reference)) {
+            node_compositor_clear_caches();
             ED_area_tag_refresh(area);
           }
         }
@@ -461,6 +475,7 @@ static void node_area_listener(wmWindow *UNUSED(win),
       if (wmn->action == NA_EDITED) {
         if (ED_node_is_compositor(snode)) {
           if (nodeUpdateID(snode->nodetree, wmn->reference)) {
+            node_compositor_clear_caches();
             ED_area_tag_refresh(area);
           }
         }
@@ -474,6 +489,9 @@ static void node_area_listener(wmWindow *UNUSED(win),
       break;
     case NC_WM:
       if (wmn->data == ND_UNDO) {
+        if (ED_node_is_compositor(snode)) {
+          node_compositor_clear_caches();
+        }
         ED_area_tag_refresh(area);
       }
       break;
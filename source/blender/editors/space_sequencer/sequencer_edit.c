@@ -30,6 +30,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
 #include "BLI_math.h"
+#include "BLI_threads.h"
 #include "BLI_timecode.h"
 #include "BLI_utildefines.h"
 
@@ -46,6 +47,8 @@
 #include "BKE_sequencer.h"
 #include "BKE_sound.h"
 
+#include "PIL_time.h"
+
 #include "WM_api.h"
 #include "WM_types.h"
 
@@ -125,14 +128,32 @@ typedef struct TransSeq {
 
 /* ***************** proxy job manager ********************** */
 
+/* Maximum number of strips to build proxies for at the same time. Each strip already uses
+ * a thread for decoding and one per proxy size for encoding. */
+#define PROXY_MAX_CONCURRENT_STRIPS 4
+
 typedef struct ProxyBuildJob {
   struct Main *main;
   struct Depsgraph *depsgraph;
   Scene *scene;
   ListBase queue;
   int stop;
+
+  /* Threads take the strip after the last claimed one from the queue, protected by the mutex.
+   * Strips can still be added to the queue while the job is running. */
+  ThreadMutex mutex;
+  LinkData *last_link;
+  int num_done;
+  int num_running;
 } ProxyJob;
 
+typedef struct ProxyJobThread {
+  ProxyJob *pj;
+  short *stop;
+  short *do_update;
+  float progress;
+} ProxyJobThread;
+
 static void proxy_freejob(void *pjv)
 {
   ProxyJob *pj = pjv;
@@ -142,22 +163,96 @@ static void proxy_freejob(void *pjv)
   MEM_freeN(pj);
 }
 
+static void *proxy_thread(void *thread_v)
+{
+  ProxyJobThread *thread = thread_v;
+  ProxyJob *pj = thread->pj;
+
+  while (true) {
+    LinkData *link;
+
+    BLI_mutex_lock(&pj->mutex);
+    link = pj->last_link ? pj->last_link->next : pj->queue.first;
+    if (link) {
+      pj->last_link = link;
+    }
+    BLI_mutex_unlock(&pj->mutex);
+
+    if (link == NULL || *thread->stop) {
+      break;
+    }
+
+    BKE_sequencer_proxy_rebuild(link->data, thread->stop, thread->do_update, &thread->progress);
+
+    BLI_mutex_lock(&pj->mutex);
+    pj->num_done++;
+    thread->progress = 0.0f;
+    BLI_mutex_unlock(&pj->mutex);
+  }
+
+  BLI_mutex_lock(&pj->mutex);
+  pj->num_running--;
+  BLI_mutex_unlock(&pj->mutex);
+
+  return NULL;
+}
+
 /* Only this runs inside thread. */
 static void proxy_startjob(void *pjv, short *stop, short *do_update, float *progress)
 {
   ProxyJob *pj = pjv;
-  LinkData *link;
+  ProxyJobThread threads_data[PROXY_MAX_CONCURRENT_STRIPS];
+  ListBase threads;
+  const int num_threads = min_ii(BLI_listbase_count(&pj->queue), PROXY_MAX_CONCURRENT_STRIPS);
+  int i;
 
-  for (link = pj->queue.first; link; link = link->next) {
-    struct SeqIndexBuildContext *context = link->data;
+  if (num_threads == 0) {
+    return;
+  }
+
+  BLI_mutex_init(&pj->mutex);
+  pj->last_link = NULL;
+  pj->num_done = 0;
+  pj->num_running = num_threads;
 
-    BKE_sequencer_proxy_rebuild(context, stop, do_update, progress);
+  BLI_threadpool_init(&threads, proxy_thread, num_threads);
+
+  for (i = 0; i < num_threads; i++) {
+    threads_data[i].pj = pj;
+    threads_data[i].stop = stop;
+    threads_data[i].do_update = do_update;
+    threads_data[i].progress = 0.0f;
+    BLI_threadpool_insert(&threads, &threads_data[i]);
+  }
 
-    if (*stop) {
-      pj->stop = 1;
-      fprintf(stderr, "Canceling proxy rebuild on users request...\n");
+  /* Report the progress of the strips being built, until all threads are done. */
+  while (true) {
+    float done;
+    bool running;
+
+    BLI_mutex_lock(&pj->mutex);
+    done = pj->num_done;
+    for (i = 0; i < num_threads; i++) {
+      done += threads_data[i].progress;
+    }
+    running = pj->num_running > 0;
+    BLI_mutex_unlock(&pj->mutex);
+
+    *progress = done / BLI_listbase_count(&pj->queue);
+
+    if (!running) {
       break;
     }
+
+    PIL_sleep_ms(50);
+  }
+
+  BLI_threadpool_end(&threads);
+  BLI_mutex_end(&pj->mutex);
+
+  if (*stop) {
+    pj->stop = 1;
+    fprintf(stderr, "Canceling proxy rebuild on users request...\n");
   }
 }
 
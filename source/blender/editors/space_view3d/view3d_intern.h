@@ -158,6 +158,27 @@ void VIEW3D_OT_select_box(struct wmOperatorType *ot);
 void VIEW3D_OT_select_lasso(struct wmOperatorType *ot);
 void VIEW3D_OT_select_menu(struct wmOperatorType *ot);
 
+/* view3d_select_cpu.c */
+struct BMEdge;
+struct BMFace;
+struct BMVert;
+struct SelectOcclusion;
+
+bool view3d_select_use_cpu(const struct ViewContext *vc);
+bool view3d_select_cpu_object_in_rect(const struct ViewContext *vc,
+                                      struct Object *ob,
+                                      const struct rctf *rect);
+struct SelectOcclusion *view3d_select_occlusion_create_editmesh(const struct ViewContext *vc);
+struct SelectOcclusion *view3d_select_occlusion_create_mesh(const struct ViewContext *vc);
+void view3d_select_occlusion_free(struct SelectOcclusion *occ);
+bool view3d_select_occlusion_vert_is_visible(const struct SelectOcclusion *occ,
+                                             struct BMVert *eve);
+bool view3d_select_occlusion_edge_is_visible(const struct SelectOcclusion *occ,
+                                             struct BMEdge *eed);
+bool view3d_select_occlusion_face_is_visible(const struct SelectOcclusion *occ,
+                                             struct BMFace *efa);
+bool view3d_select_occlusion_mesh_vert_is_visible(const struct SelectOcclusion *occ, int index);
+
 /* view3d_view.c */
 void VIEW3D_OT_smoothview(struct wmOperatorType *ot);
 void VIEW3D_OT_camera_to_view(struct wmOperatorType *ot);
@@ -171,6 +192,10 @@ bool ED_view3d_boundbox_clip_ex(const RegionView3D *rv3d,
                                 float obmat[4][4]);
 bool ED_view3d_boundbox_clip(RegionView3D *rv3d, const struct BoundBox *bb);
 
+bool view3d_select_filter_object_test(const struct ViewContext *vc,
+                                      eV3DSelectObjectFilter select_filter,
+                                      struct Object *ob);
+
 typedef struct V3D_SmoothParams {
   struct Object *camera_old, *camera;
   const float *ofs, *quat, *dist, *lens;
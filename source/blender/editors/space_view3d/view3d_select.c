@@ -411,6 +411,8 @@ typedef struct LassoSelectUserData {
   const int (*mcords)[2];
   int moves;
   eSelectOp sel_op;
+  /** Occlusion test for CPU selection (optional). */
+  struct SelectOcclusion *occlusion;
 
   /* runtime */
   int pass;
@@ -434,6 +436,7 @@ static void view3d_userdata_lassoselect_init(LassoSelectUserData *r_data,
   r_data->mcords = mcords;
   r_data->moves = moves;
   r_data->sel_op = sel_op;
+  r_data->occlusion = NULL;
 
   /* runtime */
   r_data->pass = 0;
@@ -717,7 +720,8 @@ static void do_lasso_select_mesh__doSelectVert(void *userData,
   const bool is_select = BM_elem_flag_test(eve, BM_ELEM_SELECT);
   const bool is_inside = (BLI_rctf_isect_pt_v(data->rect_fl, screen_co) &&
                           BLI_lasso_is_point_inside(
-                              data->mcords, data->moves, screen_co[0], screen_co[1], IS_CLIPPED));
+                              data->mcords, data->moves, screen_co[0], screen_co[1], IS_CLIPPED) &&
+                          view3d_select_occlusion_vert_is_visible(data->occlusion, eve));
   const int sel_op_result = ED_select_op_action_deselected(data->sel_op, is_select, is_inside);
   if (sel_op_result != -1) {
     BM_vert_select_set(data->vc->em->bm, eve, sel_op_result);
@@ -747,7 +751,8 @@ static void do_lasso_select_mesh__doSelectEdge_pass0(void *user_data,
   const bool is_inside =
       (is_visible && edge_fully_inside_rect(data->rect_fl, screen_co_a, screen_co_b) &&
        BLI_lasso_is_point_inside(data->mcords, data->moves, UNPACK2(screen_co_a), IS_CLIPPED) &&
-       BLI_lasso_is_point_inside(data->mcords, data->moves, UNPACK2(screen_co_b), IS_CLIPPED));
+       BLI_lasso_is_point_inside(data->mcords, data->moves, UNPACK2(screen_co_b), IS_CLIPPED) &&
+       view3d_select_occlusion_edge_is_visible(data->occlusion, eed));
   const int sel_op_result = ED_select_op_action_deselected(data->sel_op, is_select, is_inside);
   if (sel_op_result != -1) {
     BM_edge_select_set(data->vc->em->bm, eed, sel_op_result);
@@ -770,11 +775,13 @@ static void do_lasso_select_mesh__doSelectEdge_pass1(void *user_data,
   }
 
   const bool is_select = BM_elem_flag_test(eed, BM_ELEM_SELECT);
-  const bool is_inside = (is_visible && BLI_lasso_is_edge_inside(data->mcords,
-                                                                 data->moves,
-                                                                 UNPACK2(screen_co_a),
-                                                                 UNPACK2(screen_co_b),
-                                                                 IS_CLIPPED));
+  const bool is_inside = (is_visible &&
+                          BLI_lasso_is_edge_inside(data->mcords,
+                                                   data->moves,
+                                                   UNPACK2(screen_co_a),
+                                                   UNPACK2(screen_co_b),
+                                                   IS_CLIPPED) &&
+                          view3d_select_occlusion_edge_is_visible(data->occlusion, eed));
   const int sel_op_result = ED_select_op_action_deselected(data->sel_op, is_select, is_inside);
   if (sel_op_result != -1) {
     BM_edge_select_set(data->vc->em->bm, eed, sel_op_result);
@@ -791,7 +798,8 @@ static void do_lasso_select_mesh__doSelectFace(void *userData,
   const bool is_select = BM_elem_flag_test(efa, BM_ELEM_SELECT);
   const bool is_inside = (BLI_rctf_isect_pt_v(data->rect_fl, screen_co) &&
                           BLI_lasso_is_point_inside(
-                              data->mcords, data->moves, screen_co[0], screen_co[1], IS_CLIPPED));
+                              data->mcords, data->moves, screen_co[0], screen_co[1], IS_CLIPPED) &&
+                          view3d_select_occlusion_face_is_visible(data->occlusion, efa));
   const int sel_op_result = ED_select_op_action_deselected(data->sel_op, is_select, is_inside);
   if (sel_op_result != -1) {
     BM_face_select_set(data->vc->em->bm, efa, sel_op_result);
@@ -826,9 +834,14 @@ static bool do_lasso_select_mesh(ViewContext *vc,
   /* for non zbuf projections, don't change the GL state */
   ED_view3d_init_mats_rv3d(vc->obedit, vc->rv3d);
 
-  GPU_matrix_set(vc->rv3d->viewmat);
+  const bool use_cpu = view3d_select_use_cpu(vc);
+  const bool use_occlusion = !XRAY_FLAG_ENABLED(vc->v3d);
+  const bool use_zbuf = use_occlusion && !use_cpu;
 
-  const bool use_zbuf = !XRAY_FLAG_ENABLED(vc->v3d);
+  /* There is no GPU context in background mode, which always uses CPU selection. */
+  if (!use_cpu) {
+    GPU_matrix_set(vc->rv3d->viewmat);
+  }
 
   struct EditSelectBuf_Cache *esel = wm_userdata->data;
   if (use_zbuf) {
@@ -839,6 +852,9 @@ static bool do_lasso_select_mesh(ViewContext *vc,
           vc->depsgraph, vc->region, vc->v3d, mcords, moves, &rect, NULL);
     }
   }
+  else if (use_occlusion) {
+    data.occlusion = view3d_select_occlusion_create_editmesh(vc);
+  }
 
   if (ts->selectmode & SCE_SELECT_VERTEX) {
     if (use_zbuf) {
@@ -881,6 +897,8 @@ static bool do_lasso_select_mesh(ViewContext *vc,
     }
   }
 
+  view3d_select_occlusion_free(data.occlusion);
+
   if (data.is_changed) {
     EDBM_selectmode_flush(vc->em);
   }
@@ -1109,13 +1127,14 @@ static bool do_lasso_select_meta(ViewContext *vc,
 static void do_lasso_select_meshobject__doSelectVert(void *userData,
                                                      MVert *mv,
                                                      const float screen_co[2],
-                                                     int UNUSED(index))
+                                                     int index)
 {
   LassoSelectUserData *data = userData;
   const bool is_select = mv->flag & SELECT;
   const bool is_inside = (BLI_rctf_isect_pt_v(data->rect_fl, screen_co) &&
                           BLI_lasso_is_point_inside(
-                              data->mcords, data->moves, screen_co[0], screen_co[1], IS_CLIPPED));
+                              data->mcords, data->moves, screen_co[0], screen_co[1], IS_CLIPPED) &&
+                          view3d_select_occlusion_mesh_vert_is_visible(data->occlusion, index));
   const int sel_op_result = ED_select_op_action_deselected(data->sel_op, is_select, is_inside);
   if (sel_op_result != -1) {
     SET_FLAG_FROM_TEST(mv->flag, sel_op_result, SELECT);
@@ -1128,7 +1147,8 @@ static bool do_lasso_select_paintvert(ViewContext *vc,
                                       short moves,
                                       const eSelectOp sel_op)
 {
-  const bool use_zbuf = !XRAY_ENABLED(vc->v3d);
+  const bool use_occlusion = !XRAY_ENABLED(vc->v3d);
+  const bool use_zbuf = use_occlusion && !view3d_select_use_cpu(vc);
   Object *ob = vc->obact;
   Mesh *me = ob->data;
   rcti rect;
@@ -1167,8 +1187,13 @@ static bool do_lasso_select_paintvert(ViewContext *vc,
 
     ED_view3d_init_mats_rv3d(vc->obact, vc->rv3d);
 
+    if (use_occlusion) {
+      data.occlusion = view3d_select_occlusion_create_mesh(vc);
+    }
+
     meshobject_foreachScreenVert(
         vc, do_lasso_select_meshobject__doSelectVert, &data, V3D_PROJ_TEST_CLIP_DEFAULT);
+    view3d_select_occlusion_free(data.occlusion);
 
     changed |= data.is_changed;
   }
@@ -2526,6 +2551,8 @@ typedef struct BoxSelectUserData {
   const rctf *rect_fl;
   rctf _rect_fl;
   eSelectOp sel_op;
+  /** Occlusion test for CPU selection (optional). */
+  struct SelectOcclusion *occlusion;
 
   /* runtime */
   bool is_done;
@@ -2544,6 +2571,7 @@ static void view3d_userdata_boxselect_init(BoxSelectUserData *r_data,
   BLI_rctf_rcti_copy(&r_data->_rect_fl, rect);
 
   r_data->sel_op = sel_op;
+  r_data->occlusion = NULL;
 
   /* runtime */
   r_data->is_done = false;
@@ -2562,11 +2590,12 @@ bool edge_inside_circle(const float cent[2],
 static void do_paintvert_box_select__doSelectVert(void *userData,
                                                   MVert *mv,
                                                   const float screen_co[2],
-                                                  int UNUSED(index))
+                                                  int index)
 {
   BoxSelectUserData *data = userData;
   const bool is_select = mv->flag & SELECT;
-  const bool is_inside = BLI_rctf_isect_pt_v(data->rect_fl, screen_co);
+  const bool is_inside = (BLI_rctf_isect_pt_v(data->rect_fl, screen_co) &&
+                          view3d_select_occlusion_mesh_vert_is_visible(data->occlusion, index));
   const int sel_op_result = ED_select_op_action_deselected(data->sel_op, is_select, is_inside);
   if (sel_op_result != -1) {
     SET_FLAG_FROM_TEST(mv->flag, sel_op_result, SELECT);
@@ -2578,7 +2607,8 @@ static bool do_paintvert_box_select(ViewContext *vc,
                                     const rcti *rect,
                                     const eSelectOp sel_op)
 {
-  const bool use_zbuf = !XRAY_ENABLED(vc->v3d);
+  const bool use_occlusion = !XRAY_ENABLED(vc->v3d);
+  const bool use_zbuf = use_occlusion && !view3d_select_use_cpu(vc);
 
   Mesh *me;
 
@@ -2614,8 +2644,13 @@ static bool do_paintvert_box_select(ViewContext *vc,
 
     ED_view3d_init_mats_rv3d(vc->obact, vc->rv3d);
 
+    if (use_occlusion) {
+      data.occlusion = view3d_select_occlusion_create_mesh(vc);
+    }
+
     meshobject_foreachScreenVert(
         vc, do_paintvert_box_select__doSelectVert, &data, V3D_PROJ_TEST_CLIP_DEFAULT);
+    view3d_select_occlusion_free(data.occlusion);
     changed |= data.is_changed;
   }
 
@@ -2762,7 +2797,8 @@ static void do_mesh_box_select__doSelectVert(void *userData,
 {
   BoxSelectUserData *data = userData;
   const bool is_select = BM_elem_flag_test(eve, BM_ELEM_SELECT);
-  const bool is_inside = BLI_rctf_isect_pt_v(data->rect_fl, screen_co);
+  const bool is_inside = (BLI_rctf_isect_pt_v(data->rect_fl, screen_co) &&
+                          view3d_select_occlusion_vert_is_visible(data->occlusion, eve));
   const int sel_op_result = ED_select_op_action_deselected(data->sel_op, is_select, is_inside);
   if (sel_op_result != -1) {
     BM_vert_select_set(data->vc->em->bm, eve, sel_op_result);
@@ -2787,7 +2823,8 @@ static void do_mesh_box_select__doSelectEdge_pass0(
 
   const bool is_select = BM_elem_flag_test(eed, BM_ELEM_SELECT);
   const bool is_inside = (is_visible &&
-                          edge_fully_inside_rect(data->rect_fl, screen_co_a, screen_co_b));
+                          edge_fully_inside_rect(data->rect_fl, screen_co_a, screen_co_b) &&
+                          view3d_select_occlusion_edge_is_visible(data->occlusion, eed));
   const int sel_op_result = ED_select_op_action_deselected(data->sel_op, is_select, is_inside);
   if (sel_op_result != -1) {
     BM_edge_select_set(data->vc->em->bm, eed, sel_op_result);
@@ -2807,7 +2844,8 @@ static void do_mesh_box_select__doSelectEdge_pass1(
   }
 
   const bool is_select = BM_elem_flag_test(eed, BM_ELEM_SELECT);
-  const bool is_inside = (is_visible && edge_inside_rect(data->rect_fl, screen_co_a, screen_co_b));
+  const bool is_inside = (is_visible && edge_inside_rect(data->rect_fl, screen_co_a, screen_co_b) &&
+                          view3d_select_occlusion_edge_is_visible(data->occlusion, eed));
   const int sel_op_result = ED_select_op_action_deselected(data->sel_op, is_select, is_inside);
   if (sel_op_result != -1) {
     BM_edge_select_set(data->vc->em->bm, eed, sel_op_result);
@@ -2821,7 +2859,8 @@ static void do_mesh_box_select__doSelectFace(void *userData,
 {
   BoxSelectUserData *data = userData;
   const bool is_select = BM_elem_flag_test(efa, BM_ELEM_SELECT);
-  const bool is_inside = BLI_rctf_isect_pt_v(data->rect_fl, screen_co);
+  const bool is_inside = (BLI_rctf_isect_pt_v(data->rect_fl, screen_co) &&
+                          view3d_select_occlusion_face_is_visible(data->occlusion, efa));
   const int sel_op_result = ED_select_op_action_deselected(data->sel_op, is_select, is_inside);
   if (sel_op_result != -1) {
     BM_face_select_set(data->vc->em->bm, efa, sel_op_result);
@@ -2848,9 +2887,14 @@ static bool do_mesh_box_select(ViewContext *vc,
   /* for non zbuf projections, don't change the GL state */
   ED_view3d_init_mats_rv3d(vc->obedit, vc->rv3d);
 
-  GPU_matrix_set(vc->rv3d->viewmat);
+  const bool use_cpu = view3d_select_use_cpu(vc);
+  const bool use_occlusion = !XRAY_FLAG_ENABLED(vc->v3d);
+  const bool use_zbuf = use_occlusion && !use_cpu;
 
-  const bool use_zbuf = !XRAY_FLAG_ENABLED(vc->v3d);
+  /* There is no GPU context in background mode, which always uses CPU selection. */
+  if (!use_cpu) {
+    GPU_matrix_set(vc->rv3d->viewmat);
+  }
 
   struct EditSelectBuf_Cache *esel = wm_userdata->data;
   if (use_zbuf) {
@@ -2861,6 +2905,9 @@ static bool do_mesh_box_select(ViewContext *vc,
           vc->depsgraph, vc->region, vc->v3d, rect, NULL);
     }
   }
+  else if (use_occlusion) {
+    data.occlusion = view3d_select_occlusion_create_editmesh(vc);
+  }
 
   if (ts->selectmode & SCE_SELECT_VERTEX) {
     if (use_zbuf) {
@@ -2903,6 +2950,8 @@ static bool do_mesh_box_select(ViewContext *vc,
     }
   }
 
+  view3d_select_occlusion_free(data.occlusion);
+
   if (data.is_changed) {
     EDBM_selectmode_flush(vc->em);
   }
@@ -3064,9 +3113,53 @@ static int opengl_bone_select_buffer_cmp(const void *sel_a_p, const void *sel_b_
   }
 }
 
+/* CPU version of #do_object_box_select, using the projected object bounds. */
+static bool do_object_box_select_cpu(bContext *C,
+                                     ViewContext *vc,
+                                     const rcti *rect,
+                                     const eSelectOp sel_op)
+{
+  View3D *v3d = vc->v3d;
+  rctf rect_fl;
+  BLI_rctf_rcti_copy(&rect_fl, rect);
+
+  const eV3DSelectObjectFilter select_filter = ED_view3d_select_filter_from_mode(vc->scene,
+                                                                                 vc->obact);
+
+  bool changed = false;
+  if (SEL_OP_USE_PRE_DESELECT(sel_op)) {
+    changed |= object_deselect_all_visible(vc->view_layer, vc->v3d);
+  }
+
+  LISTBASE_FOREACH (Base *, base, &vc->view_layer->object_bases) {
+    if (BASE_SELECTABLE(v3d, base)) {
+      const bool is_select = base->flag & BASE_SELECTED;
+      /* Objects excluded by the filter are never drawn into the GPU select buffer. */
+      const bool is_inside = view3d_select_filter_object_test(vc, select_filter, base->object) &&
+                             view3d_select_cpu_object_in_rect(vc, base->object, &rect_fl);
+      const int sel_op_result = ED_select_op_action_deselected(sel_op, is_select, is_inside);
+      if (sel_op_result != -1) {
+        ED_object_base_select(base, sel_op_result ? BA_SELECT : BA_DESELECT);
+        changed = true;
+      }
+    }
+  }
+
+  if (changed) {
+    DEG_id_tag_update(&vc->scene->id, ID_RECALC_SELECT);
+    WM_event_add_notifier(C, NC_SCENE | ND_OB_SELECT, vc->scene);
+  }
+  return changed;
+}
+
 static bool do_object_box_select(bContext *C, ViewContext *vc, rcti *rect, const eSelectOp sel_op)
 {
   View3D *v3d = vc->v3d;
+
+  if (view3d_select_use_cpu(vc)) {
+    return do_object_box_select_cpu(C, vc, rect, sel_op);
+  }
+
   int totobj = MAXPICKBUF; /* XXX solve later */
 
   /* selection buffer now has bones potentially too, so we add MAXPICKBUF */
@@ -3360,6 +3453,8 @@ typedef struct CircleSelectUserData {
   float mval_fl[2];
   float radius;
   float radius_squared;
+  /** Occlusion test for CPU selection (optional). */
+  struct SelectOcclusion *occlusion;
 
   /* runtime */
   bool is_changed;
@@ -3379,6 +3474,7 @@ static void view3d_userdata_circleselect_init(CircleSelectUserData *r_data,
 
   r_data->radius = rad;
   r_data->radius_squared = rad * rad;
+  r_data->occlusion = NULL;
 
   /* runtime */
   r_data->is_changed = false;
@@ -3391,7 +3487,8 @@ static void mesh_circle_doSelectVert(void *userData,
 {
   CircleSelectUserData *data = userData;
 
-  if (len_squared_v2v2(data->mval_fl, screen_co) <= data->radius_squared) {
+  if (len_squared_v2v2(data->mval_fl, screen_co) <= data->radius_squared &&
+      view3d_select_occlusion_vert_is_visible(data->occlusion, eve)) {
     BM_vert_select_set(data->vc->em->bm, eve, data->select);
     data->is_changed = true;
   }
@@ -3404,7 +3501,8 @@ static void mesh_circle_doSelectEdge(void *userData,
 {
   CircleSelectUserData *data = userData;
 
-  if (edge_inside_circle(data->mval_fl, data->radius, screen_co_a, screen_co_b)) {
+  if (edge_inside_circle(data->mval_fl, data->radius, screen_co_a, screen_co_b) &&
+      view3d_select_occlusion_edge_is_visible(data->occlusion, eed)) {
     BM_edge_select_set(data->vc->em->bm, eed, data->select);
     data->is_changed = true;
   }
@@ -3416,7 +3514,8 @@ static void mesh_circle_doSelectFace(void *userData,
 {
   CircleSelectUserData *data = userData;
 
-  if (len_squared_v2v2(data->mval_fl, screen_co) <= data->radius_squared) {
+  if (len_squared_v2v2(data->mval_fl, screen_co) <= data->radius_squared &&
+      view3d_select_occlusion_face_is_visible(data->occlusion, efa)) {
     BM_face_select_set(data->vc->em->bm, efa, data->select);
     data->is_changed = true;
   }
@@ -3445,13 +3544,17 @@ static bool mesh_circle_select(ViewContext *vc,
 
   view3d_userdata_circleselect_init(&data, vc, select, mval, rad);
 
-  const bool use_zbuf = !XRAY_FLAG_ENABLED(vc->v3d);
+  const bool use_occlusion = !XRAY_FLAG_ENABLED(vc->v3d);
+  const bool use_zbuf = use_occlusion && !view3d_select_use_cpu(vc);
 
   if (use_zbuf) {
     if (wm_userdata->data == NULL) {
       editselect_buf_cache_init_with_generic_userdata(wm_userdata, vc, ts->selectmode);
     }
   }
+  else if (use_occlusion) {
+    data.occlusion = view3d_select_occlusion_create_editmesh(vc);
+  }
   struct EditSelectBuf_Cache *esel = wm_userdata->data;
 
   if (use_zbuf) {
@@ -3498,6 +3601,7 @@ static bool mesh_circle_select(ViewContext *vc,
     }
   }
 
+  view3d_select_occlusion_free(data.occlusion);
   changed |= data.is_changed;
 
   if (changed) {
@@ -3546,11 +3650,12 @@ static bool paint_facesel_circle_select(ViewContext *vc,
 static void paint_vertsel_circle_select_doSelectVert(void *userData,
                                                      MVert *mv,
                                                      const float screen_co[2],
-                                                     int UNUSED(index))
+                                                     int index)
 {
   CircleSelectUserData *data = userData;
 
-  if (len_squared_v2v2(data->mval_fl, screen_co) <= data->radius_squared) {
+  if (len_squared_v2v2(data->mval_fl, screen_co) <= data->radius_squared &&
+      view3d_select_occlusion_mesh_vert_is_visible(data->occlusion, index)) {
     SET_FLAG_FROM_TEST(mv->flag, data->select, SELECT);
     data->is_changed = true;
   }
@@ -3562,7 +3667,8 @@ static bool paint_vertsel_circle_select(ViewContext *vc,
                                         float rad)
 {
   BLI_assert(ELEM(sel_op, SEL_OP_SET, SEL_OP_ADD, SEL_OP_SUB));
-  const bool use_zbuf = !XRAY_ENABLED(vc->v3d);
+  const bool use_occlusion = !XRAY_ENABLED(vc->v3d);
+  const bool use_zbuf = use_occlusion && !view3d_select_use_cpu(vc);
   Object *ob = vc->obact;
   Mesh *me = ob->data;
   /* CircleSelectUserData data = {NULL}; */ /* UNUSED */
@@ -3597,8 +3703,12 @@ static bool paint_vertsel_circle_select(ViewContext *vc,
     ED_view3d_init_mats_rv3d(vc->obact, vc->rv3d); /* for foreach's screen/vert projection */
 
     view3d_userdata_circleselect_init(&data, vc, select, mval, rad);
+    if (use_occlusion) {
+      data.occlusion = view3d_select_occlusion_create_mesh(vc);
+    }
     meshobject_foreachScreenVert(
         vc, paint_vertsel_circle_select_doSelectVert, &data, V3D_PROJ_TEST_CLIP_DEFAULT);
+    view3d_select_occlusion_free(data.occlusion);
     changed |= data.is_changed;
   }
 
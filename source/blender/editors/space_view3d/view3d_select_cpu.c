@@ -0,0 +1,344 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup spview3d
+ *
+ * CPU selection: an alternative to the GPU select-ID buffer for box, lasso & circle select.
+ *
+ * Elements are projected to the screen on the CPU (the same way as for X-Ray selection),
+ * occlusion is then resolved by casting a ray from each candidate element towards the viewer
+ * against a BVH of the mesh. This avoids redrawing the viewport for every selection
+ * and works without an OpenGL context (background mode).
+ */
+
+#include <float.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_screen_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_math.h"
+#include "BLI_rect.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_bvhutils.h"
+#include "BKE_editmesh.h"
+#include "BKE_editmesh_bvh.h"
+#include "BKE_global.h"
+#include "BKE_mesh_runtime.h"
+#include "BKE_object.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
+
+#include "bmesh.h"
+
+#include "ED_view3d.h"
+
+#include "view3d_intern.h" /* own include */
+
+/* -------------------------------------------------------------------- */
+/** \name CPU Selection Utilities
+ * \{ */
+
+/**
+ * Use the CPU selection instead of the GPU select-ID buffer.
+ * Background mode has no viewport to draw selection ID's into.
+ */
+bool view3d_select_use_cpu(const ViewContext *UNUSED(vc))
+{
+  return G.background || (U.gpu_flag & USER_GPU_FLAG_SELECT_CPU);
+}
+
+/**
+ * Object-mode box select: test the screen space bounds of the objects bounding box,
+ * since the GPU version selects objects with any pixel drawn inside the rectangle.
+ */
+bool view3d_select_cpu_object_in_rect(const ViewContext *vc, Object *ob, const rctf *rect)
+{
+  Object *ob_eval = DEG_get_evaluated_object(vc->depsgraph, ob);
+  const BoundBox *bb = BKE_object_boundbox_get(ob_eval);
+
+  if (bb == NULL) {
+    float screen_co[2];
+    ED_view3d_project_float_v2_m4(vc->region, ob_eval->obmat[3], screen_co, vc->rv3d->persmat);
+    return BLI_rctf_isect_pt_v(rect, screen_co);
+  }
+
+  float mat[4][4];
+  ED_view3d_ob_project_mat_get(vc->rv3d, ob_eval, mat);
+
+  rctf bounds;
+  BLI_rctf_init_minmax(&bounds);
+  int corners_in_front = 0;
+  for (int i = 0; i < 8; i++) {
+    float vec4[4];
+    copy_v3_v3(vec4, bb->vec[i]);
+    vec4[3] = 1.0f;
+    mul_m4_v4(mat, vec4);
+    /* Corners behind the view are not projected, this matches the near-clipping of drawing. */
+    if (vec4[3] <= FLT_EPSILON) {
+      continue;
+    }
+    const float screen_co[2] = {
+        (float)(vc->region->winx / 2.0f) * (1.0f + vec4[0] / vec4[3]),
+        (float)(vc->region->winy / 2.0f) * (1.0f + vec4[1] / vec4[3]),
+    };
+    BLI_rctf_do_minmax_v(&bounds, screen_co);
+    corners_in_front++;
+  }
+
+  return (corners_in_front != 0) && BLI_rctf_isect(rect, &bounds, NULL);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Occlusion Tests
+ * \{ */
+
+typedef struct SelectOcclusion {
+  /** Edit-mesh, ray-cast against the cage. */
+  BMEditMesh *em;
+  BMBVHTree *bmbvh;
+  /** Owned by #SelectOcclusion.bmbvh. */
+  const float (*cos_cage)[3];
+
+  /** Mesh (paint modes), ray-cast against the evaluated (deformed) mesh. */
+  Mesh *me_eval;
+  BVHTreeFromMesh treedata;
+
+  /** View location (perspective) or direction towards the viewer (orthographic),
+   * in object space. */
+  float view_co[3];
+  float view_dir[3];
+  bool is_persp;
+} SelectOcclusion;
+
+static void select_occlusion_init_view(SelectOcclusion *occ, const ViewContext *vc, Object *ob)
+{
+  const RegionView3D *rv3d = vc->rv3d;
+  float imat[4][4];
+  invert_m4_m4(imat, ob->obmat);
+
+  occ->is_persp = rv3d->is_persp;
+  if (occ->is_persp) {
+    mul_v3_m4v3(occ->view_co, imat, rv3d->viewinv[3]);
+  }
+  else {
+    mul_v3_mat3_m4v3(occ->view_dir, imat, rv3d->viewinv[2]);
+    normalize_v3(occ->view_dir);
+  }
+}
+
+/** Occlusion of the edit-mesh of `vc->obedit`, the caller must ensure it's a mesh. */
+SelectOcclusion *view3d_select_occlusion_create_editmesh(const ViewContext *vc)
+{
+  SelectOcclusion *occ = MEM_callocN(sizeof(*occ), __func__);
+  Scene *scene_eval = DEG_get_evaluated_scene(vc->depsgraph);
+  Object *obedit_eval = DEG_get_evaluated_object(vc->depsgraph, vc->obedit);
+
+  occ->em = vc->em;
+  BM_mesh_elem_index_ensure(occ->em->bm, BM_VERT);
+
+  float(*cos_cage)[3] = BKE_editmesh_vert_coords_alloc(
+      vc->depsgraph, occ->em, scene_eval, obedit_eval, NULL);
+  occ->cos_cage = (const float(*)[3])cos_cage;
+  occ->bmbvh = BKE_bmbvh_new_from_editmesh(occ->em, BMBVH_RESPECT_HIDDEN, occ->cos_cage, true);
+
+  select_occlusion_init_view(occ, vc, vc->obedit);
+  return occ;
+}
+
+/** Occlusion of the evaluated deformed mesh of `vc->obact`, used by paint modes. */
+SelectOcclusion *view3d_select_occlusion_create_mesh(const ViewContext *vc)
+{
+  Scene *scene_eval = DEG_get_evaluated_scene(vc->depsgraph);
+  Object *ob_eval = DEG_get_evaluated_object(vc->depsgraph, vc->obact);
+  Mesh *me_eval = mesh_get_eval_deform(vc->depsgraph, scene_eval, ob_eval, &CD_MASK_BAREMESH);
+  if (me_eval == NULL) {
+    return NULL;
+  }
+
+  SelectOcclusion *occ = MEM_callocN(sizeof(*occ), __func__);
+  occ->me_eval = me_eval;
+  BKE_bvhtree_from_mesh_get(&occ->treedata, me_eval, BVHTREE_FROM_LOOPTRI, 2);
+
+  select_occlusion_init_view(occ, vc, vc->obact);
+  return occ;
+}
+
+void view3d_select_occlusion_free(SelectOcclusion *occ)
+{
+  if (occ == NULL) {
+    return;
+  }
+  if (occ->bmbvh) {
+    BKE_bmbvh_free(occ->bmbvh);
+  }
+  if (occ->me_eval) {
+    free_bvhtree_from_mesh(&occ->treedata);
+  }
+  MEM_freeN(occ);
+}
+
+/**
+ * Calculate the ray from \a co towards the viewer.
+ * \return the maximum distance for hits to be considered occluding.
+ */
+static float select_occlusion_ray_to_view(const SelectOcclusion *occ,
+                                          const float co[3],
+                                          float r_dir[3])
+{
+  if (occ->is_persp) {
+    sub_v3_v3v3(r_dir, occ->view_co, co);
+    return normalize_v3(r_dir);
+  }
+  copy_v3_v3(r_dir, occ->view_dir);
+  return FLT_MAX;
+}
+
+/* Edit-mesh filters: ignore the faces the element being tested belongs to. */
+
+static bool select_occlusion_filter_vert(BMFace *f, void *userdata)
+{
+  return !BM_vert_in_face((BMVert *)userdata, f);
+}
+
+static bool select_occlusion_filter_edge(BMFace *f, void *userdata)
+{
+  return !BM_edge_in_face((BMEdge *)userdata, f);
+}
+
+static bool select_occlusion_filter_face(BMFace *f, void *userdata)
+{
+  return f != (BMFace *)userdata;
+}
+
+static bool select_occlusion_editmesh_test(const SelectOcclusion *occ,
+                                           const float co[3],
+                                           BMBVHTree_FaceFilter filter_cb,
+                                           void *filter_userdata)
+{
+  float dir[3];
+  float dist = select_occlusion_ray_to_view(occ, co, dir);
+  return BKE_bmbvh_ray_cast_filter(
+             occ->bmbvh, co, dir, 0.0f, &dist, NULL, NULL, filter_cb, filter_userdata) == NULL;
+}
+
+bool view3d_select_occlusion_vert_is_visible(const SelectOcclusion *occ, BMVert *eve)
+{
+  if (occ == NULL) {
+    return true;
+  }
+  const float *co = occ->cos_cage ? occ->cos_cage[BM_elem_index_get(eve)] : eve->co;
+  return select_occlusion_editmesh_test(occ, co, select_occlusion_filter_vert, eve);
+}
+
+/**
+ * Edges are visible when either end-point or the middle of the edge is visible,
+ * to allow selecting edges partially covered by other faces.
+ */
+bool view3d_select_occlusion_edge_is_visible(const SelectOcclusion *occ, BMEdge *eed)
+{
+  if (occ == NULL) {
+    return true;
+  }
+  const float *co_a = occ->cos_cage ? occ->cos_cage[BM_elem_index_get(eed->v1)] : eed->v1->co;
+  const float *co_b = occ->cos_cage ? occ->cos_cage[BM_elem_index_get(eed->v2)] : eed->v2->co;
+  float co[3];
+
+  mid_v3_v3v3(co, co_a, co_b);
+  if (select_occlusion_editmesh_test(occ, co, select_occlusion_filter_edge, eed)) {
+    return true;
+  }
+  /* Sample slightly inside the edge, end-points are shared with other faces. */
+  interp_v3_v3v3(co, co_a, co_b, 0.01f);
+  if (select_occlusion_editmesh_test(occ, co, select_occlusion_filter_edge, eed)) {
+    return true;
+  }
+  interp_v3_v3v3(co, co_a, co_b, 0.99f);
+  return select_occlusion_editmesh_test(occ, co, select_occlusion_filter_edge, eed);
+}
+
+bool view3d_select_occlusion_face_is_visible(const SelectOcclusion *occ, BMFace *efa)
+{
+  if (occ == NULL) {
+    return true;
+  }
+  float co[3];
+  if (occ->cos_cage) {
+    BM_face_calc_center_median_vcos(occ->em->bm, efa, co, occ->cos_cage);
+  }
+  else {
+    BM_face_calc_center_median(efa, co);
+  }
+  return select_occlusion_editmesh_test(occ, co, select_occlusion_filter_face, efa);
+}
+
+/* Mesh ray-cast, skipping the triangles using the vertex being tested. */
+
+typedef struct SelectOcclusionMeshRayCast {
+  const BVHTreeFromMesh *treedata;
+  uint vert_index;
+} SelectOcclusionMeshRayCast;
+
+static void select_occlusion_mesh_raycast_cb(void *userdata,
+                                             int index,
+                                             const BVHTreeRay *ray,
+                                             BVHTreeRayHit *hit)
+{
+  SelectOcclusionMeshRayCast *data = userdata;
+  const BVHTreeFromMesh *treedata = data->treedata;
+  const MLoopTri *lt = &treedata->looptri[index];
+  for (int i = 0; i < 3; i++) {
+    if (treedata->loop[lt->tri[i]].v == data->vert_index) {
+      return;
+    }
+  }
+  treedata->raycast_callback((void *)treedata, index, ray, hit);
+}
+
+bool view3d_select_occlusion_mesh_vert_is_visible(const SelectOcclusion *occ, int index)
+{
+  if (occ == NULL || occ->treedata.tree == NULL || index >= occ->me_eval->totvert) {
+    return true;
+  }
+
+  const float *co = occ->me_eval->mvert[index].co;
+  float dir[3];
+  const float dist = select_occlusion_ray_to_view(occ, co, dir);
+
+  BVHTreeRayHit hit = {
+      .index = -1,
+      .dist = dist,
+  };
+  SelectOcclusionMeshRayCast data = {
+      .treedata = &occ->treedata,
+      .vert_index = (uint)index,
+  };
+  BLI_bvhtree_ray_cast(
+      occ->treedata.tree, co, dir, 0.0f, &hit, select_occlusion_mesh_raycast_cb, &data);
+  return hit.index == -1;
+}
+
+/** \} */
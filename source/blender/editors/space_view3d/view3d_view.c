@@ -978,6 +978,44 @@ static bool drw_select_filter_object_mode_lock_for_weight_paint(Object *ob, void
   return ob_pose_list && (BLI_linklist_index(ob_pose_list, DEG_get_original_object(ob)) != -1);
 }
 
+/**
+ * Test \a ob against \a select_filter, for selection that doesn't draw into a select buffer
+ * (where the filter is applied by the draw manager).
+ */
+bool view3d_select_filter_object_test(const ViewContext *vc,
+                                      eV3DSelectObjectFilter select_filter,
+                                      Object *ob)
+{
+  /* Matches the object filter of #view3d_opengl_select. */
+  Object *obact = vc->obact;
+  switch (select_filter) {
+    case VIEW3D_SELECT_FILTER_OBJECT_MODE_LOCK: {
+      if (obact && obact->mode != OB_MODE_OBJECT) {
+        return drw_select_filter_object_mode_lock(ob, obact);
+      }
+      break;
+    }
+    case VIEW3D_SELECT_FILTER_WPAINT_POSE_MODE_LOCK: {
+      BLI_assert(obact && (obact->mode & OB_MODE_WEIGHT_PAINT));
+
+      VirtualModifierData virtualModifierData;
+      const ModifierData *md = modifiers_getVirtualModifierList(obact, &virtualModifierData);
+      for (; md; md = md->next) {
+        if (md->type == eModifierType_Armature) {
+          ArmatureModifierData *amd = (ArmatureModifierData *)md;
+          if (amd->object == ob && (ob->mode & OB_MODE_POSE)) {
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+    case VIEW3D_SELECT_FILTER_NOP:
+      break;
+  }
+  return true;
+}
+
 /**
  * \warning be sure to account for a negative return value
  * This is an error, "Too many objects in select buffer"
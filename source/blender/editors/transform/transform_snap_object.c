@@ -47,6 +47,7 @@
 #include "BKE_main.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_runtime.h"
+#include "BKE_mesh_wrapper.h"
 #include "BKE_object.h"
 #include "BKE_tracking.h"
 
@@ -986,6 +987,7 @@ static bool raycastObj(SnapObjectContext *sctx,
           BMEditMesh *em = BKE_editmesh_from_object(ob);
           if (em->mesh_eval_final) {
             me = em->mesh_eval_final;
+            BKE_mesh_wrapper_ensure_mdata(me);
             use_hide = true;
           }
         }
@@ -2702,6 +2704,7 @@ static short snapObject(SnapObjectContext *sctx,
           BMEditMesh *em = BKE_editmesh_from_object(ob);
           if (em->mesh_eval_final) {
             me = em->mesh_eval_final;
+            BKE_mesh_wrapper_ensure_mdata(me);
           }
         }
       }
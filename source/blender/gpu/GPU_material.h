@@ -209,6 +209,9 @@ void GPU_pass_cache_init(void);
 void GPU_pass_cache_garbage_collect(void);
 void GPU_pass_cache_free(void);
 
+void GPU_pass_cache_disk_init(void);
+void GPU_pass_cache_disk_exit(void);
+
 /* Requested Material Attributes and Textures */
 
 typedef struct GPUMaterialAttribute {
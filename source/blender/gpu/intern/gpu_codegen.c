@@ -1209,28 +1209,84 @@ static bool gpu_pass_shader_validate(GPUPass *pass, GPUShader *shader)
   return (total_samplers_len <= GPU_max_textures());
 }
 
+/* Compile the sources of the pass, returns NULL on failure. */
+static GPUShader *gpu_pass_shader_create(GPUPass *pass, const char *shname)
+{
+  GPUShader *shader = GPU_shader_create(
+      pass->vertexcode, pass->fragmentcode, pass->geometrycode, NULL, pass->defines, shname);
+
+  /* NOTE: Some drivers / gpu allows more active samplers than the opengl limit.
+   * We need to make sure to count active samplers to avoid undefined behavior. */
+  if (!gpu_pass_shader_validate(pass, shader)) {
+    if (shader != NULL) {
+      fprintf(stderr, "GPUShader: error: too many samplers in shader.\n");
+      GPU_shader_free(shader);
+    }
+    return NULL;
+  }
+  return shader;
+}
+
+/* Try to skip the compilation by loading the program binary from the persistent cache.
+ * Binaries are only written after a successful validation, so they are not validated again. */
+static bool gpu_pass_compile_from_disk_cache(GPUPass *pass, const char *shname)
+{
+  char *binary;
+  uint binary_format;
+  int binary_len;
+  if (!gpu_pass_disk_cache_load(pass, &binary, &binary_format, &binary_len)) {
+    return false;
+  }
+
+  if (!BLI_thread_is_main() && GPU_context_local_shaders_workaround()) {
+    /* Program objects can not be shared, defer the loading to the main thread. */
+    pass->binary.content = binary;
+    pass->binary.format = binary_format;
+    pass->binary.len = binary_len;
+    pass->compiled = true;
+    return true;
+  }
+
+  GPUShader *shader = GPU_shader_load_from_binary(binary, binary_format, binary_len, shname);
+  MEM_freeN(binary);
+
+  if (shader == NULL) {
+    /* Driver rejected the binary (e.g. after an update that kept the same version string). */
+    gpu_pass_disk_cache_remove(pass);
+    return false;
+  }
+
+  pass->shader = shader;
+  pass->compiled = true;
+  return true;
+}
+
 bool GPU_pass_compile(GPUPass *pass, const char *shname)
 {
   bool success = true;
   if (!pass->compiled) {
-    GPUShader *shader = GPU_shader_create(
-        pass->vertexcode, pass->fragmentcode, pass->geometrycode, NULL, pass->defines, shname);
+    if (gpu_pass_compile_from_disk_cache(pass, shname)) {
+      return success;
+    }
+
+    GPUShader *shader = gpu_pass_shader_create(pass, shname);
 
-    /* NOTE: Some drivers / gpu allows more active samplers than the opengl limit.
-     * We need to make sure to count active samplers to avoid undefined behavior. */
-    if (!gpu_pass_shader_validate(pass, shader)) {
+    if (shader == NULL) {
       success = false;
-      if (shader != NULL) {
-        fprintf(stderr, "GPUShader: error: too many samplers in shader.\n");
-        GPU_shader_free(shader);
-        shader = NULL;
-      }
     }
     else if (!BLI_thread_is_main() && GPU_context_local_shaders_workaround()) {
       pass->binary.content = GPU_shader_get_binary(
           shader, &pass->binary.format, &pass->binary.len);
       GPU_shader_free(shader);
       shader = NULL;
+      gpu_pass_disk_cache_store(pass, pass->binary.content, pass->binary.format, pass->binary.len);
+    }
+    else if (gpu_pass_disk_cache_enabled()) {
+      uint binary_format;
+      int binary_len;
+      char *binary = GPU_shader_get_binary(shader, &binary_format, &binary_len);
+      gpu_pass_disk_cache_store(pass, binary, binary_format, binary_len);
+      MEM_freeN(binary);
     }
 
     pass->shader = shader;
@@ -1240,6 +1296,14 @@ bool GPU_pass_compile(GPUPass *pass, const char *shname)
     pass->shader = GPU_shader_load_from_binary(
         pass->binary.content, pass->binary.format, pass->binary.len, shname);
     MEM_SAFE_FREE(pass->binary.content);
+
+    if (pass->shader == NULL) {
+      /* The binary may come from the persistent cache and be rejected by the driver,
+       * remove the entry and compile from the sources instead. */
+      gpu_pass_disk_cache_remove(pass);
+      pass->shader = gpu_pass_shader_create(pass, shname);
+      success = (pass->shader != NULL);
+    }
   }
 
   return success;
@@ -1298,6 +1362,7 @@ void GPU_pass_cache_garbage_collect(void)
 void GPU_pass_cache_init(void)
 {
   BLI_spin_init(&pass_cache_spin);
+  GPU_pass_cache_disk_init();
 }
 
 void GPU_pass_cache_free(void)
@@ -1311,6 +1376,7 @@ void GPU_pass_cache_free(void)
   BLI_spin_unlock(&pass_cache_spin);
 
   BLI_spin_end(&pass_cache_spin);
+  GPU_pass_cache_disk_exit();
 }
 
 /* Module */
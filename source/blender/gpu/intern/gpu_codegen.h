@@ -63,6 +63,13 @@ struct GPUShader *GPU_pass_shader_get(GPUPass *pass);
 bool GPU_pass_compile(GPUPass *pass, const char *shname);
 void GPU_pass_release(GPUPass *pass);
 
+/* Persistent disk cache, see gpu_pass_disk_cache.c */
+
+bool gpu_pass_disk_cache_enabled(void);
+bool gpu_pass_disk_cache_load(const GPUPass *pass, char **r_binary, uint *r_format, int *r_len);
+void gpu_pass_disk_cache_store(const GPUPass *pass, const char *binary, uint format, int len);
+void gpu_pass_disk_cache_remove(const GPUPass *pass);
+
 /* Module */
 
 void gpu_codegen_init(void);
@@ -0,0 +1,421 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup gpu
+ *
+ * Persistent on-disk cache of linked GPUPass program binaries.
+ *
+ * Entries are keyed by an MD5 digest of the full generated GLSL sources, the driver
+ * identification string and the cache/Blender version, so a binary is only ever reused
+ * with the exact same code on the exact same driver. Each file starts with a small header
+ * that is validated before the binary is handed to the driver, and the total size of the
+ * cache directory is kept under the limit set in the preferences by removing the least
+ * recently used entries.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "atomic_ops.h"
+
+#include "BLI_dynstr.h"
+#include "BLI_fileops.h"
+#include "BLI_fileops_types.h"
+#include "BLI_hash_md5.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_userdef_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_blender_version.h"
+
+#include "GPU_glew.h"
+#include "GPU_material.h"
+#include "GPU_platform.h"
+
+#include "gpu_codegen.h"
+
+/* Bump when the file layout or the way keys are generated changes. */
+#define GPU_PASS_DISK_CACHE_VERSION 1
+#define GPU_PASS_DISK_CACHE_EXT ".glbin"
+
+/* When trimming, remove entries until the cache is below this fraction of the limit,
+ * to avoid rescanning the directory on every store once the cache is full. */
+#define GPU_PASS_DISK_CACHE_TRIM_FACTOR 0.9
+
+typedef struct GPUPassDiskCacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t blender_version;
+  /** MD5 digest of the sources and driver, also used as file name. */
+  uchar key[16];
+  uint32_t binary_format;
+  uint32_t binary_len;
+  /** Checksum of the binary, to catch truncated or corrupted files. */
+  uint32_t binary_hash;
+  uint32_t _pad;
+} GPUPassDiskCacheHeader;
+
+static const char gpu_pass_disk_cache_magic[8] = {'B', 'L', 'G', 'P', 'U', 'P', 'A', 'S'};
+
+static struct {
+  /** Read without locking by shader compile threads, only modify with atomics. */
+  int32_t enabled;
+  /** Settings and size are protected by #g_disk_cache_mutex. */
+  char dirpath[FILE_MAX];
+  /** Maximum total size of the cache directory in bytes. */
+  size_t size_limit;
+  /** Current total size of the cache directory in bytes (approximate). */
+  size_t size_used;
+} g_disk_cache = {0};
+
+/* Not freed, the preferences may enable or disable the cache while shaders are compiled
+ * in other threads. */
+static ThreadMutex g_disk_cache_mutex = BLI_MUTEX_INITIALIZER;
+
+static bool gpu_pass_disk_cache_is_enabled(void)
+{
+  return atomic_fetch_and_add_int32(&g_disk_cache.enabled, 0) != 0;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Keys & Paths
+ * \{ */
+
+static void gpu_pass_disk_cache_key(const GPUPass *pass, uchar r_key[16])
+{
+  DynStr *ds = BLI_dynstr_new();
+  /* Separate every part by a character that can not appear in GLSL,
+   * so moving code from one stage to the other changes the key. */
+  BLI_dynstr_appendf(
+      ds, "%d.%d.%d\x01", GPU_PASS_DISK_CACHE_VERSION, BLENDER_VERSION, BLENDER_SUBVERSION);
+  BLI_dynstr_append(ds, GPU_platform_gpu_name());
+  BLI_dynstr_append(ds, "\x01");
+  BLI_dynstr_append(ds, pass->vertexcode);
+  BLI_dynstr_append(ds, "\x01");
+  if (pass->geometrycode) {
+    BLI_dynstr_append(ds, pass->geometrycode);
+  }
+  BLI_dynstr_append(ds, "\x01");
+  BLI_dynstr_append(ds, pass->fragmentcode);
+  BLI_dynstr_append(ds, "\x01");
+  if (pass->defines) {
+    BLI_dynstr_append(ds, pass->defines);
+  }
+
+  const int len = BLI_dynstr_get_len(ds);
+  char *str = BLI_dynstr_get_cstring(ds);
+  BLI_dynstr_free(ds);
+
+  BLI_hash_md5_buffer(str, (size_t)len, r_key);
+  MEM_freeN(str);
+}
+
+/**
+ * Get the file path of the entry and the size limit of the cache.
+ * Returns false when the cache got disabled.
+ */
+static bool gpu_pass_disk_cache_filepath(const uchar key[16],
+                                         char r_filepath[FILE_MAX],
+                                         size_t *r_size_limit)
+{
+  char hex[33];
+  BLI_hash_md5_to_hexdigest((void *)key, hex);
+  char filename[FILE_MAXFILE];
+  BLI_snprintf(filename, sizeof(filename), "%s" GPU_PASS_DISK_CACHE_EXT, hex);
+
+  BLI_mutex_lock(&g_disk_cache_mutex);
+  const bool enabled = gpu_pass_disk_cache_is_enabled();
+  if (enabled) {
+    BLI_join_dirfile(r_filepath, FILE_MAX, g_disk_cache.dirpath, filename);
+    if (r_size_limit) {
+      *r_size_limit = g_disk_cache.size_limit;
+    }
+  }
+  BLI_mutex_unlock(&g_disk_cache_mutex);
+
+  return enabled;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Size Limit
+ * \{ */
+
+typedef struct DiskCacheEntry {
+  const char *path;
+  size_t size;
+  int64_t mtime;
+} DiskCacheEntry;
+
+static int gpu_pass_disk_cache_entry_cmp(const void *a_v, const void *b_v)
+{
+  const DiskCacheEntry *a = a_v;
+  const DiskCacheEntry *b = b_v;
+  /* Oldest first. */
+  if (a->mtime < b->mtime) {
+    return -1;
+  }
+  if (a->mtime > b->mtime) {
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Scan the cache directory, update the used size and remove the least recently
+ * used entries until the cache fits in \a size_target.
+ * Must be called with #g_disk_cache_mutex locked.
+ */
+static void gpu_pass_disk_cache_trim(size_t size_target)
+{
+  struct direntry *filelist;
+  const uint filelist_len = BLI_filelist_dir_contents(g_disk_cache.dirpath, &filelist);
+
+  DiskCacheEntry *entries = MEM_mallocN(sizeof(*entries) * MAX2(filelist_len, 1), __func__);
+  uint entries_len = 0;
+  size_t size_used = 0;
+
+  for (uint i = 0; i < filelist_len; i++) {
+    const struct direntry *file = &filelist[i];
+    if (!S_ISREG(file->s.st_mode) ||
+        !BLI_path_extension_check(file->relname, GPU_PASS_DISK_CACHE_EXT)) {
+      continue;
+    }
+    DiskCacheEntry *entry = &entries[entries_len++];
+    entry->path = file->path;
+    entry->size = (size_t)file->s.st_size;
+    entry->mtime = (int64_t)file->s.st_mtime;
+    size_used += entry->size;
+  }
+
+  if (size_used > size_target) {
+    qsort(entries, entries_len, sizeof(*entries), gpu_pass_disk_cache_entry_cmp);
+    for (uint i = 0; i < entries_len && size_used > size_target; i++) {
+      if (BLI_delete(entries[i].path, false, false) == 0) {
+        size_used -= entries[i].size;
+      }
+    }
+  }
+
+  g_disk_cache.size_used = size_used;
+
+  MEM_freeN(entries);
+  BLI_filelist_free(filelist, filelist_len);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+/**
+ * Enable or disable the persistent cache according to the user preferences.
+ * Needs an OpenGL context, as the driver capabilities are checked.
+ */
+void GPU_pass_cache_disk_init(void)
+{
+  GPU_pass_cache_disk_exit();
+
+  if ((U.gpu_flag & USER_GPU_FLAG_SHADER_DISK_CACHE) == 0 || U.gpu_shader_cache_size <= 0) {
+    return;
+  }
+
+  if (!GLEW_ARB_get_program_binary) {
+    return;
+  }
+
+  /* Some drivers expose the extension without supporting any binary format. */
+  int formats_len = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats_len);
+  if (formats_len == 0) {
+    return;
+  }
+
+  const char *dirpath = BKE_appdir_folder_id_create(BLENDER_USER_DATAFILES, "shader_cache");
+  if (dirpath == NULL) {
+    fprintf(stderr, "GPUPass disk cache: unable to create cache directory\n");
+    return;
+  }
+
+  BLI_mutex_lock(&g_disk_cache_mutex);
+  BLI_strncpy(g_disk_cache.dirpath, dirpath, sizeof(g_disk_cache.dirpath));
+  g_disk_cache.size_limit = (size_t)U.gpu_shader_cache_size * 1024 * 1024;
+  gpu_pass_disk_cache_trim(g_disk_cache.size_limit);
+  atomic_fetch_and_or_int32(&g_disk_cache.enabled, 1);
+  BLI_mutex_unlock(&g_disk_cache_mutex);
+}
+
+void GPU_pass_cache_disk_exit(void)
+{
+  BLI_mutex_lock(&g_disk_cache_mutex);
+  atomic_fetch_and_and_int32(&g_disk_cache.enabled, 0);
+  BLI_mutex_unlock(&g_disk_cache_mutex);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Load & Store
+ * \{ */
+
+bool gpu_pass_disk_cache_enabled(void)
+{
+  return gpu_pass_disk_cache_is_enabled();
+}
+
+/**
+ * Lookup the binary of \a pass in the persistent cache.
+ * On success \a r_binary is a newly allocated buffer owned by the caller.
+ */
+bool gpu_pass_disk_cache_load(const GPUPass *pass, char **r_binary, uint *r_format, int *r_len)
+{
+  if (!gpu_pass_disk_cache_is_enabled()) {
+    return false;
+  }
+
+  uchar key[16];
+  char filepath[FILE_MAX];
+  size_t size_limit;
+  gpu_pass_disk_cache_key(pass, key);
+  if (!gpu_pass_disk_cache_filepath(key, filepath, &size_limit)) {
+    return false;
+  }
+
+  FILE *file = BLI_fopen(filepath, "rb");
+  if (file == NULL) {
+    return false;
+  }
+
+  GPUPassDiskCacheHeader header;
+  bool valid = (fread(&header, sizeof(header), 1, file) == 1);
+
+  valid = valid && (memcmp(header.magic, gpu_pass_disk_cache_magic, sizeof(header.magic)) == 0);
+  valid = valid && (header.version == GPU_PASS_DISK_CACHE_VERSION);
+  valid = valid && (header.blender_version == BLENDER_VERSION);
+  valid = valid && (memcmp(header.key, key, sizeof(key)) == 0);
+  valid = valid && (header.binary_len > 0) &&
+          ((size_t)header.binary_len + sizeof(header) <= size_limit);
+
+  char *binary = NULL;
+  if (valid) {
+    binary = MEM_mallocN(header.binary_len, __func__);
+    valid = (fread(binary, header.binary_len, 1, file) == 1);
+    /* The file must not contain anything after the binary. */
+    valid = valid && (fgetc(file) == EOF);
+    valid = valid && (BLI_hash_mm2((uchar *)binary, header.binary_len, 0) == header.binary_hash);
+  }
+  fclose(file);
+
+  if (!valid) {
+    MEM_SAFE_FREE(binary);
+    /* Remove corrupted or outdated entry, it would never match again. */
+    gpu_pass_disk_cache_remove(pass);
+    return false;
+  }
+
+  /* Mark as recently used. */
+  BLI_file_touch(filepath);
+
+  *r_binary = binary;
+  *r_format = header.binary_format;
+  *r_len = (int)header.binary_len;
+  return true;
+}
+
+/** Write the binary of a successfully compiled \a pass to the persistent cache. */
+void gpu_pass_disk_cache_store(const GPUPass *pass, const char *binary, uint format, int len)
+{
+  if (!gpu_pass_disk_cache_is_enabled() || binary == NULL || len <= 0) {
+    return;
+  }
+
+  GPUPassDiskCacheHeader header = {{0}};
+  memcpy(header.magic, gpu_pass_disk_cache_magic, sizeof(header.magic));
+  header.version = GPU_PASS_DISK_CACHE_VERSION;
+  header.blender_version = BLENDER_VERSION;
+  gpu_pass_disk_cache_key(pass, header.key);
+  header.binary_format = format;
+  header.binary_len = (uint32_t)len;
+  header.binary_hash = BLI_hash_mm2((const uchar *)binary, (size_t)len, 0);
+
+  char filepath[FILE_MAX], filepath_tmp[FILE_MAX];
+  size_t size_limit;
+  if (!gpu_pass_disk_cache_filepath(header.key, filepath, &size_limit)) {
+    return;
+  }
+
+  const size_t file_size = sizeof(GPUPassDiskCacheHeader) + (size_t)len;
+  if (file_size > size_limit) {
+    return;
+  }
+  /* Write to a temporary file first so other Blender instances never read partial files. */
+  BLI_snprintf(filepath_tmp, sizeof(filepath_tmp), "%s.%p.tmp", filepath, (void *)pass);
+
+  FILE *file = BLI_fopen(filepath_tmp, "wb");
+  if (file == NULL) {
+    return;
+  }
+  bool ok = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+            (fwrite(binary, (size_t)len, 1, file) == 1);
+  ok = (fclose(file) == 0) && ok;
+
+  if (!ok || BLI_rename(filepath_tmp, filepath) != 0) {
+    BLI_delete(filepath_tmp, false, false);
+    return;
+  }
+
+  BLI_mutex_lock(&g_disk_cache_mutex);
+  g_disk_cache.size_used += file_size;
+  if (gpu_pass_disk_cache_is_enabled() && g_disk_cache.size_used > g_disk_cache.size_limit) {
+    gpu_pass_disk_cache_trim((size_t)(g_disk_cache.size_limit * GPU_PASS_DISK_CACHE_TRIM_FACTOR));
+  }
+  BLI_mutex_unlock(&g_disk_cache_mutex);
+}
+
+/** Remove the entry of \a pass, used when the driver rejects a cached binary. */
+void gpu_pass_disk_cache_remove(const GPUPass *pass)
+{
+  if (!gpu_pass_disk_cache_is_enabled()) {
+    return;
+  }
+
+  uchar key[16];
+  char filepath[FILE_MAX];
+  gpu_pass_disk_cache_key(pass, key);
+  if (!gpu_pass_disk_cache_filepath(key, filepath, NULL)) {
+    return;
+  }
+
+  if (BLI_exists(filepath)) {
+    BLI_delete(filepath, false, false);
+  }
+}
+
+/** \} */
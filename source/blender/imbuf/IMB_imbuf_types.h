@@ -170,6 +170,8 @@ typedef enum eImBufFlags {
   IB_thumbnail = 1 << 16,
   IB_multiview = 1 << 17,
   IB_halffloat = 1 << 18,
+  /** only read the layers and passes of multilayer files, see #IMB_exr_read_passes */
+  IB_multilayer_deferred = 1 << 19,
 } eImBufFlags;
 
 /** \} */
@@ -137,6 +137,9 @@ struct anim {
   int64_t last_pts;
   int64_t next_pts;
   AVPacket next_packet;
+
+  /* recently decoded frames, see anim_movie.c */
+  struct AnimFrameCache *frame_cache;
 #endif
 
   char index_dir[768];
@@ -53,12 +53,16 @@
 #  include <io.h>
 #endif
 
+#include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
 
+#include "MEM_CacheLimiterC-Api.h"
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #ifdef WITH_AVI
 #  include "AVI_avi.h"
 #endif
@@ -486,6 +490,175 @@ BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
   return (anim->x & 31) != 0;
 }
 
+/* Decoded Frame Cache
+ *
+ * Seeking decodes all frames from the previous keyframe up to the requested one. Keep the
+ * frames decoded while scanning to the requested one, so stepping backwards or scrubbing within
+ * recent GOPs does not decode the same frames again. Frames decoded during sequential playback
+ * are not cached. Frames are stored before color conversion, which is done when a frame is
+ * fetched from the cache.
+ *
+ * All open anims share a budget, which is a fraction of the memory cache limit. */
+
+#  define ANIM_FRAME_CACHE_LIMIT_FRACTION 8
+
+/* Size of the cached frames of all anims. */
+static size_t anim_frame_cache_total_size = 0;
+
+static size_t ffmpeg_frame_cache_limit(void)
+{
+  return MEM_CacheLimiter_get_maximum() / ANIM_FRAME_CACHE_LIMIT_FRACTION;
+}
+
+typedef struct AnimFrameCacheEntry {
+  struct AnimFrameCacheEntry *next, *prev;
+  AVFrame *frame;
+  int64_t pts;
+  /* PTS of the frame decoded after this one, or pts + 1 if not known. */
+  int64_t pts_next;
+  size_t size;
+} AnimFrameCacheEntry;
+
+typedef struct AnimFrameCache {
+  /* Most recently used first. */
+  ListBase entries;
+  /* Last frame decoded without seeking in between, its end is set by the next frame. */
+  AnimFrameCacheEntry *last_decoded;
+  size_t size;
+  /* Decoding up to a requested frame after a seek, only these frames are cached. */
+  bool is_scanning;
+} AnimFrameCache;
+
+static void ffmpeg_frame_cache_entry_free(AnimFrameCache *cache, AnimFrameCacheEntry *entry)
+{
+  if (cache->last_decoded == entry) {
+    cache->last_decoded = NULL;
+  }
+  cache->size -= entry->size;
+  atomic_sub_and_fetch_z(&anim_frame_cache_total_size, entry->size);
+  av_frame_free(&entry->frame);
+  BLI_freelinkN(&cache->entries, entry);
+}
+
+static void ffmpeg_frame_cache_free(struct anim *anim)
+{
+  AnimFrameCache *cache = anim->frame_cache;
+
+  if (cache == NULL) {
+    return;
+  }
+
+  while (cache->entries.first) {
+    ffmpeg_frame_cache_entry_free(cache, cache->entries.first);
+  }
+  MEM_freeN(cache);
+  anim->frame_cache = NULL;
+}
+
+static AnimFrameCache *ffmpeg_frame_cache_ensure(struct anim *anim)
+{
+  if (anim->frame_cache == NULL) {
+    anim->frame_cache = MEM_callocN(sizeof(AnimFrameCache), "AnimFrameCache");
+  }
+  return anim->frame_cache;
+}
+
+/* Store the frame that was just decoded into anim->pFrame. */
+static void ffmpeg_frame_cache_add(struct anim *anim)
+{
+  AnimFrameCache *cache = anim->frame_cache;
+  const int64_t pts = anim->next_pts;
+  AnimFrameCacheEntry *entry;
+
+  if (cache == NULL) {
+    return;
+  }
+
+  if (!cache->is_scanning) {
+    /* Still ends the cached frame decoded before. */
+    if (cache->last_decoded && cache->last_decoded->pts < pts) {
+      cache->last_decoded->pts_next = pts;
+    }
+    cache->last_decoded = NULL;
+    return;
+  }
+
+  for (entry = cache->entries.first; entry; entry = entry->next) {
+    if (entry->pts == pts) {
+      break;
+    }
+  }
+
+  if (cache->last_decoded && cache->last_decoded != entry && cache->last_decoded->pts < pts) {
+    cache->last_decoded->pts_next = pts;
+  }
+
+  if (entry == NULL) {
+    const size_t size = avpicture_get_size(
+        anim->pFrame->format, anim->pFrame->width, anim->pFrame->height);
+    const size_t limit = ffmpeg_frame_cache_limit();
+    if (size > limit / 2) {
+      cache->last_decoded = NULL;
+      return;
+    }
+
+    /* Make room by removing the least recently used frames of this anim. */
+    while (atomic_add_and_fetch_z(&anim_frame_cache_total_size, 0) + size > limit &&
+           cache->entries.last) {
+      ffmpeg_frame_cache_entry_free(cache, cache->entries.last);
+    }
+    if (atomic_add_and_fetch_z(&anim_frame_cache_total_size, 0) + size > limit) {
+      cache->last_decoded = NULL;
+      return;
+    }
+
+    /* Frames are owned by the decoder, so this copies the data. */
+    AVFrame *frame = av_frame_clone(anim->pFrame);
+    if (frame == NULL) {
+      cache->last_decoded = NULL;
+      return;
+    }
+
+    entry = MEM_callocN(sizeof(AnimFrameCacheEntry), "AnimFrameCacheEntry");
+    entry->frame = frame;
+    entry->pts = pts;
+    entry->pts_next = pts + 1;
+    entry->size = size;
+    cache->size += size;
+    atomic_add_and_fetch_z(&anim_frame_cache_total_size, size);
+    BLI_addhead(&cache->entries, entry);
+  }
+
+  cache->last_decoded = entry;
+}
+
+/* The decoder continues somewhere else, frames decoded next do not follow the last one. */
+static void ffmpeg_frame_cache_seek(struct anim *anim)
+{
+  if (anim->frame_cache) {
+    anim->frame_cache->last_decoded = NULL;
+  }
+}
+
+static AVFrame *ffmpeg_frame_cache_lookup(struct anim *anim, int64_t pts)
+{
+  AnimFrameCache *cache = anim->frame_cache;
+
+  if (cache == NULL) {
+    return NULL;
+  }
+
+  LISTBASE_FOREACH (AnimFrameCacheEntry *, entry, &cache->entries) {
+    if (entry->pts <= pts && pts < entry->pts_next) {
+      BLI_remlink(&cache->entries, entry);
+      BLI_addhead(&cache->entries, entry);
+      return entry->frame;
+    }
+  }
+
+  return NULL;
+}
+
 static int startffmpeg(struct anim *anim)
 {
   int i, video_stream_index;
@@ -727,22 +900,16 @@ static int startffmpeg(struct anim *anim)
   return (0);
 }
 
-/* postprocess the image in anim->pFrame and do color conversion
+/* postprocess the decoded image and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->last_frame
+ * Output is ibuf
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static void ffmpeg_postprocess(struct anim *anim, AVFrame *input, ImBuf *ibuf)
 {
-  AVFrame *input = anim->pFrame;
-  ImBuf *ibuf = anim->last_frame;
   int filter_y = 0;
 
-  if (!anim->pFrameComplete) {
-    return;
-  }
-
   /* This means the data wasn't read properly,
    * this check stops crashing */
   if (input->data[0] == 0 && input->data[1] == 0 && input->data[2] == 0 && input->data[3] == 0) {
@@ -762,7 +929,7 @@ static void ffmpeg_postprocess(struct anim *anim)
 
   if (anim->ib_flags & IB_animdeinterlace) {
     if (avpicture_deinterlace((AVPicture *)anim->pFrameDeinterlaced,
-                              (const AVPicture *)anim->pFrame,
+                              (const AVPicture *)input,
                               anim->pCodecCtx->pix_fmt,
                               anim->pCodecCtx->width,
                               anim->pCodecCtx->height) < 0) {
@@ -889,6 +1056,7 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 
       if (anim->pFrameComplete) {
         anim->next_pts = av_get_pts_from_frame(anim->pFormatCtx, anim->pFrame);
+        ffmpeg_frame_cache_add(anim);
 
         av_log(anim->pFormatCtx,
                AV_LOG_DEBUG,
@@ -924,6 +1092,7 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 
     if (anim->pFrameComplete) {
       anim->next_pts = av_get_pts_from_frame(anim->pFormatCtx, anim->pFrame);
+      ffmpeg_frame_cache_add(anim);
 
       av_log(anim->pFormatCtx,
              AV_LOG_DEBUG,
@@ -960,6 +1129,9 @@ static void ffmpeg_decode_video_frame_scan(struct anim *anim, int64_t pts_to_sea
          (long long int)anim->next_pts,
          (long long int)pts_to_search);
 
+  AnimFrameCache *cache = ffmpeg_frame_cache_ensure(anim);
+  cache->is_scanning = true;
+
   while (count > 0 && anim->next_pts < pts_to_search) {
     av_log(anim->pFormatCtx,
            AV_LOG_DEBUG,
@@ -971,6 +1143,8 @@ static void ffmpeg_decode_video_frame_scan(struct anim *anim, int64_t pts_to_sea
     }
     count--;
   }
+  cache->is_scanning = false;
+
   if (count == 0) {
     av_log(anim->pFormatCtx,
            AV_LOG_ERROR,
@@ -1105,6 +1279,19 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     ffmpeg_decode_video_frame_scan(anim, pts_to_search);
   }
   else if (position != anim->curposition + 1) {
+    /* Use the decoded frame instead of seeking when it is still cached. The decoder state and
+     * its position in curposition are left untouched, so following requests continue or seek
+     * from where the decoder is. */
+    AVFrame *cached_frame = ffmpeg_frame_cache_lookup(anim, pts_to_search);
+    if (cached_frame) {
+      av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: decoded frame cache hit\n");
+
+      ImBuf *ibuf = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
+      ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+      ffmpeg_postprocess(anim, cached_frame, ibuf);
+      return ibuf;
+    }
+
     long long pos;
     int ret;
 
@@ -1163,6 +1350,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     }
 
     avcodec_flush_buffers(anim->pCodecCtx);
+    ffmpeg_frame_cache_seek(anim);
 
     anim->next_pts = -1;
 
@@ -1189,7 +1377,9 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
   anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
 
-  ffmpeg_postprocess(anim);
+  if (anim->pFrameComplete) {
+    ffmpeg_postprocess(anim, anim->pFrame, anim->last_frame);
+  }
 
   anim->last_pts = anim->next_pts;
 
@@ -1232,6 +1422,7 @@ static void free_anim_ffmpeg(struct anim *anim)
 
     sws_freeContext(anim->img_convert_ctx);
     IMB_freeImBuf(anim->last_frame);
+    ffmpeg_frame_cache_free(anim);
     if (anim->next_packet.stream_index != -1) {
       av_free_packet(&anim->next_packet);
     }
@@ -1388,10 +1579,8 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
 #endif
 #ifdef WITH_FFMPEG
     case ANIM_FFMPEG:
+      /* curposition is the position of the decoder, which is updated while fetching. */
       ibuf = ffmpeg_fetchibuf(anim, position, tc);
-      if (ibuf) {
-        anim->curposition = position;
-      }
       filter_y = 0; /* done internally */
       break;
 #endif
@@ -1401,7 +1590,7 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
     if (filter_y) {
       IMB_filtery(ibuf);
     }
-    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, anim->curposition + 1);
+    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, position + 1);
   }
   return (ibuf);
 }
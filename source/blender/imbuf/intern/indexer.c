@@ -29,6 +29,7 @@
 #include "BLI_ghash.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #ifdef _WIN32
 #  include "BLI_winstuff.h"
@@ -445,6 +446,10 @@ typedef struct IndexBuildContext {
 
 #ifdef WITH_FFMPEG
 
+/* Decoded frames handed over to each proxy encoder thread, the decoder waits when an encoder
+ * falls this many frames behind. */
+#  define PROXY_MAX_QUEUED_FRAMES 4
+
 struct proxy_output_ctx {
   AVFormatContext *of;
   AVStream *st;
@@ -456,6 +461,12 @@ struct proxy_output_ctx {
   int proxy_size;
   int orig_height;
   struct anim *anim;
+
+  /* Scaling and encoding runs on its own thread, frames are passed through the queue and
+   * recycled through the free queue once encoded. */
+  ThreadQueue *frame_queue;
+  ThreadQueue *free_queue;
+  AVFrame *queued_frames[PROXY_MAX_QUEUED_FRAMES];
 };
 
 // work around stupid swscaler 16 bytes alignment bug...
@@ -499,6 +510,11 @@ static struct proxy_output_ctx *alloc_proxy_output_ffmpeg(
   rv->c->width = width;
   rv->c->height = height;
 
+  /* MJPEG only has intra frames, so proxies are quick to seek. The encoder splits frames into
+   * slices to spread encoding of each frame over multiple threads. */
+  rv->c->thread_count = BLI_system_thread_count();
+  rv->c->thread_type = FF_THREAD_SLICE;
+
   rv->of->oformat->video_codec = rv->c->codec_id;
   rv->codec = avcodec_find_encoder(rv->c->codec_id);
 
@@ -686,6 +702,63 @@ static void free_proxy_output_ffmpeg(struct proxy_output_ctx *ctx, int rollback)
   MEM_freeN(ctx);
 }
 
+static void *proxy_output_thread_ffmpeg(void *ctx_v)
+{
+  struct proxy_output_ctx *ctx = ctx_v;
+  AVFrame *frame;
+
+  while ((frame = BLI_thread_queue_pop(ctx->frame_queue))) {
+    add_to_proxy_output_ffmpeg(ctx, frame);
+    av_frame_unref(frame);
+    BLI_thread_queue_push(ctx->free_queue, frame);
+  }
+
+  return NULL;
+}
+
+static void start_proxy_output_thread_ffmpeg(struct proxy_output_ctx *ctx, ListBase *threads)
+{
+  int i;
+
+  ctx->frame_queue = BLI_thread_queue_init();
+  ctx->free_queue = BLI_thread_queue_init();
+
+  for (i = 0; i < PROXY_MAX_QUEUED_FRAMES; i++) {
+    ctx->queued_frames[i] = av_frame_alloc();
+    BLI_thread_queue_push(ctx->free_queue, ctx->queued_frames[i]);
+  }
+
+  BLI_threadpool_insert(threads, ctx);
+}
+
+static void queue_proxy_output_ffmpeg(struct proxy_output_ctx *ctx, AVFrame *frame)
+{
+  /* Blocks until the encoder thread is done with one of the earlier frames. */
+  AVFrame *queued_frame = BLI_thread_queue_pop(ctx->free_queue);
+
+  /* Decoded frames are reference counted, so this does not copy the picture. */
+  if (av_frame_ref(queued_frame, frame) < 0) {
+    BLI_thread_queue_push(ctx->free_queue, queued_frame);
+    return;
+  }
+
+  BLI_thread_queue_push(ctx->frame_queue, queued_frame);
+}
+
+static void end_proxy_output_thread_ffmpeg(struct proxy_output_ctx *ctx)
+{
+  int i;
+
+  for (i = 0; i < PROXY_MAX_QUEUED_FRAMES; i++) {
+    av_frame_free(&ctx->queued_frames[i]);
+  }
+
+  BLI_thread_queue_free(ctx->frame_queue);
+  BLI_thread_queue_free(ctx->free_queue);
+  ctx->frame_queue = NULL;
+  ctx->free_queue = NULL;
+}
+
 typedef struct FFmpegIndexBuilderContext {
   int anim_type;
 
@@ -701,6 +774,9 @@ typedef struct FFmpegIndexBuilderContext {
   struct proxy_output_ctx *proxy_ctx[IMB_PROXY_MAX_SLOT];
   anim_index_builder *indexer[IMB_TC_MAX_SLOT];
 
+  /* One encoder thread per proxy size, while frames are decoded on the calling thread. */
+  ListBase proxy_threads;
+
   IMB_Timecode_Type tcs_in_use;
   IMB_Proxy_Size proxy_sizes_in_use;
 
@@ -780,6 +856,14 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
 
   context->iCodecCtx->workaround_bugs = 1;
 
+  /* Frame threading delays the output of decoded frames, which would make them get recorded
+   * with the seek position of a later key frame. Only use it when no time codes are built. */
+  context->iCodecCtx->thread_count = BLI_system_thread_count();
+  context->iCodecCtx->thread_type = FF_THREAD_SLICE;
+  if (tcs_in_use == 0) {
+    context->iCodecCtx->thread_type |= FF_THREAD_FRAME;
+  }
+
   if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
     avformat_close_input(&context->iFormatCtx);
     MEM_freeN(context);
@@ -849,7 +933,9 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
   unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
   for (i = 0; i < context->num_proxy_sizes; i++) {
-    add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+    if (context->proxy_ctx[i]) {
+      queue_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+    }
   }
 
   if (!context->start_pts_set) {
@@ -901,11 +987,21 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
   AVFrame *in_frame = 0;
   AVPacket next_packet;
   uint64_t stream_size;
+  int i;
 
   memset(&next_packet, 0, sizeof(AVPacket));
 
   in_frame = av_frame_alloc();
 
+  BLI_threadpool_init(
+      &context->proxy_threads, proxy_output_thread_ffmpeg, context->num_proxy_sizes);
+
+  for (i = 0; i < context->num_proxy_sizes; i++) {
+    if (context->proxy_ctx[i]) {
+      start_proxy_output_thread_ffmpeg(context->proxy_ctx[i], &context->proxy_threads);
+    }
+  }
+
   stream_size = avio_size(context->iFormatCtx->pb);
 
   context->frame_rate = av_q2d(av_guess_frame_rate(context->iFormatCtx, context->iStream, NULL));
@@ -966,7 +1062,22 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
     } while (frame_finished);
   }
 
-  av_free(in_frame);
+  /* Let the encoder threads finish the frames still in their queue. */
+  for (i = 0; i < context->num_proxy_sizes; i++) {
+    if (context->proxy_ctx[i]) {
+      BLI_thread_queue_nowait(context->proxy_ctx[i]->frame_queue);
+    }
+  }
+
+  BLI_threadpool_end(&context->proxy_threads);
+
+  for (i = 0; i < context->num_proxy_sizes; i++) {
+    if (context->proxy_ctx[i]) {
+      end_proxy_output_thread_ffmpeg(context->proxy_ctx[i]);
+    }
+  }
+
+  av_frame_free(&in_frame);
 
   return 1;
 }
@@ -102,6 +102,12 @@ using namespace Imath;
 extern "C" {
 /* prototype */
 static struct ExrPass *imb_exr_get_pass(ListBase *lb, char *passname);
+static void imb_exr_pass_alloc(struct ExrPass *pass, int width, int height);
+static struct ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
+                                                MultiPartInputFile &file,
+                                                int width,
+                                                int height,
+                                                const bool alloc_passes);
 static bool exr_has_multiview(MultiPartInputFile &file);
 static bool exr_has_multipart_file(MultiPartInputFile &file);
 static bool exr_has_alpha(MultiPartInputFile &file);
@@ -647,6 +653,8 @@ typedef struct ExrHandle {
   ListBase layers;   /* hierarchical, pointing in end to ExrChannel */
 
   int num_half_channels; /* used during filr save, allows faster temporary buffers allocation */
+
+  bool read_partial; /* only some passes have memory assigned for reading */
 } ExrHandle;
 
 /* flattened out channel */
@@ -1236,6 +1244,7 @@ void IMB_exr_read_channels(void *handle)
     /* Insert all matching channel into framebuffer. */
     FrameBuffer frameBuffer;
     ExrChannel *echan;
+    int num_slices = 0;
 
     for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
       if (echan->m->part_number != i) {
@@ -1267,12 +1276,18 @@ void IMB_exr_read_channels(void *handle)
 
         frameBuffer.insert(echan->m->internal_name,
                            Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+        num_slices++;
       }
-      else {
+      else if (!data->read_partial) {
         printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
       }
     }
 
+    /* Parts without any requested channels don't need to be decoded at all. */
+    if (num_slices == 0 && data->read_partial) {
+      continue;
+    }
+
     /* Read pixels. */
     try {
       in.setFrameBuffer(frameBuffer);
@@ -1286,6 +1301,95 @@ void IMB_exr_read_channels(void *handle)
   }
 }
 
+/* Read the given passes of a multilayer file, with a single read of the file. Only the requested
+ * passes are allocated, though OpenEXR still decompresses all channels of the scanlines. Each
+ * pass gets its interleaved channels in a newly allocated rect, or NULL when the pass is not in
+ * the file or doesn't match the given channels anymore. Returns false when the file can't be
+ * read or its size doesn't match. */
+bool IMB_exr_read_passes(const char *filepath,
+                         int width,
+                         int height,
+                         ExrReadPass *passes,
+                         int passes_len)
+{
+  IFileStream *file_stream = NULL;
+  MultiPartInputFile *file = NULL;
+
+  for (int i = 0; i < passes_len; i++) {
+    passes[i].rect = NULL;
+  }
+
+  /* 32 is arbitrary, but zero length files crashes exr. */
+  if (!BLI_exists(filepath) || BLI_file_size(filepath) <= 32) {
+    return false;
+  }
+
+  try {
+    file_stream = new IFileStream(filepath);
+    file = new MultiPartInputFile(*file_stream);
+  }
+  catch (const std::exception &exc) {
+    std::cerr << exc.what() << std::endl;
+    delete file;
+    delete file_stream;
+    return false;
+  }
+
+  Box2i dw = file->header(0).dataWindow();
+  if (dw.max.x - dw.min.x + 1 != width || dw.max.y - dw.min.y + 1 != height) {
+    /* File was changed since its layers were read. */
+    delete file;
+    delete file_stream;
+    return false;
+  }
+
+  /* The handle takes ownership of the file. */
+  ExrHandle *data = imb_exr_begin_read_mem(*file_stream, *file, width, height, false);
+  if (data == NULL) {
+    return false;
+  }
+
+  std::vector<ExrPass *> exr_passes(passes_len, NULL);
+  bool any_pass = false;
+
+  for (int i = 0; i < passes_len; i++) {
+    ExrLayer *lay = (ExrLayer *)BLI_findstring(
+        &data->layers, passes[i].layname, offsetof(ExrLayer, name));
+    if (lay == NULL) {
+      continue;
+    }
+
+    for (ExrPass *pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
+      if (STREQ(pass->internal_name, passes[i].passname) &&
+          STREQ(pass->view, passes[i].viewname)) {
+        /* A pass requested twice is only returned once. */
+        if (pass->totchan == passes[i].totchan && pass->rect == NULL) {
+          imb_exr_pass_alloc(pass, width, height);
+          exr_passes[i] = pass;
+          any_pass = true;
+        }
+        break;
+      }
+    }
+  }
+
+  if (any_pass) {
+    data->read_partial = true;
+    IMB_exr_read_channels(data);
+
+    for (int i = 0; i < passes_len; i++) {
+      if (exr_passes[i]) {
+        passes[i].rect = exr_passes[i]->rect;
+        exr_passes[i]->rect = NULL;
+      }
+    }
+  }
+
+  IMB_exr_close(data);
+
+  return true;
+}
+
 void IMB_exr_multilayer_convert(void *handle,
                                 void *base,
                                 void *(*addview)(void *base, const char *str),
@@ -1527,17 +1631,91 @@ static ExrPass *imb_exr_get_pass(ListBase *lb, char *passname)
   return pass;
 }
 
-/* creates channels, makes a hierarchy and assigns memory to channels */
+/* Assign channels of a pass to their place in its interleaved rect, with some heuristics to
+ * order the channels. Without rect only the channel order is set. */
+static void imb_exr_pass_assign_channels(ExrPass *pass, float *rect, int width)
+{
+  ExrChannel *echan;
+  int a;
+
+  if (pass->totchan == 0) {
+    return;
+  }
+
+  if (pass->totchan == 1) {
+    echan = pass->chan[0];
+    echan->rect = rect;
+    echan->xstride = 1;
+    echan->ystride = width;
+    pass->chan_id[0] = echan->chan_id;
+  }
+  else {
+    char lookup[256];
+
+    memset(lookup, 0, sizeof(lookup));
+
+    /* we can have RGB(A), XYZ(W), UVA */
+    if (pass->totchan == 3 || pass->totchan == 4) {
+      if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
+          pass->chan[2]->chan_id == 'B') {
+        lookup[(unsigned int)'R'] = 0;
+        lookup[(unsigned int)'G'] = 1;
+        lookup[(unsigned int)'B'] = 2;
+        lookup[(unsigned int)'A'] = 3;
+      }
+      else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
+               pass->chan[2]->chan_id == 'Y') {
+        lookup[(unsigned int)'X'] = 0;
+        lookup[(unsigned int)'Y'] = 1;
+        lookup[(unsigned int)'Z'] = 2;
+        lookup[(unsigned int)'W'] = 3;
+      }
+      else {
+        lookup[(unsigned int)'U'] = 0;
+        lookup[(unsigned int)'V'] = 1;
+        lookup[(unsigned int)'A'] = 2;
+      }
+      for (a = 0; a < pass->totchan; a++) {
+        echan = pass->chan[a];
+        echan->rect = rect ? rect + lookup[(unsigned int)echan->chan_id] : NULL;
+        echan->xstride = pass->totchan;
+        echan->ystride = width * pass->totchan;
+        pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
+      }
+    }
+    else { /* unknown */
+      for (a = 0; a < pass->totchan; a++) {
+        echan = pass->chan[a];
+        echan->rect = rect ? rect + a : NULL;
+        echan->xstride = pass->totchan;
+        echan->ystride = width * pass->totchan;
+        pass->chan_id[a] = echan->chan_id;
+      }
+    }
+  }
+}
+
+/* Allocate memory for reading a pass. */
+static void imb_exr_pass_alloc(ExrPass *pass, int width, int height)
+{
+  if (pass->totchan) {
+    pass->rect = (float *)MEM_mapallocN(
+        (size_t)width * height * pass->totchan * sizeof(float), "pass rect");
+    imb_exr_pass_assign_channels(pass, pass->rect, width);
+  }
+}
+
+/* Creates channels, makes a hierarchy and optionally assigns memory to channels. */
 static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
                                          MultiPartInputFile &file,
                                          int width,
-                                         int height)
+                                         int height,
+                                         const bool alloc_passes)
 {
   ExrLayer *lay;
   ExrPass *pass;
   ExrChannel *echan;
   ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
-  int a;
   char layname[EXR_TOT_MAXNAME], passname[EXR_TOT_MAXNAME];
 
   data->ifile_stream = &file_stream;
@@ -1598,63 +1776,14 @@ static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
     return NULL;
   }
 
-  /* with some heuristics, try to merge the channels in buffers */
   for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
     for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
-      if (pass->totchan) {
-        pass->rect = (float *)MEM_mapallocN(width * height * pass->totchan * sizeof(float),
-                                            "pass rect");
-        if (pass->totchan == 1) {
-          echan = pass->chan[0];
-          echan->rect = pass->rect;
-          echan->xstride = 1;
-          echan->ystride = width;
-          pass->chan_id[0] = echan->chan_id;
-        }
-        else {
-          char lookup[256];
-
-          memset(lookup, 0, sizeof(lookup));
-
-          /* we can have RGB(A), XYZ(W), UVA */
-          if (pass->totchan == 3 || pass->totchan == 4) {
-            if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
-                pass->chan[2]->chan_id == 'B') {
-              lookup[(unsigned int)'R'] = 0;
-              lookup[(unsigned int)'G'] = 1;
-              lookup[(unsigned int)'B'] = 2;
-              lookup[(unsigned int)'A'] = 3;
-            }
-            else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
-                     pass->chan[2]->chan_id == 'Y') {
-              lookup[(unsigned int)'X'] = 0;
-              lookup[(unsigned int)'Y'] = 1;
-              lookup[(unsigned int)'Z'] = 2;
-              lookup[(unsigned int)'W'] = 3;
-            }
-            else {
-              lookup[(unsigned int)'U'] = 0;
-              lookup[(unsigned int)'V'] = 1;
-              lookup[(unsigned int)'A'] = 2;
-            }
-            for (a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + lookup[(unsigned int)echan->chan_id];
-              echan->xstride = pass->totchan;
-              echan->ystride = width * pass->totchan;
-              pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
-            }
-          }
-          else { /* unknown */
-            for (a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + a;
-              echan->xstride = pass->totchan;
-              echan->ystride = width * pass->totchan;
-              pass->chan_id[a] = echan->chan_id;
-            }
-          }
-        }
+      if (alloc_passes) {
+        imb_exr_pass_alloc(pass, width, height);
+      }
+      else {
+        /* Without memory the channel order is still needed to describe the pass. */
+        imb_exr_pass_assign_channels(pass, NULL, width);
       }
     }
   }
@@ -1952,9 +2081,12 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
         /* Only enters with IB_multilayer flag set. */
         if (is_multi && ((flags & IB_thumbnail) == 0)) {
           /* constructs channels for reading, allocates memory in channels */
-          ExrHandle *handle = imb_exr_begin_read_mem(*membuf, *file, width, height);
+          const bool read_pixels = (flags & IB_multilayer_deferred) == 0;
+          ExrHandle *handle = imb_exr_begin_read_mem(*membuf, *file, width, height, read_pixels);
           if (handle) {
-            IMB_exr_read_channels(handle);
+            if (read_pixels) {
+              IMB_exr_read_channels(handle);
+            }
             ibuf->userdata = handle; /* potential danger, the caller has to check for this! */
           }
         }
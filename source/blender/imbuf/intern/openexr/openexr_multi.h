@@ -40,6 +40,16 @@ extern "C" {
 
 struct StampData;
 
+/* Pass to read with #IMB_exr_read_passes. */
+typedef struct ExrReadPass {
+  const char *layname;
+  const char *passname;
+  const char *viewname;
+  int totchan;
+  /* Result, owned by the caller. */
+  float *rect;
+} ExrReadPass;
+
 void *IMB_exr_get_handle(void);
 void *IMB_exr_get_handle_name(const char *name);
 void IMB_exr_add_channel(void *handle,
@@ -73,6 +83,11 @@ float *IMB_exr_channel_rect(void *handle,
                             const char *view);
 
 void IMB_exr_read_channels(void *handle);
+bool IMB_exr_read_passes(const char *filepath,
+                         int width,
+                         int height,
+                         struct ExrReadPass *passes,
+                         int passes_len);
 void IMB_exr_write_channels(void *handle);
 void IMB_exrtile_write_channels(
     void *handle, int partx, int party, int level, const char *viewname, bool empty);
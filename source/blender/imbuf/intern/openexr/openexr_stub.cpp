@@ -88,6 +88,17 @@ float *IMB_exr_channel_rect(void * /*handle*/,
 void IMB_exr_read_channels(void * /*handle*/)
 {
 }
+bool IMB_exr_read_passes(const char * /*filepath*/,
+                         int /*width*/,
+                         int /*height*/,
+                         struct ExrReadPass *passes,
+                         int passes_len)
+{
+  for (int i = 0; i < passes_len; i++) {
+    passes[i].rect = NULL;
+  }
+  return false;
+}
 void IMB_exr_write_channels(void * /*handle*/)
 {
 }
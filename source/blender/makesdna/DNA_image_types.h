@@ -186,6 +186,10 @@ typedef struct Image {
   /** ImageView. */
   ListBase views;
   struct Stereo3dFormat *stereo3d_format;
+
+  /** Incremented when the pixels change, so caches of results using the image can tell. */
+  int update_count;
+  char _pad3[4];
 } Image;
 
 /* **************** IMAGE ********************* */
@@ -88,7 +88,8 @@ typedef struct Mesh_Runtime {
   void *batch_cache;
 
   struct SubdivCCG *subdiv_ccg;
-  void *_pad1;
+  /** Edit-mesh exposed by this mesh when #Mesh_Runtime.wrapper_type is #ME_WRAPPER_TYPE_BMESH. */
+  struct BMEditMesh *edit_mesh_wrap;
   int subdiv_ccg_tot_level;
   char _pad2[4];
 
@@ -97,6 +98,9 @@ typedef struct Mesh_Runtime {
   int64_t cd_dirty_loop;
   int64_t cd_dirty_poly;
 
+  /** Extra layers to copy when a #ME_WRAPPER_TYPE_BMESH wrapper is converted to mesh data. */
+  CustomData_MeshMasks cd_mask_extra;
+
   struct MLoopTri_Store looptris;
 
   /** 'BVHCache', for 'BKE_bvhutil.c' */
@@ -112,7 +116,10 @@ typedef struct Mesh_Runtime {
    * In the future we may leave the mesh-data empty
    * since its not needed if we can use edit-mesh data. */
   char is_original;
-  char _pad[6];
+
+  /** #eMeshWrapperType, see `BKE_mesh_wrapper.h`. */
+  char wrapper_type;
+  char _pad[5];
 } Mesh_Runtime;
 
 typedef struct Mesh {
@@ -228,6 +235,14 @@ typedef struct TFace {
 
 /* **************** MESH ********************* */
 
+/** #Mesh_Runtime.wrapper_type */
+typedef enum eMeshWrapperType {
+  /** Use mesh data (#Mesh.mvert, #Mesh.medge, #Mesh.mloop, #Mesh.mpoly). */
+  ME_WRAPPER_TYPE_MDATA = 0,
+  /** Use edit-mesh data (#Mesh_Runtime.edit_mesh_wrap, #Mesh_Runtime.edit_data). */
+  ME_WRAPPER_TYPE_BMESH = 1,
+} eMeshWrapperType;
+
 /* texflag */
 enum {
   ME_AUTOSPACE = 1,
@@ -519,6 +519,7 @@ typedef struct bNodeTree {
 
 /* tree is localized copy, free when deleting node groups */
 /* #define NTREE_IS_LOCALIZED           (1 << 5) */
+#define NTREE_COM_HALF_FLOAT_BUFFER (1 << 6) /* store color buffers as half float */
 
 /* ntree->update */
 typedef enum eNodeTreeUpdate {
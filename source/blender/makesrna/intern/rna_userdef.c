@@ -188,6 +188,7 @@ static const EnumPropertyItem rna_enum_userdef_viewport_aa_items[] = {
 #  include "DEG_depsgraph.h"
 
 #  include "GPU_draw.h"
+#  include "GPU_material.h"
 #  include "GPU_select.h"
 
 #  include "BLF_api.h"
@@ -370,6 +371,12 @@ static void rna_userdef_gl_texture_limit_update(Main *bmain, Scene *scene, Point
   rna_userdef_update(bmain, scene, ptr);
 }
 
+static void rna_userdef_shader_disk_cache_update(Main *bmain, Scene *scene, PointerRNA *ptr)
+{
+  GPU_pass_cache_disk_init();
+  rna_userdef_update(bmain, scene, ptr);
+}
+
 static void rna_userdef_undo_steps_set(PointerRNA *ptr, int value)
 {
   UserDef *userdef = (UserDef *)ptr->data;
@@ -5202,6 +5209,11 @@ static void rna_def_userdef_system(BlenderRNA *brna)
        0,
        "None",
        "Requires fast storage, but uses minimum CPU resources"},
+      {USER_SEQ_DISK_CACHE_COMPRESSION_FAST,
+       "FAST",
+       0,
+       "Fast",
+       "Requires fast storage, uses little CPU resources"},
       {USER_SEQ_DISK_CACHE_COMPRESSION_LOW,
        "LOW",
        0,
@@ -5257,6 +5269,15 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "compositor_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "compositor_cache_limit");
+  RNA_def_property_range(prop, 16, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Compositor Cache Limit",
+                           "Memory limit for node results the compositor keeps to avoid "
+                           "recalculating unchanged nodes while editing (in megabytes)");
+  RNA_def_property_update(prop, 0, "rna_userdef_update");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
@@ -5405,6 +5426,22 @@ static void rna_def_userdef_system(BlenderRNA *brna)
       "VBO Collection Rate",
       "Number of seconds between each run of the GL Vertex buffer object garbage collector");
 
+  prop = RNA_def_property(srna, "use_shader_disk_cache", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "gpu_flag", USER_GPU_FLAG_SHADER_DISK_CACHE);
+  RNA_def_property_ui_text(prop,
+                           "Shader Disk Cache",
+                           "Store compiled material shaders on disk, so they do not need to be "
+                           "compiled again in later sessions");
+  RNA_def_property_update(prop, 0, "rna_userdef_shader_disk_cache_update");
+
+  prop = RNA_def_property(srna, "shader_disk_cache_size", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "gpu_shader_cache_size");
+  RNA_def_property_range(prop, 16, INT_MAX);
+  RNA_def_property_ui_range(prop, 16, 8192, 64, -1);
+  RNA_def_property_ui_text(
+      prop, "Shader Disk Cache Limit", "Maximum size of the shader disk cache in megabytes");
+  RNA_def_property_update(prop, 0, "rna_userdef_shader_disk_cache_update");
+
   /* Select */
 
   prop = RNA_def_property(srna, "use_select_pick_depth", PROP_BOOLEAN, PROP_NONE);
@@ -5414,6 +5451,14 @@ static void rna_def_userdef_system(BlenderRNA *brna)
                            "Use the depth buffer for picking 3D View selection "
                            "(without this the front most object may not be selected first)");
 
+  prop = RNA_def_property(srna, "use_select_cpu", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "gpu_flag", USER_GPU_FLAG_SELECT_CPU);
+  RNA_def_property_ui_text(prop,
+                           "CPU Selection",
+                           "Use the CPU for box, lasso and circle select instead of drawing "
+                           "selection buffers, faster on dense meshes "
+                           "(always used in background mode)");
+
   /* Audio */
 
   prop = RNA_def_property(srna, "audio_mixing_buffer", PROP_ENUM, PROP_NONE);
@@ -46,6 +46,7 @@
 #include "BLI_path_util.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_timecode.h"
 
@@ -2321,6 +2322,37 @@ bool RE_WriteRenderViewsMovie(ReportList *reports,
   return ok;
 }
 
+/* The saving time is only known when the frame is written on the main thread. */
+static void render_print_frame_time(Render *re, const bool show_save_time)
+{
+  char name[FILE_MAX];
+  double render_time;
+
+  render_time = re->i.lastframetime;
+  re->i.lastframetime = PIL_check_seconds_timer() - re->i.starttime;
+
+  BLI_timecode_string_from_time_simple(name, sizeof(name), re->i.lastframetime);
+  printf(" Time: %s", name);
+
+  /* Flush stdout to be sure python callbacks are printing stuff after blender. */
+  fflush(stdout);
+
+  /* NOTE: using G_MAIN seems valid here???
+   * Not sure it's actually even used anyway, we could as well pass NULL? */
+  render_callback_exec_null(re, G_MAIN, BKE_CB_EVT_RENDER_STATS);
+
+  if (show_save_time) {
+    BLI_timecode_string_from_time_simple(name, sizeof(name), re->i.lastframetime - render_time);
+    printf(" (Saving: %s)\n", name);
+  }
+  else {
+    fputc('\n', stdout);
+  }
+
+  fputc('\n', stdout);
+  fflush(stdout); /* needed for renderd !! (not anymore... (ton)) */
+}
+
 static int do_write_image_or_movie(Render *re,
                                    Main *bmain,
                                    Scene *scene,
@@ -2330,7 +2362,6 @@ static int do_write_image_or_movie(Render *re,
 {
   char name[FILE_MAX];
   RenderResult rres;
-  double render_time;
   bool ok = true;
 
   RE_AcquireResultImageViews(re, &rres);
@@ -2361,24 +2392,7 @@ static int do_write_image_or_movie(Render *re,
 
   RE_ReleaseResultImageViews(re, &rres);
 
-  render_time = re->i.lastframetime;
-  re->i.lastframetime = PIL_check_seconds_timer() - re->i.starttime;
-
-  BLI_timecode_string_from_time_simple(name, sizeof(name), re->i.lastframetime);
-  printf(" Time: %s", name);
-
-  /* Flush stdout to be sure python callbacks are printing stuff after blender. */
-  fflush(stdout);
-
-  /* NOTE: using G_MAIN seems valid here???
-   * Not sure it's actually even used anyway, we could as well pass NULL? */
-  render_callback_exec_null(re, G_MAIN, BKE_CB_EVT_RENDER_STATS);
-
-  BLI_timecode_string_from_time_simple(name, sizeof(name), re->i.lastframetime - render_time);
-  printf(" (Saving: %s)\n", name);
-
-  fputc('\n', stdout);
-  fflush(stdout); /* needed for renderd !! (not anymore... (ton)) */
+  render_print_frame_time(re, true);
 
   return ok;
 }
@@ -2419,6 +2433,249 @@ static void re_movie_free_all(Render *re, bMovieHandle *mh, int totvideos)
   MEM_SAFE_FREE(re->movie_ctx_arr);
 }
 
+/* Animation Frame Pipeline
+ *
+ * Rendered frames are written from a background thread while the next frame is rendered and
+ * composited. Image sequences used by the compositor are read ahead for the next frame, so the
+ * compositor does not have to wait for the files to be decoded. */
+
+/* Limits the memory used by copies of render results waiting to be written. */
+#define MAX_SCHEDULED_FRAMES 2
+
+typedef struct RenderAnimWriter {
+  TaskPool *task_pool;
+  ThreadMutex mutex;
+  ThreadCondition condition;
+  int num_scheduled_frames;
+  /* Frames written since the last flush, for the write callbacks on the main thread. */
+  ListBase written_frames;
+  bool ok;
+  /* Reports of the write tasks, added to the render reports on the main thread. */
+  ReportList reports;
+
+  bMovieHandle *mh;
+  void **movie_ctx_arr;
+  int totvideos;
+} RenderAnimWriter;
+
+typedef struct RenderAnimWriteTask {
+  RenderResult *rr;
+  /* Copy of the scene with settings of the frame, main thread continues with the next one.
+   * The color management settings are copied too, as their curve mapping is modified when
+   * it is used. */
+  Scene tmp_scene;
+  char name[FILE_MAX];
+} RenderAnimWriteTask;
+
+static void render_anim_writer_init(
+    Render *re, RenderAnimWriter *writer, Scene *scene, bMovieHandle *mh, int totvideos)
+{
+  memset(writer, 0, sizeof(*writer));
+
+  /* Movie frames must be appended in order, so only use a single thread for them. */
+  if (BKE_imtype_is_movie(scene->r.im_format.imtype)) {
+    writer->task_pool = BLI_task_pool_create_background_serial(writer, TASK_PRIORITY_LOW);
+  }
+  else {
+    writer->task_pool = BLI_task_pool_create_background(writer, TASK_PRIORITY_LOW);
+  }
+  BLI_mutex_init(&writer->mutex);
+  BLI_condition_init(&writer->condition);
+  writer->ok = true;
+
+  BKE_reports_init(&writer->reports, re->reports ? RPT_STORE : 0);
+  writer->mh = mh;
+  writer->movie_ctx_arr = re->movie_ctx_arr;
+  writer->totvideos = totvideos;
+}
+
+static void render_anim_write_func(TaskPool *__restrict pool, void *taskdata)
+{
+  RenderAnimWriter *writer = BLI_task_pool_user_data(pool);
+  RenderAnimWriteTask *task = taskdata;
+  Scene *scene = &task->tmp_scene;
+  bool ok = false;
+
+  /* Don't attempt to write if we've got an error. */
+  if (writer->ok) {
+    /* Local reports, moved to the writer reports under the lock. */
+    ReportList reports;
+    BKE_reports_init(&reports, writer->reports.flag);
+
+    if (BKE_imtype_is_movie(scene->r.im_format.imtype)) {
+      ok = RE_WriteRenderViewsMovie(&reports,
+                                    task->rr,
+                                    scene,
+                                    &scene->r,
+                                    writer->mh,
+                                    writer->movie_ctx_arr,
+                                    writer->totvideos,
+                                    false);
+    }
+    else {
+      ok = RE_WriteRenderViewsImage(&reports, task->rr, scene, true, task->name);
+    }
+
+    BLI_mutex_lock(&writer->mutex);
+    BLI_movelisttolist(&writer->reports.list, &reports.list);
+    BLI_mutex_unlock(&writer->mutex);
+    BKE_reports_clear(&reports);
+  }
+
+  RE_FreeRenderResult(task->rr);
+  BKE_color_managed_view_settings_free(&scene->view_settings);
+  BKE_color_managed_view_settings_free(&scene->r.im_format.view_settings);
+
+  BLI_mutex_lock(&writer->mutex);
+  if (ok) {
+    BLI_addtail(&writer->written_frames, BLI_genericNodeN(POINTER_FROM_INT(scene->r.cfra)));
+  }
+  else {
+    writer->ok = false;
+  }
+  writer->num_scheduled_frames--;
+  BLI_condition_notify_all(&writer->condition);
+  BLI_mutex_unlock(&writer->mutex);
+}
+
+/* Copy the result of the current frame and write it in the background. */
+static bool render_anim_schedule_write(Render *re,
+                                       RenderAnimWriter *writer,
+                                       Main *bmain,
+                                       Scene *scene)
+{
+  RenderResult rres;
+
+  if (!writer->ok) {
+    return false;
+  }
+
+  RenderAnimWriteTask *task = MEM_mallocN(sizeof(RenderAnimWriteTask), "render anim write task");
+  task->tmp_scene = *scene;
+  BKE_color_managed_view_settings_copy(&task->tmp_scene.view_settings, &scene->view_settings);
+  BKE_color_managed_view_settings_copy(&task->tmp_scene.r.im_format.view_settings,
+                                       &scene->r.im_format.view_settings);
+  BKE_image_path_from_imformat(task->name,
+                               scene->r.pic,
+                               BKE_main_blendfile_path(bmain),
+                               scene->r.cfra,
+                               &scene->r.im_format,
+                               (scene->r.scemode & R_EXTENSION) != 0,
+                               true,
+                               NULL);
+
+  RE_AcquireResultImageViews(re, &rres);
+  task->rr = RE_DuplicateRenderResult(&rres);
+  RE_ReleaseResultImageViews(re, &rres);
+
+  BLI_mutex_lock(&writer->mutex);
+  while (writer->num_scheduled_frames >= MAX_SCHEDULED_FRAMES) {
+    BLI_condition_wait(&writer->condition, &writer->mutex);
+  }
+  writer->num_scheduled_frames++;
+  BLI_mutex_unlock(&writer->mutex);
+
+  BLI_task_pool_push(writer->task_pool, render_anim_write_func, task, true, NULL);
+
+  render_print_frame_time(re, false);
+
+  return true;
+}
+
+/* Run the post render and write callbacks for frames that finished writing, so handlers can
+ * post-process the files. The scene frame is temporarily set to the written frame. Returns
+ * false on write errors. */
+static bool render_anim_writer_flush(Render *re, RenderAnimWriter *writer, Scene *scene)
+{
+  ListBase written_frames;
+  ReportList reports;
+  BKE_reports_init(&reports, RPT_STORE);
+
+  BLI_mutex_lock(&writer->mutex);
+  written_frames = writer->written_frames;
+  BLI_listbase_clear(&writer->written_frames);
+  BLI_movelisttolist(&reports.list, &writer->reports.list);
+  BLI_mutex_unlock(&writer->mutex);
+
+  if (re->reports) {
+    LISTBASE_FOREACH (Report *, report, &reports.list) {
+      BKE_report(re->reports, report->type, report->message);
+    }
+  }
+  BKE_reports_clear(&reports);
+
+  const int cfra = scene->r.cfra;
+  LISTBASE_FOREACH (LinkData *, link, &written_frames) {
+    scene->r.cfra = POINTER_AS_INT(link->data);
+    /* keep after file save */
+    render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_POST);
+    render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_WRITE);
+  }
+  scene->r.cfra = cfra;
+  BLI_freelistN(&written_frames);
+
+  return writer->ok;
+}
+
+static bool render_anim_writer_end(Render *re, RenderAnimWriter *writer, Scene *scene)
+{
+  BLI_task_pool_work_and_wait(writer->task_pool);
+  BLI_task_pool_free(writer->task_pool);
+
+  const bool ok = render_anim_writer_flush(re, writer, scene);
+
+  BKE_reports_clear(&writer->reports);
+  BLI_mutex_end(&writer->mutex);
+  BLI_condition_end(&writer->condition);
+
+  return ok;
+}
+
+typedef struct RenderAnimPrefetchTask {
+  Image *image;
+  ImageUser iuser;
+} RenderAnimPrefetchTask;
+
+static void render_anim_prefetch_func(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  RenderAnimPrefetchTask *task = taskdata;
+  BKE_image_prefetch_ibuf(task->image, &task->iuser);
+}
+
+static void render_anim_prefetch_node_tree(TaskPool *task_pool, bNodeTree *ntree, int cfra)
+{
+  LISTBASE_FOREACH (bNode *, node, &ntree->nodes) {
+    if (node->id == NULL || (node->flag & NODE_MUTED)) {
+      continue;
+    }
+
+    if (node->type == CMP_NODE_IMAGE) {
+      Image *ima = (Image *)node->id;
+      if (ima->source != IMA_SRC_SEQUENCE) {
+        continue;
+      }
+
+      RenderAnimPrefetchTask *task = MEM_mallocN(sizeof(RenderAnimPrefetchTask),
+                                                 "render anim prefetch task");
+      task->image = ima;
+      task->iuser = *(ImageUser *)node->storage;
+      BKE_image_user_frame_calc(ima, &task->iuser, cfra);
+      BLI_task_pool_push(task_pool, render_anim_prefetch_func, task, true, NULL);
+    }
+    else if (node->type == NODE_GROUP) {
+      render_anim_prefetch_node_tree(task_pool, (bNodeTree *)node->id, cfra);
+    }
+  }
+}
+
+/* Read the images the compositor uses for the given frame in the background. */
+static void render_anim_prefetch_frame(TaskPool *task_pool, Scene *scene, int cfra)
+{
+  if (scene->nodetree && scene->use_nodes && (scene->r.scemode & R_DOCOMP)) {
+    render_anim_prefetch_node_tree(task_pool, scene->nodetree, cfra);
+  }
+}
+
 /* saves images to disk */
 void RE_RenderAnim(Render *re,
                    Main *bmain,
@@ -2496,6 +2753,10 @@ void RE_RenderAnim(Render *re,
 
   re->flag |= R_ANIMATION;
 
+  RenderAnimWriter writer;
+  render_anim_writer_init(re, &writer, scene, mh, totvideos);
+  TaskPool *prefetch_pool = BLI_task_pool_create_background(NULL, TASK_PRIORITY_LOW);
+
   {
     for (nfra = sfra, scene->r.cfra = sfra; scene->r.cfra <= efra; scene->r.cfra++) {
       char name[FILE_MAX];
@@ -2608,12 +2869,19 @@ void RE_RenderAnim(Render *re,
       /* run callbacks before rendering, before the scene is updated */
       render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_PRE);
 
+      /* Images of this frame were read while the previous one was rendered, start reading
+       * the images of the next frame. */
+      BLI_task_pool_work_and_wait(prefetch_pool);
+      if (nfra <= efra) {
+        render_anim_prefetch_frame(prefetch_pool, scene, nfra);
+      }
+
       do_render_all_options(re);
       totrendered++;
 
       if (re->test_break(re->tbh) == 0) {
         if (!G.is_break) {
-          if (!do_write_image_or_movie(re, bmain, scene, mh, totvideos, NULL)) {
+          if (!render_anim_schedule_write(re, &writer, bmain, scene)) {
             G.is_break = true;
           }
         }
@@ -2656,13 +2924,21 @@ void RE_RenderAnim(Render *re,
       }
 
       if (G.is_break == false) {
-        /* keep after file save */
-        render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_POST);
-        render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_WRITE);
+        if (!render_anim_writer_flush(re, &writer, scene)) {
+          G.is_break = true;
+          break;
+        }
       }
     }
   }
 
+  BLI_task_pool_cancel(prefetch_pool);
+  BLI_task_pool_free(prefetch_pool);
+
+  if (!render_anim_writer_end(re, &writer, scene)) {
+    G.is_break = true;
+  }
+
   /* end movie */
   if (is_movie) {
     re_movie_free_all(re, mh, totvideos);